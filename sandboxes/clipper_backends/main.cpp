@@ -0,0 +1,101 @@
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+// Compares the legacy Clipper and the Clipper2 backend of ClipperUtils on the layers of real models:
+// time of the offset and boolean workloads of perimeter, overhang and infill generation and the difference
+// of the resulting areas.
+// Usage: clipper_backends <model file> [<model file> ...]
+
+namespace Slic3r {
+
+struct Workload
+{
+    std::string                                                    name;
+    std::function<ExPolygons(const ExPolygons &, const ExPolygons &)> run;
+};
+
+struct MeasureResult
+{
+    double time { 0. };
+    double area { 0. };
+};
+
+static MeasureResult measure(const Workload &workload, const std::vector<ExPolygons> &layers, bool clipper2)
+{
+    ClipperUtils::set_clipper2_backend(clipper2);
+
+    MeasureResult r;
+    Benchmark     b;
+    b.start();
+    for (size_t i = 1; i < layers.size(); ++ i)
+        for (const ExPolygon &expoly : workload.run(layers[i], layers[i - 1]))
+            r.area += expoly.area();
+    b.stop();
+    r.time = b.getElapsedSec();
+    return r;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model file> [<model file> ...]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Layers of all the models sliced at 0.2mm.
+    std::vector<ExPolygons> layers;
+    for (int i = 1; i < argc; ++ i) {
+        Model model = Model::read_from_file(argv[i]);
+        for (ModelObject *mo : model.objects) {
+            indexed_triangle_set its = mo->raw_mesh().its;
+            BoundingBoxf3        bb  = mo->raw_mesh_bounding_box();
+            std::vector<float>   zs;
+            for (double z = bb.min.z() + 0.1; z < bb.max.z(); z += 0.2)
+                zs.emplace_back(float(z));
+            append(layers, slice_mesh_ex(its, zs, MeshSlicingParamsEx{}));
+        }
+    }
+
+    const float width = float(scaled(0.45));
+    const std::vector<Workload> workloads {
+        { "perimeters", [width](const ExPolygons &layer, const ExPolygons &) {
+            ExPolygons out, loop = offset_ex(layer, -0.5f * width);
+            for (int i = 0; i < 3 && ! loop.empty(); ++ i) {
+                append(out, loop);
+                loop = offset2_ex(loop, -1.5f * width, 0.5f * width);
+            }
+            return out;
+        } },
+        { "overhangs",    [width](const ExPolygons &layer, const ExPolygons &lower) { return diff_ex(layer, offset_ex(lower, width)); } },
+        { "intersection", [](const ExPolygons &layer, const ExPolygons &lower) { return intersection_ex(layer, lower); } },
+        { "union",        [](const ExPolygons &layer, const ExPolygons &lower) { ExPolygons both = layer; append(both, lower); return union_ex(both); } },
+        { "opening",      [width](const ExPolygons &layer, const ExPolygons &) { return opening_ex(layer, width); } },
+        { "closing",      [width](const ExPolygons &layer, const ExPolygons &) { return closing_ex(layer, width); } },
+    };
+
+    const bool clipper2_default = ClipperUtils::clipper2_backend();
+    std::cout << "layers: " << layers.size() << std::endl;
+    std::cout << "workload;clipper [s];clipper2 [s];speedup;area difference [%]" << std::endl;
+    for (const Workload &workload : workloads) {
+        MeasureResult clipper  = measure(workload, layers, false);
+        MeasureResult clipper2 = measure(workload, layers, true);
+        std::cout << workload.name << ";" << clipper.time << ";" << clipper2.time << ";" << (clipper2.time > 0. ? clipper.time / clipper2.time : 0.) << ";"
+                  << (clipper.area > 0. ? 100. * (clipper2.area - clipper.area) / clipper.area : 0.) << std::endl;
+    }
+    ClipperUtils::set_clipper2_backend(clipper2_default);
+
+    return EXIT_SUCCESS;
+}
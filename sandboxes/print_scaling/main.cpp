@@ -0,0 +1,63 @@
+#include <iostream>
+#include <vector>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/ModelArrange.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+// Measures Print::process() of 1 to 64 identical small objects with the objects processed
+// one after the other and concurrently, see Print::set_parallel_objects().
+
+namespace Slic3r {
+
+static double measure_process(size_t num_objects, bool parallel_objects)
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+
+    Model model;
+    for (size_t i = 0; i < num_objects; ++ i) {
+        // Each object gets its own mesh, otherwise the objects would share their slices.
+        ModelObject *object = model.add_object();
+        object->name = "object" + std::to_string(i) + ".stl";
+        object->add_volume(TriangleMesh(its_make_cylinder(5., 4., 2. * PI / 64.)));
+        object->add_instance();
+    }
+    arrange_objects(model, InfiniteBed{}, ArrangeParams{ scaled(min_object_distance(config)) });
+
+    Print print;
+    for (ModelObject *mo : model.objects) {
+        mo->ensure_on_bed();
+        print.auto_assign_extruders(mo);
+    }
+    print.apply(model, config);
+    print.validate();
+    print.set_status_silent();
+
+    print.set_parallel_objects(parallel_objects);
+    Benchmark b;
+    b.start();
+    print.process();
+    b.stop();
+    return b.getElapsedSec();
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    std::cout << "objects;serial [s];parallel [s];speedup" << std::endl;
+    for (size_t num_objects = 1; num_objects <= 64; num_objects *= 2) {
+        double serial   = measure_process(num_objects, false);
+        double parallel = measure_process(num_objects, true);
+        std::cout << num_objects << ";" << serial << ";" << parallel << ";" << (parallel > 0. ? serial / parallel : 0.) << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
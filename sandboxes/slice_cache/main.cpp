@@ -0,0 +1,115 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/Format/SliceCache.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+// Compares the binary slice cache against the JSON dump: export time, load time and size on disk.
+// Usage: slice_cache <model file> [<model file> ...]
+
+namespace fs = boost::filesystem;
+
+namespace Slic3r {
+
+struct MeasureResult
+{
+    double   export_time { 0. };
+    double   load_time   { 0. };
+    uintmax_t size       { 0 };
+};
+
+static uintmax_t directory_size(const fs::path &dir, const std::string &extension)
+{
+    uintmax_t size = 0;
+    for (const fs::directory_entry &entry : fs::directory_iterator(dir))
+        if (fs::is_regular_file(entry.status()) && entry.path().extension() == extension)
+            size += fs::file_size(entry.path());
+    return size;
+}
+
+static MeasureResult measure(Print &print, const Model &model, const DynamicPrintConfig &config, const fs::path &dir, bool binary)
+{
+    MeasureResult r;
+    Benchmark     b;
+
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    b.start();
+    int ret = print.export_cached_data(dir.string(), false, binary);
+    b.stop();
+    if (ret)
+        std::cerr << "export to " << dir.string() << " failed, ret=" << ret << std::endl;
+    r.export_time = b.getElapsedSec();
+    r.size        = directory_size(dir, binary ? SliceCache::Extension : ".json");
+
+    Print loaded;
+    loaded.apply(model, config);
+    b.start();
+    ret = loaded.load_cached_data(dir.string());
+    b.stop();
+    if (ret)
+        std::cerr << "load from " << dir.string() << " failed, ret=" << ret << std::endl;
+    r.load_time = b.getElapsedSec();
+
+    return r;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model file> [<model file> ...]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_key_value("enable_support", new ConfigOptionBool(true));
+
+    Model model;
+    for (int i = 1; i < argc; ++ i) {
+        Model m = Model::read_from_file(argv[i]);
+        for (ModelObject *mo : m.objects)
+            model.add_object(*mo);
+    }
+    for (ModelObject *mo : model.objects) {
+        if (mo->instances.empty())
+            mo->add_instance();
+        mo->ensure_on_bed();
+    }
+
+    Print print;
+    for (ModelObject *mo : model.objects)
+        print.auto_assign_extruders(mo);
+    print.apply(model, config);
+    print.validate();
+    print.set_status_silent();
+
+    Benchmark b;
+    b.start();
+    print.process();
+    b.stop();
+    std::cout << "Slicing [s]: " << b.getElapsedSec() << std::endl;
+
+    fs::path tmp = fs::temp_directory_path() / fs::unique_path("slice_cache_%%%%%%");
+    MeasureResult json   = measure(print, model, config, tmp / "json", false);
+    MeasureResult binary = measure(print, model, config, tmp / "binary", true);
+    fs::remove_all(tmp);
+
+    std::cout << "format;export [s];load [s];size [bytes]" << std::endl;
+    std::cout << "json;"   << json.export_time   << ";" << json.load_time   << ";" << json.size   << std::endl;
+    std::cout << "binary;" << binary.export_time << ";" << binary.load_time << ";" << binary.size << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/PrintConfig.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+// Measures the time of tree support generation with 1 to all the available cores. The support time is
+// the difference of Print::process() with and without the tree supports.
+// Usage: tree_support_scaling <model file> [<model file> ...]
+
+namespace Slic3r {
+
+static double measure_process(Model &model, bool support, size_t num_threads)
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_key_value("enable_support", new ConfigOptionBool(support));
+    config.set_key_value("support_type", new ConfigOptionEnum<SupportType>(stTreeAuto));
+
+    Print print;
+    for (ModelObject *mo : model.objects)
+        print.auto_assign_extruders(mo);
+    print.apply(model, config);
+    print.validate();
+    print.set_status_silent();
+
+    tbb::global_control control(tbb::global_control::max_allowed_parallelism, num_threads);
+    Benchmark b;
+    b.start();
+    print.process();
+    b.stop();
+    return b.getElapsedSec();
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model file> [<model file> ...]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Model model;
+    for (int i = 1; i < argc; ++ i) {
+        Model m = Model::read_from_file(argv[i]);
+        for (ModelObject *mo : m.objects)
+            model.add_object(*mo);
+    }
+    for (ModelObject *mo : model.objects) {
+        if (mo->instances.empty())
+            mo->add_instance();
+        mo->ensure_on_bed();
+    }
+
+    const size_t max_threads = size_t(std::max(1, tbb::this_task_arena::max_concurrency()));
+    double       support_single = 0.;
+    std::cout << "threads;without support [s];with support [s];support [s];speedup" << std::endl;
+    for (size_t num_threads = 1;; num_threads = std::min(2 * num_threads, max_threads)) {
+        double without = measure_process(model, false, num_threads);
+        double with    = measure_process(model, true, num_threads);
+        double support = std::max(0., with - without);
+        if (num_threads == 1)
+            support_single = support;
+        std::cout << num_threads << ";" << without << ";" << with << ";" << support << ";" << (support > 0. ? support_single / support : 0.) << std::endl;
+        if (num_threads == max_threads)
+            break;
+    }
+
+    return EXIT_SUCCESS;
+}
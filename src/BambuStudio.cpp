@@ -158,6 +158,8 @@ typedef struct  _sliced_plate_info{
     size_t generate_support_material_time {0};
     size_t triangle_count{0};
     std::string warning_message;
+    //BBS: timing and counters of every print / object step
+    json stage_statistics;
 }sliced_plate_info_t;
 
 typedef struct _sliced_info {
@@ -404,6 +406,50 @@ static PrinterTechnology get_printer_technology(const DynamicConfig &config)
     return(ret);}
 #endif
 
+//BBS: collect the per step wall time, CPU time and peak memory growth and the object counters of a processed print
+//the CPU time and the peak memory growth are sampled for the whole process, the steps of the objects processed concurrently
+//overlap, thus these values include the work of the other objects and must not be summed up, see PrintStepStats
+static json collect_stage_statistics(const Print &print)
+{
+    auto step_stats_json = [](const PrintStepStats &stats) {
+        json j;
+        j["wall_time"] = stats.wall_time_ms;
+        j["cpu_time"] = stats.cpu_time_ms;
+        j["peak_rss_delta"] = stats.peak_rss_delta;
+        return j;
+    };
+
+    json j;
+    j["print_steps"] = json::object();
+    for (int step = 0; step < int(psCount); step++) {
+        if (step != psGCodeExport && print.is_step_done(PrintStep(step)))
+            j["print_steps"][print_step_name(PrintStep(step))] = step_stats_json(print.step_stats(PrintStep(step)));
+    }
+    //psGCodeExport is not marked done by the command line export, report the timing of export_gcode() itself
+    if (print.gcode_export_stats())
+        j["print_steps"][print_step_name(psGCodeExport)] = step_stats_json(*print.gcode_export_stats());
+    j["objects"] = json::array();
+    for (const PrintObject *object : print.objects()) {
+        json object_json;
+        PrintObject::Counters counters = object->counters();
+        object_json["name"] = object->model_object()->name;
+        object_json["identify_id"] = object->model_object()->instances.empty() ? 0 : object->model_object()->instances[0]->loaded_id;
+        object_json["shared"] = object->get_shared_object() != nullptr;
+        object_json["layer_count"] = counters.layers;
+        object_json["support_layer_count"] = counters.support_layers;
+        object_json["region_count"] = counters.regions;
+        object_json["layer_region_count"] = counters.layer_regions;
+        object_json["polygon_count"] = counters.polygons;
+        object_json["steps"] = json::object();
+        for (int step = 0; step < int(posCount); step++) {
+            if (object->is_step_done(PrintObjectStep(step)))
+                object_json["steps"][print_object_step_name(PrintObjectStep(step))] = step_stats_json(object->step_stats(PrintObjectStep(step)));
+        }
+        j["objects"].push_back(std::move(object_json));
+    }
+    return j;
+}
+
 void record_exit_reson(std::string outputdir, int code, int plate_id, std::string error_message, sliced_info_t& sliced_info, std::map<std::string, std::string> key_values = std::map<std::string, std::string>())
 {
 #if defined(__linux__) || defined(__LINUX__)
@@ -437,6 +483,8 @@ void record_exit_reson(std::string outputdir, int code, int plate_id, std::strin
             plate_json["generate_support_material_time"] = sliced_info.sliced_plates[index].generate_support_material_time;
             plate_json["triangle_count"] = sliced_info.sliced_plates[index].triangle_count;
             plate_json["warning_message"] = sliced_info.sliced_plates[index].warning_message;
+            if (!sliced_info.sliced_plates[index].stage_statistics.is_null())
+                plate_json["stage_statistics"] = sliced_info.sliced_plates[index].stage_statistics;
             j["sliced_plates"].push_back(plate_json);
         }
         for (auto& iter: key_values)
@@ -4292,6 +4340,8 @@ int CLI::run(int argc, char **argv)
             Slic3r::GUI::PartPlate* cur_plate = nullptr;
             int low_duplicate_count = 0, up_duplicate_count = duplicate_count, arrange_count = 0;
             float orig_wipe_x = 0.f, orig_wipe_y = 0.f;
+            // the same shapes are arranged again while searching for the duplicate count
+            std::shared_ptr<arrangement::NfpCache> nfp_cache = arrangement::create_nfp_cache();
 
             if (duplicate_count > 0) {
                 original_model = model;
@@ -4299,7 +4349,10 @@ int CLI::run(int argc, char **argv)
 
             while(!finished_arrange)
             {
+                //indices of the instances of the original objects in selected
+                std::vector<size_t> selected_originals;
                 arrange_cfg = ArrangeParams();  // reset all params
+                arrange_cfg.nfp_cache = nfp_cache;
                 arrange_count++;
                 //step-0: duplicate model
                 if (duplicate_count > 0)
@@ -4460,6 +4513,9 @@ int CLI::run(int argc, char **argv)
                             BOOST_LOG_TRIVIAL(info) << boost::format("name %4% in_plate %1% printable %2%, locked %3%")%in_plate %mo->instances[inst_idx]->printable %locked % ap.name ;
                             if (!locked)
                             {
+                                //the copies are appended as new objects behind the original ones
+                                if ((&cont == &selected) && (oidx < original_model.objects.size()))
+                                    selected_originals.push_back(selected.size());
                                 ap.itemid = cont.size();
                                 cont.emplace_back(std::move(ap));
                             }
@@ -4625,11 +4681,35 @@ int CLI::run(int argc, char **argv)
                     //boost::nowide::cout << "st=" << st << ", " << str << std::endl;
                 };
 
+                //Step-2.5: find a lower bound of the count of copies in a single pass for multiple objects mode
+                //it only narrows the bisection below, the full arrange still runs at the requested count and verifies every tried count,
+                //the single object mode arranges all the copies once and keeps the ones landing on the plate, it needs no search
+                if ((arrange_count == 1) && (duplicate_count > 0) && !duplicate_single_object && !selected_originals.empty())
+                {
+                    //the copies are the same shapes as the original instances, laid out one set after another
+                    size_t set_size = selected_originals.size();
+                    ArrangePolygons sets;
+                    sets.reserve(set_size * (duplicate_count + 1));
+                    for (int index = 0; index <= duplicate_count; index++)
+                        for (size_t original_idx : selected_originals)
+                            sets.emplace_back(selected[original_idx]);
+
+                    size_t placed_count = arrangement::arrange_until_full(sets, unselected, beds, arrange_cfg);
+                    int fit_count = int(placed_count / set_size) - 1;
+                    BOOST_LOG_TRIVIAL(info) << boost::format("arrange until full: placed %1% of %2% items, fit copies %3%")%placed_count %sets.size() %fit_count;
+                    if ((fit_count > low_duplicate_count) && (fit_count < duplicate_count))
+                    {
+                        //the greedy fill only proves a lower bound, the full arrange may fit more copies, the upper bound stays
+                        low_duplicate_count = fit_count;
+                        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": count %1%, new low_duplicate_count %2%, up_duplicate_count %3%")%duplicate_count %low_duplicate_count %up_duplicate_count;
+                    }
+                }
+
                 //Step-3:do the arrange
                 BOOST_LOG_TRIVIAL(info) << boost::format("start %1% th arranging...")%arrange_count;
                 arrangement::arrange(selected, unselected, beds, arrange_cfg);
                 arrangement::arrange(unprintable, {}, beds, arrange_cfg);
-                BOOST_LOG_TRIVIAL(info) << boost::format("finished %1% th arranging...")%arrange_count;
+                BOOST_LOG_TRIVIAL(info) << boost::format("finished %1% th arranging, nfp cache: %2%")%arrange_count %arrangement::nfp_cache_stats(*nfp_cache);
 
                 //Step-4:postprocess by partplate list&&apply the result
                 int bed_idx_max = 0;
@@ -5581,6 +5661,8 @@ int CLI::run(int argc, char **argv)
                                 sliced_plate_info.make_perimeters_time = slice_time[TIME_MAKE_PERIMETERS];
                                 sliced_plate_info.infill_time = slice_time[TIME_INFILL];
                                 sliced_plate_info.generate_support_material_time = slice_time[TIME_GENERATE_SUPPORT];
+                                if (print_fff)
+                                    sliced_plate_info.stage_statistics = collect_stage_statistics(*print_fff);
 
 
                                 if (max_slicing_time_per_plate != 0) {
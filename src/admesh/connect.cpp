@@ -26,6 +26,8 @@
 #include <math.h>
 
 #include <algorithm>
+#include <cmath>
+#include <utility>
 #include <vector>
 
 #include <boost/predef/other/endian.h>
@@ -34,8 +36,86 @@
 #define BOOST_POOL_NO_MT
 #include <boost/pool/object_pool.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
 #include "stl.h"
 
+// Ordering of vertices used to store the vertices of an edge in a unique order.
+// This method is numerically robust.
+static inline bool vertex_lower(const stl_vertex &a, const stl_vertex &b)
+{
+	return (a(0) != b(0)) ? (a(0) < b(0)) :
+	       ((a(1) != b(1)) ? (a(1) < b(1)) : (a(2) < b(2)));
+}
+
+// Key of an edge for the exact matching: sorted vertices of the edge.
+// If the edge is stored backwards, which_edge is increased by 3.
+static inline void stl_edge_key_exact(uint32_t key[6], int &which_edge, const stl_vertex *a, const stl_vertex *b)
+{
+  	// Ensure identical vertex ordering of equal edges.
+  	if (! vertex_lower(*a, *b)) {
+  		// This edge is loaded backwards.
+	    std::swap(a, b);
+	    which_edge += 3;
+  	}
+  	memcpy(&key[0], a->data(), sizeof(stl_vertex));
+  	memcpy(&key[3], b->data(), sizeof(stl_vertex));
+  	// Switch negative zeros to positive zeros, so memcmp will consider them to be equal.
+  	for (size_t i = 0; i < 6; ++ i) {
+    	unsigned char *p = (unsigned char*)(key + i);
+#if BOOST_ENDIAN_LITTLE_BYTE
+    	if (p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 0x80)
+      		// Negative zero, switch to positive zero.
+      		p[3] = 0;
+#else /* BOOST_ENDIAN_LITTLE_BYTE */
+    	if (p[0] == 0x80 && p[1] == 0 && p[2] == 0 && p[3] == 0)
+      		// Negative zero, switch to positive zero.
+      		p[0] = 0;
+#endif /* BOOST_ENDIAN_LITTLE_BYTE */
+  	}
+}
+
+// Edge of a facet, keyed by the bits of its ordered vertices for the exact matching of edges.
+struct BucketedEdge {
+	// Key of a sorted edge: sorted vertices of the edge.
+	uint32_t       key[6];
+	// Index of a facet owning this edge.
+	int            facet_number;
+	// Index of this edge inside the facet with an index of facet_number.
+	// If this edge is stored backwards, which_edge is increased by 3.
+	int            which_edge;
+
+	bool     key_equal(const BucketedEdge &rhs) const { return memcmp(key, rhs.key, sizeof(key)) == 0; }
+	uint32_t hash() const {
+		uint64_t h = 0;
+		for (int i = 0; i < 6; ++ i)
+			h = (h ^ key[i]) * 0x9E3779B97F4A7C15ull;
+		return uint32_t(h >> 32);
+	}
+
+	void load_exact(const stl_vertex *a, const stl_vertex *b) { stl_edge_key_exact(this->key, this->which_edge, a, b); }
+};
+
+// Facet a's neighbor is facet b and vice versa, which_edge_a and which_edge_b are the indices of the shared edge as stored by HashEdge or BucketedEdge.
+static inline void stl_link_neighbors(stl_file *stl, int facet_a, int which_edge_a, int facet_b, int which_edge_b)
+{
+	// Facet a's neighbor is facet b
+	stl->neighbors_start[facet_a].neighbor[which_edge_a % 3] = facet_b;	/* sets the .neighbor part */
+	stl->neighbors_start[facet_a].which_vertex_not[which_edge_a % 3] = (which_edge_b + 2) % 3; /* sets the .which_vertex_not part */
+
+	// Facet b's neighbor is facet a
+	stl->neighbors_start[facet_b].neighbor[which_edge_b % 3] = facet_a;	/* sets the .neighbor part */
+	stl->neighbors_start[facet_b].which_vertex_not[which_edge_b % 3] = (which_edge_a + 2) % 3; /* sets the .which_vertex_not part */
+
+	if ((which_edge_a < 3 && which_edge_b < 3) || (which_edge_a > 2 && which_edge_b > 2)) {
+		// These facets are oriented in opposite directions, their normals are probably messed up.
+		stl->neighbors_start[facet_a].which_vertex_not[which_edge_a % 3] += 3;
+		stl->neighbors_start[facet_b].which_vertex_not[which_edge_b % 3] += 3;
+	}
+}
+
 struct HashEdge {
 	// Key of a hash edge: sorted vertices of the edge.
 	uint32_t       key[6];
@@ -58,30 +138,7 @@ struct HashEdge {
 	    	float max_diff = std::max(diff(0), std::max(diff(1), diff(2)));
 	    	stl->stats.shortest_edge = std::min(max_diff, stl->stats.shortest_edge);
 	  	}
-
-	  	// Ensure identical vertex ordering of equal edges.
-	  	// This method is numerically robust.
-	  	if (vertex_lower(*a, *b)) {
-	  	} else {
-	  		// This edge is loaded backwards.
-		    std::swap(a, b);
-		    this->which_edge += 3;
-	  	}
-	  	memcpy(&this->key[0], a->data(), sizeof(stl_vertex));
-	  	memcpy(&this->key[3], b->data(), sizeof(stl_vertex));
-	  	// Switch negative zeros to positive zeros, so memcmp will consider them to be equal.
-	  	for (size_t i = 0; i < 6; ++ i) {
-	    	unsigned char *p = (unsigned char*)(this->key + i);
-	#if BOOST_ENDIAN_LITTLE_BYTE
-	    	if (p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 0x80)
-	      		// Negative zero, switch to positive zero.
-	      		p[3] = 0;
-	#else /* BOOST_ENDIAN_LITTLE_BYTE */
-	    	if (p[0] == 0x80 && p[1] == 0 && p[2] == 0 && p[3] == 0)
-	      		// Negative zero, switch to positive zero.
-	      		p[0] = 0;
-	#endif /* BOOST_ENDIAN_LITTLE_BYTE */
-	  	}
+	  	stl_edge_key_exact(this->key, this->which_edge, a, b);
 	}
 
 	bool load_nearby(const stl_file *stl, const stl_vertex &a, const stl_vertex &b, float tolerance)
@@ -112,12 +169,6 @@ struct HashEdge {
 		}
 		return true;
 	}
-
-private:
-	inline bool vertex_lower(const stl_vertex &a, const stl_vertex &b) {
-	  	return (a(0) != b(0)) ? (a(0) < b(0)) :
-	           ((a(1) != b(1)) ? (a(1) < b(1)) : (a(2) < b(2)));
-	}
 };
 
 struct HashTableEdges {
@@ -242,19 +293,7 @@ private:
 	// Connect edge_a with edge_b, update edge connection statistics.
 	static void record_neighbors(stl_file *stl, const HashEdge &edge_a, const HashEdge &edge_b)
 	{
-		// Facet a's neighbor is facet b
-		stl->neighbors_start[edge_a.facet_number].neighbor[edge_a.which_edge % 3] = edge_b.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] = (edge_b.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		// Facet b's neighbor is facet a
-		stl->neighbors_start[edge_b.facet_number].neighbor[edge_b.which_edge % 3] = edge_a.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] = (edge_a.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		if ((edge_a.which_edge < 3 && edge_b.which_edge < 3) || (edge_a.which_edge > 2 && edge_b.which_edge > 2)) {
-			// These facets are oriented in opposite directions, their normals are probably messed up.
-			stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] += 3;
-			stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] += 3;
-		}
+		stl_link_neighbors(stl, edge_a.facet_number, edge_a.which_edge, edge_b.facet_number, edge_b.which_edge);
 
 		// Count successful connects:
 		// Total connects:
@@ -454,22 +493,158 @@ void stl_check_facets_exact(stl_file *stl)
 		  	++ i;
   	}
 
-  	// Initialize hash table.
-  	HashTableEdges hash_table(stl->stats.number_of_facets);
 	for (auto &neighbor : stl->neighbors_start)
 		neighbor.reset();
 
-  	// Connect neighbor edges.
-	for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i) {
-		const stl_facet &facet = stl->facet_start[i];
-		for (int j = 0; j < 3; ++ j) {
-			HashEdge edge;
-			edge.facet_number = i;
-			edge.which_edge = j;
-			edge.load_exact(stl, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
-			hash_table.insert_edge_exact(stl, edge);
-		}
+	// Collect the edges of all facets in parallel, update the shortest edge.
+	std::vector<BucketedEdge> edges(size_t(stl->stats.number_of_facets) * 3);
+	auto edge_length = [stl](uint32_t facet_idx, int j) {
+		const stl_facet &facet = stl->facet_start[facet_idx];
+		stl_vertex diff = (facet.vertex[j] - facet.vertex[(j + 1) % 3]).cwiseAbs();
+		return std::max(diff(0), std::max(diff(1), diff(2)));
+	};
+	std::pair<float, bool> shortest_edge = tbb::parallel_reduce(tbb::blocked_range<uint32_t>(0, stl->stats.number_of_facets, 0x4000),
+		std::make_pair(stl->stats.shortest_edge, false),
+		[stl, &edges, &edge_length](const tbb::blocked_range<uint32_t> &range, std::pair<float, bool> shortest) {
+			for (uint32_t i = range.begin(); i < range.end(); ++ i) {
+				const stl_facet &facet = stl->facet_start[i];
+				for (int j = 0; j < 3; ++ j) {
+					BucketedEdge &edge = edges[size_t(i) * 3 + j];
+					edge.facet_number = i;
+					edge.which_edge = j;
+					edge.load_exact(&facet.vertex[j], &facet.vertex[(j + 1) % 3]);
+					float max_diff = edge_length(i, j);
+					if (std::isnan(max_diff))
+						shortest.second = true;
+					else
+						shortest.first = std::min(max_diff, shortest.first);
+				}
+			}
+			return shortest;
+		},
+		[](const std::pair<float, bool> &a, const std::pair<float, bool> &b) { return std::make_pair(std::min(a.first, b.first), a.second || b.second); });
+	if (shortest_edge.second || std::isnan(stl->stats.shortest_edge)) {
+		// std::min() does not ignore NaNs, thus the order of the edges matters.
+		for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i)
+			for (int j = 0; j < 3; ++ j)
+				stl->stats.shortest_edge = std::min(edge_length(i, j), stl->stats.shortest_edge);
+	} else
+		stl->stats.shortest_edge = shortest_edge.first;
+
+	// Partition the edges into buckets by the hashes of their keys, keeping the order of the edges (stable counting sort).
+	// Equal edges land into the same bucket, the buckets are small enough to be matched in cache.
+	const size_t num_edges   = edges.size();
+	int          bucket_bits = 0;
+	while (bucket_bits < 24 && (size_t(1024) << bucket_bits) < num_edges)
+		++ bucket_bits;
+	const size_t num_buckets = size_t(1) << bucket_bits;
+	auto         bucket_of   = [bucket_bits](const BucketedEdge &edge) { return bucket_bits == 0 ? size_t(0) : size_t(edge.hash() >> (32 - bucket_bits)); };
+	const size_t chunk_size  = std::max<size_t>(0x10000, (num_edges + 63) / 64);
+	const size_t num_chunks  = (num_edges + chunk_size - 1) / chunk_size;
+	// Number of edges of a chunk in a bucket, then the position of the first edge of a chunk in a bucket.
+	std::vector<size_t> chunk_offsets(num_chunks * num_buckets, 0);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1), [&edges, &chunk_offsets, &bucket_of, chunk_size, num_edges, num_buckets](const tbb::blocked_range<size_t> &range) {
+		for (size_t chunk = range.begin(); chunk < range.end(); ++ chunk)
+			for (size_t i = chunk * chunk_size; i < std::min(num_edges, (chunk + 1) * chunk_size); ++ i)
+				++ chunk_offsets[chunk * num_buckets + bucket_of(edges[i])];
+	});
+	std::vector<size_t> bucket_begin(num_buckets + 1);
+	size_t              offset = 0;
+	for (size_t bucket = 0; bucket < num_buckets; ++ bucket) {
+		bucket_begin[bucket] = offset;
+		for (size_t chunk = 0; chunk < num_chunks; ++ chunk)
+			offset += std::exchange(chunk_offsets[chunk * num_buckets + bucket], offset);
 	}
+	bucket_begin.back() = offset;
+	std::vector<BucketedEdge> bucketed_edges(num_edges);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1), [&edges, &bucketed_edges, &chunk_offsets, &bucket_of, chunk_size, num_edges, num_buckets](const tbb::blocked_range<size_t> &range) {
+		for (size_t chunk = range.begin(); chunk < range.end(); ++ chunk)
+			for (size_t i = chunk * chunk_size; i < std::min(num_edges, (chunk + 1) * chunk_size); ++ i)
+				bucketed_edges[chunk_offsets[chunk * num_buckets + bucket_of(edges[i])] ++] = edges[i];
+	});
+	edges = std::vector<BucketedEdge>();
+
+  	// Connect neighbor edges. Each edge is connected with the first of the preceding equal edges, which belongs to another facet
+  	// and which is not connected yet. This is the order, in which the edges used to be matched by inserting them into a hash table
+  	// facet by facet, thus the neighbors do not change. The buckets are disjoint, they are processed in parallel,
+  	// each bucket with its own small hash table of the chains of equal edges not connected yet.
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_buckets, 16), [stl, &bucketed_edges, &bucket_begin](const tbb::blocked_range<size_t> &range) {
+		struct Chain {
+			// First edge of this key, -1 for an empty slot.
+			int first;
+			// Edges of this key not connected yet.
+			int head;
+			int tail;
+		};
+		std::vector<Chain> table;
+		std::vector<int>   next;
+		for (size_t bucket = range.begin(); bucket < range.end(); ++ bucket) {
+			const BucketedEdge *edges = bucketed_edges.data() + bucket_begin[bucket];
+			const int         num   = int(bucket_begin[bucket + 1] - bucket_begin[bucket]);
+			size_t            mask  = 15;
+			while (mask < size_t(num) * 2)
+				mask = mask * 2 + 1;
+			table.assign(mask + 1, Chain{ -1, -1, -1 });
+			next.assign(num, -1);
+			for (int i = 0; i < num; ++ i) {
+				const BucketedEdge &edge = edges[i];
+				size_t slot = edge.hash() & mask;
+				while (table[slot].first != -1 && ! edges[table[slot].first].key_equal(edge))
+					slot = (slot + 1) & mask;
+				Chain &chain = table[slot];
+				if (chain.first == -1) {
+					chain = { i, i, i };
+					continue;
+				}
+				int prev = -1;
+				int j    = chain.head;
+				while (j != -1 && edges[j].facet_number == edge.facet_number) {
+					prev = j;
+					j    = next[j];
+				}
+				if (j == -1) {
+					// Not matched, append to the chain.
+					if (chain.head == -1)
+						chain.head = i;
+					else
+						next[chain.tail] = i;
+					chain.tail = i;
+				} else {
+					stl_link_neighbors(stl, edge.facet_number, edge.which_edge, edges[j].facet_number, edges[j].which_edge);
+					// Remove the matched edge from the chain.
+					(prev == -1 ? chain.head : next[prev]) = next[j];
+					if (chain.tail == j)
+						chain.tail = prev;
+				}
+			}
+		}
+	});
+
+	// Count successful connects.
+	struct Connects {
+		int edges = 0;
+		int facets[3] = { 0, 0, 0 };
+	};
+	Connects connects = tbb::parallel_reduce(tbb::blocked_range<uint32_t>(0, stl->stats.number_of_facets, 0x10000), Connects{},
+		[stl](const tbb::blocked_range<uint32_t> &range, Connects connects) {
+			for (uint32_t i = range.begin(); i < range.end(); ++ i) {
+				int num_neighbors = stl->neighbors_start[i].num_neighbors();
+				connects.edges += num_neighbors;
+				for (int j = 0; j < num_neighbors; ++ j)
+					++ connects.facets[j];
+			}
+			return connects;
+		},
+		[](Connects a, const Connects &b) {
+			a.edges += b.edges;
+			for (int j = 0; j < 3; ++ j)
+				a.facets[j] += b.facets[j];
+			return a;
+		});
+	stl->stats.connected_edges         = connects.edges;
+	stl->stats.connected_facets_1_edge = connects.facets[0];
+	stl->stats.connected_facets_2_edge = connects.facets[1];
+	stl->stats.connected_facets_3_edge = connects.facets[2];
 
 #if 0
 	printf("Number of faces: %d, number of manifold edges: %d, number of connected edges: %d, number of unconnected edges: %d\r\n", 
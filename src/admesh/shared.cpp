@@ -23,16 +23,24 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include "stl.h"
 
 #include "libslic3r/LocalesUtils.hpp"
 
-void stl_generate_shared_vertices(stl_file *stl, indexed_triangle_set &its)
+// Generate the shared vertices by traversing the fans of triangles around the vertices, one fan after the other.
+// Robust to invalid neighbors, used if stl_generate_shared_vertices() finds the neighbors not to be symmetric.
+static void stl_generate_shared_vertices_by_fans(stl_file *stl, indexed_triangle_set &its)
 {
 	// 3 indices to vertex per face
 	its.indices.assign(stl->stats.number_of_facets, stl_triangle_vertex_indices(-1, -1, -1));
@@ -127,6 +135,134 @@ void stl_generate_shared_vertices(stl_file *stl, indexed_triangle_set &its)
 	}
 }
 
+// Lock free union-find on the corners of the facets (facet_idx * 3 + vertex_idx). A corner is only attached to a corner
+// with a lower index, thus the root of a set of corners is the corner with the lowest index.
+static inline uint32_t corner_find_root(std::atomic<uint32_t> *parent, uint32_t corner)
+{
+	for (;;) {
+		uint32_t p = parent[corner].load(std::memory_order_relaxed);
+		if (p == corner)
+			return corner;
+		uint32_t pp = parent[p].load(std::memory_order_relaxed);
+		if (pp != p)
+			// Path halving.
+			parent[corner].compare_exchange_weak(p, pp, std::memory_order_relaxed);
+		corner = pp;
+	}
+}
+
+static inline void corner_unite(std::atomic<uint32_t> *parent, uint32_t a, uint32_t b)
+{
+	for (;;) {
+		a = corner_find_root(parent, a);
+		b = corner_find_root(parent, b);
+		if (a == b)
+			return;
+		if (a < b)
+			std::swap(a, b);
+		uint32_t expected = a;
+		if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+			return;
+	}
+}
+
+// Generate the shared vertices by welding the corners of the facets connected over their common edges. The corners welded
+// are exactly the corners of the fans traversed by stl_generate_shared_vertices_by_fans(), and the shared vertices are numbered
+// by their first corner, which is the order of the fan traversal, thus the result is the same, only computed in parallel.
+// If the neighbors are not symmetric or if a facet is connected to itself over a fan, the fans are traversed instead.
+void stl_generate_shared_vertices(stl_file *stl, indexed_triangle_set &its)
+{
+	const uint32_t num_facets  = stl->stats.number_of_facets;
+	const size_t   num_corners = size_t(num_facets) * 3;
+
+	std::unique_ptr<std::atomic<uint32_t>[]> parent(new std::atomic<uint32_t>[num_corners]);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_corners, 0x10000), [&parent](const tbb::blocked_range<size_t> &range) {
+		for (size_t corner = range.begin(); corner < range.end(); ++ corner)
+			parent[corner].store(uint32_t(corner), std::memory_order_relaxed);
+	});
+
+	std::atomic<bool> valid { true };
+	tbb::parallel_for(tbb::blocked_range<uint32_t>(0, num_facets, 0x4000), [stl, num_facets, &parent, &valid](const tbb::blocked_range<uint32_t> &range) {
+		for (uint32_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
+			const stl_neighbors &neighbors = stl->neighbors_start[facet_idx];
+			for (int edge = 0; edge < 3; ++ edge) {
+				int other = neighbors.neighbor[edge];
+				if (other == -1)
+					continue;
+				// Index of the vertex of the other facet opposite to the common edge, increased by 3 if the other facet is flipped.
+				int vnot = neighbors.which_vertex_not[edge];
+				if (other < 0 || other >= int(num_facets) || other == int(facet_idx) || vnot < 0 || vnot > 5) {
+					valid = false;
+					continue;
+				}
+				// The common edge as seen by the other facet.
+				int other_edge = (vnot + 1) % 3;
+				const stl_neighbors &other_neighbors = stl->neighbors_start[other];
+				if (other_neighbors.neighbor[other_edge] != int(facet_idx) || other_neighbors.which_vertex_not[other_edge] != (edge + 2) % 3 + (vnot > 2 ? 3 : 0)) {
+					valid = false;
+					continue;
+				}
+				if (int(facet_idx) < other) {
+					// Weld the starting and the ending vertex of the edge with the vertices of the other facet.
+					bool flipped = vnot > 2;
+					corner_unite(parent.get(), facet_idx * 3 + edge,           other * 3 + (vnot + (flipped ? 1 : 2)) % 3);
+					corner_unite(parent.get(), facet_idx * 3 + (edge + 1) % 3, other * 3 + (vnot + (flipped ? 2 : 1)) % 3);
+				}
+			}
+		}
+	});
+
+	// Roots of the corners, check that no facet has two of its corners welded.
+	std::vector<uint32_t> roots(num_corners);
+	if (valid)
+		tbb::parallel_for(tbb::blocked_range<uint32_t>(0, num_facets, 0x4000), [&parent, &roots, &valid](const tbb::blocked_range<uint32_t> &range) {
+			for (uint32_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
+				uint32_t *root = roots.data() + size_t(facet_idx) * 3;
+				for (int j = 0; j < 3; ++ j)
+					root[j] = corner_find_root(parent.get(), facet_idx * 3 + j);
+				if (root[0] == root[1] || root[1] == root[2] || root[2] == root[0])
+					valid = false;
+			}
+		});
+	parent.reset();
+	if (! valid) {
+		stl_generate_shared_vertices_by_fans(stl, its);
+		return;
+	}
+
+	// Number the shared vertices by their roots: Count the roots of blocks of corners, then assign the vertex indices.
+	static constexpr size_t block_size = 0x10000;
+	std::vector<int> block_vertices((num_corners + block_size - 1) / block_size, 0);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, block_vertices.size()), [&roots, &block_vertices, num_corners](const tbb::blocked_range<size_t> &range) {
+		for (size_t block = range.begin(); block < range.end(); ++ block)
+			for (size_t corner = block * block_size; corner < std::min(num_corners, (block + 1) * block_size); ++ corner)
+				block_vertices[block] += roots[corner] == corner;
+	});
+	int num_vertices = 0;
+	for (int &first_vertex : block_vertices)
+		num_vertices += std::exchange(first_vertex, num_vertices);
+
+	std::vector<int> vertex_ids(num_corners);
+	its.indices.assign(num_facets, stl_triangle_vertex_indices(-1, -1, -1));
+	its.vertices.clear();
+	its.vertices.resize(num_vertices);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, block_vertices.size()), [stl, &roots, &block_vertices, &vertex_ids, &its, num_corners](const tbb::blocked_range<size_t> &range) {
+		for (size_t block = range.begin(); block < range.end(); ++ block) {
+			int vertex_id = block_vertices[block];
+			for (size_t corner = block * block_size; corner < std::min(num_corners, (block + 1) * block_size); ++ corner)
+				if (roots[corner] == corner) {
+					vertex_ids[corner] = vertex_id;
+					its.vertices[vertex_id ++] = stl->facet_start[corner / 3].vertex[corner % 3];
+				}
+		}
+	});
+	// The root of a corner has a lower index, thus its vertex index has been assigned above.
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_corners, 0x10000), [&roots, &vertex_ids, &its](const tbb::blocked_range<size_t> &range) {
+		for (size_t corner = range.begin(); corner < range.end(); ++ corner)
+			its.indices[corner / 3][corner % 3] = vertex_ids[roots[corner]];
+	});
+}
+
 bool its_write_off(const indexed_triangle_set &its, const char *file)
 {
     Slic3r::CNumericLocalesSetter locales_setter;
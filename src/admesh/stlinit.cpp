@@ -24,21 +24,27 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <cmath>
 #include <assert.h>
 
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
+#include <boost/nowide/convert.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/predef/other/endian.h>
 
+#include <fast_float/fast_float.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
 #include "stl.h"
 #include "libslic3r/Format/STL.hpp"
 
 #include "libslic3r/LocalesUtils.hpp"
 
-#ifndef SEEK_SET
-#error "SEEK_SET not defined"
-#endif
-
 #if BOOST_ENDIAN_BIG_BYTE
 extern void stl_internal_reverse_quads(char *buf, size_t cnt);
 #endif /* BOOST_ENDIAN_BIG_BYTE */
@@ -50,35 +56,199 @@ static std::string ml_name            = "";
 static std::string ml_id              = "";
 static std::string ml_region          = "";
 
-static FILE *stl_open_count_facets(stl_file *stl, const char *file, unsigned int custom_header_length)
+// Memory map the input file. Returns false if the file could not be mapped, for example because it is empty.
+static bool stl_map_file(const char *file, boost::iostreams::mapped_file_source &mapped)
 {
-  	// Open the file in binary mode first.
-  	FILE *fp = boost::nowide::fopen(file, "rb");
-  	if (fp == nullptr) {
-		BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: Couldn't open " << file << " for reading";
-    	return nullptr;
-  	}
-  	// Find size of file.
-  	fseek(fp, 0, SEEK_END);
-  	long file_size = ftell(fp);
+    try {
+#ifdef _WIN32
+        boost::filesystem::path path(boost::nowide::widen(file));
+#else
+        boost::filesystem::path path(file);
+#endif
+        // Memory mapping of an empty file fails.
+        if (boost::filesystem::file_size(path) > 0)
+            mapped.open(path);
+    } catch (const std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << "stl_open: Couldn't map " << file << " for reading, reason = " << err.what();
+        return false;
+    }
+    return true;
+}
+
+// The ASCII STL used to be parsed by fscanf() and fgets() from a file opened in text mode, the following helpers
+// emulate these functions on the memory mapped file, so that the same facets are produced.
+
+static inline bool stl_is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; }
+static inline void stl_skip_spaces(const char *&p, const char *end) { while (p != end && stl_is_space(*p)) ++ p; }
+
+// Matches a scanf format made of literal characters only, white space of the format matches any amount of white space.
+// The matching characters are consumed even if the match fails later.
+static inline bool stl_scanf_match(const char *&p, const char *end, const char *format)
+{
+    for (; *format != 0; ++ format) {
+        if (stl_is_space(*format))
+            stl_skip_spaces(p, end);
+        else if (p != end && *p == *format)
+            ++ p;
+        else
+            return false;
+    }
+    return true;
+}
+
+// fscanf(fp, " <keyword>%*[^\n]\n"), used to skip the solid / endsolid lines.
+static inline void stl_scanf_skip_line(const char *&p, const char *end, const char *keyword)
+{
+    if (stl_scanf_match(p, end, keyword) && p != end && *p != '\n') {
+        p = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (p == nullptr)
+            p = end;
+        stl_skip_spaces(p, end);
+    }
+}
+
+// %31s conversion.
+static inline bool stl_scanf_token(const char *&p, const char *end, const char *&token_begin, const char *&token_end)
+{
+    stl_skip_spaces(p, end);
+    if (p == end)
+        return false;
+    token_begin = p;
+    for (size_t i = 0; i < 31 && p != end && ! stl_is_space(*p); ++ i)
+        ++ p;
+    token_end = p;
+    return true;
+}
+
+// %f conversion.
+static inline bool stl_scanf_float(const char *&p, const char *end, float &out)
+{
+    stl_skip_spaces(p, end);
+    const char *first = p != end && *p == '+' ? p + 1 : p;
+    auto [ptr, ec] = fast_float::from_chars(first, end, out);
+    if (ec != std::errc())
+        return false;
+    p = ptr;
+    return true;
+}
+
+// fgets(buf, 2047, fp) followed by a test whether the line starts with the keyword followed by a white space.
+static inline bool stl_gets_keyword(const char *&p, const char *end, const char *keyword)
+{
+    const char *line     = p;
+    const char *line_end = p + std::min<size_t>(2046, end - p);
+    if (const char *eol = static_cast<const char*>(memchr(p, '\n', line_end - p)); eol != nullptr)
+        line_end = eol + 1;
+    p = line_end;
+    size_t len = strlen(keyword);
+    if (size_t(line_end - line) <= len || strncmp(line, keyword, len) != 0)
+        return false;
+    char c = line[len];
+    return c == '\r' || c == '\n' || c == ' ' || c == '\t';
+}
 
+// Parse a single facet of an ASCII STL, skipping the solid / endsolid lines in front of it.
+static bool stl_read_ascii_facet(const char *&p, const char *end, stl_facet &facet)
+{
+    // skip solid/endsolid
+    // (in this order, otherwise it won't work when they are paired in the middle of a file)
+    stl_scanf_skip_line(p, end, " endsolid");
+    // name might contain spaces so %*s doesn't work and it also can be empty (just "solid")
+    stl_scanf_skip_line(p, end, " solid");
+    const char *normal_token[3][2];
+    bool ok = stl_scanf_match(p, end, " facet normal") &&
+        stl_scanf_token(p, end, normal_token[0][0], normal_token[0][1]) &&
+        stl_scanf_token(p, end, normal_token[1][0], normal_token[1][1]) &&
+        stl_scanf_token(p, end, normal_token[2][0], normal_token[2][1]);
+    if (! ok)
+        return false;
+    stl_scanf_match(p, end, " outer loop");
+    for (int i = 0; i < 3; ++ i)
+        if (! stl_scanf_match(p, end, " vertex") ||
+            ! stl_scanf_float(p, end, facet.vertex[i](0)) || ! stl_scanf_float(p, end, facet.vertex[i](1)) || ! stl_scanf_float(p, end, facet.vertex[i](2)))
+            return false;
+    // Eat all whitespaces and empty lines up to the next non-whitespace.
+    stl_skip_spaces(p, end);
+    // Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
+    if (! stl_gets_keyword(p, end, "endloop"))
+        return false;
+    stl_skip_spaces(p, end);
+    if (! stl_gets_keyword(p, end, "endfacet"))
+        return false;
+    // The facet normal has been parsed as a single string as to workaround for not a numbers in the normal definition.
+    for (int i = 0; i < 3; ++ i) {
+        const char *token = normal_token[i][0];
+        if (! stl_scanf_float(token, normal_token[i][1], facet.normal(i))) {
+            // Normal was mangled. Maybe denormals or "not a number" were stored?
+            // Just reset the normal and silently ignore it.
+            facet.normal = stl_normal::Zero();
+            break;
+        }
+    }
+    return true;
+}
+
+// Number of facets of an ASCII STL estimated from the number of its lines. The lines used to be read by fgets()
+// into a 100 characters long buffer from a file opened in text mode, thus long lines are counted multiple times.
+static uint32_t stl_ascii_count_facets(const char *data, const char *end)
+{
+    // Split the file after LFs, a line is never counted across a LF.
+    static constexpr const size_t chunk_size = 1 << 22;
+    std::vector<const char*> chunks { data };
+    while (size_t(end - chunks.back()) > chunk_size) {
+        const char *eol = static_cast<const char*>(memchr(chunks.back() + chunk_size, '\n', end - chunks.back() - chunk_size));
+        if (eol == nullptr || eol + 1 == end)
+            break;
+        chunks.emplace_back(eol + 1);
+    }
+    chunks.emplace_back(end);
+    size_t num_lines = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, chunks.size() - 1, 1), size_t(0),
+        [&chunks, end](const tbb::blocked_range<size_t> &range, size_t num_lines) {
+            auto count_piece = [&num_lines](const char *piece, size_t len) {
+                // Don't count short lines.
+                // Skip solid/endsolid lines as broken STL file generators may put several of them.
+                if (len > 4 && memcmp(piece, "solid", 5) != 0 && (len < 8 || memcmp(piece, "endsolid", 8) != 0))
+                    ++ num_lines;
+            };
+            for (size_t chunk_id = range.begin(); chunk_id < range.end(); ++ chunk_id) {
+                const char *piece = chunks[chunk_id];
+                size_t      len   = 0;
+                for (const char *c = chunks[chunk_id]; c != chunks[chunk_id + 1]; ++ c) {
+#ifdef _WIN32
+                    // CR LF is read as a single LF in text mode.
+                    if (*c == '\r' && c + 1 != end && c[1] == '\n')
+                        continue;
+#endif // _WIN32
+                    if (++ len == 99 || *c == '\n') {
+                        count_piece(piece, len);
+                        piece = c + 1;
+                        len   = 0;
+                    }
+                }
+                if (len > 0)
+                    count_piece(piece, len);
+            }
+            return num_lines;
+        },
+        std::plus<size_t>());
+    return uint32_t((num_lines + 1) / ASCII_LINES_PER_FACET);
+}
+
+static bool stl_open_count_facets(stl_file *stl, const char *file, const char *data, size_t file_size, unsigned int custom_header_length)
+{
   	// Check for binary or ASCII file.
     int header_size = custom_header_length + NUM_FACET_SIZE;
-    fseek(fp, header_size, SEEK_SET);
-	unsigned char chtest[128];
-  	if (! fread(chtest, sizeof(chtest), 1, fp)) {
+    if (file_size < size_t(header_size) + 128) {
 		BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: The input is an empty file: " << file;
-    	fclose(fp);
-    	return nullptr;
+    	return false;
   	}
   	stl->stats.type = ascii;
-  	for (size_t s = 0; s < sizeof(chtest); s++) {
-    	if (chtest[s] > 127) {
+  	for (size_t s = 0; s < 128; s++) {
+    	if ((unsigned char)data[header_size + s] > 127) {
       		stl->stats.type = binary;
       		break;
     	}
   	}
-  	rewind(fp);
 
   	uint32_t num_facets = 0;
 
@@ -88,248 +258,297 @@ static FILE *stl_open_count_facets(stl_file *stl, const char *file, unsigned int
     	// Test if the STL file has the right size.
         if (((file_size - header_size) % SIZEOF_STL_FACET != 0) || (file_size < STL_MIN_FILE_SIZE)) {
 			BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: The file " << file << " has the wrong size.";
-      		fclose(fp);
-      		return nullptr;
+      		return false;
     	}
         num_facets = (file_size - header_size) / SIZEOF_STL_FACET;
 
     	// Read the header.
-        if (fread(stl->stats.header.data(), custom_header_length, 1, fp) > custom_header_length -1)
-            stl->stats.header[custom_header_length] = '\0';
+        memcpy(stl->stats.header.data(), data, custom_header_length);
 
     	// Read the int following the header.  This should contain # of facets.
 	  	uint32_t header_num_facets;
-    	bool header_num_faces_read = fread(&header_num_facets, sizeof(uint32_t), 1, fp) != 0;
+        memcpy(&header_num_facets, data + custom_header_length, sizeof(uint32_t));
 #if BOOST_ENDIAN_BIG_BYTE
     	// Convert from little endian to big endian.
     	stl_internal_reverse_quads((char*)&header_num_facets, 4);
 #endif /* BOOST_ENDIAN_BIG_BYTE */
-    	if (! header_num_faces_read || num_facets != header_num_facets)
+    	if (num_facets != header_num_facets)
 			BOOST_LOG_TRIVIAL(info) << "stl_open_count_facets: Warning: File size doesn't match number of facets in the header: " << file;
   	}
   	// Otherwise, if the .STL file is ASCII, then do the following:
   	else
   	{
-    	// Reopen the file in text mode (for getting correct newlines on Windows)
-    	// fix to silence a warning about unused return value.
-    	// obviously if it fails we have problems....
-    	fp = boost::nowide::freopen(file, "r", fp);
-
-		// do another null check to be safe
-    	if (fp == nullptr) {
-			BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: Couldn't open " << file << " for reading";
-      		fclose(fp);
-      		return nullptr;
-    	}
-    
     	// Find the number of facets.
-		char linebuf[100];
-		int num_lines = 1;
-		while (fgets(linebuf, 100, fp) != nullptr) {
-		    // Don't count short lines.
-		    if (strlen(linebuf) <= 4)
-		    	continue;
-		    // Skip solid/endsolid lines as broken STL file generators may put several of them.
-		    if (strncmp(linebuf, "solid", 5) == 0 || strncmp(linebuf, "endsolid", 8) == 0)
-		    	continue;
-		    ++ num_lines;
-		}
-
-    	rewind(fp);
-    
+        num_facets = stl_ascii_count_facets(data, data + file_size);
+
     	// Get the header.
 		int i = 0;
-    	for (; i < custom_header_length && (stl->stats.header[i] = getc(fp)) != '\n'; ++ i) ;
+    	for (const char *c = data; i < custom_header_length && c != data + file_size && *c != '\n'; ++ c) {
+#ifdef _WIN32
+            if (*c == '\r' && c + 1 != data + file_size && c[1] == '\n')
+                continue;
+#endif // _WIN32
+            stl->stats.header[i ++] = *c;
+        }
     	stl->stats.header[i] = '\0'; // Lose the '\n'
         stl->stats.header[custom_header_length] = '\0';
-
-    	num_facets = num_lines / ASCII_LINES_PER_FACET;
   	}
 
   	stl->stats.number_of_facets += num_facets;
   	stl->stats.original_num_facets = stl->stats.number_of_facets;
-  	return fp;
+  	return true;
 }
 
-/* Reads the contents of the file pointed to by fp into the stl structure,
-   starting at facet first_facet.  The second argument says if it's our first
-   time running this for the stl and therefore we should reset our max and min stats. */
-static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first, ImportstlProgressFn stlFn, int custom_header_length)
+// Read the model info stored by MakerWorld / MakerLab into the "solid" line of an ASCII STL.
+static void stl_read_ascii_model_info(const char *data, const char *end)
 {
-    if (stl->stats.type == binary) {
-        int header_size = custom_header_length + NUM_FACET_SIZE;
-        fseek(fp, header_size, SEEK_SET);
-        model_id = "";
-        country_code = "";
-    }
-	else {
-        rewind(fp);
-        try{
-            char solid_content[256];
-            int res_solid = fscanf(fp, " solid %[^\n]", solid_content);
-            if (res_solid == 1) {
-                /*include ml info*/
-                std::string ext_content(solid_content);
-                std::string ml_content;
-                std::string mw_content;
-
-                size_t pos = ext_content.find('&');
-                if (pos != std::string::npos) {
-                    mw_content = ext_content.substr(0, pos);
-                    ml_content = ext_content.substr(pos + 1);
-                }
+    const char *p = data;
+    if (! stl_scanf_match(p, end, " solid ") || p == end || *p == '\n')
+        return;
+    const char *eol = static_cast<const char*>(memchr(p, '\n', end - p));
+    std::string ext_content(p, eol ? eol : end);
+#ifdef _WIN32
+    // CR LF is read as a single LF in text mode.
+    if (! ext_content.empty() && ext_content.back() == '\r')
+        ext_content.pop_back();
+#endif // _WIN32
+    try{
+        /*include ml info*/
+        std::string ml_content;
+        std::string mw_content;
+
+        size_t pos = ext_content.find('&');
+        if (pos != std::string::npos) {
+            mw_content = ext_content.substr(0, pos);
+            ml_content = ext_content.substr(pos + 1);
+        }
 
-                if (ml_content.empty() && ext_content.find("ML") != std::string::npos) {
-                    ml_content = ext_content;
-                }
+        if (ml_content.empty() && ext_content.find("ML") != std::string::npos) {
+            ml_content = ext_content;
+        }
 
-                if (mw_content.empty() && ext_content.find("MW") != std::string::npos) {
-                    mw_content = ext_content;
+        if (mw_content.empty() && ext_content.find("MW") != std::string::npos) {
+            mw_content = ext_content;
+        }
+
+        /*parse ml info*/
+        if (!ml_content.empty()) {
+            std::istringstream iss(ml_content);
+            std::string token;
+            std::vector<std::string> result;
+            while (iss >> token) {
+                if (token.find(' ') == std::string::npos) {
+                    result.push_back(token);
                 }
+            }
 
-                /*parse ml info*/
-                if (!ml_content.empty()) {
-                    std::istringstream iss(ml_content);
-                    std::string token;
-                    std::vector<std::string> result;
-                    while (iss >> token) {
-                        if (token.find(' ') == std::string::npos) {
-                            result.push_back(token);
-                        }
-                    }
+            if (result.size() == 4 && result[0] == "ML") {
+                ml_region = result[1];
+                ml_name = result[2];
+                ml_id = result[3];
+            }
+        }
 
-                    if (result.size() == 4 && result[0] == "ML") {
-                        ml_region = result[1];
-                        ml_name = result[2];
-                        ml_id = result[3];
-                    }
+        /*parse mw info*/
+        if (!mw_content.empty()) {
+            std::istringstream iss(mw_content);
+            std::string token;
+            std::vector<std::string> result;
+            while (iss >> token) {
+                if (token.find(' ') == std::string::npos) {
+                    result.push_back(token);
                 }
+            }
 
-                /*parse mw info*/
-                if (!mw_content.empty()) {
-                    std::istringstream iss(mw_content);
-                    std::string token;
-                    std::vector<std::string> result;
-                    while (iss >> token) {
-                        if (token.find(' ') == std::string::npos) {
-                            result.push_back(token);
-                        }
-                    }
+            if (result.size() == 4 && result[0] == "MW") {
+                model_id = result[2];
+                country_code = result[3];
+            }
+        }
+    }
+    catch (...){
+    }
+}
 
-                    if (result.size() == 4 && result[0] == "MW") {
-                        model_id = result[2];
-                        country_code = result[3];
+// Parse the facets of an ASCII STL. The file is split at lines starting with "facet", the pieces are parsed in parallel.
+// Returns false if one of the first stl->stats.number_of_facets facets is malformed or if there are not enough facets.
+static bool stl_read_ascii_facets(stl_file *stl, const char *data, const char *end, std::vector<stl_facet> &facets)
+{
+    static constexpr const size_t chunk_size = 1 << 22;
+    std::vector<const char*> chunks { data };
+    for (;;) {
+        const char *p = chunks.back() + std::min<size_t>(chunk_size, end - chunks.back());
+        const char *chunk_end = end;
+        while (p != end) {
+            const char *eol = static_cast<const char*>(memchr(p, '\n', end - p));
+            if (eol == nullptr)
+                break;
+            p = eol + 1;
+            const char *c = p;
+            while (c != end && (*c == ' ' || *c == '\t'))
+                ++ c;
+            if (end - c > 5 && strncmp(c, "facet", 5) == 0 && stl_is_space(c[5])) {
+                chunk_end = p;
+                break;
+            }
+        }
+        if (chunk_end == end)
+            break;
+        chunks.emplace_back(chunk_end);
+    }
+    chunks.emplace_back(end);
+
+    struct ChunkFacets {
+        std::vector<stl_facet> facets;
+        bool                   error { false };
+    };
+    std::vector<ChunkFacets> chunk_facets(chunks.size() - 1);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunk_facets.size(), 1),
+        [&chunks, &chunk_facets, end](const tbb::blocked_range<size_t> &range) {
+            for (size_t chunk_id = range.begin(); chunk_id < range.end(); ++ chunk_id) {
+                const char  *p          = chunks[chunk_id];
+                const char  *chunk_end  = chunks[chunk_id + 1];
+                ChunkFacets &out        = chunk_facets[chunk_id];
+                out.facets.reserve((chunk_end - p) / 256);
+                for (;;) {
+                    // Skip the solid / endsolid lines to find out whether another facet follows in this chunk.
+                    const char *q = p;
+                    stl_scanf_skip_line(q, end, " endsolid");
+                    stl_scanf_skip_line(q, end, " solid");
+                    stl_skip_spaces(q, end);
+                    if (q >= chunk_end)
+                        break;
+                    stl_facet facet;
+                    memset(&facet, 0, sizeof(facet));
+                    if (! stl_read_ascii_facet(p, end, facet)) {
+                        out.error = true;
+                        break;
                     }
+                    out.facets.emplace_back(facet);
                 }
             }
+        });
+
+    // Count the facets up to the first malformed facet.
+    size_t num_facets = stl->stats.number_of_facets;
+    size_t num_read   = 0;
+    for (const ChunkFacets &chunk : chunk_facets) {
+        num_read += chunk.facets.size();
+        if (chunk.error)
+            break;
+    }
+    if (num_read < num_facets) {
+        // The facet following the last facet read is either malformed or missing.
+        BOOST_LOG_TRIVIAL(error) << "Something is syntactically very wrong with this ASCII STL! ";
+        return false;
+    }
+    facets.reserve(num_facets);
+    for (const ChunkFacets &chunk : chunk_facets) {
+        if (facets.size() == num_facets)
+            break;
+        facets.insert(facets.end(), chunk.facets.begin(), chunk.facets.begin() + std::min(chunk.facets.size(), num_facets - facets.size()));
+    }
+    return true;
+}
+
+// Bounding box of the facets stored into stl_file::facet_start, see stl_facet_stats().
+struct StlFacetStats
+{
+    size_t     first_facet { size_t(-1) };
+    stl_vertex min;
+    stl_vertex max;
+
+    void add(size_t facet_idx, const stl_facet &facet) {
+        if (first_facet == size_t(-1)) {
+            first_facet = facet_idx;
+            min = max = facet.vertex[0];
         }
-        catch (...){
+        for (size_t i = 0; i < 3; ++ i) {
+            min = min.cwiseMin(facet.vertex[i]);
+            max = max.cwiseMax(facet.vertex[i]);
         }
-        
-        rewind(fp);
-	}
-    	
-
-  	char normal_buf[3][32];
-
-	uint32_t facets_num = stl->stats.number_of_facets;
-	uint32_t unit = facets_num / LOAD_STL_UNIT_NUM + 1;
-    for (uint32_t i = first_facet; i < facets_num; ++ i) {
-        if ((i % unit) == 0) {
-            bool cb_cancel = false;
-            if (stlFn) {
-                stlFn(i, facets_num, cb_cancel, model_id, country_code, ml_region, ml_name, ml_id);
-                if (cb_cancel)
-                    return false;
-            }
+    }
+    void join(const StlFacetStats &rhs) {
+        if (rhs.first_facet == size_t(-1))
+            return;
+        if (first_facet == size_t(-1)) {
+            *this = rhs;
+            return;
         }
+        first_facet = std::min(first_facet, rhs.first_facet);
+        min = min.cwiseMin(rhs.min);
+        max = max.cwiseMax(rhs.max);
+    }
+};
 
-  	  	stl_facet facet;
-
-    	if (stl->stats.type == binary) {
-  
-
-      		// Read a single facet from a binary .STL file. We assume little-endian architecture!
-      		if (fread(&facet, 1, SIZEOF_STL_FACET, fp) != SIZEOF_STL_FACET)
-      			return false;
-
+/* Reads the contents of the memory mapped file into the stl structure. The facets are parsed in parallel,
+   the progress callback is called from the calling thread between blocks of facets. */
+static bool stl_read(stl_file *stl, const char *data, size_t file_size, ImportstlProgressFn stlFn, int custom_header_length)
+{
+    std::vector<stl_facet> ascii_facets;
+    if (stl->stats.type == binary) {
+        model_id = "";
+        country_code = "";
+    } else {
+        stl_read_ascii_model_info(data, data + file_size);
+        if (! stl_read_ascii_facets(stl, data, data + file_size, ascii_facets))
+            return false;
+    }
 
+    const char *binary_facets = data + custom_header_length + NUM_FACET_SIZE;
+    auto read_facet = [stl, binary_facets, &ascii_facets](size_t facet_idx) {
+        stl_facet facet;
+        if (stl->stats.type == binary) {
+            // Read a single facet from a binary .STL file. We assume little-endian architecture!
+            memcpy(&facet, binary_facets + facet_idx * SIZEOF_STL_FACET, SIZEOF_STL_FACET);
 #if BOOST_ENDIAN_BIG_BYTE
-      		// Convert the loaded little endian data to big endian.
-      		stl_internal_reverse_quads((char*)&facet, 48);
+            // Convert the loaded little endian data to big endian.
+            stl_internal_reverse_quads((char*)&facet, 48);
 #endif /* BOOST_ENDIAN_BIG_BYTE */
-    	} else {
-			// Read a single facet from an ASCII .STL file
-			// skip solid/endsolid
-			// (in this order, otherwise it won't work when they are paired in the middle of a file)
-			fscanf(fp, " endsolid%*[^\n]\n");
-			fscanf(fp, " solid%*[^\n]\n");  // name might contain spaces so %*s doesn't work and it also can be empty (just "solid")
-			// Leading space in the fscanf format skips all leading white spaces including numerous new lines and tabs.
-			int res_normal     = fscanf(fp, " facet normal %31s %31s %31s", normal_buf[0], normal_buf[1], normal_buf[2]);
-			assert(res_normal == 3);
-			int res_outer_loop = fscanf(fp, " outer loop");
-			assert(res_outer_loop == 0);
-			int res_vertex1    = fscanf(fp, " vertex %f %f %f", &facet.vertex[0](0), &facet.vertex[0](1), &facet.vertex[0](2));
-			assert(res_vertex1 == 3);
-			int res_vertex2    = fscanf(fp, " vertex %f %f %f", &facet.vertex[1](0), &facet.vertex[1](1), &facet.vertex[1](2));
-			assert(res_vertex2 == 3);
-			// Trailing whitespace is there to eat all whitespaces and empty lines up to the next non-whitespace.
-			int res_vertex3    = fscanf(fp, " vertex %f %f %f ", &facet.vertex[2](0), &facet.vertex[2](1), &facet.vertex[2](2));
-			assert(res_vertex3 == 3);
-			// Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
-			char buf[2048];
-			fgets(buf, 2047, fp);
-			bool endloop_ok = strncmp(buf, "endloop", 7) == 0 && (buf[7] == '\r' || buf[7] == '\n' || buf[7] == ' ' || buf[7] == '\t');
-			assert(endloop_ok);
-			// Skip the trailing whitespaces and empty lines.
-			fscanf(fp, " ");
-			fgets(buf, 2047, fp);
-			bool endfacet_ok = strncmp(buf, "endfacet", 8) == 0 && (buf[8] == '\r' || buf[8] == '\n' || buf[8] == ' ' || buf[8] == '\t');
-			assert(endfacet_ok);
-			if (res_normal != 3 || res_outer_loop != 0 || res_vertex1 != 3 || res_vertex2 != 3 || res_vertex3 != 3 || ! endloop_ok || ! endfacet_ok) {
-				BOOST_LOG_TRIVIAL(error) << "Something is syntactically very wrong with this ASCII STL! ";
-				return false;
-			}
-
-			// The facet normal has been parsed as a single string as to workaround for not a numbers in the normal definition.
-			if (sscanf(normal_buf[0], "%f", &facet.normal(0)) != 1 ||
-			    sscanf(normal_buf[1], "%f", &facet.normal(1)) != 1 ||
-			    sscanf(normal_buf[2], "%f", &facet.normal(2)) != 1) {
-			    // Normal was mangled. Maybe denormals or "not a number" were stored?
-			  	// Just reset the normal and silently ignore it.
-			  	memset(&facet.normal, 0, sizeof(facet.normal));
-			}
-		}
-
-#if 0
-		// Report close to zero vertex coordinates. Due to the nature of the floating point numbers,
-		// close to zero values may be represented with singificantly higher precision than the rest of the vertices.
-		// It may be worth to round these numbers to zero during loading to reduce the number of errors reported
-		// during the STL import.
-		for (size_t j = 0; j < 3; ++ j) {
-		if (facet.vertex[j](0) > -1e-12f && facet.vertex[j](0) < 1e-12f)
-		    printf("stl_read: facet %d(0) = %e\r\n", j, facet.vertex[j](0));
-		if (facet.vertex[j](1) > -1e-12f && facet.vertex[j](1) < 1e-12f)
-		    printf("stl_read: facet %d(1) = %e\r\n", j, facet.vertex[j](1));
-		if (facet.vertex[j](2) > -1e-12f && facet.vertex[j](2) < 1e-12f)
-		    printf("stl_read: facet %d(2) = %e\r\n", j, facet.vertex[j](2));
-		}
-#endif
+        } else
+            facet = ascii_facets[facet_idx];
+        return facet;
+    };
 
-		// Write the facet into memory if none of facet vertices is NAN.
-		bool someone_is_nan = false;
-		for (size_t j = 0; j < 3; ++j) {
-			if (isnan(facet.vertex[j](0)) || isnan(facet.vertex[j](1)) || isnan(facet.vertex[j](2))) { 
-				someone_is_nan = true;
-				break; 
-			}
-		}
-		if(someone_is_nan)
-            continue;
-
-		stl->facet_start[i] = facet;
-		stl_facet_stats(stl, facet, first);
-  	}
+    StlFacetStats stats;
+	uint32_t facets_num = stl->stats.number_of_facets;
+	uint32_t unit = facets_num / LOAD_STL_UNIT_NUM + 1;
+    for (uint32_t i = 0; i < facets_num; i += unit) {
+        bool cb_cancel = false;
+        if (stlFn) {
+            stlFn(i, facets_num, cb_cancel, model_id, country_code, ml_region, ml_name, ml_id);
+            if (cb_cancel)
+                return false;
+        }
+        stats.join(tbb::parallel_reduce(tbb::blocked_range<size_t>(i, std::min(facets_num, i + unit)), StlFacetStats(),
+            [stl, &read_facet](const tbb::blocked_range<size_t> &range, StlFacetStats stats) {
+                for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
+                    stl_facet facet = read_facet(facet_idx);
+                    // Write the facet into memory if none of facet vertices is NAN.
+                    bool someone_is_nan = false;
+                    for (size_t j = 0; j < 3; ++j) {
+                        if (std::isnan(facet.vertex[j](0)) || std::isnan(facet.vertex[j](1)) || std::isnan(facet.vertex[j](2))) {
+                            someone_is_nan = true;
+                            break;
+                        }
+                    }
+                    if (someone_is_nan)
+                        continue;
+                    stl->facet_start[facet_idx] = facet;
+                    stats.add(facet_idx, facet);
+                }
+                return stats;
+            },
+            [](StlFacetStats lhs, const StlFacetStats &rhs) { lhs.join(rhs); return lhs; }));
+    }
+
+    if (stats.first_facet != size_t(-1)) {
+        const stl_facet &first = stl->facet_start[stats.first_facet];
+		stl_vertex diff = (first.vertex[1] - first.vertex[0]).cwiseAbs();
+		stl->stats.shortest_edge = std::max(diff(0), std::max(diff(1), diff(2)));
+        stl->stats.min = stats.min;
+        stl->stats.max = stats.max;
+    }
 
   	stl->stats.size = stl->stats.max - stl->stats.min;
   	stl->stats.bounding_diameter = stl->stats.size.norm();
@@ -344,13 +563,15 @@ bool stl_open(stl_file *stl, const char *file, ImportstlProgressFn stlFn, int cu
     Slic3r::CNumericLocalesSetter locales_setter;
 	stl->clear();
     stl->stats.reset_header(custom_header_length);
-    FILE *fp = stl_open_count_facets(stl, file, custom_header_length);
-	if (fp == nullptr)
-		return false;
+    boost::iostreams::mapped_file_source mapped;
+    if (! stl_map_file(file, mapped))
+        return false;
+    const char *data      = mapped.is_open() ? mapped.data() : nullptr;
+    size_t      file_size = mapped.is_open() ? mapped.size() : 0;
+    if (! stl_open_count_facets(stl, file, data, file_size, custom_header_length))
+        return false;
 	stl_allocate(stl);
-    bool result = stl_read(stl, fp, 0, true, stlFn, custom_header_length);
-  	fclose(fp);
-  	return result;
+    return stl_read(stl, data, file_size, stlFn, custom_header_length);
 }
 
 void stl_allocate(stl_file *stl)
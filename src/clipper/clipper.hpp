@@ -110,7 +110,12 @@ using DoublePoint = Eigen::Matrix<double, 2, 1, Eigen::DontAlign>;
 
 //------------------------------------------------------------------------------
 
+#ifdef CLIPPERLIB_PATH_TYPE
+// Path type sharing the allocator with the points of the user.
+using Path = CLIPPERLIB_PATH_TYPE;
+#else // CLIPPERLIB_PATH_TYPE
 typedef std::vector<IntPoint> Path;
+#endif // CLIPPERLIB_PATH_TYPE
 typedef std::vector<Path> Paths;
 
 inline Path& operator <<(Path& poly, const IntPoint& p) {poly.push_back(p); return poly;}
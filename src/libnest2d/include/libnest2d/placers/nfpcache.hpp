@@ -0,0 +1,198 @@
+#ifndef NFPCACHE_HPP
+#define NFPCACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <libnest2d/geometry_traits_nfp.hpp>
+
+namespace libnest2d {
+namespace placers {
+
+struct NfpCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t memory = 0;      // approximate bytes held by the cached polygons
+
+    double hit_rate() const
+    {
+        size_t lookups = hits + misses;
+        return lookups == 0 ? 0. : double(hits) / double(lookups);
+    }
+};
+
+/**
+ * Store of no fit polygons shared by the placements of one arrange call and
+ * by subsequent arrange calls (e.g. when searching for the count of copies
+ * fitting on a bed).
+ *
+ * The NFP of two polygons does not depend on where the polygons are, only on
+ * their shape after rotation and inflation. Both polygons are therefore
+ * identified by their contour relative to its leftmost bottom vertex, which
+ * is hashed for the lookup and compared exactly on a hash match. The NFP is
+ * stored relative to the leftmost bottom vertex of the stationary polygon,
+ * which is exactly where correctNfpPosition() puts it.
+ * The rotation is part of the contour, because rotating integer
+ * coordinates does not commute with rotating the resulting NFP.
+ *
+ * Thread safe. The least recently used polygons are dropped when the memory
+ * limit is exceeded.
+ */
+template<class RawShape>
+class NfpCache {
+    using Vertex = TPoint<RawShape>;
+
+public:
+    // Contour relative to its leftmost bottom vertex.
+    using Contour = std::vector<Vertex>;
+    using ContourPtr = std::shared_ptr<const Contour>;
+
+    struct Key {
+        ContourPtr stationary, orbiter;
+        uint64_t hash = 0;
+        bool operator==(const Key &other) const
+        {
+            return hash == other.hash &&
+                   (stationary == other.stationary || *stationary == *other.stationary) &&
+                   (orbiter == other.orbiter || *orbiter == *other.orbiter);
+        }
+    };
+
+    explicit NfpCache(size_t max_memory = 256 * 1024 * 1024)
+        : max_memory_(max_memory) {}
+
+    NfpCache(const NfpCache&) = delete;
+    NfpCache& operator=(const NfpCache&) = delete;
+
+    static ContourPtr contour(const RawShape &sh, const Vertex &leftmost_bottom)
+    {
+        auto c = std::make_shared<Contour>();
+        c->reserve(shapelike::contourVertexCount(sh));
+        for (auto it = shapelike::cbegin(sh); it != shapelike::cend(sh); ++it)
+            c->emplace_back(getX(*it) - getX(leftmost_bottom), getY(*it) - getY(leftmost_bottom));
+        return c;
+    }
+
+    static Key key(ContourPtr stationary, ContourPtr orbiter)
+    {
+        Key k;
+        k.hash = mix(contourHash(*stationary) ^ (contourHash(*orbiter) * 0x9E3779B97F4A7C15ull));
+        k.stationary = std::move(stationary);
+        k.orbiter = std::move(orbiter);
+        return k;
+    }
+
+    // Returns false on miss. On hit nfp is moved to the leftmost bottom
+    // vertex of the stationary polygon.
+    bool get(const Key &key, const Vertex &stationary_leftmost_bottom, RawShape &nfp)
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = map_.find(key);
+        if (it == map_.end()) {
+            ++stats_.misses;
+            return false;
+        }
+        ++stats_.hits;
+        lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+        nfp = it->second.nfp;
+        shapelike::translate(nfp, stationary_leftmost_bottom);
+        return true;
+    }
+
+    // nfp is expected to be at its final position around the stationary
+    // polygon with the given leftmost bottom vertex.
+    void put(const Key &key, const Vertex &stationary_leftmost_bottom, const RawShape &nfp)
+    {
+        RawShape rel = nfp;
+        shapelike::translate(rel, Vertex{-getX(stationary_leftmost_bottom), -getY(stationary_leftmost_bottom)});
+        size_t memory = memoryOf(key, rel);
+        if (memory > max_memory_) return;
+
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (map_.count(key) > 0) return; // computed by another thread meanwhile
+        lru_.push_front(key);
+        map_.emplace(key, Entry{std::move(rel), memory, lru_.begin()});
+        stats_.memory += memory;
+        ++stats_.entries;
+        while (stats_.memory > max_memory_) {
+            auto victim = map_.find(lru_.back());
+            stats_.memory -= victim->second.memory;
+            --stats_.entries;
+            ++stats_.evictions;
+            map_.erase(victim);
+            lru_.pop_back();
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        map_.clear();
+        lru_.clear();
+        stats_ = {};
+    }
+
+    NfpCacheStats stats() const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return stats_;
+    }
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key &key) const { return size_t(key.hash); }
+    };
+
+    using LRU = std::list<Key>;
+
+    struct Entry {
+        RawShape nfp; // relative to the leftmost bottom vertex of the stationary
+        size_t memory;
+        typename LRU::iterator lru_it;
+    };
+
+    // splitmix64 finalizer
+    static uint64_t mix(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    // Contours shared by more keys are counted by each of them.
+    static size_t memoryOf(const Key &key, const RawShape &sh)
+    {
+        // contour only, NFPs of the convex level have no holes
+        return sizeof(Entry) + sizeof(Key) + 4 * sizeof(void*) +
+               (key.stationary->size() + key.orbiter->size() +
+                shapelike::contourVertexCount(sh)) * sizeof(Vertex);
+    }
+
+    static uint64_t contourHash(const Contour &c)
+    {
+        uint64_t h = mix(uint64_t(c.size()));
+        for (const Vertex &v : c) {
+            h = mix(h ^ uint64_t(getX(v)));
+            h = mix(h ^ uint64_t(getY(v)));
+        }
+        return h;
+    }
+
+    const size_t max_memory_;
+    mutable std::mutex mutex_;
+    std::unordered_map<Key, Entry, KeyHash> map_;
+    LRU lru_;
+    NfpCacheStats stats_;
+};
+
+}
+}
+
+#endif // NFPCACHE_HPP
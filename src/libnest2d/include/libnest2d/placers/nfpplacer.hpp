@@ -16,6 +16,7 @@
 #include <libnest2d/optimizer.hpp>
 
 #include "placer_boilerplate.hpp"
+#include "nfpcache.hpp"
 
 // temporary
 //#include "../tools/svgtools.hpp"
@@ -97,6 +98,15 @@ struct NfpPConfig {
     bool parallel = true;
 
     bool save_svg = false;
+
+    /**
+     * @brief Store of already calculated no fit polygons. (Optional)
+     *
+     * It can outlive the placer and be shared by subsequent arrange calls
+     * with the same items. No caching is done if empty.
+     */
+    std::shared_ptr<NfpCache<RawShape>> nfp_cache;
+
     /**
      * @brief before_packing Callback that is called just before a search for
      * a new item's position is started. You can use this to create various
@@ -613,14 +623,25 @@ private:
         }
         // /////////////////////////////////////////////////////////////////////
 
+        using Cache = NfpCache<RawShape>;
+        Cache *cache = config_.nfp_cache.get();
+        typename Cache::ContourPtr orbiter_contour = cache ?
+            Cache::contour(trsh.transformedShape(), trsh.leftmostBottomVertex()) : nullptr;
+
         __parallel::enumerate(items_.begin(), items_.end(),
-                              [&nfps, &trsh](const Item& sh, size_t n)
+                              [&nfps, &trsh, cache, &orbiter_contour](const Item& sh, size_t n)
         {
             auto& fixedp = sh.transformedShape();
+            typename Cache::Key key;
+            if (cache) {
+                key = Cache::key(Cache::contour(fixedp, sh.leftmostBottomVertex()), orbiter_contour);
+                if (cache->get(key, sh.leftmostBottomVertex(), nfps[n])) return;
+            }
             auto& orbp = trsh.transformedShape();
             auto subnfp_r = noFitPolygon<NfpLevel::CONVEX_ONLY>(fixedp, orbp);
             correctNfpPosition(subnfp_r, sh, trsh);
             nfps[n] = subnfp_r.first;
+            if (cache) cache->put(key, sh.leftmostBottomVertex(), nfps[n]);
         });
 
         RawShape innerNfp = nfpInnerRectBed(bed, trsh.transformedShape()).first;
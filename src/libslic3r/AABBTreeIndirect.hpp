@@ -7,6 +7,9 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -218,6 +221,120 @@ using Tree3f = Tree<3, float>;
 using Tree2d = Tree<2, double>;
 using Tree3d = Tree<3, double>;
 
+// Compact variant of Tree with the same implicit balanced layout, thus all the queries of this file work on it unchanged.
+// The bounding boxes are quantized to 16 bits per coordinate relative to the bounding box of the root node,
+// the quantization rounds outwards, so that a quantized bounding box always contains the original one.
+// The entity index is stored with 32 bits. A 3D node takes 16 bytes instead of 32 bytes of Tree3f or 56 bytes of Tree3d
+// at the cost of decoding the bounding box when the node is accessed. The quantized bounding boxes are a bit larger
+// than the original ones, therefore a query may visit a few more nodes.
+template<int ANumDimensions, typename ACoordType>
+class QuantizedTree
+{
+public:
+    static_assert(std::is_floating_point<ACoordType>::value, "QuantizedTree requires floating point coordinates");
+
+    static constexpr int    NumDimensions = ANumDimensions;
+	using					CoordType     = ACoordType;
+    using 					SourceTree    = Tree<NumDimensions, CoordType>;
+    using 					VectorType 	  = typename SourceTree::VectorType;
+    using  					BoundingBox   = typename SourceTree::BoundingBox;
+    // Decoded node, returned by value from node().
+    using 					Node 		  = typename SourceTree::Node;
+    enum : size_t {
+        npos  = SourceTree::npos,
+        inner = SourceTree::inner
+    };
+
+    struct QuantizedNode {
+    	// Index of the external source entity, npos and inner are stored as uint32_t(-1) and uint32_t(-2).
+    	uint32_t 								 idx;
+    	// Minimum corner as a multiple of m_scale above the minimum corner of the root.
+    	std::array<uint16_t, NumDimensions> 	 min;
+    	// Maximum corner as a multiple of m_scale below the maximum corner of the root.
+    	std::array<uint16_t, NumDimensions> 	 max;
+    };
+
+    QuantizedTree() = default;
+    explicit QuantizedTree(const SourceTree &tree) { this->build(tree); }
+
+	void clear() { m_nodes.clear(); }
+
+	void build(const SourceTree &tree)
+	{
+		if (tree.empty()) {
+			this->clear();
+			return;
+		}
+		const BoundingBox &root = tree.node(0).bbox;
+		m_min = root.min();
+		m_max = root.max();
+		for (int i = 0; i < NumDimensions; ++ i) {
+			m_scale(i) = (m_max(i) - m_min(i)) / CoordType(qmax);
+			// Degenerate root: all the bounding boxes collapse to the root, which is represented exactly.
+			m_inv_scale(i) = m_scale(i) > 0 ? CoordType(1) / m_scale(i) : CoordType(0);
+		}
+		m_nodes.assign(tree.nodes().size(), QuantizedNode{});
+		for (size_t i = 0; i < m_nodes.size(); ++ i) {
+			const Node    &src = tree.node(i);
+			QuantizedNode &dst = m_nodes[i];
+			assert(! src.is_leaf() || ! src.is_valid() || src.idx < size_t(std::numeric_limits<uint32_t>::max() - 1));
+			dst.idx = src.idx == npos ? uint32_t(-1) : src.idx == inner ? uint32_t(-2) : uint32_t(src.idx);
+			if (src.is_valid())
+				for (int d = 0; d < NumDimensions; ++ d) {
+					// Round down, then correct the rounding errors of the decoding, so that the decoded box contains the source box.
+					auto q = uint16_t(std::clamp<CoordType>(std::floor((src.bbox.min()(d) - m_min(d)) * m_inv_scale(d)), 0, qmax));
+					while (q > 0 && this->decode_min(d, q) > src.bbox.min()(d))
+						-- q;
+					dst.min[d] = q;
+					q = uint16_t(std::clamp<CoordType>(std::floor((m_max(d) - src.bbox.max()(d)) * m_inv_scale(d)), 0, qmax));
+					while (q > 0 && this->decode_max(d, q) < src.bbox.max()(d))
+						-- q;
+					dst.max[d] = q;
+				}
+		}
+	}
+
+	// The compact nodes, for example to evaluate memory consumption.
+	const std::vector<QuantizedNode>& 	nodes() const { return m_nodes; }
+	Node 								node(size_t idx) const { return this->decode(m_nodes[idx]); }
+	bool 								empty() const { return m_nodes.empty(); }
+
+	// Addressing the child nodes using the power of two rule, the same as Tree.
+    static size_t						left_child_idx(size_t idx) { return SourceTree::left_child_idx(idx); }
+    static size_t						right_child_idx(size_t idx) { return SourceTree::right_child_idx(idx); }
+	Node								left_child(size_t idx) const { return this->node(left_child_idx(idx)); }
+	Node								right_child(size_t idx) const { return this->node(right_child_idx(idx)); }
+
+private:
+	static constexpr uint16_t qmax = std::numeric_limits<uint16_t>::max();
+
+	// Quantization zero (the root corner) is represented exactly, the decoding is the same during build and query.
+	CoordType decode_min(int dim, uint16_t q) const { return m_min(dim) + CoordType(q) * m_scale(dim); }
+	CoordType decode_max(int dim, uint16_t q) const { return m_max(dim) - CoordType(q) * m_scale(dim); }
+
+	Node decode(const QuantizedNode &src) const
+	{
+		Node out;
+		out.idx = src.idx == uint32_t(-1) ? size_t(npos) : src.idx == uint32_t(-2) ? size_t(inner) : size_t(src.idx);
+		for (int d = 0; d < NumDimensions; ++ d) {
+			out.bbox.min()(d) = this->decode_min(d, src.min[d]);
+			out.bbox.max()(d) = this->decode_max(d, src.max[d]);
+		}
+		return out;
+	}
+
+	VectorType 					m_min { VectorType::Zero() };
+	VectorType 					m_max { VectorType::Zero() };
+	VectorType 					m_scale { VectorType::Zero() };
+	VectorType 					m_inv_scale { VectorType::Zero() };
+	std::vector<QuantizedNode> 	m_nodes;
+};
+
+using QuantizedTree2f = QuantizedTree<2, float>;
+using QuantizedTree3f = QuantizedTree<3, float>;
+using QuantizedTree2d = QuantizedTree<2, double>;
+using QuantizedTree3d = QuantizedTree<3, double>;
+
 // Wrap a 2D Slic3r own BoundingBox to be passed to Tree::build() and similar
 // to build an AABBTree over coord_t 2D bounding boxes.
 class BoundingBoxWrapper {
@@ -384,7 +501,7 @@ namespace detail {
 	double intersect_triangle_epsilon(const Tree &tree) {
 		double eps = 0.000001;
 		if (! tree.empty()) {
-			const typename Tree::BoundingBox &bbox = tree.nodes().front().bbox;
+			const typename Tree::BoundingBox bbox = tree.node(0).bbox;
 			double l = (bbox.max() - bbox.min()).cwiseMax();
 			if (l > 0)
 				eps /= (l * l);
@@ -884,9 +1001,7 @@ void get_candidate_idxs(const TreeType& tree, const VectorType& v, std::vector<s
     if (tree.empty() || ! tree.node(node_idx).bbox.contains(v))
         return;
 
-    decltype(tree.node(node_idx)) node = tree.node(node_idx);
-    static_assert(std::is_reference<decltype(node)>::value,
-                  "Nodes shall be addressed by reference.");
+    const auto &node = tree.node(node_idx);
     assert(node.is_valid());
     assert(node.bbox.contains(v));
 
@@ -940,11 +1055,11 @@ namespace detail {
 
 // Returns true in case traversal should continue,
 // returns false if traversal should stop (for example if the first hit was found).
-template<int Dims, typename T, typename Pred, typename Fn>
-bool traverse_recurse(const Tree<Dims, T> &tree,
-                      size_t               idx,
-                      Pred &&              pred,
-                      Fn &&                callback)
+template<typename TreeType, typename Pred, typename Fn>
+bool traverse_recurse(const TreeType &tree,
+                      size_t          idx,
+                      Pred &&         pred,
+                      Fn &&           callback)
 {
     assert(tree.node(idx).is_valid());
 
@@ -965,8 +1080,8 @@ bool traverse_recurse(const Tree<Dims, T> &tree,
 
         // Left / right child node index.
         // Returns true if both children allow the traversal to continue.
-        return trv(Tree<Dims, T>::left_child_idx(idx)) &&
-        	   trv(Tree<Dims, T>::right_child_idx(idx));
+        return trv(TreeType::left_child_idx(idx)) &&
+        	   trv(TreeType::right_child_idx(idx));
     }
 }
 
@@ -977,8 +1092,8 @@ bool traverse_recurse(const Tree<Dims, T> &tree,
 //      /* ... */
 // });
 // Callback shall return true to continue traversal, false if it wants to stop traversal, for example if it found the answer.
-template<int Dims, typename T, typename Predicate, typename Fn>
-void traverse(const Tree<Dims, T> &tree, Predicate &&pred, Fn &&callback)
+template<typename TreeType, typename Predicate, typename Fn>
+void traverse(const TreeType &tree, Predicate &&pred, Fn &&callback)
 {
     if (tree.empty()) return;
 
@@ -17,6 +17,7 @@
 #define BOOST_NO_CXX17_HDR_STRING_VIEW
 #endif
 
+#include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/multiprecision/integer.hpp>
 #include <boost/rational.hpp>
@@ -157,6 +158,37 @@ Points get_shrink_bedpts(const DynamicPrintConfig & print_cfg, const ArrangePara
     return bedpts;
 }
 
+class NfpCache : public placers::NfpCache<ExPolygon>
+{
+public:
+    using placers::NfpCache<ExPolygon>::NfpCache;
+};
+
+std::shared_ptr<NfpCache> create_nfp_cache(size_t max_memory)
+{
+    return std::make_shared<NfpCache>(max_memory);
+}
+
+// Shared by the arrange calls, which do not bring their own cache, until cleared by clear_default_nfp_cache().
+// The GUI arranges the same objects over and over again.
+static std::shared_ptr<NfpCache> default_nfp_cache()
+{
+    static std::shared_ptr<NfpCache> cache = create_nfp_cache(64 * 1024 * 1024);
+    return cache;
+}
+
+void clear_default_nfp_cache()
+{
+    default_nfp_cache()->clear();
+}
+
+std::string nfp_cache_stats(const NfpCache &cache)
+{
+    placers::NfpCacheStats stats = cache.stats();
+    return (boost::format("hits %1%, misses %2%, hit rate %3$.1f%%, entries %4%, evictions %5%, memory %6% kB")
+        % stats.hits % stats.misses % (100. * stats.hit_rate()) % stats.entries % stats.evictions % (stats.memory / 1024)).str();
+}
+
 // Fill in the placer algorithm configuration with values carefully chosen for
 // Slic3r.
 template<class PConf>
@@ -193,6 +225,8 @@ void fill_config(PConf& pcfg, const ArrangeParams &params) {
     // Allow parallel execution.
     pcfg.parallel = params.parallel;
 
+    pcfg.nfp_cache = params.nfp_cache ? params.nfp_cache : default_nfp_cache();
+
     // BBS: excluded regions in BBS bed
     for (auto& poly : params.excluded_regions)
         process_arrangeable(poly, pcfg.m_excluded_regions);
@@ -727,6 +761,49 @@ public:
 
         m_item_count += fixeditems.size();
     }
+
+    // Place the items into the first bin one at a time in their order, without
+    // moving the ones placed before, until the first one which does not fit.
+    // Returns the count of the placed items.
+    size_t fill_first_bin(std::vector<Item> &items, std::vector<Item> &fixeditems, std::function<bool(void)> stopcond)
+    {
+        ItemGroup fixed;
+        for (Item &itm : fixeditems)
+            if (itm.binId() <= 0) {
+                itm.markAsFixedInBin(0);
+                fixed.emplace_back(itm);
+            }
+
+        ItemGroup queue(items.begin(), items.end());
+        m_rtree.clear();
+        m_item_count += queue.size() + fixed.size();
+
+        size_t count = 0;
+        {
+            Placer placer(m_bin);
+            placer.plateID(0);
+            placer.configure(m_pconf);
+            placer.preload(fixed);
+
+            for (auto it = queue.cbegin(); it != queue.cend() && !(stopcond && stopcond()); ++it) {
+                Item &itm    = *it;
+                auto  result = placer.pack(itm, rem(it, queue));
+                double score = result.score();
+                if (!result || score < 0 || score >= LARGE_COST_TO_REJECT)
+                    break;
+
+                itm.binId(0);
+                itm.itemId(int(count++));
+                placer.accept(result);
+            }
+        } // the placer aligns the pile on destruction, as after a full arrange
+
+        for (size_t i = count; i < items.size(); ++i)
+            items[i].binId(BIN_ID_UNFIT);
+
+        m_item_count = 0;
+        return count;
+    }
 };
 
 template<> std::function<double(const Item&, const ItemGroup&)> AutoArranger<Box>::get_objfn()
@@ -848,6 +925,36 @@ Radians fit_into_box_rotation(const S &sh, const _Box<TPoint<S>> &box)
     return fitIntoBoxRotation<S, TCompute<S>, boost::rational<LargeInt>>(sh, box);
 }
 
+// Use the minimum bounding box rotation as a starting point.
+// TODO: This only works for convex hull. If we ever switch to concave
+// polygon nesting, a convex hull needs to be calculated.
+template<class BinT>
+void set_initial_rotations(std::vector<Item> &shapes, const BinT &bin, const ArrangeParams &params)
+{
+    if (params.align_to_y_axis) {
+        for (auto &itm : shapes) {
+            auto angle = min_area_boundingbox_rotation(itm.transformedShape());
+            itm.rotate(angle + PI / 2);
+        }
+    }
+    else if (params.allow_rotations) {
+        for (auto &itm : shapes) {
+            auto angle = min_area_boundingbox_rotation(itm.transformedShape());
+            BOOST_LOG_TRIVIAL(debug) << itm.name << " min_area_boundingbox_rotation=" << angle << ", original angle=" << itm.rotation();
+            itm.rotate(angle);
+
+            // If the item is too big, try to find a rotation that makes it fit
+            if constexpr (std::is_same_v<BinT, Box>) {
+                auto bb = itm.boundingBox();
+                if (bb.width() >= bin.width() || bb.height() >= bin.height()) {
+                    BOOST_LOG_TRIVIAL(debug) << itm.name << " too big, rotate to " << fit_into_box_rotation(itm.transformedShape(), bin);
+                    itm.rotate(fit_into_box_rotation(itm.transformedShape(), bin));
+                }
+            }
+        }
+    }
+}
+
 template<class BinT> // Arrange for arbitrary bin type
 void _arrange(
         std::vector<Item> &           shapes,
@@ -878,36 +985,33 @@ void _arrange(
     for (auto &itm : shapes  ) inp.emplace_back(itm);
     for (auto &itm : excludes) inp.emplace_back(itm);
 
-    // Use the minimum bounding box rotation as a starting point.
-    // TODO: This only works for convex hull. If we ever switch to concave
-    // polygon nesting, a convex hull needs to be calculated.
-    if (params.align_to_y_axis) {
-        for (auto &itm : shapes) {
-            auto angle = min_area_boundingbox_rotation(itm.transformedShape());
-            itm.rotate(angle + PI / 2);
-        }
-    }
-    else if (params.allow_rotations) {
-        for (auto &itm : shapes) {
-            auto angle = min_area_boundingbox_rotation(itm.transformedShape());
-            BOOST_LOG_TRIVIAL(debug) << itm.name << " min_area_boundingbox_rotation=" << angle << ", original angle=" << itm.rotation();
-            itm.rotate(angle);
-
-            // If the item is too big, try to find a rotation that makes it fit
-            if constexpr (std::is_same_v<BinT, Box>) {
-                auto bb = itm.boundingBox();
-                if (bb.width() >= bin.width() || bb.height() >= bin.height()) {
-                    BOOST_LOG_TRIVIAL(debug) << itm.name << " too big, rotate to " << fit_into_box_rotation(itm.transformedShape(), bin);
-                    itm.rotate(fit_into_box_rotation(itm.transformedShape(), bin));
-                }
-            }
-        }
-    }
+    set_initial_rotations(shapes, bin, params);
 
     arranger(inp.begin(), inp.end());
     for (Item &itm : inp) itm.inflation(0);
 }
 
+template<class BinT> // Fill the first bin of arbitrary type
+size_t _arrange_until_full(
+        std::vector<Item> &           shapes,
+        std::vector<Item> &           excludes,
+        const BinT &                  bin,
+        const ArrangeParams           &params)
+{
+    ArrangeParams mod_params = params;
+    mod_params.min_obj_distance = 0;  // items are already inflated
+
+    AutoArranger<BinT> arranger{bin, mod_params, params.progressind, params.stopcondition};
+
+    remove_large_items(excludes, bin);
+
+    set_initial_rotations(shapes, bin, params);
+
+    size_t count = arranger.fill_first_bin(shapes, excludes, params.stopcondition);
+    for (Item &itm : shapes) itm.inflation(0);
+    return count;
+}
+
 inline Box to_nestbin(const BoundingBox &bb) { return Box{{bb.min(X), bb.min(Y)}, {bb.max(X), bb.max(Y)}};}
 inline Circle to_nestbin(const CircleBed &c) { return Circle({c.center()(0), c.center()(1)}, c.radius()); }
 inline ExPolygon to_nestbin(const Polygon &p) { return ExPolygon{p}; }
@@ -1043,10 +1147,55 @@ void arrange(ArrangePolygons &      arrangables,
     }
 }
 
+template<>
+size_t arrange_until_full(ArrangePolygons &      items,
+                          const ArrangePolygons &excludes,
+                          const Points &         bed,
+                          const ArrangeParams &  params)
+{
+    return call_with_bed(bed, [&](const auto &bin) {
+        return arrange_until_full(items, excludes, bin, params);
+    });
+}
+
+template<class BedT>
+size_t arrange_until_full(ArrangePolygons &      arrangables,
+                          const ArrangePolygons &excludes,
+                          const BedT &           bed,
+                          const ArrangeParams &  params)
+{
+    std::vector<Item> items, fixeditems;
+    items.reserve(arrangables.size());
+
+    for (ArrangePolygon &arrangeable : arrangables)
+        process_arrangeable(arrangeable, items);
+
+    for (const ArrangePolygon &fixed: excludes)
+        process_arrangeable(fixed, fixeditems);
+
+    for (Item &itm : fixeditems) itm.inflate(scaled(-2. * EPSILON));
+
+    size_t count = _arrange_until_full(items, fixeditems, to_nestbin(bed), params);
+
+    for(size_t i = 0; i < items.size(); ++i) {
+        Point tr = items[i].translation();
+        arrangables[i].translation = {coord_t(tr.x()), coord_t(tr.y())};
+        arrangables[i].rotation    = items[i].rotation();
+        arrangables[i].bed_idx     = items[i].binId();
+        arrangables[i].itemid      = items[i].itemId();
+    }
+
+    return count;
+}
+
 template void arrange(ArrangePolygons &items, const ArrangePolygons &excludes, const BoundingBox &bed, const ArrangeParams &params);
 template void arrange(ArrangePolygons &items, const ArrangePolygons &excludes, const CircleBed &bed, const ArrangeParams &params);
 template void arrange(ArrangePolygons &items, const ArrangePolygons &excludes, const Polygon &bed, const ArrangeParams &params);
 template void arrange(ArrangePolygons &items, const ArrangePolygons &excludes, const InfiniteBed &bed, const ArrangeParams &params);
+template size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const BoundingBox &bed, const ArrangeParams &params);
+template size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const CircleBed &bed, const ArrangeParams &params);
+template size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const Polygon &bed, const ArrangeParams &params);
+template size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const InfiniteBed &bed, const ArrangeParams &params);
 
 } // namespace arr
 } // namespace Slic3r
@@ -104,6 +104,21 @@ struct ArrangePolygon {
 
 using ArrangePolygons = std::vector<ArrangePolygon>;
 
+/// Store of already calculated no fit polygons. It can be shared by subsequent
+/// arrange calls with the same objects, e.g. when searching for the count of
+/// copies which fit on a plate.
+class NfpCache;
+
+/// max_memory: the least recently used polygons are dropped above this limit
+std::shared_ptr<NfpCache> create_nfp_cache(size_t max_memory = 256 * 1024 * 1024);
+
+/// Hit rate, entry count and memory of the cache, for logging.
+std::string nfp_cache_stats(const NfpCache &cache);
+
+/// Drop the polygons of the cache shared by the arrange calls without their own
+/// cache, e.g. when the objects of the model are deleted.
+void clear_default_nfp_cache();
+
 struct ArrangeParams {
 
     /// The minimum distance which is allowed for any
@@ -139,6 +154,9 @@ struct ArrangeParams {
     ArrangePolygons excluded_regions;   // regions cant't be used
     ArrangePolygons nonprefered_regions; // regions can be used but not prefered
 
+    // Shared store of no fit polygons, a cache shared by all arrange calls is used if empty
+    std::shared_ptr<NfpCache> nfp_cache;
+
     /// Progress indicator callback called when an object gets packed.
     /// The unsigned argument is the number of items remaining to pack.
     std::function<void(unsigned, std::string)> progressind = [](unsigned st, std::string str = "") {
@@ -210,6 +228,31 @@ inline void arrange(ArrangePolygons &items, const CircleBed &bed, const ArrangeP
 inline void arrange(ArrangePolygons &items, const Polygon &bed, const ArrangeParams &params = {}) { arrange(items, {}, bed, params); }
 inline void arrange(ArrangePolygons &items, const InfiniteBed &bed, const ArrangeParams &params = {}) { arrange(items, {}, bed, params); }
 
+/**
+ * \brief Fills the first bed with the input polygons in their order.
+ *
+ * The items are added one at a time to the same packing, the ones placed
+ * before are not moved anymore. Arranging stops at the first item which does
+ * not fit, this and all the following items are left with bed_idx ==
+ * UNARRANGED. Ordering the copies of the objects one set after another thus
+ * gives a count of the copies fitting on the bed in a single pass, without
+ * arranging from scratch for each candidate count. As the placed items are
+ * never moved, the count is only a lower bound of what arrange() fits.
+ *
+ * Only the excludes with bed_idx 0 or UNARRANGED are taken into account.
+ *
+ * \return The count of the items placed on the bed.
+ */
+template<class TBed> size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const TBed &bed, const ArrangeParams &params = {});
+
+// A dispatch function that determines the bed shape from a set of points.
+template<> size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const Points &bed, const ArrangeParams &params);
+
+extern template size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const BoundingBox &bed, const ArrangeParams &params);
+extern template size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const CircleBed &bed, const ArrangeParams &params);
+extern template size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const Polygon &bed, const ArrangeParams &params);
+extern template size_t arrange_until_full(ArrangePolygons &items, const ArrangePolygons &excludes, const InfiniteBed &bed, const ArrangeParams &params);
+
 }} // namespace Slic3r::arrangement
 
 #endif // MODELARRANGE_HPP
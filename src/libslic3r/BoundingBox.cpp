@@ -7,7 +7,7 @@
 
 namespace Slic3r {
 
-template BoundingBoxBase<Point>::BoundingBoxBase(const std::vector<Point> &points);
+template BoundingBoxBase<Point>::BoundingBoxBase(const Points &points);
 template BoundingBoxBase<Vec2d>::BoundingBoxBase(const std::vector<Vec2d> &points);
 
 template BoundingBox3Base<Vec3d>::BoundingBox3Base(const std::vector<Vec3d> &points);
@@ -80,7 +80,7 @@ template void BoundingBoxBase<Vec2f>::merge(const Vec2f &point);
 template void BoundingBoxBase<Vec2d>::merge(const Vec2d &point);
 
 template <class PointClass> void
-BoundingBoxBase<PointClass>::merge(const std::vector<PointClass> &points)
+BoundingBoxBase<PointClass>::merge(const PointsOf<PointClass> &points)
 {
     this->merge(BoundingBoxBase(points));
 }
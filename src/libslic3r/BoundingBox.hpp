@@ -30,13 +30,13 @@ public:
         construct(*this, from, to);
     }
 
-    BoundingBoxBase(const std::vector<PointClass> &points)
+    BoundingBoxBase(const PointsOf<PointClass> &points)
         : BoundingBoxBase(points.begin(), points.end())
     {}
 
     void reset() { this->defined = false; this->min = PointClass::Zero(); this->max = PointClass::Zero(); }
     void merge(const PointClass &point);
-    void merge(const std::vector<PointClass> &points);
+    void merge(const PointsOf<PointClass> &points);
     void merge(const BoundingBoxBase<PointClass> &bb);
     void scale(double factor);
     PointClass size() const;
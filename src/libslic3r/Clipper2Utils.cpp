@@ -57,4 +57,132 @@ Slic3r::Polylines intersection_pl_2(const Slic3r::Polylines& subject, const Slic
 Slic3r::Polylines  diff_pl_2(const Slic3r::Polylines& subject, const Slic3r::Polygons& clip)
     { return _clipper2_pl_open(Clipper2Lib::ClipType::Difference, subject, clip); }
 
-}
\ No newline at end of file
+namespace Clipper2Utils {
+
+Clipper2Lib::Path64 to_path64(const Points &path)
+{
+    Clipper2Lib::Path64 out;
+    out.reserve(path.size());
+    for (const Point &pt : path)
+        out.emplace_back(pt.x(), pt.y());
+    return out;
+}
+
+static Points to_points(const Clipper2Lib::Path64 &path)
+{
+    Points out;
+    out.reserve(path.size());
+    for (const Clipper2Lib::Point64 &pt : path)
+        out.emplace_back(coord_t(pt.x), coord_t(pt.y));
+    return out;
+}
+
+ClipperLib::Paths to_paths(const Clipper2Lib::Paths64 &paths)
+{
+    ClipperLib::Paths out;
+    out.reserve(paths.size());
+    for (const Clipper2Lib::Path64 &path : paths)
+        out.emplace_back(to_points(path));
+    return out;
+}
+
+ExPolygons to_expolygons(const Clipper2Lib::PolyPath64 &parent)
+{
+    struct Inner {
+        static void add_outer_recursive(const Clipper2Lib::PolyPath64 &outer, ExPolygons &out)
+        {
+            size_t idx = out.size();
+            out.emplace_back();
+            out[idx].contour.points = to_points(outer.Polygon());
+            out[idx].holes.reserve(outer.Count());
+            for (const Clipper2Lib::PolyPath64 *hole : outer) {
+                out[idx].holes.emplace_back(to_points(hole->Polygon()));
+                // Add outer polygons contained by (nested within) holes.
+                for (const Clipper2Lib::PolyPath64 *nested : *hole)
+                    add_outer_recursive(*nested, out);
+            }
+        }
+    };
+
+    ExPolygons out;
+    out.reserve(parent.Count());
+    for (const Clipper2Lib::PolyPath64 *outer : parent)
+        Inner::add_outer_recursive(*outer, out);
+    return out;
+}
+
+ClipperLib::Paths to_paths(const Clipper2Lib::PolyPath64 &parent)
+{
+    struct Inner {
+        static void add_recursive(const Clipper2Lib::PolyPath64 &node, ClipperLib::Paths &out)
+        {
+            out.emplace_back(to_points(node.Polygon()));
+            for (const Clipper2Lib::PolyPath64 *child : node)
+                add_recursive(*child, out);
+        }
+    };
+
+    ClipperLib::Paths out;
+    for (const Clipper2Lib::PolyPath64 *child : parent)
+        Inner::add_recursive(*child, out);
+    return out;
+}
+
+void clear(Clipper2Lib::PolyPath64 &parent)
+{
+    for (Clipper2Lib::PolyPath64 *child : parent)
+        clear(*child);
+    parent.Clear();
+}
+
+Clipper2Lib::ClipType to_clip_type(ClipperLib::ClipType clip_type)
+{
+    switch (clip_type) {
+    case ClipperLib::ctIntersection: return Clipper2Lib::ClipType::Intersection;
+    case ClipperLib::ctUnion:        return Clipper2Lib::ClipType::Union;
+    case ClipperLib::ctDifference:   return Clipper2Lib::ClipType::Difference;
+    case ClipperLib::ctXor:          return Clipper2Lib::ClipType::Xor;
+    }
+    assert(false);
+    return Clipper2Lib::ClipType::None;
+}
+
+Clipper2Lib::FillRule to_fill_rule(ClipperLib::PolyFillType fill_type)
+{
+    switch (fill_type) {
+    case ClipperLib::pftEvenOdd:  return Clipper2Lib::FillRule::EvenOdd;
+    case ClipperLib::pftNonZero:  return Clipper2Lib::FillRule::NonZero;
+    case ClipperLib::pftPositive: return Clipper2Lib::FillRule::Positive;
+    case ClipperLib::pftNegative: return Clipper2Lib::FillRule::Negative;
+    }
+    assert(false);
+    return Clipper2Lib::FillRule::NonZero;
+}
+
+Clipper2Lib::JoinType to_join_type(ClipperLib::JoinType join_type)
+{
+    switch (join_type) {
+    case ClipperLib::jtSquare: return Clipper2Lib::JoinType::Square;
+    case ClipperLib::jtRound:  return Clipper2Lib::JoinType::Round;
+    case ClipperLib::jtMiter:  return Clipper2Lib::JoinType::Miter;
+    }
+    assert(false);
+    return Clipper2Lib::JoinType::Miter;
+}
+
+Clipper2Lib::EndType to_end_type(ClipperLib::EndType end_type)
+{
+    switch (end_type) {
+    case ClipperLib::etClosedPolygon: return Clipper2Lib::EndType::Polygon;
+    case ClipperLib::etClosedLine:    return Clipper2Lib::EndType::Joined;
+    case ClipperLib::etOpenButt:      return Clipper2Lib::EndType::Butt;
+    case ClipperLib::etOpenSquare:    return Clipper2Lib::EndType::Square;
+    case ClipperLib::etOpenRound:     return Clipper2Lib::EndType::Round;
+    }
+    assert(false);
+    return Clipper2Lib::EndType::Polygon;
+}
+
+} // namespace Clipper2Utils
+
+}
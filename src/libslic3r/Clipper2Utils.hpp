@@ -2,7 +2,9 @@
 #define slic3r_Clipper2Utils_hpp_
 
 #include "libslic3r.h"
+#include "clipper.hpp"
 #include "clipper2/clipper.h"
+#include "ExPolygon.hpp"
 #include "Polygon.hpp"
 #include "Polyline.hpp"
 
@@ -11,7 +13,40 @@ namespace Slic3r {
 Slic3r::Polylines  intersection_pl_2(const Slic3r::Polylines& subject, const Slic3r::Polygons& clip);
 Slic3r::Polylines  diff_pl_2(const Slic3r::Polylines& subject, const Slic3r::Polygons& clip);
 
+// Conversions between the legacy Clipper and Clipper2, used by the Clipper2 backend of ClipperUtils.
+namespace Clipper2Utils {
+
+    // Any range of Points: ClipperLib::Paths or one of the ClipperUtils paths providers.
+    template<typename PathsProvider>
+    inline Clipper2Lib::Paths64 to_paths64(PathsProvider &&paths)
+    {
+        Clipper2Lib::Paths64 out;
+        out.reserve(paths.size());
+        for (const Points &path : paths) {
+            Clipper2Lib::Path64 &out_path = out.emplace_back();
+            out_path.reserve(path.size());
+            for (const Point &pt : path)
+                out_path.emplace_back(pt.x(), pt.y());
+        }
+        return out;
+    }
+
+    Clipper2Lib::Path64 to_path64(const Points &path);
+    ClipperLib::Paths   to_paths(const Clipper2Lib::Paths64 &paths);
+    // Children of parent are the outer contours, their children the holes and so on.
+    ExPolygons          to_expolygons(const Clipper2Lib::PolyPath64 &parent);
+    // All the contours below parent at any depth, in the order of a depth first traversal.
+    ClipperLib::Paths   to_paths(const Clipper2Lib::PolyPath64 &parent);
+    // Release the whole tree below parent. PolyPath64 destructor does not release the grandchildren.
+    void                clear(Clipper2Lib::PolyPath64 &parent);
+
+    Clipper2Lib::ClipType to_clip_type(ClipperLib::ClipType clip_type);
+    Clipper2Lib::FillRule to_fill_rule(ClipperLib::PolyFillType fill_type);
+    Clipper2Lib::JoinType to_join_type(ClipperLib::JoinType join_type);
+    Clipper2Lib::EndType  to_end_type(ClipperLib::EndType end_type);
+
+} // namespace Clipper2Utils
+
 }
 
 #endif
-
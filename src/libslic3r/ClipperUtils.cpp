@@ -1,7 +1,10 @@
 #include "ClipperUtils.hpp"
+#include "Clipper2Utils.hpp"
 #include "Geometry.hpp"
 #include "ShortestPath.hpp"
 
+#include <atomic>
+
 // #define CLIPPER_UTILS_DEBUG
 
 #ifdef CLIPPER_UTILS_DEBUG
@@ -60,11 +63,21 @@ namespace ClipperUtils {
 Points EmptyPathsProvider::s_empty_points;
 Points SinglePathProvider::s_end;
 
+#ifdef SLIC3R_CLIPPER2_BACKEND
+static std::atomic<bool> s_clipper2_backend { true };
+#else
+static std::atomic<bool> s_clipper2_backend { false };
+#endif
+
+void set_clipper2_backend(bool enable) { s_clipper2_backend.store(enable, std::memory_order_relaxed); }
+bool clipper2_backend() { return s_clipper2_backend.load(std::memory_order_relaxed); }
+
 // Clip source polygon to be used as a clipping polygon with a bouding box around the source (to be clipped) polygon.
 // Useful as an optimization for expensive ClipperLib operations, for example when clipping source polygons one by one
 // with a set of polygons covering the whole layer below.
-template<typename PointType> inline void clip_clipper_polygon_with_subject_bbox_templ(const std::vector<PointType> &src, const BoundingBox &bbox, std::vector<PointType> &out, const bool get_entire_polygons=false)
+template<typename PointsType> inline void clip_clipper_polygon_with_subject_bbox_templ(const PointsType &src, const BoundingBox &bbox, PointsType &out, const bool get_entire_polygons=false)
 {
+    using PointType = typename PointsType::value_type;
     out.clear();
     const size_t cnt = src.size();
     if (cnt < 3) return;
@@ -120,9 +133,9 @@ template<typename PointType> inline void clip_clipper_polygon_with_subject_bbox_
 void clip_clipper_polygon_with_subject_bbox(const Points &src, const BoundingBox &bbox, Points &out, const bool get_entire_polygons) { clip_clipper_polygon_with_subject_bbox_templ(src, bbox, out, get_entire_polygons); }
 void clip_clipper_polygon_with_subject_bbox(const ZPoints &src, const BoundingBox &bbox, ZPoints &out) { clip_clipper_polygon_with_subject_bbox_templ(src, bbox, out); }
 
-template<typename PointType> [[nodiscard]] std::vector<PointType> clip_clipper_polygon_with_subject_bbox_templ(const std::vector<PointType> &src, const BoundingBox &bbox)
+template<typename PointsType> [[nodiscard]] PointsType clip_clipper_polygon_with_subject_bbox_templ(const PointsType &src, const BoundingBox &bbox)
 {
-    std::vector<PointType> out;
+    PointsType out;
     clip_clipper_polygon_with_subject_bbox(src, bbox, out);
     return out;
 }
@@ -267,28 +280,45 @@ bool has_duplicate_points(const ClipperLib::PolyTree &polytree)
 }
 #endif
 
+// Offset a single path with the semantics of ClipperLib::ClipperOffset:
+// Execute reorients the contours so that the outer most contour has a positive area. Thus the output
+// contours will be CCW oriented even though the input paths are CW oriented.
+static ClipperLib::Paths offset_path(const ClipperLib::Path &path, float offset, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType endType)
+{
+    ClipperLib::Paths out;
+    if (ClipperUtils::clipper2_backend()) {
+        // Clipper2 keeps the orientation of the input and offsets a CW path as a hole.
+        Clipper2Lib::Path64 path64 = Clipper2Utils::to_path64(path);
+        if (endType == ClipperLib::etClosedPolygon && Clipper2Lib::Area(path64) < 0)
+            std::reverse(path64.begin(), path64.end());
+        Clipper2Lib::ClipperOffset co(joinType == jtRound ? 2. : miterLimit, joinType == jtRound ? miterLimit : 0.);
+        co.AddPath(path64, Clipper2Utils::to_join_type(joinType), Clipper2Utils::to_end_type(endType));
+        out = Clipper2Utils::to_paths(co.Execute(offset));
+    } else {
+        ClipperLib::ClipperOffset co;
+        if (joinType == jtRound)
+            co.ArcTolerance = miterLimit;
+        else
+            co.MiterLimit = miterLimit;
+        co.ShortestEdgeLength = double(std::abs(offset * ClipperOffsetShortestEdgeFactor));
+        co.AddPath(path, joinType, endType);
+        co.Execute(out, offset);
+    }
+    return out;
+}
+
 // Offset CCW contours outside, CW contours (holes) inside.
 // Don't calculate union of the output paths.
 template<typename PathsProvider>
 static ClipperLib::Paths raw_offset(PathsProvider &&paths, float offset, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType endType = ClipperLib::etClosedPolygon)
 {
-    ClipperLib::ClipperOffset co;
     ClipperLib::Paths out;
     out.reserve(paths.size());
     ClipperLib::Paths out_this;
-    if (joinType == jtRound)
-        co.ArcTolerance = miterLimit;
-    else
-        co.MiterLimit = miterLimit;
-    co.ShortestEdgeLength = std::abs(offset * ClipperOffsetShortestEdgeFactor);
     for (const ClipperLib::Path &path : paths) {
-        co.Clear();
-        // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
-        // contours will be CCW oriented even though the input paths are CW oriented.
         // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-        co.AddPath(path, joinType, endType);
         bool ccw = endType == ClipperLib::etClosedPolygon ? ClipperLib::Orientation(path) : true;
-        co.Execute(out_this, ccw ? offset : - offset);
+        out_this = offset_path(path, ccw ? offset : - offset, joinType, miterLimit, endType);
         if (! ccw) {
             // Reverse the resulting contours.
             for (ClipperLib::Path &path : out_this)
@@ -306,6 +336,41 @@ static ClipperLib::Paths safety_offset(PathsProvider &&paths)
     return raw_offset(std::forward<PathsProvider>(paths), ClipperSafetyOffset, DefaultJoinType, DefaultMiterLimit);
 }
 
+// Clipper2 backend: Execute the boolean operation prepared in clipper, convert the result to TResult,
+// which is either ClipperLib::Paths or ExPolygons.
+template<class TResult>
+static TResult clipper2_execute(Clipper2Lib::Clipper64 &clipper, const ClipperLib::ClipType clipType, const ClipperLib::PolyFillType fillType)
+{
+    if constexpr (std::is_same_v<TResult, ExPolygons>) {
+        Clipper2Lib::PolyTree64 polytree;
+        Clipper2Lib::Paths64    open_paths;
+        clipper.Execute(Clipper2Utils::to_clip_type(clipType), Clipper2Utils::to_fill_rule(fillType), polytree, open_paths);
+        ExPolygons out = Clipper2Utils::to_expolygons(polytree);
+        Clipper2Utils::clear(polytree);
+        return out;
+    } else {
+        static_assert(std::is_same_v<TResult, ClipperLib::Paths>, "Clipper2 backend produces either ClipperLib::Paths or ExPolygons");
+        Clipper2Lib::Paths64 out;
+        clipper.Execute(Clipper2Utils::to_clip_type(clipType), Clipper2Utils::to_fill_rule(fillType), out);
+        return Clipper2Utils::to_paths(out);
+    }
+}
+
+template<class TResult, class TSubj, class TClip>
+static TResult clipper2_do(
+    const ClipperLib::ClipType     clipType,
+    TSubj &&                       subject,
+    TClip &&                       clip,
+    const ClipperLib::PolyFillType fillType)
+{
+    Clipper2Lib::Clipper64 clipper;
+    // Legacy Clipper removes collinear points.
+    clipper.PreserveCollinear = false;
+    clipper.AddSubject(Clipper2Utils::to_paths64(std::forward<TSubj>(subject)));
+    clipper.AddClip(Clipper2Utils::to_paths64(std::forward<TClip>(clip)));
+    return clipper2_execute<TResult>(clipper, clipType, fillType);
+}
+
 template<class TResult, class TSubj, class TClip>
 TResult clipper_do(
     const ClipperLib::ClipType     clipType,
@@ -313,6 +378,9 @@ TResult clipper_do(
     TClip &&                       clip,
     const ClipperLib::PolyFillType fillType)
 {
+    if constexpr (std::is_same_v<TResult, ClipperLib::Paths>)
+        if (ClipperUtils::clipper2_backend())
+            return clipper2_do<TResult>(clipType, std::forward<TSubj>(subject), std::forward<TClip>(clip), fillType);
     ClipperLib::Clipper clipper;
     clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
     clipper.AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
@@ -336,24 +404,34 @@ TResult clipper_do(
         clipper_do<TResult>(clipType, std::forward<TSubj>(subject), std::forward<TClip>(clip), fillType);
 }
 
+// TResult is ClipperLib::Paths, ClipperLib::PolyTree or ExPolygons.
 template<class TResult, class TSubj>
 TResult clipper_union(
     TSubj &&                       subject,
     // fillType pftNonZero and pftPositive "should" produce the same result for "normalized with implicit union" set of polygons
     const ClipperLib::PolyFillType fillType = ClipperLib::pftNonZero)
 {
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
-    TResult retval;
-    clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
-    return retval;
+    if constexpr (std::is_same_v<TResult, ExPolygons>) {
+        return ClipperUtils::clipper2_backend() ?
+            clipper2_do<ExPolygons>(ClipperLib::ctUnion, std::forward<TSubj>(subject), ClipperUtils::EmptyPathsProvider(), fillType) :
+            PolyTreeToExPolygons(clipper_union<ClipperLib::PolyTree>(std::forward<TSubj>(subject), fillType));
+    } else {
+        if constexpr (std::is_same_v<TResult, ClipperLib::Paths>)
+            if (ClipperUtils::clipper2_backend())
+                return clipper2_do<TResult>(ClipperLib::ctUnion, std::forward<TSubj>(subject), ClipperUtils::EmptyPathsProvider(), fillType);
+        ClipperLib::Clipper clipper;
+        clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
+        TResult retval;
+        clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
+        return retval;
+    }
 }
 
 // Perform union of input polygons using the positive rule, convert to ExPolygons.
 //FIXME is there any benefit of not doing the boolean / using pftEvenOdd?
 ExPolygons ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input, bool do_union)
 {
-    return PolyTreeToExPolygons(clipper_union<ClipperLib::PolyTree>(input, do_union ? ClipperLib::pftNonZero : ClipperLib::pftEvenOdd));
+    return clipper_union<ExPolygons>(input, do_union ? ClipperLib::pftNonZero : ClipperLib::pftEvenOdd);
 }
 
 template<typename PathsProvider>
@@ -378,24 +456,64 @@ template<> void remove_outermost_polygon<ClipperLib::Paths>(ClipperLib::Paths &s
 template<> void remove_outermost_polygon<ClipperLib::PolyTree>(ClipperLib::PolyTree &solution)
     { solution.RemoveOutermostPolygon(); }
 
+// used by shrink_paths(): Unite the shrunk contours inside a reversed bounding rectangle, which is removed afterwards.
+template<class TResult>
+static TResult shrink_union(const ClipperLib::Paths &raw)
+{
+    TResult out;
+    ClipperLib::Clipper clipper;
+    clipper.AddPaths(raw, ClipperLib::ptSubject, true);
+    ClipperLib::IntRect r = clipper.GetBounds();
+    clipper.AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
+    clipper.ReverseSolution(true);
+    clipper.Execute(ClipperLib::ctUnion, out, ClipperLib::pftNegative, ClipperLib::pftNegative);
+    remove_outermost_polygon(out);
+    return out;
+}
+
+// The same as shrink_union() with Clipper2. The rectangle is the root of the polygon tree.
+template<class TResult>
+static TResult clipper2_shrink_union(const ClipperLib::Paths &raw)
+{
+    Clipper2Lib::Paths64 raw64 = Clipper2Utils::to_paths64(raw);
+    Clipper2Lib::Rect64  r     = Clipper2Lib::Bounds(raw64);
+    raw64.push_back({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } });
+    Clipper2Lib::Clipper64 clipper;
+    clipper.PreserveCollinear = false;
+    clipper.ReverseSolution   = true;
+    clipper.AddSubject(raw64);
+    Clipper2Lib::PolyTree64 polytree;
+    Clipper2Lib::Paths64    open_paths;
+    clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::Negative, polytree, open_paths);
+    TResult out;
+    if (polytree.Count() == 1) {
+        if constexpr (std::is_same_v<TResult, ExPolygons>)
+            out = Clipper2Utils::to_expolygons(*polytree[0]);
+        else
+            out = Clipper2Utils::to_paths(*polytree[0]);
+    }
+    Clipper2Utils::clear(polytree);
+    return out;
+}
+
+// TResult is ClipperLib::Paths, ClipperLib::PolyTree or ExPolygons.
 template<class TResult, typename PathsProvider>
 static TResult shrink_paths(PathsProvider &&paths, float offset, ClipperLib::JoinType joinType, double miterLimit)
 {
     // BBS
     //assert(offset > 0);
-    TResult out;
     if (auto raw = raw_offset(std::forward<PathsProvider>(paths), - offset, joinType, miterLimit); ! raw.empty()) {
-        ClipperLib::Clipper clipper;
-        clipper.AddPaths(raw, ClipperLib::ptSubject, true);
-        ClipperLib::IntRect r = clipper.GetBounds();
-        clipper.AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
-        clipper.ReverseSolution(true);
-        clipper.Execute(ClipperLib::ctUnion, out, ClipperLib::pftNegative, ClipperLib::pftNegative);
-        remove_outermost_polygon(out);
+        if constexpr (std::is_same_v<TResult, ExPolygons>)
+            return ClipperUtils::clipper2_backend() ? clipper2_shrink_union<ExPolygons>(raw) : PolyTreeToExPolygons(shrink_union<ClipperLib::PolyTree>(raw));
+        else if constexpr (std::is_same_v<TResult, ClipperLib::Paths>)
+            return ClipperUtils::clipper2_backend() ? clipper2_shrink_union<ClipperLib::Paths>(raw) : shrink_union<ClipperLib::Paths>(raw);
+        else
+            return shrink_union<TResult>(raw);
     }
-    return out;
+    return TResult();
 }
 
+// TResult is ClipperLib::Paths, ClipperLib::PolyTree or ExPolygons.
 template<class TResult, typename PathsProvider>
 static TResult offset_paths(PathsProvider &&paths, float offset, ClipperLib::JoinType joinType, double miterLimit)
 {
@@ -413,7 +531,7 @@ Slic3r::Polygons offset(const Slic3r::Polygon &polygon, const float delta, Clipp
 Slic3r::Polygons offset(const Slic3r::Polygons &polygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
     { return to_polygons(offset_paths<ClipperLib::Paths>(ClipperUtils::PolygonsProvider(polygons), delta, joinType, miterLimit)); }
 Slic3r::ExPolygons offset_ex(const Slic3r::Polygons &polygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
-    { return PolyTreeToExPolygons(offset_paths<ClipperLib::PolyTree>(ClipperUtils::PolygonsProvider(polygons), delta, joinType, miterLimit)); }
+    { return offset_paths<ExPolygons>(ClipperUtils::PolygonsProvider(polygons), delta, joinType, miterLimit); }
 
 Slic3r::Polygons offset(const Slic3r::Polyline &polyline, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType end_type)
     { assert(delta > 0); return to_polygons(clipper_union<ClipperLib::Paths>(raw_offset_polyline(ClipperUtils::SinglePathProvider(polyline.points), delta, joinType, miterLimit, end_type))); }
@@ -437,17 +555,7 @@ Polygons contour_to_polygons(const Polygons &polygons, const float line_width, C
 static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::Paths &out)
 {
     // 1) Offset the outer contour.
-    ClipperLib::Paths contours;
-    {
-        ClipperLib::ClipperOffset co;
-        if (joinType == jtRound)
-            co.ArcTolerance = miterLimit;
-        else
-            co.MiterLimit = miterLimit;
-        co.ShortestEdgeLength = double(std::abs(delta * ClipperOffsetShortestEdgeFactor));
-        co.AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
-        co.Execute(contours, delta);
-    }
+    ClipperLib::Paths contours = offset_path(expoly.contour.points, delta, joinType, miterLimit, ClipperLib::etClosedPolygon);
     if (contours.empty())
         // No need to try to offset the holes.
         return 0;
@@ -459,21 +567,9 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
         // 2) Offset the holes one by one, collect the offsetted holes.
         ClipperLib::Paths holes;
         {
-            for (const Polygon &hole : expoly.holes) {
-                ClipperLib::ClipperOffset co;
-                if (joinType == jtRound)
-                    co.ArcTolerance = miterLimit;
-                else
-                    co.MiterLimit = miterLimit;
-                co.ShortestEdgeLength = double(std::abs(delta * ClipperOffsetShortestEdgeFactor));
-                co.AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
-                ClipperLib::Paths out2;
-                // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
-                // contours will be CCW oriented even though the input paths are CW oriented.
+            for (const Polygon &hole : expoly.holes)
                 // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-                co.Execute(out2, - delta);
-                append(holes, std::move(out2));
-            }
+                append(holes, offset_path(hole.points, - delta, joinType, miterLimit, ClipperLib::etClosedPolygon));
         }
 
         // 3) Subtract holes from the contours.
@@ -547,13 +643,13 @@ static ClipperLib::Paths expolygons_offset(const ExPolygonVector &expolygons, co
         output;
 }
 
-// See comment on expolygons_offset_raw. In addition, the polygons are always united to conver to polytree.
+// See comment on expolygons_offset_raw. In addition, the polygons are always united to conver to ExPolygons.
 template<typename ExPolygonVector>
-static ClipperLib::PolyTree expolygons_offset_pt(const ExPolygonVector &expolygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+static ExPolygons expolygons_offset_ex(const ExPolygonVector &expolygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
 {
     auto [output, expolygons_collected] = expolygons_offset_raw(expolygons, delta, joinType, miterLimit);
     // Unite the offsetted expolygons for both the
-    return clipper_union<ClipperLib::PolyTree>(output);
+    return clipper_union<ExPolygons>(output);
 }
 
 Slic3r::Polygons offset(const Slic3r::ExPolygon &expolygon, const float delta, ClipperLib::JoinType joinType, double miterLimit)
@@ -568,11 +664,11 @@ Slic3r::ExPolygons offset_ex(const Slic3r::ExPolygon &expolygon, const float del
     //FIXME one may spare one Clipper Union call.
     { return ClipperPaths_to_Slic3rExPolygons(expolygon_offset(expolygon, delta, joinType, miterLimit)); }
 Slic3r::ExPolygons offset_ex(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
-    { return PolyTreeToExPolygons(expolygons_offset_pt(expolygons, delta, joinType, miterLimit)); }
+    { return expolygons_offset_ex(expolygons, delta, joinType, miterLimit); }
 Slic3r::ExPolygons offset_ex(const Slic3r::Surfaces &surfaces, const float delta, ClipperLib::JoinType joinType, double miterLimit)
-    { return PolyTreeToExPolygons(expolygons_offset_pt(surfaces, delta, joinType, miterLimit)); }
+    { return expolygons_offset_ex(surfaces, delta, joinType, miterLimit); }
 Slic3r::ExPolygons offset_ex(const Slic3r::SurfacesPtr &surfaces, const float delta, ClipperLib::JoinType joinType, double miterLimit)
-    { return PolyTreeToExPolygons(expolygons_offset_pt(surfaces, delta, joinType, miterLimit)); }
+    { return expolygons_offset_ex(surfaces, delta, joinType, miterLimit); }
 
 Polygons offset2(const ExPolygons &expolygons, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
 {
@@ -580,12 +676,12 @@ Polygons offset2(const ExPolygons &expolygons, const float delta1, const float d
 }
 ExPolygons offset2_ex(const ExPolygons &expolygons, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
 {
-    return PolyTreeToExPolygons(offset_paths<ClipperLib::PolyTree>(expolygons_offset(expolygons, delta1, joinType, miterLimit), delta2, joinType, miterLimit));
+    return offset_paths<ExPolygons>(expolygons_offset(expolygons, delta1, joinType, miterLimit), delta2, joinType, miterLimit);
 }
 ExPolygons offset2_ex(const Surfaces &surfaces, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
 {
     //FIXME it may be more efficient to offset to_expolygons(surfaces) instead of to_polygons(surfaces).
-    return PolyTreeToExPolygons(offset_paths<ClipperLib::PolyTree>(expolygons_offset(surfaces, delta1, joinType, miterLimit), delta2, joinType, miterLimit));
+    return offset_paths<ExPolygons>(expolygons_offset(surfaces, delta1, joinType, miterLimit), delta2, joinType, miterLimit);
 }
 
 // Offset outside, then inside produces morphological closing. All deltas should be positive.
@@ -599,14 +695,14 @@ Slic3r::ExPolygons closing_ex(const Slic3r::Polygons &polygons, const float delt
 {
     assert(delta1 > 0);
     assert(delta2 > 0);
-    return PolyTreeToExPolygons(shrink_paths<ClipperLib::PolyTree>(expand_paths<ClipperLib::Paths>(ClipperUtils::PolygonsProvider(polygons), delta1, joinType, miterLimit), delta2, joinType, miterLimit));
+    return shrink_paths<ExPolygons>(expand_paths<ClipperLib::Paths>(ClipperUtils::PolygonsProvider(polygons), delta1, joinType, miterLimit), delta2, joinType, miterLimit);
 }
 Slic3r::ExPolygons closing_ex(const Slic3r::Surfaces &surfaces, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
 {
     assert(delta1 > 0);
     assert(delta2 > 0);
     //FIXME it may be more efficient to offset to_expolygons(surfaces) instead of to_polygons(surfaces).
-    return PolyTreeToExPolygons(shrink_paths<ClipperLib::PolyTree>(expand_paths<ClipperLib::Paths>(ClipperUtils::SurfacesProvider(surfaces), delta1, joinType, miterLimit), delta2, joinType, miterLimit));
+    return shrink_paths<ExPolygons>(expand_paths<ClipperLib::Paths>(ClipperUtils::SurfacesProvider(surfaces), delta1, joinType, miterLimit), delta2, joinType, miterLimit);
 }
 
 // Offset inside, then outside produces morphological opening. All deltas should be positive.
@@ -736,7 +832,16 @@ Slic3r::Polygons union_(const Slic3r::Polygons &subject, const Slic3r::ExPolygon
     { return _clipper(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::ExPolygonProvider(subject2), ApplySafetyOffset::No); }
 template <typename TSubject, typename TClip>
 static ExPolygons _clipper_ex(ClipperLib::ClipType clipType, TSubject &&subject,  TClip &&clip, ApplySafetyOffset do_safety_offset, ClipperLib::PolyFillType fill_type = ClipperLib::pftNonZero)
-    { return PolyTreeToExPolygons(clipper_do_polytree(clipType, std::forward<TSubject>(subject), std::forward<TClip>(clip), fill_type, do_safety_offset)); }
+{
+    if (ClipperUtils::clipper2_backend()) {
+        // Clipper2 builds the polygon tree directly, it does not need the workaround of clipper_do_polytree().
+        assert(do_safety_offset == ApplySafetyOffset::No || clipType != ClipperLib::ctUnion);
+        return do_safety_offset == ApplySafetyOffset::Yes ?
+            clipper2_do<ExPolygons>(clipType, std::forward<TSubject>(subject), safety_offset(std::forward<TClip>(clip)), fill_type) :
+            clipper2_do<ExPolygons>(clipType, std::forward<TSubject>(subject), std::forward<TClip>(clip), fill_type);
+    }
+    return PolyTreeToExPolygons(clipper_do_polytree(clipType, std::forward<TSubject>(subject), std::forward<TClip>(clip), fill_type, do_safety_offset));
+}
 
 Slic3r::ExPolygons diff_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset)
     { return _clipper_ex(ClipperLib::ctDifference, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), do_safety_offset); }
@@ -813,14 +918,13 @@ Slic3r::ExPolygons intersection_ex(const Slic3r::SurfacesPtr &subject, const Sli
 Slic3r::ExPolygons union_ex(const Slic3r::Polygons &subject, ClipperLib::PolyFillType fill_type)
     { return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No, fill_type); }
 Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject)
-    { return PolyTreeToExPolygons(clipper_do_polytree(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ClipperLib::pftNonZero)); }
+    { return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No); }
 Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject, const Slic3r::Polygons &subject2)
 {
-    return PolyTreeToExPolygons(
-        clipper_do_polytree(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PolygonsProvider(subject2), ClipperLib::pftNonZero));
+    return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PolygonsProvider(subject2), ApplySafetyOffset::No);
 }
     Slic3r::ExPolygons union_ex(const Slic3r::Surfaces &subject)
-    { return PolyTreeToExPolygons(clipper_do_polytree(ClipperLib::ctUnion, ClipperUtils::SurfacesProvider(subject), ClipperUtils::EmptyPathsProvider(), ClipperLib::pftNonZero)); }
+    { return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::SurfacesProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No); }
 // BBS
 Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons& poly1, const Slic3r::ExPolygons& poly2, bool safety_offset_)
     {
@@ -833,6 +937,19 @@ Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons& poly1, const Slic3r::ExPol
 template<typename PathsProvider1, typename PathsProvider2>
 Polylines _clipper_pl_open(ClipperLib::ClipType clipType, PathsProvider1 &&subject, PathsProvider2 &&clip)
 {
+    if (ClipperUtils::clipper2_backend()) {
+        Clipper2Lib::Clipper64 clipper;
+        clipper.PreserveCollinear = false;
+        clipper.AddOpenSubject(Clipper2Utils::to_paths64(std::forward<PathsProvider1>(subject)));
+        clipper.AddClip(Clipper2Utils::to_paths64(std::forward<PathsProvider2>(clip)));
+        Clipper2Lib::Paths64 closed, open;
+        clipper.Execute(Clipper2Utils::to_clip_type(clipType), Clipper2Lib::FillRule::NonZero, closed, open);
+        Polylines out;
+        out.reserve(open.size());
+        for (Points &points : Clipper2Utils::to_paths(open))
+            out.emplace_back(std::move(points));
+        return out;
+    }
     ClipperLib::Clipper clipper;
     clipper.AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
     clipper.AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
@@ -331,6 +331,12 @@ namespace ClipperUtils {
     [[nodiscard]] Polygons clip_clipper_polygons_with_subject_bbox(const ExPolygon &src, const BoundingBox &bbox, const bool get_entire_polygons = false);
     [[nodiscard]] Polygons clip_clipper_polygons_with_subject_bbox(const ExPolygons &src, const BoundingBox &bbox, const bool get_entire_polygons = false);
 
+    // Evaluate the offsets and the boolean operations below by Clipper2 instead of the legacy Clipper.
+    // Defaults to the SLIC3R_CLIPPER2_BACKEND build option, may be switched at runtime to compare the two.
+    // union_pt() and the functions taking or returning ClipperLib::PolyTree always run on the legacy Clipper.
+    void set_clipper2_backend(bool enable);
+    bool clipper2_backend();
+
     }
 
 // Perform union of input polygons using the non-zero rule, convert to ExPolygons.
@@ -17,7 +17,7 @@ public:
 	Contour() = default;
 	Contour(const Slic3r::Point *begin, const Slic3r::Point *end, bool open) : m_begin(begin), m_end(end), m_open(open) {}
 	Contour(const Slic3r::Point *data, size_t size, bool open) : Contour(data, data + size, open) {}
-	Contour(const std::vector<Slic3r::Point> &pts, bool open) : Contour(pts.data(), pts.size(), open) {}
+	Contour(const Slic3r::Points &pts, bool open) : Contour(pts.data(), pts.size(), open) {}
 
     const Slic3r::Point *begin()  const { return m_begin; }
     const Slic3r::Point *end()    const { return m_end; }
@@ -440,7 +440,7 @@ bool has_duplicate_points(const ExPolygon &expoly)
     size_t cnt = expoly.contour.points.size();
     for (const Polygon &hole : expoly.holes)
         cnt += hole.points.size();
-    std::vector<Point> allpts;
+    Points allpts;
     allpts.reserve(cnt);
     allpts.insert(allpts.begin(), expoly.contour.points.begin(), expoly.contour.points.end());
     for (const Polygon &hole : expoly.holes)
@@ -467,7 +467,7 @@ bool has_duplicate_points(const ExPolygons &expolys)
         for (const Polygon &hole : expoly.holes)
             cnt += hole.points.size();
     }
-    std::vector<Point> allpts;
+    Points allpts;
     allpts.reserve(cnt);
     for (const ExPolygon &expoly : expolys) {
         allpts.insert(allpts.begin(), expoly.contour.points.begin(), expoly.contour.points.end());
@@ -0,0 +1,599 @@
+#include "SliceCache.hpp"
+
+#include "../Exception.hpp"
+#include "../ExtrusionEntity.hpp"
+#include "../ExtrusionEntityCollection.hpp"
+#include "../Layer.hpp"
+#include "../Print.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <tbb/parallel_for.h>
+
+namespace Slic3r {
+namespace SliceCache {
+
+static constexpr const char SLICE_CACHE_MAGIC[8] = { 'B', 'B', 'S', 'L', 'I', 'C', 'E', 0 };
+// Written in the native byte order, read back as a different number on a machine with the other endianness.
+static constexpr uint32_t   SLICE_CACHE_BYTE_ORDER = 0x01020304;
+
+struct FileHeader
+{
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    byte_order;
+    uint64_t    identify_id;
+    uint64_t    name_offset;
+    uint64_t    name_size;
+    // Tables of TableEntry, one per layer.
+    uint64_t    layer_table_offset;
+    uint64_t    layer_count;
+    uint64_t    support_layer_table_offset;
+    uint64_t    support_layer_count;
+    uint64_t    first_layer_groups_offset;
+    uint64_t    first_layer_groups_size;
+};
+static_assert(sizeof(FileHeader) == 88, "FileHeader shall not be padded");
+
+struct TableEntry
+{
+    uint64_t    offset;
+    uint64_t    size;
+};
+
+enum class EntityType : uint8_t {
+    Path,
+    MultiPath,
+    Loop,
+    Collection
+};
+
+static_assert(sizeof(Point) == 2 * sizeof(coord_t), "Points are stored as flat arrays of coordinates");
+
+// Appends plain data to a growing buffer.
+class BlobWriter
+{
+public:
+    explicit BlobWriter(std::string &out) : m_out(out) {}
+
+    template<typename T> void pod(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types may be written directly");
+        m_out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void size(size_t value) { this->pod<uint64_t>(uint64_t(value)); }
+    void points(const Points &pts) {
+        this->size(pts.size());
+        if (! pts.empty())
+            m_out.append(reinterpret_cast<const char*>(pts.data()), pts.size() * sizeof(Point));
+    }
+    void point(const Point &pt) { this->pod<coord_t>(pt.x()); this->pod<coord_t>(pt.y()); }
+    void bbox(const BoundingBox &bbox) {
+        this->point(bbox.min);
+        this->point(bbox.max);
+        this->pod<uint8_t>(bbox.defined);
+    }
+    void expolygon(const ExPolygon &expoly) {
+        this->points(expoly.contour.points);
+        this->size(expoly.holes.size());
+        for (const Polygon &hole : expoly.holes)
+            this->points(hole.points);
+    }
+    void expolygons(const ExPolygons &expolys) {
+        this->size(expolys.size());
+        for (const ExPolygon &expoly : expolys)
+            this->expolygon(expoly);
+    }
+    void surfaces(const Surfaces &surfaces) {
+        this->size(surfaces.size());
+        for (const Surface &surface : surfaces) {
+            this->pod<int32_t>(int32_t(surface.surface_type));
+            this->pod<double>(surface.thickness);
+            this->pod<uint16_t>(surface.thickness_layers);
+            this->pod<double>(surface.bridge_angle);
+            this->pod<uint16_t>(surface.extra_perimeters);
+            this->expolygon(surface.expolygon);
+        }
+    }
+    void arc(const ArcSegment &arc) {
+        this->point(arc.center);
+        this->pod<double>(arc.radius);
+        this->pod<double>(arc.length);
+        this->pod<double>(arc.angle_radians);
+        this->pod<double>(arc.polar_start_theta);
+        this->pod<double>(arc.polar_end_theta);
+        this->point(arc.start_point);
+        this->point(arc.end_point);
+        this->pod<int32_t>(int32_t(arc.direction));
+    }
+    void polyline(const Polyline &polyline) {
+        this->points(polyline.points);
+        this->size(polyline.fitting_result.size());
+        for (const PathFittingData &fitting : polyline.fitting_result) {
+            this->size(fitting.start_point_index);
+            this->size(fitting.end_point_index);
+            this->pod<int32_t>(int32_t(fitting.path_type));
+            this->pod<uint8_t>(fitting.arc_data.is_arc);
+            // Same as the JSON dump, only a valid arc is stored.
+            if (fitting.arc_data.is_arc)
+                this->arc(fitting.arc_data);
+        }
+    }
+    void polylines(const Polylines &polylines) {
+        this->size(polylines.size());
+        for (const Polyline &polyline : polylines)
+            this->polyline(polyline);
+    }
+    void path(const ExtrusionPath &path) {
+        this->polyline(path.polyline);
+        this->pod<double>(path.overhang_degree);
+        this->pod<int32_t>(path.curve_degree);
+        this->pod<double>(path.mm3_per_mm);
+        this->pod<float>(path.width);
+        this->pod<float>(path.height);
+        this->pod<int32_t>(int32_t(path.role()));
+        this->pod<uint8_t>(path.is_force_no_extrusion());
+    }
+    void paths(const ExtrusionPaths &paths) {
+        this->size(paths.size());
+        for (const ExtrusionPath &path : paths)
+            this->path(path);
+    }
+    void entity(const ExtrusionEntity &entity) {
+        if (const auto *collection = dynamic_cast<const ExtrusionEntityCollection*>(&entity)) {
+            this->pod<EntityType>(EntityType::Collection);
+            this->collection(*collection);
+        } else if (const auto *path = dynamic_cast<const ExtrusionPath*>(&entity)) {
+            this->pod<EntityType>(EntityType::Path);
+            this->path(*path);
+        } else if (const auto *multipath = dynamic_cast<const ExtrusionMultiPath*>(&entity)) {
+            this->pod<EntityType>(EntityType::MultiPath);
+            this->paths(multipath->paths);
+        } else if (const auto *loop = dynamic_cast<const ExtrusionLoop*>(&entity)) {
+            this->pod<EntityType>(EntityType::Loop);
+            this->pod<int32_t>(int32_t(loop->loop_role()));
+            this->paths(loop->paths);
+        } else
+            throw Slic3r::FileIOError("Slice cache: invalid extrusion entity type");
+    }
+    void collection(const ExtrusionEntityCollection &collection) {
+        this->pod<uint8_t>(collection.no_sort);
+        this->size(collection.entities.size());
+        for (const ExtrusionEntity *entity : collection.entities)
+            this->entity(*entity);
+    }
+
+private:
+    std::string &m_out;
+};
+
+// Decodes plain data from a memory range, throws on reading past its end.
+class BlobReader
+{
+public:
+    BlobReader(const char *begin, size_t size) : m_ptr(begin), m_end(begin + size) {}
+
+    template<typename T> T pod() {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types may be read directly");
+        T value;
+        std::memcpy(&value, this->advance(sizeof(T)), sizeof(T));
+        return value;
+    }
+    size_t size() {
+        uint64_t value = this->pod<uint64_t>();
+        // Any count is bounded by the number of bytes left, this rejects garbage before allocating memory for it.
+        if (value > uint64_t(m_end - m_ptr))
+            throw Slic3r::FileIOError("Slice cache: corrupted element count");
+        return size_t(value);
+    }
+    void points(Points &pts) {
+        size_t cnt = this->size();
+        const char *src = this->advance(cnt * sizeof(Point));
+        pts.resize(cnt);
+        if (cnt > 0)
+            std::memcpy(pts.data(), src, cnt * sizeof(Point));
+    }
+    Point point() {
+        coord_t x = this->pod<coord_t>();
+        coord_t y = this->pod<coord_t>();
+        return { x, y };
+    }
+    BoundingBox bbox() {
+        BoundingBox out;
+        out.min     = this->point();
+        out.max     = this->point();
+        out.defined = this->pod<uint8_t>() != 0;
+        return out;
+    }
+    void expolygon(ExPolygon &expoly) {
+        this->points(expoly.contour.points);
+        expoly.holes.resize(this->size());
+        for (Polygon &hole : expoly.holes)
+            this->points(hole.points);
+    }
+    void expolygons(ExPolygons &expolys) {
+        expolys.resize(this->size());
+        for (ExPolygon &expoly : expolys)
+            this->expolygon(expoly);
+    }
+    void surfaces(Surfaces &surfaces) {
+        size_t cnt = this->size();
+        surfaces.reserve(surfaces.size() + cnt);
+        for (size_t i = 0; i < cnt; ++ i) {
+            Surface surface(stInternal, ExPolygon());
+            surface.surface_type     = SurfaceType(this->pod<int32_t>());
+            surface.thickness        = this->pod<double>();
+            surface.thickness_layers = this->pod<uint16_t>();
+            surface.bridge_angle     = this->pod<double>();
+            surface.extra_perimeters = this->pod<uint16_t>();
+            this->expolygon(surface.expolygon);
+            surfaces.emplace_back(std::move(surface));
+        }
+    }
+    void arc(ArcSegment &arc) {
+        arc.center            = this->point();
+        arc.radius            = this->pod<double>();
+        arc.length            = this->pod<double>();
+        arc.angle_radians     = this->pod<double>();
+        arc.polar_start_theta = this->pod<double>();
+        arc.polar_end_theta   = this->pod<double>();
+        arc.start_point       = this->point();
+        arc.end_point         = this->point();
+        arc.direction         = ArcDirection(this->pod<int32_t>());
+    }
+    void polyline(Polyline &polyline) {
+        this->points(polyline.points);
+        polyline.fitting_result.resize(this->size());
+        for (PathFittingData &fitting : polyline.fitting_result) {
+            fitting.start_point_index = this->size_value();
+            fitting.end_point_index   = this->size_value();
+            fitting.path_type         = EMovePathType(this->pod<int32_t>());
+            fitting.arc_data          = ArcSegment();
+            if (this->pod<uint8_t>()) {
+                fitting.arc_data.is_arc = true;
+                this->arc(fitting.arc_data);
+            }
+        }
+    }
+    void polylines(Polylines &polylines) {
+        polylines.resize(this->size());
+        for (Polyline &polyline : polylines)
+            this->polyline(polyline);
+    }
+    void path(ExtrusionPath &path) {
+        this->polyline(path.polyline);
+        path.overhang_degree = this->pod<double>();
+        path.curve_degree    = this->pod<int32_t>();
+        path.mm3_per_mm      = this->pod<double>();
+        path.width           = this->pod<float>();
+        path.height          = this->pod<float>();
+        path.set_extrusion_role(ExtrusionRole(this->pod<int32_t>()));
+        path.set_force_no_extrusion(this->pod<uint8_t>() != 0);
+    }
+    void paths(ExtrusionPaths &paths) {
+        paths.resize(this->size());
+        for (ExtrusionPath &path : paths)
+            this->path(path);
+    }
+    ExtrusionEntity* entity() {
+        switch (this->pod<EntityType>()) {
+        case EntityType::Path: {
+            auto path = std::make_unique<ExtrusionPath>();
+            this->path(*path);
+            return path.release();
+        }
+        case EntityType::MultiPath: {
+            auto multipath = std::make_unique<ExtrusionMultiPath>();
+            this->paths(multipath->paths);
+            return multipath.release();
+        }
+        case EntityType::Loop: {
+            auto loop = std::make_unique<ExtrusionLoop>();
+            loop->set_loop_role(ExtrusionLoopRole(this->pod<int32_t>()));
+            this->paths(loop->paths);
+            return loop.release();
+        }
+        case EntityType::Collection: {
+            auto collection = std::make_unique<ExtrusionEntityCollection>();
+            this->collection(*collection);
+            return collection.release();
+        }
+        default:
+            throw Slic3r::FileIOError("Slice cache: unknown extrusion entity type");
+        }
+    }
+    void collection(ExtrusionEntityCollection &collection) {
+        collection.no_sort = this->pod<uint8_t>() != 0;
+        size_t cnt = this->size();
+        collection.entities.reserve(collection.entities.size() + cnt);
+        for (size_t i = 0; i < cnt; ++ i)
+            collection.entities.emplace_back(this->entity());
+    }
+
+private:
+    // A value stored with size(), which is not a count of elements to follow.
+    size_t size_value() { return size_t(this->pod<uint64_t>()); }
+
+    const char* advance(size_t bytes) {
+        if (bytes > size_t(m_end - m_ptr))
+            throw Slic3r::FileIOError("Slice cache: unexpected end of a layer record");
+        const char *out = m_ptr;
+        m_ptr += bytes;
+        return out;
+    }
+
+    const char *m_ptr;
+    const char *m_end;
+};
+
+static void write_layer_info(BlobWriter &writer, const Layer &layer, int interface_id)
+{
+    writer.pod<int32_t>(int32_t(layer.id()));
+    writer.pod<int32_t>(int32_t(interface_id));
+    writer.pod<double>(layer.height);
+    writer.pod<double>(layer.print_z);
+    writer.pod<double>(layer.slice_z);
+    writer.size(layer.region_count());
+    for (const LayerRegion *layerm : layer.regions())
+        writer.size(layerm->region().config_hash());
+}
+
+static LayerInfo read_layer_info(BlobReader &reader)
+{
+    LayerInfo info;
+    info.id           = reader.pod<int32_t>();
+    info.interface_id = reader.pod<int32_t>();
+    info.height       = reader.pod<double>();
+    info.print_z      = reader.pod<double>();
+    info.slice_z      = reader.pod<double>();
+    info.region_config_hashes.resize(reader.size());
+    for (size_t &hash : info.region_config_hashes)
+        hash = size_t(reader.pod<uint64_t>());
+    return info;
+}
+
+static void write_layer(BlobWriter &writer, const Layer &layer, int interface_id)
+{
+    write_layer_info(writer, layer, interface_id);
+    writer.expolygons(layer.lslices);
+    writer.size(layer.lslices_bboxes.size());
+    for (const BoundingBox &bbox : layer.lslices_bboxes)
+        writer.bbox(bbox);
+    writer.expolygons(layer.loverhangs);
+    writer.bbox(layer.loverhangs_bbox);
+    for (const LayerRegion *layerm : layer.regions()) {
+        writer.surfaces(layerm->slices.surfaces);
+        writer.expolygons(layerm->raw_slices);
+        writer.collection(layerm->thin_fills);
+        writer.expolygons(layerm->fill_expolygons);
+        writer.surfaces(layerm->fill_surfaces.surfaces);
+        writer.expolygons(layerm->fill_no_overlap_expolygons);
+        writer.polylines(layerm->unsupported_bridge_edges);
+        writer.collection(layerm->perimeters);
+        writer.collection(layerm->fills);
+    }
+}
+
+static void read_layer(BlobReader &reader, Layer &layer)
+{
+    LayerInfo info = read_layer_info(reader);
+    if (info.region_config_hashes.size() != layer.region_count())
+        throw Slic3r::FileIOError((boost::format("Slice cache: layer %1% has %2% regions, %3% expected") % info.id % layer.region_count() % info.region_config_hashes.size()).str());
+    reader.expolygons(layer.lslices);
+    layer.lslices_bboxes.resize(reader.size());
+    for (BoundingBox &bbox : layer.lslices_bboxes)
+        bbox = reader.bbox();
+    reader.expolygons(layer.loverhangs);
+    layer.loverhangs_bbox = reader.bbox();
+    for (size_t region_id = 0; region_id < layer.region_count(); ++ region_id) {
+        LayerRegion *layerm = layer.get_region(int(region_id));
+        reader.surfaces(layerm->slices.surfaces);
+        reader.expolygons(layerm->raw_slices);
+        reader.collection(layerm->thin_fills);
+        reader.expolygons(layerm->fill_expolygons);
+        reader.surfaces(layerm->fill_surfaces.surfaces);
+        reader.expolygons(layerm->fill_no_overlap_expolygons);
+        reader.polylines(layerm->unsupported_bridge_edges);
+        reader.collection(layerm->perimeters);
+        reader.collection(layerm->fills);
+    }
+}
+
+void save(const std::string &path, const std::string &object_name, size_t identify_id,
+    const PrintObject &object, const std::vector<groupedVolumeSlices> &first_layer_groups)
+{
+    // Serialize the layers into independent blobs in parallel.
+    std::vector<std::string> layer_blobs(object.layer_count());
+    std::vector<std::string> support_layer_blobs(object.support_layer_count());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layer_blobs.size() + support_layer_blobs.size()),
+        [&object, &layer_blobs, &support_layer_blobs](const tbb::blocked_range<size_t> &range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
+                if (idx < layer_blobs.size()) {
+                    BlobWriter writer(layer_blobs[idx]);
+                    write_layer(writer, *object.get_layer(int(idx)), 0);
+                } else {
+                    size_t               support_idx   = idx - layer_blobs.size();
+                    const SupportLayer  *support_layer = object.support_layers()[support_idx];
+                    BlobWriter writer(support_layer_blobs[support_idx]);
+                    write_layer(writer, *support_layer, support_layer->interface_id());
+                    writer.expolygons(support_layer->support_islands);
+                    writer.collection(support_layer->support_fills);
+                }
+            }
+        });
+
+    std::string groups_blob;
+    {
+        BlobWriter writer(groups_blob);
+        writer.size(first_layer_groups.size());
+        for (const groupedVolumeSlices &group : first_layer_groups) {
+            writer.pod<int32_t>(int32_t(group.groupId));
+            writer.size(group.volume_ids.size());
+            for (const ObjectID &volume_id : group.volume_ids)
+                writer.size(volume_id.id);
+            writer.expolygons(group.slices);
+        }
+    }
+
+    FILE *file = boost::nowide::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        throw Slic3r::FileIOError("Slice cache: failed to open " + path + " for writing");
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SLICE_CACHE_MAGIC, sizeof(header.magic));
+    header.version                   = Version;
+    header.byte_order                = SLICE_CACHE_BYTE_ORDER;
+    header.identify_id               = identify_id;
+    header.layer_count               = layer_blobs.size();
+    header.support_layer_count       = support_layer_blobs.size();
+
+    // Layout: header, object name, layer blobs, support layer blobs, first layer groups, layer table, support layer table.
+    uint64_t offset = sizeof(FileHeader);
+    header.name_offset = offset;
+    header.name_size   = object_name.size();
+    offset += object_name.size();
+    std::vector<TableEntry> layer_table, support_layer_table;
+    layer_table.reserve(layer_blobs.size());
+    for (const std::string &blob : layer_blobs) {
+        layer_table.push_back({ offset, blob.size() });
+        offset += blob.size();
+    }
+    support_layer_table.reserve(support_layer_blobs.size());
+    for (const std::string &blob : support_layer_blobs) {
+        support_layer_table.push_back({ offset, blob.size() });
+        offset += blob.size();
+    }
+    header.first_layer_groups_offset  = offset;
+    header.first_layer_groups_size    = groups_blob.size();
+    offset += groups_blob.size();
+    // Keep the tables 8 bytes aligned.
+    const uint64_t padding = (8 - offset % 8) % 8;
+    offset += padding;
+    header.layer_table_offset         = offset;
+    header.support_layer_table_offset = offset + layer_table.size() * sizeof(TableEntry);
+
+    auto write = [file](const void *data, size_t size) {
+        return size == 0 || ::fwrite(data, 1, size, file) == size;
+    };
+    const uint64_t zeros = 0;
+    bool ok = write(&header, sizeof(header)) && write(object_name.data(), object_name.size());
+    for (size_t i = 0; ok && i < layer_blobs.size(); ++ i)
+        ok = write(layer_blobs[i].data(), layer_blobs[i].size());
+    for (size_t i = 0; ok && i < support_layer_blobs.size(); ++ i)
+        ok = write(support_layer_blobs[i].data(), support_layer_blobs[i].size());
+    ok = ok && write(groups_blob.data(), groups_blob.size()) && write(&zeros, size_t(padding)) &&
+        write(layer_table.data(), layer_table.size() * sizeof(TableEntry)) &&
+        write(support_layer_table.data(), support_layer_table.size() * sizeof(TableEntry));
+    ok = (::fclose(file) == 0) && ok;
+    if (! ok) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(path, ec);
+        throw Slic3r::FileIOError("Slice cache: failed to write " + path);
+    }
+}
+
+Reader::Reader(const std::string &path)
+{
+    try {
+        m_file.open(path);
+    } catch (const std::exception &err) {
+        throw Slic3r::FileIOError("Slice cache: failed to map " + path + ": " + err.what());
+    }
+    if (! m_file.is_open())
+        throw Slic3r::FileIOError("Slice cache: failed to map " + path);
+
+    if (m_file.size() < sizeof(FileHeader))
+        throw Slic3r::FileIOError("Slice cache: " + path + " is too short");
+    FileHeader header;
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SLICE_CACHE_MAGIC, sizeof(header.magic)) != 0)
+        throw Slic3r::FileIOError("Slice cache: " + path + " is not a slice cache");
+    if (header.byte_order != SLICE_CACHE_BYTE_ORDER)
+        throw Slic3r::FileIOError("Slice cache: " + path + " was written on a machine with a different byte order");
+    if (header.version != Version)
+        throw Slic3r::FileIOError((boost::format("Slice cache: %1% has version %2%, version %3% expected") % path % header.version % Version).str());
+
+    Blob name = this->blob(header.name_offset, header.name_size);
+    m_object_name.assign(name.data, name.size);
+    m_identify_id        = size_t(header.identify_id);
+    m_first_layer_groups = this->blob(header.first_layer_groups_offset, header.first_layer_groups_size);
+
+    auto read_table = [this](uint64_t table_offset, uint64_t count, std::vector<Blob> &out) {
+        if (count > m_file.size() / sizeof(TableEntry))
+            throw Slic3r::FileIOError("Slice cache: corrupted layer count");
+        Blob table = this->blob(table_offset, count * sizeof(TableEntry));
+        out.reserve(size_t(count));
+        for (size_t i = 0; i < size_t(count); ++ i) {
+            TableEntry entry;
+            std::memcpy(&entry, table.data + i * sizeof(TableEntry), sizeof(entry));
+            out.emplace_back(this->blob(entry.offset, entry.size));
+        }
+    };
+    read_table(header.layer_table_offset, header.layer_count, m_layers);
+    read_table(header.support_layer_table_offset, header.support_layer_count, m_support_layers);
+
+    BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << boost::format(": mapped %1%, %2% bytes, %3% layers, %4% support layers")
+        % path % m_file.size() % m_layers.size() % m_support_layers.size();
+}
+
+Reader::~Reader()
+{
+    if (m_file.is_open())
+        m_file.close();
+}
+
+Reader::Blob Reader::blob(uint64_t offset, uint64_t size) const
+{
+    if (offset > m_file.size() || size > m_file.size() - offset)
+        throw Slic3r::FileIOError("Slice cache: record out of the file bounds");
+    return { m_file.data() + offset, size_t(size) };
+}
+
+LayerInfo Reader::layer_info(size_t idx) const
+{
+    BlobReader reader(m_layers[idx].data, m_layers[idx].size);
+    return read_layer_info(reader);
+}
+
+LayerInfo Reader::support_layer_info(size_t idx) const
+{
+    BlobReader reader(m_support_layers[idx].data, m_support_layers[idx].size);
+    return read_layer_info(reader);
+}
+
+void Reader::load_layer(size_t idx, Layer &layer) const
+{
+    BlobReader reader(m_layers[idx].data, m_layers[idx].size);
+    read_layer(reader, layer);
+}
+
+void Reader::load_support_layer(size_t idx, SupportLayer &support_layer) const
+{
+    BlobReader reader(m_support_layers[idx].data, m_support_layers[idx].size);
+    read_layer(reader, support_layer);
+    reader.expolygons(support_layer.support_islands);
+    reader.collection(support_layer.support_fills);
+}
+
+std::vector<groupedVolumeSlices> Reader::first_layer_groups() const
+{
+    BlobReader reader(m_first_layer_groups.data, m_first_layer_groups.size);
+    std::vector<groupedVolumeSlices> out(reader.size());
+    for (groupedVolumeSlices &group : out) {
+        group.groupId = reader.pod<int32_t>();
+        group.volume_ids.resize(reader.size());
+        for (ObjectID &volume_id : group.volume_ids)
+            volume_id.id = size_t(reader.pod<uint64_t>());
+        reader.expolygons(group.slices);
+    }
+    return out;
+}
+
+} // namespace SliceCache
+} // namespace Slic3r
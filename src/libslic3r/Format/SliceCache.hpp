@@ -0,0 +1,92 @@
+#ifndef slic3r_Format_SliceCache_hpp_
+#define slic3r_Format_SliceCache_hpp_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace Slic3r {
+
+class Layer;
+class SupportLayer;
+class PrintObject;
+struct groupedVolumeSlices;
+
+// BBS: Binary container of the sliced layers of a single PrintObject, written by Print::export_cached_data()
+// and read by Print::load_cached_data() in place of the JSON dump.
+// Each layer is stored as a self contained blob with flat point arrays, the blobs are followed by offset tables,
+// so that the file may be memory mapped and its layers decoded lazily, one layer at a time and in parallel.
+// The numbers are stored in the native byte order, a foreign file is rejected by the header check.
+namespace SliceCache {
+
+// File name extension of the cache of a single object, "obj_<identify_id>.bin"
+static constexpr const char *Extension = ".bin";
+// Increment whenever the layout of the container or of the layer blobs changes.
+static constexpr uint32_t    Version   = 1;
+
+// Layer parameters needed to create a Layer / SupportLayer before its content is decoded.
+struct LayerInfo
+{
+    int                     id              { 0 };
+    // Only used by support layers.
+    int                     interface_id    { 0 };
+    double                  height          { 0. };
+    double                  print_z         { 0. };
+    double                  slice_z         { 0. };
+    // PrintRegion::config_hash() of the layer regions in the order of Layer::regions().
+    std::vector<size_t>     region_config_hashes;
+};
+
+// Serialize all layers and support layers of the object in parallel and write the container into path.
+// The volume IDs of first_layer_groups are expected to be converted to volume indices by the caller.
+// Throws Slic3r::FileIOError on failure.
+void save(const std::string &path, const std::string &object_name, size_t identify_id,
+    const PrintObject &object, const std::vector<groupedVolumeSlices> &first_layer_groups);
+
+class Reader
+{
+public:
+    // Memory map the file and validate its header and offset tables.
+    // Throws Slic3r::FileIOError if the file could not be opened or if it is not a valid cache of this version.
+    explicit Reader(const std::string &path);
+    ~Reader();
+
+    const std::string&  object_name() const         { return m_object_name; }
+    size_t              identify_id() const         { return m_identify_id; }
+    size_t              layer_count() const         { return m_layers.size(); }
+    size_t              support_layer_count() const { return m_support_layers.size(); }
+    // Size of the memory mapped file in bytes.
+    size_t              size() const                { return m_file.size(); }
+
+    LayerInfo           layer_info(size_t idx) const;
+    LayerInfo           support_layer_info(size_t idx) const;
+    // Decode content of a layer into a freshly created Layer, which regions were already added
+    // in the order of LayerInfo::region_config_hashes.
+    // Only reads the memory mapped file, thus it may be called for multiple layers in parallel.
+    // Throws Slic3r::FileIOError on a truncated or corrupted blob.
+    void                load_layer(size_t idx, Layer &layer) const;
+    void                load_support_layer(size_t idx, SupportLayer &support_layer) const;
+    // Volume IDs of the returned groups contain volume indices.
+    std::vector<groupedVolumeSlices> first_layer_groups() const;
+
+private:
+    struct Blob {
+        const char *data;
+        size_t      size;
+    };
+    Blob                                    blob(uint64_t offset, uint64_t size) const;
+
+    boost::iostreams::mapped_file_source    m_file;
+    std::string                             m_object_name;
+    size_t                                  m_identify_id { 0 };
+    std::vector<Blob>                       m_layers;
+    std::vector<Blob>                       m_support_layers;
+    Blob                                    m_first_layer_groups { nullptr, 0 };
+};
+
+} // namespace SliceCache
+} // namespace Slic3r
+
+#endif /* slic3r_Format_SliceCache_hpp_ */
@@ -1,19 +1,72 @@
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <climits>
 
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
+#include <boost/nowide/convert.hpp>
 #include <boost/nowide/cstdio.hpp>
 
+#include <fast_float/fast_float.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include "objparser.hpp"
 
 #include "libslic3r/LocalesUtils.hpp"
 
 namespace ObjParser {
+
+// Lines of a block of an OBJ file parsed independently of the blocks in front of it into its own ObjData, see objparse().
+// Everything referencing the data of the preceding blocks is recorded here and resolved when the blocks are merged.
+struct ObjParseBlock
+{
+	// Placeholder of a relative (negative) index, which is resolved when merging the blocks.
+	static constexpr int unresolved_idx = INT_MIN;
+
+	struct RelativeIdx {
+		// Index of the ObjVertex in ObjData::vertices of this block.
+		size_t			 vertex_idx;
+		int ObjVertex::* member;
+		// Negative index as stored in the file.
+		int				 idx;
+		// Number of values of the referenced array (coordinates, normals or texture coordinates) of this block at the time of the reference.
+		size_t			 num_values;
+	};
+	std::vector<RelativeIdx> relative_indices;
+
+	// Faces in front of the first usemtl of this block extend the last usemtl of the preceding blocks.
+	int				leading_vertex_idx_end { -1 };
+	int				leading_face_end_increment { 0 };
+};
+
+// strtod() replacement, parsing the decimal numbers with fast_float and falling back to strtod() for anything else
+// (hexadecimal floats, parse errors) to produce exactly the same results.
+static inline double obj_strtod(const char *str, const char *str_end, char **endptr)
+{
+	const char *p = str;
+	while (p != str_end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\v' || *p == '\f' || *p == '\r'))
+		++ p;
+	// fast_float does not accept the leading plus sign.
+	if (p != str_end && *p == '+' && p + 1 != str_end && p[1] != '-' && p[1] != '+')
+		++ p;
+	double out;
+	auto [ptr, ec] = fast_float::from_chars(p, str_end, out);
+	if (ec != std::errc() || (ptr != str_end && (*ptr == 'x' || *ptr == 'X')))
+		return strtod(str, endptr);
+	*endptr = const_cast<char*>(ptr);
+	return out;
+}
+
 #define EATWS()  while (*line == ' ' || *line == '\t') ++line
-static bool obj_parseline(const char *line, ObjData &data)
+static bool obj_parseline(const char *line, ObjData &data, ObjParseBlock *block = nullptr)
 {
 	if (*line == 0)
 		return true;
+	const char *line_end = line + strlen(line);
     assert(Slic3r::is_decimal_separator_point());
 	// Ignore whitespaces at the beginning of the line.
 	//FIXME is this a good idea?
@@ -38,14 +91,14 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double u = strtod(line, &endptr);
+			double u = obj_strtod(line, line_end, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
 			double v = 0;
 			if (*line != 0) {
-				v = strtod(line, &endptr);
+				v = obj_strtod(line, line_end, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -53,7 +106,7 @@ static bool obj_parseline(const char *line, ObjData &data)
 			}
 			/*double w = 0;
 			if (*line != 0) {
-				w = strtod(line, &endptr);
+				w = obj_strtod(line, line_end, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -75,17 +128,17 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double x = strtod(line, &endptr);
+			double x = obj_strtod(line, line_end, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double y = strtod(line, &endptr);
+			double y = obj_strtod(line, line_end, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double z = strtod(line, &endptr);
+			double z = obj_strtod(line, line_end, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
@@ -105,19 +158,19 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double u = strtod(line, &endptr);
+			double u = obj_strtod(line, line_end, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
 			EATWS();
-			double v = strtod(line, &endptr);
+			double v = obj_strtod(line, line_end, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
 			EATWS();
 			double w = 0;
 			if (*line != 0) {
-				w = strtod(line, &endptr);
+				w = obj_strtod(line, line_end, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -137,17 +190,17 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double x = strtod(line, &endptr);
+			double x = obj_strtod(line, line_end, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double y = strtod(line, &endptr);
+			double y = obj_strtod(line, line_end, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double z = strtod(line, &endptr);
+			double z = obj_strtod(line, line_end, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
@@ -157,24 +210,24 @@ static bool obj_parseline(const char *line, ObjData &data)
                 if (!data.has_vertex_color) {
                     data.has_vertex_color = true;
                 }
-                color_x = strtod(line, &endptr);
+                color_x = obj_strtod(line, line_end, &endptr);
                 if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
                     return false;
                 line = endptr;
                 EATWS();
-                color_y = strtod(line, &endptr);
+                color_y = obj_strtod(line, line_end, &endptr);
                 if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
                      return false;
                 line = endptr;
                 EATWS();
-                color_z = strtod(line, &endptr);
+                color_z = obj_strtod(line, line_end, &endptr);
                 if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
                     return false;
                 line = endptr;
                 EATWS();
                 color_w = 1.0;//default define alpha = 1.0
                 if (*line != 0) {
-                    color_w = strtod(line, &endptr);
+                    color_w = obj_strtod(line, line_end, &endptr);
                     if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0)) return false;
                     line = endptr;
                     EATWS();
@@ -236,16 +289,24 @@ static bool obj_parseline(const char *line, ObjData &data)
 					line = endptr;
 				}
 			}
+			auto resolve_relative = [&data, block, &vertex](int ObjVertex::* member, size_t num_values, int values_per_item) {
+				if (block != nullptr) {
+					// The values referenced may be stored in one of the preceding blocks.
+					block->relative_indices.push_back({ data.vertices.size(), member, vertex.*member, num_values });
+					vertex.*member = ObjParseBlock::unresolved_idx;
+				} else
+					vertex.*member += (int) num_values / values_per_item;
+			};
 			if (vertex.coordIdx < 0)
-                vertex.coordIdx += (int) data.coordinates.size() / OBJ_VERTEX_LENGTH;
+				resolve_relative(&ObjVertex::coordIdx, data.coordinates.size(), OBJ_VERTEX_LENGTH);
             else
 				-- vertex.coordIdx;
 			if (vertex.normalIdx < 0)
-                vertex.normalIdx += (int)data.normals.size() / 3;
+				resolve_relative(&ObjVertex::normalIdx, data.normals.size(), 3);
             else
 				-- vertex.normalIdx;
 			if (vertex.textureCoordIdx < 0)
-                vertex.textureCoordIdx += (int)data.textureCoordinates.size() / 3;
+				resolve_relative(&ObjVertex::textureCoordIdx, data.textureCoordinates.size(), 3);
             else
 				-- vertex.textureCoordIdx;
 			data.vertices.push_back(vertex);
@@ -253,8 +314,9 @@ static bool obj_parseline(const char *line, ObjData &data)
 		}
         if (data.usemtls.size() > 0) {
 			data.usemtls.back().vertexIdxEnd = (int) data.vertices.size();
-		}
-        if (data.usemtls.size() > 0) {
+		} else if (block != nullptr)
+			block->leading_vertex_idx_end = (int) data.vertices.size();
+        if (data.usemtls.size() > 0 || block != nullptr) {
             int face_index_count = 0;
             for (int i = data.vertices.size() - 1; i >= 0; i--) {
                 if (data.vertices[i].coordIdx == -1) {
@@ -262,11 +324,12 @@ static bool obj_parseline(const char *line, ObjData &data)
 				}
                 face_index_count++;
             }
+            int &face_end = data.usemtls.empty() ? block->leading_face_end_increment : data.usemtls.back().face_end;
             if (face_index_count == 3) {//tri
-                data.usemtls.back().face_end++;
+                face_end++;
 			} else if (face_index_count == 4) {//quad
-                data.usemtls.back().face_end++;
-                data.usemtls.back().face_end++;
+                face_end++;
+                face_end++;
 			}
         }
 		vertex.coordIdx			= -1;
@@ -565,54 +628,179 @@ static bool        mtl_parseline(const char *line, MtlData &data)
     return true;
 }
 
+// Parse the lines of [begin, end) terminated by CR or LF, an unterminated last line is not parsed.
+// Returns false on a line, which would not fit the 64kB read buffer of the former FILE based parser: The file used to be read
+// in 64kB pieces at offsets aligned to 64kB, failing if the remainder of the last unterminated line exceeded 64kB.
+static bool obj_parselines(const char *file_begin, const char *file_end, const char *begin, const char *end, ObjData &data, ObjParseBlock *block)
+{
+	static constexpr size_t read_size = 65536;
+	std::string line;
+	for (const char *c = begin; c != end;) {
+		const char *eol = c;
+		while (eol != file_end && *eol != '\r' && *eol != '\n')
+			++ eol;
+		if (size_t(eol - c) > read_size) {
+			size_t first_read_end = std::min(((size_t(c - file_begin) + read_size) / read_size + 1) * read_size, size_t(file_end - file_begin));
+			if (file_begin + first_read_end <= eol) {
+		    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
+				return false;
+			}
+		}
+		if (eol == file_end)
+			break;
+		line.assign(c, eol);
+		const char *l = line.c_str();
+		while (*l == ' ' || *l == '\t')
+			++ l;
+		//FIXME check the return value and exit on error?
+		// Will it break parsing of some obj files?
+		obj_parseline(l, data, block);
+		c = eol + 1;
+	}
+	return true;
+}
+
+// Append the data of a block parsed by obj_parselines() to the data of the blocks in front of it.
+static void obj_merge_block(ObjData &data, ObjData &&block_data, const ObjParseBlock &block)
+{
+	const int vertices_base = int(data.vertices.size());
+	for (const ObjParseBlock::RelativeIdx &rel : block.relative_indices) {
+		int num_items = 0;
+		if (rel.member == &ObjVertex::coordIdx)
+			num_items = int(data.coordinates.size() + rel.num_values) / OBJ_VERTEX_LENGTH;
+		else if (rel.member == &ObjVertex::normalIdx)
+			num_items = int(data.normals.size() + rel.num_values) / 3;
+		else
+			num_items = int(data.textureCoordinates.size() + rel.num_values) / 3;
+		block_data.vertices[rel.vertex_idx].*rel.member = rel.idx + num_items;
+	}
+
+	int face_base = 0;
+	if (! data.usemtls.empty()) {
+		ObjUseMtl &last = data.usemtls.back();
+		if (block.leading_vertex_idx_end != -1)
+			last.vertexIdxEnd = vertices_base + block.leading_vertex_idx_end;
+		last.face_end += block.leading_face_end_increment;
+		if (! block_data.usemtls.empty())
+			last.vertexIdxEnd = vertices_base + block_data.usemtls.front().vertexIdxFirst;
+		face_base = last.face_end + 1;
+	}
+	for (ObjUseMtl &usemtl : block_data.usemtls) {
+		usemtl.vertexIdxFirst += vertices_base;
+		if (usemtl.vertexIdxEnd != -1)
+			usemtl.vertexIdxEnd += vertices_base;
+		usemtl.face_start += face_base;
+		usemtl.face_end   += face_base;
+	}
+	for (ObjObject &object : block_data.objects)
+		object.vertexIdxFirst += vertices_base;
+	for (ObjGroup &group : block_data.groups)
+		group.vertexIdxFirst += vertices_base;
+	for (ObjSmoothingGroup &group : block_data.smoothingGroups)
+		group.vertexIdxFirst += vertices_base;
+
+	auto append = [](auto &dst, auto &src) { dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end())); };
+	append(data.coordinates, block_data.coordinates);
+	append(data.textureCoordinates, block_data.textureCoordinates);
+	append(data.normals, block_data.normals);
+	append(data.parameters, block_data.parameters);
+	append(data.mtllibs, block_data.mtllibs);
+	append(data.usemtls, block_data.usemtls);
+	append(data.objects, block_data.objects);
+	append(data.groups, block_data.groups);
+	append(data.smoothingGroups, block_data.smoothingGroups);
+	append(data.vertices, block_data.vertices);
+	data.has_vertex_color |= block_data.has_vertex_color;
+}
+
 bool objparse(const char *path, ObjData &data)
 {
     Slic3r::CNumericLocalesSetter locales_setter;
 
-	FILE *pFile = boost::nowide::fopen(path, "rt");
-	if (pFile == 0)
+	boost::iostreams::mapped_file_source mapped;
+	try {
+#ifdef _WIN32
+		boost::filesystem::path file_path(boost::nowide::widen(path));
+#else
+		boost::filesystem::path file_path(path);
+#endif
+		// Memory mapping of an empty file fails.
+		if (boost::filesystem::file_size(file_path) == 0)
+			return true;
+		mapped.open(file_path);
+	} catch (const std::exception &err) {
+		BOOST_LOG_TRIVIAL(error) << "ObjParser: Couldn't map " << path << " for reading, reason = " << err.what();
 		return false;
+	}
+	const char *file_begin = mapped.data();
+	const char *file_end   = file_begin + mapped.size();
 
 	try {
-		char buf[65536 * 2];
-		size_t len = 0;
-		size_t lenPrev = 0;
-		size_t lineCount = 0;
-
-		while ((len = ::fread(buf + lenPrev, 1, 65536, pFile)) != 0) {
-			len += lenPrev;
-			size_t lastLine = 0;
-			for (size_t i = 0; i < len; ++ i)
-				if (buf[i] == '\r' || buf[i] == '\n') {
-					buf[i] = 0;
-					char *c = buf + lastLine;
-					while (*c == ' ' || *c == '\t')
-						++ c;
-					//FIXME check the return value and exit on error?
-					// Will it break parsing of some obj files?
-					obj_parseline(c, data);
-
-					/*for ml*/
-					if (lineCount == 0) { data.ml_region = parsemlinfo(c, "region:");}
-                    if (lineCount == 1) { data.ml_name = parsemlinfo(c, "ml_name:"); }
-					if (lineCount == 2) { data.ml_id = parsemlinfo(c, "ml_file_id:");}
-
-					++lineCount;
-					lastLine = i + 1;
-				}
-			lenPrev = len - lastLine;
-			if (lenPrev > 65536) {
-		    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
-				::fclose(pFile);
+		/*for ml*/
+		{
+			const char *c = file_begin;
+			for (size_t line_idx = 0; line_idx < 3 && c != file_end; ++ line_idx) {
+				const char *eol = c;
+				while (eol != file_end && *eol != '\r' && *eol != '\n')
+					++ eol;
+				if (eol == file_end)
+					break;
+				std::string line(c, eol);
+				const char *l = line.c_str();
+				while (*l == ' ' || *l == '\t')
+					++ l;
+				if (line_idx == 0) { data.ml_region = parsemlinfo(l, "region:"); }
+				if (line_idx == 1) { data.ml_name = parsemlinfo(l, "ml_name:"); }
+				if (line_idx == 2) { data.ml_id = parsemlinfo(l, "ml_file_id:"); }
+				c = eol + 1;
+#ifdef _WIN32
+				// The file used to be opened in text mode, CR LF was read as a single end of line.
+				if (*eol == '\r' && c != file_end && *c == '\n')
+					++ c;
+#endif
+			}
+		}
+
+		// Split the file into blocks of whole lines, which are parsed in parallel.
+		static constexpr size_t block_size = 4 * 1024 * 1024;
+		std::vector<const char*> block_begins { file_begin };
+		for (const char *c = file_begin + block_size; c < file_end; c += block_size) {
+			while (c != file_end && *c != '\r' && *c != '\n')
+				++ c;
+			if (c == file_end)
+				break;
+			block_begins.emplace_back(++ c);
+		}
+		block_begins.emplace_back(file_end);
+		size_t num_blocks = block_begins.size() - 1;
+
+		if (num_blocks > 1) {
+			std::vector<ObjData>       blocks_data(num_blocks);
+			std::vector<ObjParseBlock> blocks(num_blocks);
+			std::vector<char>          blocks_valid(num_blocks, true);
+			tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks, 1), [&](const tbb::blocked_range<size_t> &range) {
+				for (size_t i = range.begin(); i < range.end(); ++ i)
+					blocks_valid[i] = obj_parselines(file_begin, file_end, block_begins[i], block_begins[i + 1], blocks_data[i], &blocks[i]);
+			});
+			if (std::find(blocks_valid.begin(), blocks_valid.end(), false) != blocks_valid.end())
 				return false;
+			// The number of vertices of a face is counted back up to the end of the previous face, which may lie in the previous block
+			// if the previous block ends with a face, which failed to parse. Fall back to the sequential parsing in that case.
+			bool independent = true;
+			for (size_t i = 0; i + 1 < num_blocks && independent; ++ i)
+				independent = blocks_data[i].vertices.empty() || blocks_data[i].vertices.back().coordIdx == -1;
+			if (independent) {
+				for (size_t i = 0; i < num_blocks; ++ i)
+					obj_merge_block(data, std::move(blocks_data[i]), blocks[i]);
+				return true;
 			}
-			memmove(buf, buf + lastLine, lenPrev);
 		}
+		if (! obj_parselines(file_begin, file_end, file_begin, file_end, data, nullptr))
+			return false;
     }
     catch (std::bad_alloc&) {
     	BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
 	}
-	::fclose(pFile);
 	return true;
 }
 
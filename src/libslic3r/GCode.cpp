@@ -5,6 +5,7 @@
 #include "ExtrusionEntity.hpp"
 #include "EdgeGrid.hpp"
 #include "Geometry/ConvexHull.hpp"
+#include "GCode/AsyncFileWriter.hpp"
 #include "GCode/PrintExtents.hpp"
 #include "GCode/WipeTower.hpp"
 #include "ShortestPath.hpp"
@@ -1158,7 +1159,7 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessorResult* resu
     path_tmp += ".tmp";
 
     m_processor.initialize(path_tmp);
-    GCodeOutputStream file(boost::nowide::fopen(path_tmp.c_str(), "wb"), m_processor);
+    GCodeOutputStream file(path_tmp, m_processor);
     if (! file.is_open()) {
         BOOST_LOG_TRIVIAL(error) << std::string("G-code export to ") + path + " failed.\nCannot open the file for writing.\n" << std::endl;
         if (!fs::exists(folder)) {
@@ -2385,23 +2386,44 @@ void GCode::process_layers(
     GCodeOutputStream                                                   &output_stream)
 {
     // The pipeline is variable: The vase mode filter is optional.
+    std::vector<const LayerTools*> layer_tools_to_print;
+    layer_tools_to_print.reserve(layers_to_print.size());
+    for (const std::pair<coordf_t, std::vector<LayerToPrint>> &layer : layers_to_print)
+        layer_tools_to_print.emplace_back(&tool_ordering.tools_for_layer(layer.first));
+    const bool parallel_planning = m_parallel_layer_planning;
+
     size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, GCode::LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> GCode::LayerResult {
+    const auto generator = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [&layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> size_t {
             if (layer_to_print_idx == layers_to_print.size()) {
                 fc.stop();
-                return {};
-            } else {
-                const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
-                const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
-                if (m_wipe_tower && layer_tools.has_wipe_tower)
-                    m_wipe_tower->next_layer();
-                //BBS
-                check_placeholder_parser_failed();
-                print.throw_if_canceled();
-                return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
+                return 0;
             }
+            return layer_to_print_idx ++;
+        });
+    // Grouping of extrusions by extruders does not touch the G-code generator state, it may run out of order.
+    // The travel boundaries only depend on the layers, they are prepared ahead even if the extrusions are not.
+    const auto planner = tbb::make_filter<size_t, LayerToProcess>(parallel_planning || print.config().reduce_crossing_wall ?
+            slic3r_tbb_filtermode::parallel : slic3r_tbb_filtermode::serial_in_order,
+        [&print, &layers_to_print, &layer_tools_to_print, parallel_planning](size_t idx) -> LayerToProcess {
+            print.throw_if_canceled();
+            LayerToProcess out { idx, {}, {} };
+            if (parallel_planning)
+                out.extrusions = collect_layer_extrusions(print, layers_to_print[idx].second, *layer_tools_to_print[idx]);
+            out.travel_boundaries = prepare_layer_travel_boundaries(print, layers_to_print[idx].second);
+            return out;
+        });
+    const auto emitter = tbb::make_filter<LayerToProcess, GCode::LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &print_object_instances_ordering, &layers_to_print, &layer_tools_to_print](LayerToProcess in) -> GCode::LayerResult {
+            const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[in.idx];
+            const LayerTools& layer_tools = *layer_tools_to_print[in.idx];
+            print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(in.idx + 1)));
+            if (m_wipe_tower && layer_tools.has_wipe_tower)
+                m_wipe_tower->next_layer();
+            //BBS
+            check_placeholder_parser_failed();
+            print.throw_if_canceled();
+            return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1), false, &in.extrusions, std::move(in.travel_boundaries));
         });
     if (m_spiral_vase) {
         float nozzle_diameter  = EXTRUDER_CONFIG(nozzle_diameter);
@@ -2414,19 +2436,25 @@ void GCode::process_layers(
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
             return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush};
         });
-    const auto cooling = tbb::make_filter<GCode::LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](GCode::LayerResult in) -> std::string {
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+    // Tokenizing the G-code for the cooling buffer does not depend on the previous layers, it may run out of order.
+    const auto cooling_parser = tbb::make_filter<GCode::LayerResult, LayerToCool>(slic3r_tbb_filtermode::parallel,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](GCode::LayerResult in) -> LayerToCool {
+            return { cooling_buffer.parse_layer(std::move(in.gcode)), in.layer_id, in.cooling_buffer_flush };
+        });
+    // Layer times, slow down and fan control are chained from layer to layer.
+    const auto cooling = tbb::make_filter<LayerToCool, std::string>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerToCool in) -> std::string {
+            return cooling_buffer.process_layer(std::move(in.layer), in.layer_id, in.cooling_buffer_flush);
         });
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+        [&output_stream](std::string s) { output_stream.write(std::move(s)); }
     );
 
     // The pipeline elements are joined using const references, thus no copying is performed.
     if (m_spiral_vase)
-        tbb::parallel_pipeline(12, generator & spiral_mode & cooling & output);
+        tbb::parallel_pipeline(12, generator & planner & emitter & spiral_mode & cooling_parser & cooling & output);
     else
-        tbb::parallel_pipeline(12, generator & cooling & output);
+        tbb::parallel_pipeline(12, generator & planner & emitter & cooling_parser & cooling & output);
 }
 
 // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
@@ -2442,20 +2470,41 @@ void GCode::process_layers(
     const bool                               prime_extruder)
 {
     // The pipeline is variable: The vase mode filter is optional.
+    std::vector<const LayerTools*> layer_tools_to_print;
+    layer_tools_to_print.reserve(layers_to_print.size());
+    for (const LayerToPrint &layer : layers_to_print)
+        layer_tools_to_print.emplace_back(&tool_ordering.tools_for_layer(layer.print_z()));
+    const bool parallel_planning = m_parallel_layer_planning;
+
     size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, GCode::LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, single_object_idx, prime_extruder](tbb::flow_control& fc) -> GCode::LayerResult {
+    const auto generator = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [&layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> size_t {
             if (layer_to_print_idx == layers_to_print.size()) {
                 fc.stop();
-                return {};
-            } else {
-                LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
-                //BBS
-                check_placeholder_parser_failed();
-                print.throw_if_canceled();
-                return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, single_object_idx, prime_extruder);
+                return 0;
             }
+            return layer_to_print_idx ++;
+        });
+    // Grouping of extrusions by extruders does not touch the G-code generator state, it may run out of order.
+    // The travel boundaries only depend on the layers, they are prepared ahead even if the extrusions are not.
+    const auto planner = tbb::make_filter<size_t, LayerToProcess>(parallel_planning || print.config().reduce_crossing_wall ?
+            slic3r_tbb_filtermode::parallel : slic3r_tbb_filtermode::serial_in_order,
+        [&print, &layers_to_print, &layer_tools_to_print, parallel_planning](size_t idx) -> LayerToProcess {
+            print.throw_if_canceled();
+            LayerToProcess out { idx, {}, {} };
+            if (parallel_planning)
+                out.extrusions = collect_layer_extrusions(print, { layers_to_print[idx] }, *layer_tools_to_print[idx]);
+            out.travel_boundaries = prepare_layer_travel_boundaries(print, { layers_to_print[idx] });
+            return out;
+        });
+    const auto emitter = tbb::make_filter<LayerToProcess, GCode::LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &layers_to_print, &layer_tools_to_print, single_object_idx, prime_extruder](LayerToProcess in) -> GCode::LayerResult {
+            const LayerToPrint &layer = layers_to_print[in.idx];
+            print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(in.idx + 1)));
+            //BBS
+            check_placeholder_parser_failed();
+            print.throw_if_canceled();
+            return this->process_layer(print, { layer }, *layer_tools_to_print[in.idx], &layer == &layers_to_print.back(), nullptr, single_object_idx, prime_extruder, &in.extrusions, std::move(in.travel_boundaries));
         });
     if (m_spiral_vase) {
         float nozzle_diameter  = EXTRUDER_CONFIG(nozzle_diameter);
@@ -2468,19 +2517,25 @@ void GCode::process_layers(
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
             return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush };
         });
-    const auto cooling = tbb::make_filter<GCode::LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](GCode::LayerResult in)->std::string {
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+    // Tokenizing the G-code for the cooling buffer does not depend on the previous layers, it may run out of order.
+    const auto cooling_parser = tbb::make_filter<GCode::LayerResult, LayerToCool>(slic3r_tbb_filtermode::parallel,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](GCode::LayerResult in) -> LayerToCool {
+            return { cooling_buffer.parse_layer(std::move(in.gcode)), in.layer_id, in.cooling_buffer_flush };
+        });
+    // Layer times, slow down and fan control are chained from layer to layer.
+    const auto cooling = tbb::make_filter<LayerToCool, std::string>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerToCool in) -> std::string {
+            return cooling_buffer.process_layer(std::move(in.layer), in.layer_id, in.cooling_buffer_flush);
         });
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+        [&output_stream](std::string s) { output_stream.write(std::move(s)); }
     );
 
     // The pipeline elements are joined using const references, thus no copying is performed.
     if (m_spiral_vase)
-        tbb::parallel_pipeline(12, generator & spiral_mode & cooling & output);
+        tbb::parallel_pipeline(12, generator & planner & emitter & spiral_mode & cooling_parser & cooling & output);
     else
-        tbb::parallel_pipeline(12, generator & cooling & output);
+        tbb::parallel_pipeline(12, generator & planner & emitter & cooling_parser & cooling & output);
 }
 
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override)
@@ -2929,6 +2984,245 @@ inline std::string get_instance_name(const PrintObject* object, const PrintInsta
     return get_instance_name(object, inst.id);
 }
 
+// Build the boundaries of all the layers of a print_z for AvoidCrossingPerimeters, they depend on the sliced layers only,
+// therefore they may be built in parallel ahead of the serial G-code emission.
+AvoidCrossingPerimeters::LayerBoundariesPtrs GCode::prepare_layer_travel_boundaries(const Print &print, const std::vector<LayerToPrint> &layers)
+{
+    AvoidCrossingPerimeters::LayerBoundariesPtrs out;
+    if (print.config().reduce_crossing_wall)
+        for (const LayerToPrint &layer_to_print : layers) {
+            // The travels are planned over the object layer and over the support layer, if printed separately.
+            if (layer_to_print.object_layer != nullptr)
+                out.emplace_back(AvoidCrossingPerimeters::prepare_layer(*layer_to_print.object_layer));
+            if (layer_to_print.support_layer != nullptr)
+                out.emplace_back(AvoidCrossingPerimeters::prepare_layer(*layer_to_print.support_layer));
+        }
+    return out;
+}
+
+// Group extrusions by an extruder, then by an object, an island and a region.
+// Only the sliced layers, the tool ordering and the print config are consulted, no state of the G-code generator,
+// therefore the extrusions of several layers may be collected in parallel ahead of the serial G-code emission.
+GCode::LayerExtrusions GCode::collect_layer_extrusions(
+    const Print                             &print,
+    const std::vector<LayerToPrint>         &layers,
+    const LayerTools                        &layer_tools)
+{
+    LayerExtrusions out;
+    out.collected = true;
+    if (layer_tools.extruders.empty())
+        // Nothing to extrude.
+        return out;
+
+    unsigned int first_extruder_id = layer_tools.extruders.front();
+    std::map<unsigned int, std::vector<ObjectByExtruder>> &by_extruder = out.by_extruder;
+    const WipingExtrusions &wiping_extrusions = layer_tools.wiping_extrusions();
+    bool is_anything_overridden = wiping_extrusions.is_anything_overridden();
+    out.is_anything_overridden = is_anything_overridden;
+    for (const LayerToPrint &layer_to_print : layers) {
+        if (layer_to_print.support_layer != nullptr) {
+            const SupportLayer &support_layer = *layer_to_print.support_layer;
+            const PrintObject& object = *layer_to_print.original_object;
+            if (! support_layer.support_fills.entities.empty()) {
+                ExtrusionRole   role               = support_layer.support_fills.role();
+                bool            has_support        = role == erMixed || role == erSupportMaterial || role == erSupportTransition;
+                bool            has_interface      = role == erMixed || role == erSupportMaterialInterface;
+                // Extruder ID of the support base. -1 if "don't care".
+                unsigned int    support_extruder   = object.config().support_filament.value - 1;
+                // Shall the support be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
+                bool            support_dontcare   = object.config().support_filament.value == 0;
+                // Extruder ID of the support interface. -1 if "don't care".
+                unsigned int    interface_extruder = object.config().support_interface_filament.value - 1;
+                // Shall the support interface be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
+                bool            interface_dontcare = object.config().support_interface_filament.value == 0;
+
+                // BBS: apply wiping overridden extruders
+                if (support_dontcare) {
+                    int extruder_override = wiping_extrusions.get_support_extruder_overrides(&object);
+                    if (extruder_override >= 0) {
+                        support_extruder = extruder_override;
+                        support_dontcare = false;
+                    }
+                }
+
+                if (interface_dontcare) {
+                    int extruder_override = wiping_extrusions.get_support_interface_extruder_overrides(&object);
+                    if (extruder_override >= 0) {
+                        interface_extruder = extruder_override;
+                        interface_dontcare = false;
+                    }
+                }
+
+                // BBS: try to print support base with a filament other than interface filament
+                if (support_dontcare && !interface_dontcare) {
+                    unsigned int dontcare_extruder = first_extruder_id;
+                    for (unsigned int extruder_id : layer_tools.extruders) {
+                        if (print.config().filament_soluble.get_at(extruder_id))
+                            continue;
+
+                        //BBS: now we don't consider interface filament used in other object
+                        if (extruder_id == interface_extruder)
+                            continue;
+
+                        dontcare_extruder = extruder_id;
+                        break;
+                    }
+                #if 0
+                    //BBS: not found a suitable extruder in current layer ,dontcare_extruider==first_extruder_id==interface_extruder
+                    if (dontcare_extruder == interface_extruder && (object.config().support_interface_not_for_body && object.config().support_interface_filament.value!=0)) {
+                        // BBS : get a suitable extruder from other layer
+                        auto all_extruders = print.extruders();
+                        dontcare_extruder = get_next_extruder(dontcare_extruder, all_extruders);
+                    }
+                #endif
+
+                    if (support_dontcare)
+                        support_extruder = dontcare_extruder;
+                }
+                else if (support_dontcare || interface_dontcare) {
+                    // Some support will be printed with "don't care" material, preferably non-soluble.
+                    // Is the current extruder assigned a soluble filament?
+                    unsigned int dontcare_extruder = first_extruder_id;
+                    if (print.config().filament_soluble.get_at(dontcare_extruder)) {
+                        // The last extruder printed on the previous layer extrudes soluble filament.
+                        // Try to find a non-soluble extruder on the same layer.
+                        for (unsigned int extruder_id : layer_tools.extruders)
+                            if (! print.config().filament_soluble.get_at(extruder_id)) {
+                                dontcare_extruder = extruder_id;
+                                break;
+                            }
+                    }
+                    if (support_dontcare)
+                        support_extruder = dontcare_extruder;
+                    if (interface_dontcare)
+                        interface_extruder = dontcare_extruder;
+                }
+                // Both the support and the support interface are printed with the same extruder, therefore
+                // the interface may be interleaved with the support base.
+                bool single_extruder = ! has_support || support_extruder == interface_extruder;
+                // Assign an extruder to the base.
+                ObjectByExtruder &obj = object_by_extruder(by_extruder, has_support ? support_extruder : interface_extruder, &layer_to_print - layers.data(), layers.size());
+                obj.support = &support_layer.support_fills;
+                obj.support_extrusion_role = single_extruder ? erMixed : erSupportMaterial;
+                if (! single_extruder && has_interface) {
+                    ObjectByExtruder &obj_interface = object_by_extruder(by_extruder, interface_extruder, &layer_to_print - layers.data(), layers.size());
+                    obj_interface.support = &support_layer.support_fills;
+                    obj_interface.support_extrusion_role = erSupportMaterialInterface;
+                }
+            }
+        }
+
+        if (layer_to_print.object_layer != nullptr) {
+            const Layer &layer = *layer_to_print.object_layer;
+            // We now define a strategy for building perimeters and fills. The separation
+            // between regions doesn't matter in terms of printing order, as we follow
+            // another logic instead:
+            // - we group all extrusions by extruder so that we minimize toolchanges
+            // - we start from the last used extruder
+            // - for each extruder, we group extrusions by island
+            // - for each island, we extrude perimeters first, unless user set the infill_first
+            //   option
+            // (Still, we have to keep track of regions because we need to apply their config)
+            size_t n_slices = layer.lslices.size();
+            const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
+            // Traverse the slices in an increasing order of bounding box size, so that the islands inside another islands are tested first,
+            // so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
+            std::vector<size_t> slices_test_order;
+            slices_test_order.reserve(n_slices);
+            for (size_t i = 0; i < n_slices; ++ i)
+                slices_test_order.emplace_back(i);
+            std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
+                const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
+                const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
+                return s1.x() * s1.y() < s2.x() * s2.y();
+            });
+            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) {
+                const BoundingBox &bbox = layer_surface_bboxes[i];
+                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
+                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
+                       layer.lslices[i].contour.contains(point);
+            };
+
+            for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
+                const LayerRegion *layerm = layer.regions()[region_id];
+                if (layerm == nullptr)
+                    continue;
+                // PrintObjects own the PrintRegions, thus the pointer to PrintRegion would be unique to a PrintObject, they would not
+                // identify the content of PrintRegion accross the whole print uniquely. Translate to a Print specific PrintRegion.
+                const PrintRegion &region = print.get_print_region(layerm->region().print_region_id());
+
+                // Now we must process perimeters and infills and create islands of extrusions in by_region std::map.
+                // It is also necessary to save which extrusions are part of MM wiping and which are not.
+                // The process is almost the same for perimeters and infills - we will do it in a cycle that repeats twice:
+                std::vector<unsigned int> printing_extruders;
+                for (const ObjectByExtruder::Island::Region::Type entity_type : { ObjectByExtruder::Island::Region::INFILL, ObjectByExtruder::Island::Region::PERIMETERS }) {
+                    for (const ExtrusionEntity *ee : (entity_type == ObjectByExtruder::Island::Region::INFILL) ? layerm->fills.entities : layerm->perimeters.entities) {
+                        // extrusions represents infill or perimeter extrusions of a single island.
+                        assert(dynamic_cast<const ExtrusionEntityCollection*>(ee) != nullptr);
+                        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
+                        if (extrusions->entities.empty()) // This shouldn't happen but first_point() would fail.
+                            continue;
+
+                        // This extrusion is part of certain Region, which tells us which extruder should be used for it:
+                        int correct_extruder_id = layer_tools.extruder(*extrusions, region);
+
+                        // Let's recover vector of extruder overrides:
+                        const WipingExtrusions::ExtruderPerCopy *entity_overrides = nullptr;
+                        if (! layer_tools.has_extruder(correct_extruder_id)) {
+                            // this entity is not overridden, but its extruder is not in layer_tools - we'll print it
+                            // by last extruder on this layer (could happen e.g. when a wiping object is taller than others - dontcare extruders are eradicated from layer_tools)
+                            correct_extruder_id = layer_tools.extruders.back();
+                        }
+                        printing_extruders.clear();
+                        if (is_anything_overridden) {
+                            WipingExtrusions::ExtruderPerCopy overrides;
+                            if (! wiping_extrusions.get_extruder_overrides(extrusions, layer_to_print.original_object, correct_extruder_id, layer_to_print.object()->instances().size(), overrides)) {
+                                printing_extruders.emplace_back(correct_extruder_id);
+                            } else {
+                                entity_overrides = &out.extruder_overrides.emplace_back(std::move(overrides));
+                                printing_extruders.reserve(entity_overrides->size());
+                                for (int extruder : *entity_overrides)
+                                    printing_extruders.emplace_back(extruder >= 0 ?
+                                        // at least one copy is overridden to use this extruder
+                                        extruder :
+                                        // at least one copy would normally be printed with this extruder (see get_extruder_overrides function for explanation)
+                                        static_cast<unsigned int>(- extruder - 1));
+                                Slic3r::sort_remove_duplicates(printing_extruders);
+                            }
+                        } else
+                            printing_extruders.emplace_back(correct_extruder_id);
+
+                        // Now we must add this extrusion into the by_extruder map, once for each extruder that will print it:
+                        for (unsigned int extruder : printing_extruders)
+                        {
+                            std::vector<ObjectByExtruder::Island> &islands = object_islands_by_extruder(
+                                by_extruder,
+                                extruder,
+                                &layer_to_print - layers.data(),
+                                layers.size(), n_slices+1);
+                            for (size_t i = 0; i <= n_slices; ++ i) {
+                                bool   last = i == n_slices;
+                                size_t island_idx = last ? n_slices : slices_test_order[i];
+                                if (// extrusions->first_point does not fit inside any slice
+                                    last ||
+                                    // extrusions->first_point fits inside ith slice
+                                    point_inside_surface(island_idx, extrusions->first_point())) {
+                                    if (islands[island_idx].by_region.empty())
+                                        islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
+                                    islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+            } // for regions
+        }
+    } // for objects
+
+    return out;
+}
+
 // In sequential mode, process_layer is called once per each object and its copy,
 // therefore layers will contain a single entry and single_object_instance_idx will point to the copy of the object.
 // In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
@@ -2946,12 +3240,18 @@ GCode::LayerResult GCode::process_layer(
     // Otherwise print a single copy of a single object.
     const size_t                     		 single_object_instance_idx,
     // BBS
-    const bool                               prime_extruder)
+    const bool                               prime_extruder,
+    // Extrusions of this layer grouped by collect_layer_extrusions() ahead of time. Collected here if null.
+    LayerExtrusions                         *layer_extrusions,
+    // Travel boundaries of this layer prepared by prepare_layer_travel_boundaries(). Built on demand if missing.
+    AvoidCrossingPerimeters::LayerBoundariesPtrs travel_boundaries)
 {
     assert(! layers.empty());
     // Either printing all copies of all objects, or just a single copy of a single object.
     assert(single_object_instance_idx == size_t(-1) || layers.size() == 1);
 
+    m_avoid_crossing_perimeters.set_prepared_layers(std::move(travel_boundaries));
+
     // First object, support and raft layer, if available.
     const Layer         *object_layer  = nullptr;
     const SupportLayer  *support_layer = nullptr;
@@ -3203,208 +3503,13 @@ GCode::LayerResult GCode::process_layer(
     };
 
     // Group extrusions by an extruder, then by an object, an island and a region.
-    std::map<unsigned int, std::vector<ObjectByExtruder>> by_extruder;
-    bool is_anything_overridden = const_cast<LayerTools&>(layer_tools).wiping_extrusions().is_anything_overridden();
-    for (const LayerToPrint &layer_to_print : layers) {
-        if (layer_to_print.support_layer != nullptr) {
-            const SupportLayer &support_layer = *layer_to_print.support_layer;
-            const PrintObject& object = *layer_to_print.original_object;
-            if (! support_layer.support_fills.entities.empty()) {
-                ExtrusionRole   role               = support_layer.support_fills.role();
-                bool            has_support        = role == erMixed || role == erSupportMaterial || role == erSupportTransition;
-                bool            has_interface      = role == erMixed || role == erSupportMaterialInterface;
-                // Extruder ID of the support base. -1 if "don't care".
-                unsigned int    support_extruder   = object.config().support_filament.value - 1;
-                // Shall the support be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
-                bool            support_dontcare   = object.config().support_filament.value == 0;
-                // Extruder ID of the support interface. -1 if "don't care".
-                unsigned int    interface_extruder = object.config().support_interface_filament.value - 1;
-                // Shall the support interface be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
-                bool            interface_dontcare = object.config().support_interface_filament.value == 0;
-
-                // BBS: apply wiping overridden extruders
-                WipingExtrusions& wiping_extrusions = const_cast<LayerTools&>(layer_tools).wiping_extrusions();
-                if (support_dontcare) {
-                    int extruder_override = wiping_extrusions.get_support_extruder_overrides(&object);
-                    if (extruder_override >= 0) {
-                        support_extruder = extruder_override;
-                        support_dontcare = false;
-                    }
-                }
-
-                if (interface_dontcare) {
-                    int extruder_override = wiping_extrusions.get_support_interface_extruder_overrides(&object);
-                    if (extruder_override >= 0) {
-                        interface_extruder = extruder_override;
-                        interface_dontcare = false;
-                    }
-                }
-
-                // BBS: try to print support base with a filament other than interface filament
-                if (support_dontcare && !interface_dontcare) {
-                    unsigned int dontcare_extruder = first_extruder_id;
-                    for (unsigned int extruder_id : layer_tools.extruders) {
-                        if (print.config().filament_soluble.get_at(extruder_id))
-                            continue;
-
-                        //BBS: now we don't consider interface filament used in other object
-                        if (extruder_id == interface_extruder)
-                            continue;
-
-                        dontcare_extruder = extruder_id;
-                        break;
-                    }
-                #if 0
-                    //BBS: not found a suitable extruder in current layer ,dontcare_extruider==first_extruder_id==interface_extruder
-                    if (dontcare_extruder == interface_extruder && (object.config().support_interface_not_for_body && object.config().support_interface_filament.value!=0)) {
-                        // BBS : get a suitable extruder from other layer
-                        auto all_extruders = print.extruders();
-                        dontcare_extruder = get_next_extruder(dontcare_extruder, all_extruders);
-                    }
-                #endif
-
-                    if (support_dontcare)
-                        support_extruder = dontcare_extruder;
-                }
-                else if (support_dontcare || interface_dontcare) {
-                    // Some support will be printed with "don't care" material, preferably non-soluble.
-                    // Is the current extruder assigned a soluble filament?
-                    unsigned int dontcare_extruder = first_extruder_id;
-                    if (print.config().filament_soluble.get_at(dontcare_extruder)) {
-                        // The last extruder printed on the previous layer extrudes soluble filament.
-                        // Try to find a non-soluble extruder on the same layer.
-                        for (unsigned int extruder_id : layer_tools.extruders)
-                            if (! print.config().filament_soluble.get_at(extruder_id)) {
-                                dontcare_extruder = extruder_id;
-                                break;
-                            }
-                    }
-                    if (support_dontcare)
-                        support_extruder = dontcare_extruder;
-                    if (interface_dontcare)
-                        interface_extruder = dontcare_extruder;
-                }
-                // Both the support and the support interface are printed with the same extruder, therefore
-                // the interface may be interleaved with the support base.
-                bool single_extruder = ! has_support || support_extruder == interface_extruder;
-                // Assign an extruder to the base.
-                ObjectByExtruder &obj = object_by_extruder(by_extruder, has_support ? support_extruder : interface_extruder, &layer_to_print - layers.data(), layers.size());
-                obj.support = &support_layer.support_fills;
-                obj.support_extrusion_role = single_extruder ? erMixed : erSupportMaterial;
-                if (! single_extruder && has_interface) {
-                    ObjectByExtruder &obj_interface = object_by_extruder(by_extruder, interface_extruder, &layer_to_print - layers.data(), layers.size());
-                    obj_interface.support = &support_layer.support_fills;
-                    obj_interface.support_extrusion_role = erSupportMaterialInterface;
-                }
-            }
-        }
-
-        if (layer_to_print.object_layer != nullptr) {
-            const Layer &layer = *layer_to_print.object_layer;
-            // We now define a strategy for building perimeters and fills. The separation
-            // between regions doesn't matter in terms of printing order, as we follow
-            // another logic instead:
-            // - we group all extrusions by extruder so that we minimize toolchanges
-            // - we start from the last used extruder
-            // - for each extruder, we group extrusions by island
-            // - for each island, we extrude perimeters first, unless user set the infill_first
-            //   option
-            // (Still, we have to keep track of regions because we need to apply their config)
-            size_t n_slices = layer.lslices.size();
-            const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
-            // Traverse the slices in an increasing order of bounding box size, so that the islands inside another islands are tested first,
-            // so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
-            std::vector<size_t> slices_test_order;
-            slices_test_order.reserve(n_slices);
-            for (size_t i = 0; i < n_slices; ++ i)
-                slices_test_order.emplace_back(i);
-            std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
-                const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
-                const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
-                return s1.x() * s1.y() < s2.x() * s2.y();
-            });
-            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) {
-                const BoundingBox &bbox = layer_surface_bboxes[i];
-                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
-                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
-                       layer.lslices[i].contour.contains(point);
-            };
-
-            for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
-                const LayerRegion *layerm = layer.regions()[region_id];
-                if (layerm == nullptr)
-                    continue;
-                // PrintObjects own the PrintRegions, thus the pointer to PrintRegion would be unique to a PrintObject, they would not
-                // identify the content of PrintRegion accross the whole print uniquely. Translate to a Print specific PrintRegion.
-                const PrintRegion &region = print.get_print_region(layerm->region().print_region_id());
-
-                // Now we must process perimeters and infills and create islands of extrusions in by_region std::map.
-                // It is also necessary to save which extrusions are part of MM wiping and which are not.
-                // The process is almost the same for perimeters and infills - we will do it in a cycle that repeats twice:
-                std::vector<unsigned int> printing_extruders;
-                for (const ObjectByExtruder::Island::Region::Type entity_type : { ObjectByExtruder::Island::Region::INFILL, ObjectByExtruder::Island::Region::PERIMETERS }) {
-                    for (const ExtrusionEntity *ee : (entity_type == ObjectByExtruder::Island::Region::INFILL) ? layerm->fills.entities : layerm->perimeters.entities) {
-                        // extrusions represents infill or perimeter extrusions of a single island.
-                        assert(dynamic_cast<const ExtrusionEntityCollection*>(ee) != nullptr);
-                        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
-                        if (extrusions->entities.empty()) // This shouldn't happen but first_point() would fail.
-                            continue;
-
-                        // This extrusion is part of certain Region, which tells us which extruder should be used for it:
-                        int correct_extruder_id = layer_tools.extruder(*extrusions, region);
-
-                        // Let's recover vector of extruder overrides:
-                        const WipingExtrusions::ExtruderPerCopy *entity_overrides = nullptr;
-                        if (! layer_tools.has_extruder(correct_extruder_id)) {
-                            // this entity is not overridden, but its extruder is not in layer_tools - we'll print it
-                            // by last extruder on this layer (could happen e.g. when a wiping object is taller than others - dontcare extruders are eradicated from layer_tools)
-                            correct_extruder_id = layer_tools.extruders.back();
-                        }
-                        printing_extruders.clear();
-                        if (is_anything_overridden) {
-                            entity_overrides = const_cast<LayerTools&>(layer_tools).wiping_extrusions().get_extruder_overrides(extrusions, layer_to_print.original_object, correct_extruder_id, layer_to_print.object()->instances().size());
-                            if (entity_overrides == nullptr) {
-                                printing_extruders.emplace_back(correct_extruder_id);
-                            } else {
-                                printing_extruders.reserve(entity_overrides->size());
-                                for (int extruder : *entity_overrides)
-                                    printing_extruders.emplace_back(extruder >= 0 ?
-                                        // at least one copy is overridden to use this extruder
-                                        extruder :
-                                        // at least one copy would normally be printed with this extruder (see get_extruder_overrides function for explanation)
-                                        static_cast<unsigned int>(- extruder - 1));
-                                Slic3r::sort_remove_duplicates(printing_extruders);
-                            }
-                        } else
-                            printing_extruders.emplace_back(correct_extruder_id);
-
-                        // Now we must add this extrusion into the by_extruder map, once for each extruder that will print it:
-                        for (unsigned int extruder : printing_extruders)
-                        {
-                            std::vector<ObjectByExtruder::Island> &islands = object_islands_by_extruder(
-                                by_extruder,
-                                extruder,
-                                &layer_to_print - layers.data(),
-                                layers.size(), n_slices+1);
-                            for (size_t i = 0; i <= n_slices; ++ i) {
-                                bool   last = i == n_slices;
-                                size_t island_idx = last ? n_slices : slices_test_order[i];
-                                if (// extrusions->first_point does not fit inside any slice
-                                    last ||
-                                    // extrusions->first_point fits inside ith slice
-                                    point_inside_surface(island_idx, extrusions->first_point())) {
-                                    if (islands[island_idx].by_region.empty())
-                                        islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
-                                    islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-            } // for regions
-        }
-    } // for objects
+    LayerExtrusions collected_extrusions;
+    if (layer_extrusions == nullptr || ! layer_extrusions->collected) {
+        collected_extrusions = collect_layer_extrusions(print, layers, layer_tools);
+        layer_extrusions     = &collected_extrusions;
+    }
+    std::map<unsigned int, std::vector<ObjectByExtruder>> &by_extruder = layer_extrusions->by_extruder;
+    bool is_anything_overridden = layer_extrusions->is_anything_overridden;
 
     if (m_wipe_tower)
         m_wipe_tower->set_is_first_print(true);
@@ -3586,7 +3691,7 @@ GCode::LayerResult GCode::process_layer(
                     ExtrusionEntityCollection support_eec;
 
                     // BBS
-                    WipingExtrusions& wiping_extrusions = const_cast<LayerTools&>(layer_tools).wiping_extrusions();
+                    const WipingExtrusions& wiping_extrusions = layer_tools.wiping_extrusions();
                     bool support_overridden = wiping_extrusions.is_support_overridden(layer_to_print.original_object);
                     bool support_intf_overridden = wiping_extrusions.is_support_interface_overridden(layer_to_print.original_object);
 
@@ -4327,32 +4432,49 @@ std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fill
     return gcode;
 }
 
+GCode::GCodeOutputStream::GCodeOutputStream(const std::string &path, GCodeProcessor &processor) :
+    m_file(std::make_unique<AsyncFileWriter>(path)), m_processor(processor)
+{}
+
+GCode::GCodeOutputStream::~GCodeOutputStream()
+{
+    this->close();
+}
+
+bool GCode::GCodeOutputStream::is_open() const
+{
+    return m_file->is_open();
+}
+
 bool GCode::GCodeOutputStream::is_error() const
 {
-    return ::ferror(this->f);
+    return m_file->is_error();
 }
 
 void GCode::GCodeOutputStream::flush()
 {
-    ::fflush(this->f);
+    m_file->flush();
 }
 
 void GCode::GCodeOutputStream::close()
 {
-    if (this->f) {
-        ::fclose(this->f);
-        this->f = nullptr;
+    m_file->close();
+}
+
+void GCode::GCodeOutputStream::write(const char *what, size_t len)
+{
+    if (len > 0) {
+        // Parse the G-code before it is queued, the writer thread may release it any time after.
+        m_processor.process_buffer(what, what + len);
+        m_file->write(what, len);
     }
 }
 
-void GCode::GCodeOutputStream::write(const char *what)
+void GCode::GCodeOutputStream::write(std::string &&what)
 {
-    if (what != nullptr) {
-        const char* gcode = what;
-        // writes string to file
-        fwrite(gcode, 1, ::strlen(gcode), this->f);
-        //FIXME don't allocate a string, maybe process a batch of lines?
-        m_processor.process_buffer(std::string(gcode));
+    if (! what.empty()) {
+        m_processor.process_buffer(what.c_str(), what.c_str() + what.size());
+        m_file->write(std::move(what));
     }
 }
 
@@ -4386,7 +4508,7 @@ void GCode::GCodeOutputStream::write_format(const char* format, ...)
     char *bufptr = buffer_dynamic ? (char*)malloc(buflen) : buffer;
     int res = ::vsnprintf(bufptr, buflen, format, args);
     if (res > 0)
-        this->write(bufptr);
+        this->write(bufptr, size_t(res));
 
     if (buffer_dynamic)
         free(bufptr);
@@ -21,6 +21,8 @@
 #include "libslic3r/ObjectID.hpp"
 
 #include <cfloat>
+#include <cstring>
+#include <deque>
 #include <memory>
 #include <map>
 #include <set>
@@ -34,6 +36,7 @@ namespace Slic3r {
 
 // Forward declarations.
 class GCode;
+class AsyncFileWriter;
 
 namespace { struct Item; }
 struct PrintInstance;
@@ -214,6 +217,12 @@ public:
 
     BoundingBoxf first_layer_projection(const Print& print) const;
 
+    // BBS: Group the extrusions of the upcoming layers by extruders on worker threads while the G-code of the preceding
+    // layers is being emitted. The G-code is the same with or without, the switch is kept for comparing against the serial path.
+    // The travel boundaries of reduce_crossing_wall are built on the worker threads independently of this switch.
+    void            set_parallel_layer_planning(bool enable) { m_parallel_layer_planning = enable; }
+    bool            parallel_layer_planning() const { return m_parallel_layer_planning; }
+
     // Object and support extrusions of the same PrintObject at the same print_z.
     // public, so that it could be accessed by free helper functions from GCode.cpp
     struct LayerToPrint
@@ -256,20 +265,24 @@ public:
     };
 
 private:
+    // BBS: G-code is stored into the file by AsyncFileWriter from a background thread, while the G-code
+    // processor parses the very same buffers in the calling thread, thus the G-code is neither copied nor re-read.
     class GCodeOutputStream {
     public:
-        GCodeOutputStream(FILE *f, GCodeProcessor &processor) : f(f), m_processor(processor) {}
-        ~GCodeOutputStream() { this->close(); }
+        GCodeOutputStream(const std::string &path, GCodeProcessor &processor);
+        ~GCodeOutputStream();
 
-        bool is_open() const { return f; }
+        bool is_open() const;
         bool is_error() const;
 
         void flush();
         void close();
 
         // Write a string into a file.
-        void write(const std::string& what) { this->write(what.c_str()); }
-        void write(const char* what);
+        void write(const std::string& what) { this->write(what.c_str(), what.size()); }
+        // Long strings are handed over to the writer thread without copying.
+        void write(std::string&& what);
+        void write(const char* what) { if (what != nullptr) this->write(what, ::strlen(what)); }
 
         // Write a string into a file.
         // Add a newline, if the string does not end with a newline already.
@@ -280,7 +293,10 @@ private:
         void write_format(const char* format, ...);
 
     private:
-        FILE *f = nullptr;
+        // The data shall be terminated by a zero character, see GCodeReader::parse_buffer().
+        void write(const char* what, size_t len);
+
+        std::unique_ptr<AsyncFileWriter> m_file;
         GCodeProcessor &m_processor;
     };
     void            _do_export(Print &print, GCodeOutputStream &file, ThumbnailsGeneratorCallback thumbnail_cb);
@@ -296,19 +312,6 @@ private:
         // Should the cooling buffer content be flushed at the end of this layer?
         bool        cooling_buffer_flush { false };
     };
-    LayerResult process_layer(
-        const Print                     &print,
-        // Set of object & print layers of the same PrintObject and with the same print_z.
-        const std::vector<LayerToPrint> &layers,
-        const LayerTools  				&layer_tools,
-        const bool                       last_layer,
-		// Pairs of PrintObject index and its instance index.
-		const std::vector<const PrintInstance*> *ordering,
-        // If set to size_t(-1), then print all copies of all objects.
-        // Otherwise print a single copy of a single object.
-        const size_t                     single_object_idx = size_t(-1),
-        // BBS
-        const bool                       prime_extruder = false);
     // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
     // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
     // and export G-code into file.
@@ -404,6 +407,57 @@ private:
         const size_t             label_object_id;
 	};
 
+    // Extrusions of a single print_z grouped by an extruder, then by an object, an island and a region.
+    struct LayerExtrusions
+    {
+        std::map<unsigned int, std::vector<ObjectByExtruder>> by_extruder;
+        bool is_anything_overridden { false };
+        // Extruders of the overridden copies of the grouped extrusions, referenced by ObjectByExtruder::Island::Region.
+        // A deque does not move its elements when growing.
+        std::deque<WipingExtrusions::ExtruderPerCopy> extruder_overrides;
+        // False if the layer has not been processed by collect_layer_extrusions() yet.
+        bool collected { false };
+    };
+    static LayerExtrusions collect_layer_extrusions(
+        const Print                     &print,
+        const std::vector<LayerToPrint> &layers,
+        const LayerTools                &layer_tools);
+
+    // Boundaries of the object and support layers of a single print_z for AvoidCrossingPerimeters, empty if not avoiding crossing walls.
+    static AvoidCrossingPerimeters::LayerBoundariesPtrs prepare_layer_travel_boundaries(const Print &print, const std::vector<LayerToPrint> &layers);
+
+    // Token passed from the extrusion grouping stage of process_layers() to the G-code emission stage.
+    struct LayerToProcess {
+        // Index into the layers to print.
+        size_t          idx;
+        LayerExtrusions extrusions;
+        // Boundaries for AvoidCrossingPerimeters, empty if not prepared ahead.
+        AvoidCrossingPerimeters::LayerBoundariesPtrs travel_boundaries;
+    };
+    // Token passed from the G-code parsing stage of process_layers() to the cooling stage.
+    struct LayerToCool {
+        CoolingBuffer::ParsedLayer  layer;
+        size_t                      layer_id;
+        bool                        cooling_buffer_flush;
+    };
+    LayerResult process_layer(
+        const Print                     &print,
+        // Set of object & print layers of the same PrintObject and with the same print_z.
+        const std::vector<LayerToPrint> &layers,
+        const LayerTools  				&layer_tools,
+        const bool                       last_layer,
+		// Pairs of PrintObject index and its instance index.
+		const std::vector<const PrintInstance*> *ordering,
+        // If set to size_t(-1), then print all copies of all objects.
+        // Otherwise print a single copy of a single object.
+        const size_t                     single_object_idx = size_t(-1),
+        // BBS
+        const bool                       prime_extruder = false,
+        // Extrusions of this layer grouped by collect_layer_extrusions() ahead of time. Collected here if null.
+        LayerExtrusions                 *layer_extrusions = nullptr,
+        // Travel boundaries of this layer prepared by prepare_layer_travel_boundaries(). Built on demand if missing.
+        AvoidCrossingPerimeters::LayerBoundariesPtrs travel_boundaries = {});
+
 	std::vector<InstanceToPrint> sort_print_object_instances(
 		std::vector<ObjectByExtruder> 					&objects_by_extruder,
 		// Object and Support layers for the current print_z, collected for a single object, or for possibly multiple objects with multiple instances.
@@ -504,6 +558,7 @@ private:
     bool m_support_traditional_timelapse = true;
 
     bool m_silent_time_estimator_enabled;
+    bool m_parallel_layer_planning { true };
 
     // Processor
     GCodeProcessor m_processor;
@@ -0,0 +1,161 @@
+#include "AsyncFileWriter.hpp"
+#include "../Thread.hpp"
+
+#include <cassert>
+
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <openssl/md5.h>
+
+namespace Slic3r {
+
+// Number of spare buffers kept by the writer thread for the producer to reuse.
+static constexpr size_t max_free_buffers = 4;
+
+AsyncFileWriter::AsyncFileWriter(const std::string &path, bool compute_md5)
+{
+    m_file = boost::nowide::fopen(path.c_str(), "wb");
+    if (m_file == nullptr)
+        return;
+    if (compute_md5) {
+        m_md5_ctx = std::make_unique<MD5_CTX>();
+        MD5_Init(m_md5_ctx.get());
+    }
+    m_buffer.reserve(BufferSize);
+    m_thread = create_thread([this]() { this->thread_proc(); });
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    this->close();
+}
+
+void AsyncFileWriter::write(const char *data, size_t size)
+{
+    if (m_file == nullptr || size == 0)
+        return;
+    m_buffer.append(data, size);
+    if (m_buffer.size() >= BufferSize)
+        this->submit_buffer();
+}
+
+void AsyncFileWriter::write(std::string &&data)
+{
+    if (m_file == nullptr || data.empty())
+        return;
+    if (data.size() < HandoverSize) {
+        this->write(data.data(), data.size());
+        return;
+    }
+    // Keep the order of the data: queue the partially filled buffer first, then hand over the string as a whole.
+    if (! m_buffer.empty())
+        this->submit_buffer();
+    this->submit(std::move(data));
+}
+
+void AsyncFileWriter::submit(std::string &&data)
+{
+    assert(! data.empty());
+    {
+        std::unique_lock<std::mutex> lck(m_mutex);
+        m_cond_producer.wait(lck, [this]() { return m_queued_bytes < MaxQueuedBytes; });
+        m_queued_bytes += data.size();
+        m_queue.emplace_back(std::move(data));
+    }
+    m_cond_writer.notify_one();
+}
+
+// Queue m_buffer for the writer thread and get a fresh buffer to be filled, preferably one returned by the writer thread.
+void AsyncFileWriter::submit_buffer()
+{
+    this->submit(std::move(m_buffer));
+    m_buffer = std::string();
+    {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        if (! m_free_buffers.empty()) {
+            m_buffer = std::move(m_free_buffers.back());
+            m_free_buffers.pop_back();
+        }
+    }
+    if (m_buffer.capacity() < BufferSize)
+        m_buffer.reserve(BufferSize);
+}
+
+void AsyncFileWriter::flush()
+{
+    if (m_file == nullptr)
+        return;
+    if (! m_buffer.empty())
+        this->submit_buffer();
+    std::unique_lock<std::mutex> lck(m_mutex);
+    m_cond_producer.wait(lck, [this]() { return m_queue.empty() && ! m_writing; });
+    lck.unlock();
+    if (::fflush(m_file) != 0)
+        m_error = true;
+}
+
+void AsyncFileWriter::close()
+{
+    if (m_file == nullptr)
+        return;
+    if (! m_buffer.empty())
+        this->submit_buffer();
+    {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        m_stop = true;
+    }
+    m_cond_writer.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+    if (::fclose(m_file) != 0)
+        m_error = true;
+    m_file = nullptr;
+    if (m_md5_ctx) {
+        unsigned char digest[MD5_DIGEST_LENGTH];
+        MD5_Final(digest, m_md5_ctx.get());
+        m_md5_ctx.reset();
+        if (! m_error) {
+            char hex[MD5_DIGEST_LENGTH * 2 + 1];
+            for (int i = 0; i < MD5_DIGEST_LENGTH; ++ i)
+                sprintf(hex + i * 2, "%02X", digest[i]);
+            m_md5 = hex;
+        }
+    }
+    m_buffer = std::string();
+    m_free_buffers.clear();
+}
+
+void AsyncFileWriter::thread_proc()
+{
+    std::unique_lock<std::mutex> lck(m_mutex);
+    for (;;) {
+        m_cond_writer.wait(lck, [this]() { return m_stop || ! m_queue.empty(); });
+        if (m_queue.empty())
+            // Stopped and all the data was written.
+            break;
+        std::string buffer = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_writing = true;
+        lck.unlock();
+
+        if (! m_error) {
+            if (::fwrite(buffer.data(), 1, buffer.size(), m_file) != buffer.size()) {
+                m_error = true;
+                BOOST_LOG_TRIVIAL(error) << "AsyncFileWriter: Writing into file failed, is the disk full?";
+            } else if (m_md5_ctx)
+                MD5_Update(m_md5_ctx.get(), (const unsigned char*)buffer.data(), buffer.size());
+        }
+
+        lck.lock();
+        m_writing = false;
+        m_queued_bytes -= buffer.size();
+        if (buffer.capacity() >= BufferSize && buffer.capacity() < 2 * BufferSize && m_free_buffers.size() < max_free_buffers) {
+            buffer.clear();
+            m_free_buffers.emplace_back(std::move(buffer));
+        }
+        m_cond_producer.notify_one();
+    }
+}
+
+} // namespace Slic3r
@@ -0,0 +1,85 @@
+#ifndef slic3r_GCode_AsyncFileWriter_hpp_
+#define slic3r_GCode_AsyncFileWriter_hpp_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+struct MD5state_st;
+
+namespace Slic3r {
+
+// BBS: Writes a file from a background thread in large blocks.
+// The producer fills a large buffer, or hands over a whole std::string without copying it, and the filled buffers
+// are queued for the writer thread, which writes them to the file and optionally computes MD5 of the written data.
+// The amount of data in flight is bounded, the producer blocks if the writer thread does not keep up.
+// Not thread safe: write(), flush() and close() shall be called from a single producer thread.
+class AsyncFileWriter
+{
+public:
+    // Size of a buffer filled by write(const char*, size_t) before it is handed over to the writer thread.
+    static constexpr size_t BufferSize      = 4 * 1024 * 1024;
+    // Strings at least this long are handed over to the writer thread by write(std::string&&) without copying.
+    static constexpr size_t HandoverSize    = 64 * 1024;
+    // Maximum amount of data queued for the writer thread before the producer blocks.
+    static constexpr size_t MaxQueuedBytes  = 64 * 1024 * 1024;
+
+    // Opens the file for binary writing, check is_open().
+    AsyncFileWriter(const std::string &path, bool compute_md5 = false);
+    AsyncFileWriter(const AsyncFileWriter &) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter &) = delete;
+    ~AsyncFileWriter();
+
+    bool        is_open() const { return m_file != nullptr; }
+    // True if writing into the file failed. The data written after the failure is dropped.
+    bool        is_error() const { return m_error; }
+
+    void        write(const char *data, size_t size);
+    void        write(const std::string &data) { this->write(data.data(), data.size()); }
+    void        write(std::string &&data);
+
+    // Wait until all the data written so far is stored into the file.
+    void        flush();
+    // Store the remaining data, stop the writer thread and close the file.
+    void        close();
+
+    // Upper case hex MD5 of the file content. Only valid after close() if the MD5 was requested and no error occured.
+    const std::string& md5() const { return m_md5; }
+
+private:
+    void        submit(std::string &&data);
+    void        submit_buffer();
+    void        thread_proc();
+
+    FILE                            *m_file { nullptr };
+    std::unique_ptr<MD5state_st>     m_md5_ctx;
+    std::string                      m_md5;
+    std::atomic<bool>                m_error { false };
+
+    // Buffer being filled by the producer.
+    std::string                      m_buffer;
+
+    std::mutex                       m_mutex;
+    std::condition_variable          m_cond_writer;
+    std::condition_variable          m_cond_producer;
+    std::deque<std::string>          m_queue;
+    size_t                           m_queued_bytes { 0 };
+    // The writer thread is storing a buffer it already popped from m_queue.
+    bool                             m_writing { false };
+    bool                             m_stop { false };
+    // Buffers of BufferSize capacity returned by the writer thread for reuse.
+    std::vector<std::string>         m_free_buffers;
+
+    boost::thread                    m_thread;
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_GCode_AsyncFileWriter_hpp_ */
@@ -1136,17 +1136,27 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     const ExPolygons               &lslices          = gcodegen.layer()->lslices;
     const std::vector<BoundingBox> &lslices_bboxes   = gcodegen.layer()->lslices_bboxes;
     bool                            is_support_layer = (dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr);
-    if (!use_external && (is_support_layer || (!lslices.empty() && !any_expolygon_contains(lslices, lslices_bboxes, m_grid_lslice, travel)))) {
+    if (!use_external && (is_support_layer || (!lslices.empty() && !any_expolygon_contains(lslices, lslices_bboxes, *m_grid_lslice, travel)))) {
         // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty())
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer())));
+        if (! m_internal) {
+            if (std::shared_ptr<const LayerBoundaries> prepared = this->find_prepared(*gcodegen.layer()); prepared)
+                m_internal = std::shared_ptr<const Boundary>(prepared, &prepared->internal);
+            else {
+                auto internal = std::make_shared<Boundary>();
+                init_boundary(internal.get(), to_polygons(get_boundary(*gcodegen.layer())));
+                m_internal = std::move(internal);
+            }
+        }
 
         // Trim the travel line by the bounding box.
-        if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
+        if (!m_internal->boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal->bbox)) {
+            travel_intersection_count = avoid_perimeters(*m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
+        // An empty boundary is initialized again by the next travel, possibly from another layer.
+        if (m_internal->boundaries.empty())
+            m_internal.reset();
     } else if(use_external) {
         // Initialize m_external only when exist any external travel for the current layer.
         if (m_external.boundaries.empty())
@@ -1186,24 +1196,50 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_grid_lslice, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, *m_grid_lslice, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+static void init_grid_lslice(EdgeGrid::Grid &grid_lslice, const Layer &layer)
 {
-    m_internal.clear();
-    m_external.clear();
-
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslice.set_bbox(bbox_slice);
+    grid_lslice.set_bbox(bbox_slice);
     //FIXME 1mm grid?
-    m_grid_lslice.create(layer.lslices, coord_t(scale_(1.)));
+    grid_lslice.create(layer.lslices, coord_t(scale_(1.)));
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+{
+    m_internal.reset();
+    m_external.clear();
+
+    if (std::shared_ptr<const LayerBoundaries> prepared = this->find_prepared(layer); prepared)
+        m_grid_lslice = std::shared_ptr<const EdgeGrid::Grid>(prepared, &prepared->grid_lslice);
+    else {
+        auto grid_lslice = std::make_shared<EdgeGrid::Grid>();
+        init_grid_lslice(*grid_lslice, layer);
+        m_grid_lslice = std::move(grid_lslice);
+    }
+}
+
+std::shared_ptr<const AvoidCrossingPerimeters::LayerBoundaries> AvoidCrossingPerimeters::prepare_layer(const Layer &layer)
+{
+    auto out = std::make_shared<LayerBoundaries>();
+    out->layer = &layer;
+    init_grid_lslice(out->grid_lslice, layer);
+    init_boundary(&out->internal, to_polygons(get_boundary(layer)));
+    return out;
+}
+
+std::shared_ptr<const AvoidCrossingPerimeters::LayerBoundaries> AvoidCrossingPerimeters::find_prepared(const Layer &layer) const
+{
+    auto it = std::find_if(m_prepared.begin(), m_prepared.end(), [&layer](const std::shared_ptr<const LayerBoundaries> &prepared) { return prepared->layer == &layer; });
+    return it == m_prepared.end() ? nullptr : *it;
 }
 
 #if 0
@@ -5,6 +5,8 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <memory>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -50,6 +52,22 @@ public:
         }
     };
 
+    // The boundaries of a single layer needed for planning the travels inside the object. They depend on the layer only,
+    // thus they may be prepared for the upcoming layers on worker threads while G-code of the preceding layers is being emitted.
+    // The external boundary is built from all the objects and it is rarely needed, thus it is built on demand only.
+    struct LayerBoundaries {
+        const Layer    *layer { nullptr };
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid  grid_lslice;
+        // Store all needed data for travels inside object
+        Boundary        internal;
+    };
+    using LayerBoundariesPtrs = std::vector<std::shared_ptr<const LayerBoundaries>>;
+    // Build the boundaries of a layer, including the internal one, which is otherwise built on demand.
+    static std::shared_ptr<const LayerBoundaries> prepare_layer(const Layer &layer);
+    // Boundaries prepared by prepare_layer() for the layers printed next. Boundaries of other layers are built on demand.
+    void        set_prepared_layers(LayerBoundariesPtrs &&layers) { m_prepared = std::move(layers); }
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -58,12 +76,17 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
+    std::shared_ptr<const LayerBoundaries> find_prepared(const Layer &layer) const;
+
+    // Boundaries prepared ahead by prepare_layer().
+    LayerBoundariesPtrs                     m_prepared;
     // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid m_grid_lslice;
-    // Store all needed data for travels inside object
-    Boundary m_internal;
+    // Either built by init_layer() or pointing into the prepared boundaries.
+    std::shared_ptr<const EdgeGrid::Grid>   m_grid_lslice { std::make_shared<EdgeGrid::Grid>() };
+    // Store all needed data for travels inside object, null until the first travel inside object of a layer.
+    std::shared_ptr<const Boundary>         m_internal;
     // Store all needed data for travels outside object
-    Boundary m_external;
+    Boundary                                m_external;
 };
 
 } // namespace Slic3r
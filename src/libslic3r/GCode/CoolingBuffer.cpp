@@ -4,6 +4,7 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/log/trivial.hpp>
 #include <iostream>
+#include <string_view>
 #include <float.h>
 
 #if 0
@@ -294,60 +295,58 @@ finished:
 	return new_feedrate;
 }
 
-std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, bool flush)
+std::string CoolingBuffer::process_layer(ParsedLayer &&layer, size_t layer_id, bool flush)
 {
     // Cache the input G-code.
-    if (m_gcode.empty())
-        m_gcode = std::move(gcode);
-    else
-        m_gcode += gcode;
+    if (m_layer.gcode.empty()) {
+        m_layer = std::move(layer);
+    } else {
+        // Shift the lines of the appended layer behind the cached G-code.
+        size_t offset = m_layer.gcode.size();
+        m_layer.gcode += layer.gcode;
+        m_layer.lines.reserve(m_layer.lines.size() + layer.lines.size());
+        for (ParsedLine &line : layer.lines) {
+            line.line_start += offset;
+            line.line_end   += offset;
+            m_layer.lines.emplace_back(line);
+        }
+    }
 
     std::string out;
     if (flush) {
         // This is either an object layer or the very last print layer. Calculate cool down over the collected support layers
         // and one object layer.
-        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_current_pos);
+        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_layer, m_current_pos);
         float layer_time_stretched = this->calculate_layer_slowdown(per_extruder_adjustments);
-        out = this->apply_layer_cooldown(m_gcode, layer_id, layer_time_stretched, per_extruder_adjustments);
-        m_gcode.clear();
+        out = this->apply_layer_cooldown(m_layer.gcode, layer_id, layer_time_stretched, per_extruder_adjustments);
+        m_layer.gcode.clear();
+        m_layer.lines.clear();
     }
     return out;
 }
 
-// Parse the layer G-code for the moves, which could be adjusted.
-// Return the list of parsed lines, bucketed by an extruder.
-std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const
+// Find the G-code lines, which could be relevant to the cooling logic, and parse their parameters.
+CoolingBuffer::ParsedLayer CoolingBuffer::parse_layer(std::string &&gcode) const
 {
-    std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
-    std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
-    for (size_t i = 0; i < m_extruder_ids.size(); ++ i) {
-        PerExtruderAdjustments &adj         = per_extruder_adjustments[i];
-        unsigned int            extruder_id = m_extruder_ids[i];
-        adj.extruder_id               = extruder_id;
-        adj.cooling_slow_down_enabled = m_config.slow_down_for_layer_cooling.get_at(extruder_id);
-        adj.slow_down_layer_time = float(m_config.slow_down_layer_time.get_at(extruder_id));
-        adj.slow_down_min_speed           = float(m_config.slow_down_min_speed.get_at(extruder_id));
-        map_extruder_to_per_extruder_adjustment[extruder_id] = i;
-    }
-
-    unsigned int      current_extruder  = m_current_extruder;
-    PerExtruderAdjustments *adjustment  = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
-    const char       *line_start = gcode.c_str();
-    const char       *line_end   = line_start;
-    // Index of an existing CoolingLine of the current adjustment, which holds the feedrate setting command
-    // for a sequence of extrusion moves.
-    size_t            active_speed_modifier = size_t(-1);
-
-    for (; *line_start != 0; line_start = line_end) 
+    ParsedLayer out;
+    out.gcode = std::move(gcode);
+
+    auto contains = [](std::string_view sline, std::string_view what) { return sline.find(what) != std::string_view::npos; };
+    const char *gcode_begin = out.gcode.c_str();
+    const char *line_start  = gcode_begin;
+    const char *line_end    = line_start;
+    for (; *line_start != 0; line_start = line_end)
     {
         while (*line_end != '\n' && *line_end != 0)
             ++ line_end;
         // sline will not contain the trailing '\n'.
-        std::string sline(line_start, line_end);
-        // CoolingLine will contain the trailing '\n'.
+        std::string_view sline(line_start, line_end - line_start);
+        // ParsedLine will contain the trailing '\n'.
         if (*line_end == '\n')
             ++ line_end;
-        CoolingLine line(0, line_start - gcode.c_str(), line_end - gcode.c_str());
+        ParsedLine line;
+        line.line_start = line_start - gcode_begin;
+        line.line_end   = line_end - gcode_begin;
         if (boost::starts_with(sline, "G0 "))
             line.type = CoolingLine::TYPE_G0;
         else if (boost::starts_with(sline, "G1 "))
@@ -359,14 +358,14 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
         else if (boost::starts_with(sline, "G3 "))
             line.type = CoolingLine::TYPE_G3;
         if (line.type) {
-            // G0, G1 or G92
+            // G0, G1, G2, G3 or G92
             // Parse the G-code line.
-            std::vector<float> new_pos(current_pos);
-            const char *c = sline.data() + 3;
+            const char *c   = sline.data() + 3;
+            const char *end = sline.data() + sline.size();
             for (;;) {
                 // Skip whitespaces.
-                for (; *c == ' ' || *c == '\t'; ++ c);
-                if (*c == 0 || *c == ';')
+                for (; c < end && (*c == ' ' || *c == '\t'); ++ c);
+                if (c == end || *c == ';')
                     break;
 
                 assert(is_decimal_separator_point()); // for atof
@@ -375,31 +374,91 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                               (*c == 'E') ? 3 : (*c == 'F') ? 4 :
                               (*c == 'I') ? 5 : (*c == 'J') ? 6 : size_t(-1);
                 if (axis != size_t(-1)) {
-                    new_pos[axis] = float(atof(++c));
+                    line.axis_mask   |= 1 << axis;
+                    line.values[axis] = float(atof(++c));
                     if (axis == 4) {
                         // Convert mm/min to mm/sec.
-                        new_pos[4] /= 60.f;
+                        line.values[4] /= 60.f;
                         if ((line.type & CoolingLine::TYPE_G92) == 0)
                             // This is G0 or G1 line and it sets the feedrate. This mark is used for reducing the duplicate F calls.
                             line.type |= CoolingLine::TYPE_HAS_F;
-                    } else if (axis == 5 || axis == 6) {
-                        // BBS: get position of arc center
-                        new_pos[axis] += current_pos[axis - 5];
                     }
                 }
                 // Skip this word.
-                for (; *c != ' ' && *c != '\t' && *c != 0; ++ c);
+                for (; c < end && *c != ' ' && *c != '\t'; ++ c);
             }
-            bool external_perimeter = boost::contains(sline, ";_EXTERNAL_PERIMETER");
-            bool wipe               = boost::contains(sline, ";_WIPE");
-            if (external_perimeter)
+            bool wipe = contains(sline, ";_WIPE");
+            if (contains(sline, ";_EXTERNAL_PERIMETER"))
                 line.type |= CoolingLine::TYPE_EXTERNAL_PERIMETER;
             if (wipe)
                 line.type |= CoolingLine::TYPE_WIPE;
-            if (boost::contains(sline, ";_EXTRUDE_SET_SPEED") && ! wipe) {
+            if (contains(sline, ";_EXTRUDE_SET_SPEED") && ! wipe)
                 line.type |= CoolingLine::TYPE_ADJUSTABLE;
+        } else if (boost::starts_with(sline, ";_EXTRUDE_END")) {
+            line.type = CoolingLine::TYPE_EXTRUDE_END;
+        } else if (boost::starts_with(sline, m_toolchange_prefix)) {
+            // Validated against the extruders by parse_layer_gcode().
+            line.type        = CoolingLine::TYPE_SET_TOOL;
+            line.extruder_id = (unsigned int)atoi(sline.data() + m_toolchange_prefix.size());
+        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_START")) {
+            line.type = CoolingLine::TYPE_OVERHANG_FAN_START;
+        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_END")) {
+            line.type = CoolingLine::TYPE_OVERHANG_FAN_END;
+        } else if (boost::starts_with(sline, "G4 ")) {
+            // Parse the wait time.
+            line.type = CoolingLine::TYPE_G4;
+            size_t pos_S = sline.find('S', 3);
+            size_t pos_P = sline.find('P', 3);
+            assert(is_decimal_separator_point()); // for atof
+            line.values[0] = float(
+                (pos_S != std::string_view::npos) ? atof(sline.data() + pos_S + 1) :
+                (pos_P != std::string_view::npos) ? atof(sline.data() + pos_P + 1) * 0.001 : 0.);
+        } else if (boost::starts_with(sline, ";_FORCE_RESUME_FAN_SPEED")) {
+            line.type = CoolingLine::TYPE_FORCE_RESUME_FAN;
+        } else if (boost::starts_with(sline, ";_SET_FAN_SPEED_CHANGING_LAYER")) {
+            line.type = CoolingLine::TYPE_SET_FAN_CHANGING_LAYER;
+        }
+        if (line.type != 0)
+            out.lines.emplace_back(line);
+    }
+
+    return out;
+}
+
+// Calculate the durations of the lines parsed by parse_layer() starting from the current position and extruder.
+// Return the list of parsed lines, bucketed by an extruder.
+std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const ParsedLayer &layer, std::vector<float> &current_pos) const
+{
+    std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
+    std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
+    for (size_t i = 0; i < m_extruder_ids.size(); ++ i) {
+        PerExtruderAdjustments &adj         = per_extruder_adjustments[i];
+        unsigned int            extruder_id = m_extruder_ids[i];
+        adj.extruder_id               = extruder_id;
+        adj.cooling_slow_down_enabled = m_config.slow_down_for_layer_cooling.get_at(extruder_id);
+        adj.slow_down_layer_time = float(m_config.slow_down_layer_time.get_at(extruder_id));
+        adj.slow_down_min_speed           = float(m_config.slow_down_min_speed.get_at(extruder_id));
+        map_extruder_to_per_extruder_adjustment[extruder_id] = i;
+    }
+
+    unsigned int      current_extruder  = m_current_extruder;
+    PerExtruderAdjustments *adjustment  = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
+    // Index of an existing CoolingLine of the current adjustment, which holds the feedrate setting command
+    // for a sequence of extrusion moves.
+    size_t            active_speed_modifier = size_t(-1);
+    const uint32_t    move_types = CoolingLine::TYPE_G0 | CoolingLine::TYPE_G1 | CoolingLine::TYPE_G2 | CoolingLine::TYPE_G3 | CoolingLine::TYPE_G92;
+    float             new_pos[7];
+
+    for (const ParsedLine &parsed : layer.lines) {
+        CoolingLine line(parsed.type, parsed.line_start, parsed.line_end);
+        if (line.type & move_types) {
+            std::copy(current_pos.begin(), current_pos.begin() + 7, new_pos);
+            for (size_t axis = 0; axis < 7; ++ axis)
+                if (parsed.axis_mask & (1 << axis))
+                    // BBS: I and J are relative to the start of the arc.
+                    new_pos[axis] = axis < 5 ? parsed.values[axis] : parsed.values[axis] + current_pos[axis - 5];
+            if (line.type & CoolingLine::TYPE_ADJUSTABLE)
                 active_speed_modifier = adjustment->lines.size();
-            }
             if ((line.type & CoolingLine::TYPE_G92) == 0) {
                 //BBS: G0, G1, G2, G3. Calculate the duration.
                 if (m_config.use_relative_e_distances.value)
@@ -455,12 +514,12 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                     line.type = 0;
                 }
             }
-            current_pos = std::move(new_pos);
-        } else if (boost::starts_with(sline, ";_EXTRUDE_END")) {
-            line.type = CoolingLine::TYPE_EXTRUDE_END;
+            std::copy(new_pos, new_pos + 7, current_pos.begin());
+        } else if (line.type & CoolingLine::TYPE_EXTRUDE_END) {
             active_speed_modifier = size_t(-1);
-        } else if (boost::starts_with(sline, m_toolchange_prefix)) {
-            unsigned int new_extruder = (unsigned int)atoi(sline.c_str() + m_toolchange_prefix.size());
+        } else if (line.type & CoolingLine::TYPE_SET_TOOL) {
+            unsigned int new_extruder = parsed.extruder_id;
+            line.type = 0;
             // Only change extruder in case the number is meaningful. User could provide an out-of-range index through custom gcodes - those shall be ignored.
             if (new_extruder < map_extruder_to_per_extruder_adjustment.size()) {
                 if (new_extruder != current_extruder) {
@@ -473,26 +532,11 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
             else {
                 // Only log the error in case of MM printer. Single extruder printers likely ignore any T anyway.
                 if (map_extruder_to_per_extruder_adjustment.size() > 1)
-                    BOOST_LOG_TRIVIAL(error) << "CoolingBuffer encountered an invalid toolchange, maybe from a custom gcode: " << sline;
+                    BOOST_LOG_TRIVIAL(error) << "CoolingBuffer encountered an invalid toolchange, maybe from a custom gcode: " <<
+                        std::string_view(layer.gcode.data() + parsed.line_start, parsed.line_end - parsed.line_start);
             }
-
-        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_START")) {
-            line.type = CoolingLine::TYPE_OVERHANG_FAN_START;
-        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_END")) {
-            line.type = CoolingLine::TYPE_OVERHANG_FAN_END;
-        } else if (boost::starts_with(sline, "G4 ")) {
-            // Parse the wait time.
-            line.type = CoolingLine::TYPE_G4;
-            size_t pos_S = sline.find('S', 3);
-            size_t pos_P = sline.find('P', 3);
-            assert(is_decimal_separator_point()); // for atof
-            line.time = line.time_max = float(
-                (pos_S > 0) ? atof(sline.c_str() + pos_S + 1) :
-                (pos_P > 0) ? atof(sline.c_str() + pos_P + 1) * 0.001 : 0.);
-        } else if (boost::starts_with(sline, ";_FORCE_RESUME_FAN_SPEED")) {
-            line.type = CoolingLine::TYPE_FORCE_RESUME_FAN;
-        } else if (boost::starts_with(sline, ";_SET_FAN_SPEED_CHANGING_LAYER")) {
-            line.type = CoolingLine::TYPE_SET_FAN_CHANGING_LAYER;
+        } else if (line.type & CoolingLine::TYPE_G4) {
+            line.time = line.time_max = parsed.values[0];
         }
         if (line.type != 0)
             adjustment->lines.emplace_back(std::move(line));
@@ -4,7 +4,9 @@
 #include "../libslic3r.h"
 #include <map>
 #include <string>
+#include <vector>
 #include <cfloat>
+#include <cstdint>
 
 namespace Slic3r {
 
@@ -23,21 +25,48 @@ struct PerExtruderAdjustments;
 //
 class CoolingBuffer {
 public:
+    // BBS: G-code line, which is relevant to the cooling logic, tokenized by parse_layer().
+    struct ParsedLine {
+        // CoolingLine::Type flags known from the line itself, resolved by process_layer().
+        uint32_t        type        { 0 };
+        // Bit mask of the axes X, Y, Z, E, F, I, J set by a G0 / G1 / G2 / G3 / G92 line.
+        uint32_t        axis_mask   { 0 };
+        // Start and end (including the trailing '\n') of this line in ParsedLayer::gcode.
+        size_t          line_start  { 0 };
+        size_t          line_end    { 0 };
+        // Values of the axes in axis_mask, feedrate in mm/sec. Wait time in seconds for G4 at values[0].
+        float           values[7]   { 0.f };
+        // New extruder of a tool change.
+        unsigned int    extruder_id { 0 };
+    };
+    // BBS: G-code of a layer and its cooling relevant lines.
+    struct ParsedLayer {
+        std::string             gcode;
+        std::vector<ParsedLine> lines;
+    };
+
     CoolingBuffer(GCode &gcodegen);
     void        reset(const Vec3d &position);
     void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; }
-    std::string process_layer(std::string &&gcode, size_t layer_id, bool flush);
+    // Tokenize the G-code of a layer. Only depends on the configuration, not on the state of the previous layers,
+    // thus it may be called for multiple layers in parallel ahead of process_layer().
+    ParsedLayer parse_layer(std::string &&gcode) const;
+    // Accumulate the extrusion times of a layer starting from the position and extruder left by the previous layer,
+    // slow down and control the fan. Layers have to be passed in order.
+    std::string process_layer(ParsedLayer &&layer, size_t layer_id, bool flush);
+    std::string process_layer(std::string &&gcode, size_t layer_id, bool flush)
+        { return this->process_layer(this->parse_layer(std::move(gcode)), layer_id, flush); }
 
 private:
 	CoolingBuffer& operator=(const CoolingBuffer&) = delete;
-    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const;
+    std::vector<PerExtruderAdjustments> parse_layer_gcode(const ParsedLayer &layer, std::vector<float> &current_pos) const;
     float       calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
     // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
     // Returns the adjusted G-code.
     std::string apply_layer_cooldown(const std::string &gcode, size_t layer_id, float layer_time, std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
 
     // G-code snippet cached for the support layers preceding an object layer.
-    std::string                 m_gcode;
+    ParsedLayer                 m_layer;
     // Internal data.
     // BBS: X,Y,Z,E,F,I,J
     std::vector<char>           m_axis;
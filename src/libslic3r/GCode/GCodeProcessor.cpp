@@ -4,6 +4,7 @@
 #include "libslic3r/LocalesUtils.hpp"
 #include "libslic3r/format.hpp"
 #include "GCodeProcessor.hpp"
+#include "AsyncFileWriter.hpp"
 
 #include <boost/log/trivial.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -373,7 +374,7 @@ void GCodeProcessor::TimeProcessor::reset()
     machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].enabled = true;
 }
 
-void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, std::vector<GCodeProcessorResult::MoveVertex>& moves, std::vector<size_t>& lines_ends, const TimeProcessContext& context)
+void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, GCodeProcessorResult::MoveVertices& moves, std::vector<size_t>& lines_ends, std::string& md5, const TimeProcessContext& context)
 {
     FilePtr in{ boost::nowide::fopen(filename.c_str(), "rb") };
     if (in.f == nullptr)
@@ -382,8 +383,9 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ <<  boost::format(":  before process %1%")%filename.c_str();
     // temporary file to contain modified gcode
     std::string out_path = filename + ".postprocess";
-    FilePtr out{ boost::nowide::fopen(out_path.c_str(), "wb") };
-    if (out.f == nullptr) {
+    // BBS: the MD5 of the final G-code is computed while writing, so that the 3MF export does not need to read the file again.
+    AsyncFileWriter out(out_path, true);
+    if (! out.is_open()) {
         throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nCannot open file for writing.\n"));
     }
 
@@ -664,8 +666,7 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
     size_t out_file_pos = 0;
     lines_ends.clear();
     auto write_string = [&export_line, &out, &out_path, &out_file_pos, &lines_ends](const std::string& str) {
-        fwrite((const void*)export_line.c_str(), 1, export_line.length(), out.f);
-        if (ferror(out.f)) {
+        if (out.is_error()) {
             out.close();
             boost::nowide::remove(out_path.c_str());
             throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nIs the disk full?\n"));
@@ -674,6 +675,7 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
             if (export_line[i] == '\n')
                 lines_ends.emplace_back(out_file_pos + i + 1);
         out_file_pos += export_line.size();
+        out.write(export_line.data(), export_line.size());
         export_line.clear();
     };
 
@@ -740,17 +742,23 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
 
     out.close();
     in.close();
+    if (out.is_error()) {
+        boost::nowide::remove(out_path.c_str());
+        throw Slic3r::RuntimeError(std::string("Time estimator post process export failed.\nIs the disk full?\n"));
+    }
+    md5 = out.md5();
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ <<  boost::format(":  after process %1%")%filename.c_str();
 
     // updates moves' gcode ids which have been modified by the insertion of the M73 lines
     unsigned int curr_offset_id = 0;
     unsigned int total_offset = 0;
-    for (GCodeProcessorResult::MoveVertex& move : moves) {
-        while (curr_offset_id < static_cast<unsigned int>(offsets.size()) && offsets[curr_offset_id].first <= move.gcode_id) {
+    for (size_t i = 0; i < moves.size(); ++ i) {
+        unsigned int& gcode_id = moves.gcode_id(i);
+        while (curr_offset_id < static_cast<unsigned int>(offsets.size()) && offsets[curr_offset_id].first <= gcode_id) {
             total_offset += offsets[curr_offset_id].second;
             ++curr_offset_id;
         }
-        move.gcode_id += total_offset;
+        gcode_id += total_offset;
     }
 
     if (rename_file(out_path, filename)) {
@@ -907,12 +915,160 @@ void GCodeProcessor::UsedFilaments::process_caches(GCodeProcessor* processor)
     process_total_volume_cache(processor);
 }
 
+void GCodeProcessorResult::MoveVertices::get(size_t idx, MoveVertex &move) const
+{
+    assert(idx < this->size());
+    const Attributes &attributes = m_attributes[idx];
+    move.gcode_id        = m_gcode_ids[idx];
+    move.type            = attributes.type;
+    move.extrusion_role  = attributes.extrusion_role;
+    move.extruder_id     = attributes.extruder_id;
+    move.cp_color_id     = attributes.cp_color_id;
+    move.position        = m_positions[idx];
+    move.delta_extruder  = m_delta_extruders[idx];
+    move.feedrate        = m_feedrates[idx];
+    move.width           = m_widths[idx];
+    move.height          = m_heights[idx];
+    move.mm3_per_mm      = m_mm3_per_mms[idx];
+    move.fan_speed       = m_fan_speeds[idx];
+    move.temperature     = m_temperatures[idx];
+    move.time            = m_times[idx];
+    move.layer_duration  = m_layer_durations[idx];
+    move.move_path_type  = attributes.move_path_type;
+    if (uint32_t arc_id = m_arc_ids[idx]; arc_id != NoArc) {
+        const Arc &arc = m_arcs[arc_id];
+        move.arc_center_position = arc.center;
+        move.interpolation_points.assign(m_arc_points.begin() + arc.first_point, m_arc_points.begin() + arc.first_point + arc.num_points);
+    } else {
+        move.arc_center_position = Vec3f::Zero();
+        move.interpolation_points.clear();
+    }
+}
+
+void GCodeProcessorResult::MoveVertices::push_back(const MoveVertex &move, const InterpolationPoints &points)
+{
+    m_gcode_ids.emplace_back(move.gcode_id);
+    m_attributes.push_back({ move.type, move.extrusion_role, move.extruder_id, move.cp_color_id, move.move_path_type });
+    m_positions.emplace_back(move.position);
+    m_delta_extruders.emplace_back(move.delta_extruder);
+    m_feedrates.emplace_back(move.feedrate);
+    m_widths.emplace_back(move.width);
+    m_heights.emplace_back(move.height);
+    m_mm3_per_mms.emplace_back(move.mm3_per_mm);
+    m_fan_speeds.emplace_back(move.fan_speed);
+    m_temperatures.emplace_back(move.temperature);
+    m_times.emplace_back(move.time);
+    m_layer_durations.emplace_back(move.layer_duration);
+    if (! move.is_arc_move()) {
+        m_arc_ids.emplace_back(NoArc);
+        return;
+    }
+
+    const Vec3f *pool_begin = m_arc_points.data();
+    if (! points.empty() && points.begin() >= pool_begin && points.begin() < pool_begin + m_arc_points.size()) {
+        // Points of a move already stored, share them.
+        m_arc_ids.emplace_back(uint32_t(m_arcs.size()));
+        m_arcs.push_back({ move.arc_center_position, uint32_t(points.begin() - pool_begin), uint32_t(points.size()) });
+        return;
+    }
+    m_arc_ids.emplace_back(uint32_t(m_arcs.size()));
+    m_arcs.push_back({ move.arc_center_position, uint32_t(m_arc_points.size()), uint32_t(points.size()) });
+    m_arc_points.insert(m_arc_points.end(), points.begin(), points.end());
+}
+
+void GCodeProcessorResult::MoveVertices::erase(size_t idx)
+{
+    assert(idx < this->size());
+    // The arc data of the erased move is left in the pools, moves are erased rarely.
+    m_gcode_ids.erase(m_gcode_ids.begin() + idx);
+    m_attributes.erase(m_attributes.begin() + idx);
+    m_positions.erase(m_positions.begin() + idx);
+    m_delta_extruders.erase(m_delta_extruders.begin() + idx);
+    m_feedrates.erase(m_feedrates.begin() + idx);
+    m_widths.erase(m_widths.begin() + idx);
+    m_heights.erase(m_heights.begin() + idx);
+    m_mm3_per_mms.erase(m_mm3_per_mms.begin() + idx);
+    m_fan_speeds.erase(m_fan_speeds.begin() + idx);
+    m_temperatures.erase(m_temperatures.begin() + idx);
+    m_times.erase(m_times.begin() + idx);
+    m_layer_durations.erase(m_layer_durations.begin() + idx);
+    m_arc_ids.erase(m_arc_ids.begin() + idx);
+}
+
+void GCodeProcessorResult::MoveVertices::clear()
+{
+    m_gcode_ids.clear();
+    m_attributes.clear();
+    m_positions.clear();
+    m_delta_extruders.clear();
+    m_feedrates.clear();
+    m_widths.clear();
+    m_heights.clear();
+    m_mm3_per_mms.clear();
+    m_fan_speeds.clear();
+    m_temperatures.clear();
+    m_times.clear();
+    m_layer_durations.clear();
+    m_arc_ids.clear();
+    m_arcs.clear();
+    m_arc_points.clear();
+}
+
+void GCodeProcessorResult::MoveVertices::reserve(size_t n)
+{
+    m_gcode_ids.reserve(n);
+    m_attributes.reserve(n);
+    m_positions.reserve(n);
+    m_delta_extruders.reserve(n);
+    m_feedrates.reserve(n);
+    m_widths.reserve(n);
+    m_heights.reserve(n);
+    m_mm3_per_mms.reserve(n);
+    m_fan_speeds.reserve(n);
+    m_temperatures.reserve(n);
+    m_times.reserve(n);
+    m_layer_durations.reserve(n);
+    m_arc_ids.reserve(n);
+}
+
+void GCodeProcessorResult::MoveVertices::shrink_to_fit()
+{
+    m_gcode_ids.shrink_to_fit();
+    m_attributes.shrink_to_fit();
+    m_positions.shrink_to_fit();
+    m_delta_extruders.shrink_to_fit();
+    m_feedrates.shrink_to_fit();
+    m_widths.shrink_to_fit();
+    m_heights.shrink_to_fit();
+    m_mm3_per_mms.shrink_to_fit();
+    m_fan_speeds.shrink_to_fit();
+    m_temperatures.shrink_to_fit();
+    m_times.shrink_to_fit();
+    m_layer_durations.shrink_to_fit();
+    m_arc_ids.shrink_to_fit();
+    m_arcs.shrink_to_fit();
+    m_arc_points.shrink_to_fit();
+}
+
+size_t GCodeProcessorResult::MoveVertices::memory_usage() const
+{
+    return SLIC3R_STDVEC_MEMSIZE(m_gcode_ids, unsigned int) + SLIC3R_STDVEC_MEMSIZE(m_attributes, Attributes) +
+        SLIC3R_STDVEC_MEMSIZE(m_positions, Vec3f) + SLIC3R_STDVEC_MEMSIZE(m_delta_extruders, float) +
+        SLIC3R_STDVEC_MEMSIZE(m_feedrates, float) + SLIC3R_STDVEC_MEMSIZE(m_widths, float) +
+        SLIC3R_STDVEC_MEMSIZE(m_heights, float) + SLIC3R_STDVEC_MEMSIZE(m_mm3_per_mms, float) +
+        SLIC3R_STDVEC_MEMSIZE(m_fan_speeds, float) + SLIC3R_STDVEC_MEMSIZE(m_temperatures, float) +
+        SLIC3R_STDVEC_MEMSIZE(m_times, float) + SLIC3R_STDVEC_MEMSIZE(m_layer_durations, float) +
+        SLIC3R_STDVEC_MEMSIZE(m_arc_ids, uint32_t) + SLIC3R_STDVEC_MEMSIZE(m_arcs, Arc) +
+        SLIC3R_STDVEC_MEMSIZE(m_arc_points, Vec3f);
+}
+
 #if ENABLE_GCODE_VIEWER_STATISTICS
 void GCodeProcessorResult::reset() {
     //BBS: add mutex for protection of gcode result
     lock();
 
-    moves = std::vector<GCodeProcessorResult::MoveVertex>();
+    moves = GCodeProcessorResult::MoveVertices();
+    gcode_md5.clear();
     printable_area = Pointfs();
     //BBS: add bed exclude area
     bed_exclude_area = Pointfs();
@@ -941,6 +1097,7 @@ void GCodeProcessorResult::reset() {
 
     moves.clear();
     lines_ends.clear();
+    gcode_md5.clear();
     printable_area = Pointfs();
     //BBS: add bed exclude area
     bed_exclude_area = Pointfs();
@@ -1550,9 +1707,10 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     m_result.filename = filename;
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
+    m_result.moves.push_back(GCodeProcessorResult::MoveVertex());
     size_t parse_line_callback_cntr = 10000;
-    m_parser.parse_file(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
+    //BBS: the lines are tokenized in parallel, the machine is simulated serially in the file order
+    m_parser.parse_file_parallel(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (-- parse_line_callback_cntr == 0) {
             // Don't call the cancel_callback() too often, do it every at every 10000'th line.
             parse_line_callback_cntr = 10000;
@@ -1578,13 +1736,18 @@ void GCodeProcessor::initialize(const std::string& filename)
     m_result.filename = filename;
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
+    m_result.moves.push_back(GCodeProcessorResult::MoveVertex());
 }
 
 void GCodeProcessor::process_buffer(const std::string &buffer)
+{
+    this->process_buffer(buffer.c_str(), buffer.c_str() + buffer.size());
+}
+
+void GCodeProcessor::process_buffer(const char *begin, const char *end)
 {
     //FIXME maybe cache GCodeLine gline to be over multiple parse_buffer() invocations.
-    m_parser.parse_buffer(buffer, [this](GCodeReader&, const GCodeReader::GCodeLine& line) {
+    m_parser.parse_buffer(begin, end, [this](GCodeReader&, const GCodeReader::GCodeLine& line) {
         this->process_gcode_line(line, false);
     });
 }
@@ -1592,10 +1755,10 @@ void GCodeProcessor::process_buffer(const std::string &buffer)
 void GCodeProcessor::finalize(bool post_process)
 {
     // update width/height of wipe moves
-    for (GCodeProcessorResult::MoveVertex& move : m_result.moves) {
-        if (move.type == EMoveType::Wipe) {
-            move.width = Wipe_Width;
-            move.height = Wipe_Height;
+    for (size_t i = 0; i < m_result.moves.size(); ++ i) {
+        if (m_result.moves.type(i) == EMoveType::Wipe) {
+            m_result.moves.width(i) = Wipe_Width;
+            m_result.moves.height(i) = Wipe_Height;
         }
     }
 
@@ -1619,13 +1782,17 @@ void GCodeProcessor::finalize(bool post_process)
     //update times for results
     for (size_t i = 0; i < m_result.moves.size(); i++) {
         //field layer_duration contains the layer id for the move in which the layer_duration has to be set.
-        size_t layer_id = size_t(m_result.moves[i].layer_duration);
+        float& layer_duration = m_result.moves.layer_duration(i);
+        size_t layer_id = size_t(layer_duration);
         std::vector<float>& layer_times = m_result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].layers_times;
         if (layer_times.size() > layer_id - 1 && layer_id > 0)
-            m_result.moves[i].layer_duration = layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
+            layer_duration = layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
         else
-            m_result.moves[i].layer_duration = 0;
+            layer_duration = 0;
     }
+    m_result.moves.shrink_to_fit();
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": %1% moves stored in %2% bytes") % m_result.moves.size() % m_result.moves.memory_usage()
+                            << log_memory_info();
 
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     std::cout << "\n";
@@ -1635,7 +1802,7 @@ void GCodeProcessor::finalize(bool post_process)
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
     if (post_process){
         TimeProcessContext context(m_layer_id,m_filament_lists,m_used_filaments);
-        m_time_processor.post_process(m_result.filename, m_result.moves, m_result.lines_ends, context);
+        m_time_processor.post_process(m_result.filename, m_result.moves, m_result.lines_ends, m_result.gcode_md5, context);
     }
 #if ENABLE_GCODE_VIEWER_STATISTICS
     m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - m_start_time).count();
@@ -3208,12 +3375,12 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
     if (m_seams_detector.is_active()) {
         // check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter && !m_seams_detector.has_first_vertex()) {
-            //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f real_first_pos = Vec3f(m_result.moves.back().position.x() - m_x_offset, m_result.moves.back().position.y() - m_y_offset, m_result.moves.back().position.z());
+            //BBS: m_result.moves.back_position() has plate offset, must minus plate offset before calculate the real seam position
+            const Vec3f real_first_pos = Vec3f(m_result.moves.back_position().x() - m_x_offset, m_result.moves.back_position().y() - m_y_offset, m_result.moves.back_position().z());
             m_seams_detector.set_first_vertex(real_first_pos - m_extruder_offsets[m_extruder_id]);
         } else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter && m_detect_layer_based_on_tag) {
-            const Vec3f real_last_pos = Vec3f(m_result.moves.back().position.x() - m_x_offset, m_result.moves.back().position.y() - m_y_offset,
-                                              m_result.moves.back().position.z());
+            const Vec3f real_last_pos = Vec3f(m_result.moves.back_position().x() - m_x_offset, m_result.moves.back_position().y() - m_y_offset,
+                                              m_result.moves.back_position().z());
             const Vec3f new_pos       = real_last_pos - m_extruder_offsets[m_extruder_id];
             // We may have sloped loop, drop any previous start pos if we have z increment
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
@@ -3228,8 +3395,8 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
             };
 
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f real_last_pos = Vec3f(m_result.moves.back().position.x() - m_x_offset, m_result.moves.back().position.y() - m_y_offset, m_result.moves.back().position.z());
+            //BBS: m_result.moves.back_position() has plate offset, must minus plate offset before calculate the real seam position
+            const Vec3f real_last_pos = Vec3f(m_result.moves.back_position().x() - m_x_offset, m_result.moves.back_position().y() - m_y_offset, m_result.moves.back_position().z());
             const Vec3f new_pos = real_last_pos - m_extruder_offsets[m_extruder_id];
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             // the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
@@ -3246,7 +3413,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line)
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
         Vec3f plate_offset = {(float) m_x_offset, (float) m_y_offset, 0.0f};
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.back_position() - m_extruder_offsets[m_extruder_id] - plate_offset);
     }
 
     if (m_detect_layer_based_on_tag && !m_result.spiral_vase_layers.empty()) {
@@ -3646,10 +3813,10 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     if (m_seams_detector.is_active()) {
         //BBS: check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter && !m_seams_detector.has_first_vertex()) {
-            m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset);
+            m_seams_detector.set_first_vertex(m_result.moves.back_position() - m_extruder_offsets[m_extruder_id] - plate_offset);
         } else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter && m_detect_layer_based_on_tag) {
-            const Vec3f real_last_pos = Vec3f(m_result.moves.back().position.x() - m_x_offset, m_result.moves.back().position.y() - m_y_offset,
-                                              m_result.moves.back().position.z());
+            const Vec3f real_last_pos = Vec3f(m_result.moves.back_position().x() - m_x_offset, m_result.moves.back_position().y() - m_y_offset,
+                                              m_result.moves.back_position().z());
             const Vec3f new_pos       = real_last_pos - m_extruder_offsets[m_extruder_id];
             // We may have sloped loop, drop any previous start pos if we have z increment
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
@@ -3661,7 +3828,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
                 m_end_position[X] = pos.x(); m_end_position[Y] = pos.y(); m_end_position[Z] = pos.z();
             };
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.back_position() - m_extruder_offsets[m_extruder_id] - plate_offset;
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             //BBS: the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
 
@@ -3676,7 +3843,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     }
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.back_position() - m_extruder_offsets[m_extruder_id] - plate_offset);
     }
 
     //BBS: some layer may only has G3/G3, update right layer height
@@ -4266,7 +4433,7 @@ void GCodeProcessor::store_move_vertex(EMoveType type, EMovePathType path_type)
                 m_extruder_offsets[m_extruder_id];
     }
 
-    m_result.moves.push_back({
+    m_result.moves.push_back(GCodeProcessorResult::MoveVertex{
         m_last_line_id,
         type,
         m_extrusion_role,
@@ -4286,8 +4453,7 @@ void GCodeProcessor::store_move_vertex(EMoveType type, EMovePathType path_type)
         //BBS: add arc move related data
         path_type,
         Vec3f(m_arc_center(0, 0) + m_x_offset, m_arc_center(1, 0) + m_y_offset, m_arc_center(2, 0)) + m_extruder_offsets[m_extruder_id],
-        m_interpolation_points,
-    });
+    }, m_interpolation_points);
 
     if (type == EMoveType::Seam) {
         m_seams_count++;
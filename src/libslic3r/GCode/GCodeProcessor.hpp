@@ -10,6 +10,8 @@
 
 #include <cstdint>
 #include <array>
+#include <iterator>
+#include <limits>
 #include <vector>
 #include <mutex>
 #include <string>
@@ -148,6 +150,27 @@ namespace Slic3r {
             }
         };
 
+        //BBS: read only view into the arc interpolation points owned by MoveVertices
+        class InterpolationPoints
+        {
+        public:
+            InterpolationPoints() = default;
+            InterpolationPoints(const Vec3f *data, size_t size) : m_data(data), m_size(size) {}
+            InterpolationPoints(const std::vector<Vec3f> &points) : m_data(points.data()), m_size(points.size()) {}
+
+            size_t       size() const                   { return m_size; }
+            bool         empty() const                  { return m_size == 0; }
+            const Vec3f& operator[](size_t idx) const   { assert(idx < m_size); return m_data[idx]; }
+            const Vec3f* begin() const                  { return m_data; }
+            const Vec3f* end() const                    { return m_data + m_size; }
+
+        private:
+            const Vec3f *m_data { nullptr };
+            size_t       m_size { 0 };
+        };
+
+        // Value type of MoveVertices, a copy of a move assembled from the columns.
+        // Loops over many moves shall rather read the columns they need through the MoveVertices accessors.
         struct MoveVertex
         {
             unsigned int gcode_id{ 0 };
@@ -182,6 +205,130 @@ namespace Slic3r {
             }
         };
 
+        //BBS: compact storage of the moves, a G-code of a multi-plate job easily produces millions of them.
+        // The attributes are stored column wise, the enums packed into bytes, and the arc data
+        // (center and interpolation points) is stored only for arc moves, in pools shared by all the moves.
+        // Moves are read as MoveVertex copies through operator[], get() or the iterators. Loops over all the moves
+        // shall read the single columns they need instead, the columns are accessible directly.
+        class MoveVertices
+        {
+        public:
+            class const_iterator
+            {
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type        = MoveVertex;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = void;
+                using reference         = MoveVertex;
+
+                const_iterator() = default;
+                const_iterator(const MoveVertices *moves, size_t idx) : m_moves(moves), m_idx(idx) {}
+
+                MoveVertex      operator*() const                           { return (*m_moves)[m_idx]; }
+                const_iterator& operator++()                                { ++ m_idx; return *this; }
+                const_iterator  operator++(int)                             { const_iterator out = *this; ++ m_idx; return out; }
+                bool            operator==(const const_iterator &rhs) const { return m_idx == rhs.m_idx; }
+                bool            operator!=(const const_iterator &rhs) const { return m_idx != rhs.m_idx; }
+                size_t          index() const                               { return m_idx; }
+
+            private:
+                const MoveVertices *m_moves { nullptr };
+                size_t              m_idx   { 0 };
+            };
+
+            size_t          size() const                        { return m_gcode_ids.size(); }
+            bool            empty() const                       { return m_gcode_ids.empty(); }
+            MoveVertex      operator[](size_t idx) const        { MoveVertex out; this->get(idx, out); return out; }
+            // Assemble a move into out, reusing the memory of its interpolation points.
+            void            get(size_t idx, MoveVertex &out) const;
+            MoveVertex      front() const                       { return (*this)[0]; }
+            MoveVertex      back() const                        { return (*this)[this->size() - 1]; }
+            const_iterator  begin() const                       { return { this, 0 }; }
+            const_iterator  end() const                         { return { this, this->size() }; }
+
+            void            push_back(const MoveVertex &move) { this->push_back(move, move.interpolation_points); }
+            // Store a move with the interpolation points passed separately, move.interpolation_points is ignored.
+            void            push_back(const MoveVertex &move, const InterpolationPoints &interpolation_points);
+            void            erase(size_t idx);
+            void            clear();
+            void            reserve(size_t n);
+            void            shrink_to_fit();
+
+            // Columns updated in place after the moves were stored.
+            unsigned int&   gcode_id(size_t idx)                { return m_gcode_ids[idx]; }
+            Vec3f&          position(size_t idx)                { return m_positions[idx]; }
+            float&          width(size_t idx)                   { return m_widths[idx]; }
+            float&          height(size_t idx)                  { return m_heights[idx]; }
+            float&          layer_duration(size_t idx)          { return m_layer_durations[idx]; }
+            EMoveType       type(size_t idx) const              { return m_attributes[idx].type; }
+
+            // Read only access to single columns, which avoids assembling a whole MoveVertex.
+            unsigned int    gcode_id(size_t idx) const          { return m_gcode_ids[idx]; }
+            ExtrusionRole   extrusion_role(size_t idx) const    { return m_attributes[idx].extrusion_role; }
+            unsigned char   extruder_id(size_t idx) const       { return m_attributes[idx].extruder_id; }
+            unsigned char   cp_color_id(size_t idx) const       { return m_attributes[idx].cp_color_id; }
+            const Vec3f&    position(size_t idx) const          { return m_positions[idx]; }
+            const Vec3f&    back_position() const               { return m_positions.back(); }
+            float           delta_extruder(size_t idx) const    { return m_delta_extruders[idx]; }
+            float           feedrate(size_t idx) const          { return m_feedrates[idx]; }
+            float           width(size_t idx) const             { return m_widths[idx]; }
+            float           height(size_t idx) const            { return m_heights[idx]; }
+            float           mm3_per_mm(size_t idx) const        { return m_mm3_per_mms[idx]; }
+            float           volumetric_rate(size_t idx) const   { return m_feedrates[idx] * m_mm3_per_mms[idx]; }
+            float           fan_speed(size_t idx) const         { return m_fan_speeds[idx]; }
+            float           temperature(size_t idx) const       { return m_temperatures[idx]; }
+            float           time(size_t idx) const              { return m_times[idx]; }
+            float           layer_duration(size_t idx) const    { return m_layer_durations[idx]; }
+            EMovePathType   move_path_type(size_t idx) const    { return m_attributes[idx].move_path_type; }
+            bool            is_arc_move(size_t idx) const       { return m_arc_ids[idx] != NoArc; }
+            bool            is_arc_move_with_interpolation_points(size_t idx) const
+                { return m_arc_ids[idx] != NoArc && m_arcs[m_arc_ids[idx]].num_points > 0; }
+            // View valid until this MoveVertices is modified.
+            InterpolationPoints interpolation_points(size_t idx) const {
+                if (uint32_t arc_id = m_arc_ids[idx]; arc_id != NoArc)
+                    return { m_arc_points.data() + m_arcs[arc_id].first_point, m_arcs[arc_id].num_points };
+                return {};
+            }
+
+            // Number of bytes allocated by the columns and pools.
+            size_t          memory_usage() const;
+
+        private:
+            struct Attributes
+            {
+                EMoveType       type;
+                ExtrusionRole   extrusion_role;
+                unsigned char   extruder_id;
+                unsigned char   cp_color_id;
+                EMovePathType   move_path_type;
+            };
+            struct Arc
+            {
+                Vec3f           center;
+                uint32_t        first_point;
+                uint32_t        num_points;
+            };
+            static constexpr const uint32_t NoArc = std::numeric_limits<uint32_t>::max();
+
+            std::vector<unsigned int>   m_gcode_ids;
+            std::vector<Attributes>     m_attributes;
+            std::vector<Vec3f>          m_positions;
+            std::vector<float>          m_delta_extruders;
+            std::vector<float>          m_feedrates;
+            std::vector<float>          m_widths;
+            std::vector<float>          m_heights;
+            std::vector<float>          m_mm3_per_mms;
+            std::vector<float>          m_fan_speeds;
+            std::vector<float>          m_temperatures;
+            std::vector<float>          m_times;
+            std::vector<float>          m_layer_durations;
+            // Index into m_arcs for arc moves, NoArc otherwise.
+            std::vector<uint32_t>       m_arc_ids;
+            std::vector<Arc>            m_arcs;
+            std::vector<Vec3f>          m_arc_points;
+        };
+
         struct SliceWarning {
             int         level;                  // 0: normal tips, 1: warning; 2: error
             std::string msg;                    // enum string
@@ -191,9 +338,11 @@ namespace Slic3r {
 
         std::string filename;
         unsigned int id;
-        std::vector<MoveVertex> moves;
+        MoveVertices moves;
         // Positions of ends of lines of the final G-code this->filename after TimeProcessor::post_process() finalizes the G-code.
         std::vector<size_t> lines_ends;
+        // Upper case hex MD5 of the final G-code this->filename, filled in by TimeProcessor::post_process().
+        std::string gcode_md5;
         Pointfs printable_area;
         //BBS: add bed exclude area
         Pointfs bed_exclude_area;
@@ -234,6 +383,7 @@ namespace Slic3r {
             id = other.id;
             moves = other.moves;
             lines_ends = other.lines_ends;
+            gcode_md5 = other.gcode_md5;
             printable_area = other.printable_area;
             bed_exclude_area = other.bed_exclude_area;
             toolpath_outside = other.toolpath_outside;
@@ -545,8 +695,8 @@ namespace Slic3r {
             void reset();
 
             // post process the file with the given filename to add remaining time lines M73
-            // and updates moves' gcode ids accordingly
-            void post_process(const std::string& filename, std::vector<GCodeProcessorResult::MoveVertex>& moves, std::vector<size_t>& lines_ends, const TimeProcessContext& context);
+            // and updates moves' gcode ids accordingly, returns MD5 of the final G-code in md5
+            void post_process(const std::string& filename, GCodeProcessorResult::MoveVertices& moves, std::vector<size_t>& lines_ends, std::string& md5, const TimeProcessContext& context);
         };
     public:
         class SeamsDetector
@@ -591,12 +741,13 @@ namespace Slic3r {
                 if (!m_move_id.has_value() || !m_custom_gcode_per_print_z_id.has_value())
                     return;
 
-                const Vec3f position = m_result.moves.back().position;
+                const Vec3f position = m_result.moves.back_position();
 
-                GCodeProcessorResult::MoveVertex& move = m_result.moves.emplace_back(m_result.moves[*m_move_id]);
-                move.position = position;
-                move.height = height;
-                m_result.moves.erase(m_result.moves.begin() + *m_move_id);
+                m_result.moves.push_back(m_result.moves[*m_move_id]);
+                const size_t move_id = m_result.moves.size() - 1;
+                m_result.moves.position(move_id) = position;
+                m_result.moves.height(move_id) = height;
+                m_result.moves.erase(*m_move_id);
                 m_result.custom_gcode_per_print_z[*m_custom_gcode_per_print_z_id].print_z = position.z();
                 reset();
             }
@@ -786,6 +937,8 @@ namespace Slic3r {
         // Streaming interface, for processing G-codes just generated by PrusaSlicer in a pipelined fashion.
         void initialize(const std::string& filename);
         void process_buffer(const std::string& buffer);
+        // The range shall be followed by a zero character, see GCodeReader::parse_buffer().
+        void process_buffer(const char* begin, const char* end);
         void finalize(bool post_process);
 
         float get_time(PrintEstimatedStatistics::ETimeMode mode) const;
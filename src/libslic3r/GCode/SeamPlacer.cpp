@@ -129,7 +129,9 @@ Vec3f sample_power_cosine_hemisphere(const Vec2f &samples, float power)
     return Vec3f(cos(term1) * term3, sin(term1) * term3, term2);
 }
 
-std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &raycasting_tree,
+// TreeType is AABBTreeIndirect::Tree3f or AABBTreeIndirect::QuantizedTree3f, see SeamPlacer::raycasting_quantized_tree.
+template<typename TreeType>
+std::vector<float> raycast_visibility(const TreeType                         &raycasting_tree,
                                       const indexed_triangle_set &            triangles,
                                       const TriangleSetSamples &              samples,
                                       size_t                                  negative_volumes_start_index)
@@ -405,7 +407,7 @@ Polygons extract_perimeter_polygons(const Layer *layer, const SeamPosition confi
 
     if (polygons.empty()) { // If there are no perimeter polygons for whatever reason (disabled perimeters .. ) insert dummy point
         // it is easier than checking everywhere if the layer is not emtpy, no seam will be placed to this layer anyway
-        polygons.emplace_back(std::vector{Point{0, 0}});
+        polygons.emplace_back(Points{Point{0, 0}});
         corresponding_regions_out.push_back(nullptr);
     }
 
@@ -630,7 +632,13 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po, st
 
     throw_if_canceled();
     BOOST_LOG_TRIVIAL(debug) << "SeamPlacer: build AABB tree: end";
-    result.mesh_samples_visibility = raycast_visibility(raycasting_tree, triangle_set, result.mesh_samples, negative_volumes_start_index);
+    if constexpr (SeamPlacer::raycasting_quantized_tree) {
+        const AABBTreeIndirect::QuantizedTree3f quantized_tree(raycasting_tree);
+        // Release the full tree, only the quantized one is traversed.
+        raycasting_tree = AABBTreeIndirect::Tree3f();
+        result.mesh_samples_visibility = raycast_visibility(quantized_tree, triangle_set, result.mesh_samples, negative_volumes_start_index);
+    } else
+        result.mesh_samples_visibility = raycast_visibility(raycasting_tree, triangle_set, result.mesh_samples, negative_volumes_start_index);
     throw_if_canceled();
 #ifdef DEBUG_FILES
     result.debug_export(triangle_set);
@@ -118,6 +118,9 @@ public:
     static constexpr size_t fast_decimation_triangle_count_target = 16000;
     //square of number of rays per sample point
     static constexpr size_t sqr_rays_per_sample_point = 5;
+    // Cast the visibility rays over AABBTreeIndirect::QuantizedTree, which takes half the memory of the full tree
+    // and finds the same hits, at the cost of decoding the bounding boxes during traversal.
+    static constexpr bool raycasting_quantized_tree = false;
 
     // snapping angle - angles larger than this value will be snapped to during seam painting
     static constexpr float sharp_angle_snapping_threshold = 55.0f * float(PI) / 180.0f;
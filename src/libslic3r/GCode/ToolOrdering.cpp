@@ -1342,27 +1342,27 @@ void WipingExtrusions::ensure_perimeters_infills_order(const Print& print)
     }
 }
 
-// Following function is called from GCode::process_layer and returns pointer to vector with information about which extruders should be used for given copy of this entity.
-// If this extrusion does not have any override, nullptr is returned.
-// Otherwise it modifies the vector in place and changes all -1 to correct_extruder_id (at the time the overrides were created, correct extruders were not known,
+// Following function is called from GCode::collect_layer_extrusions and returns information about which extruders should be used for given copy of this entity.
+// If this extrusion does not have any override, false is returned.
+// Otherwise overrides is filled in with the stored vector, where all -1 are changed to correct_extruder_id (at the time the overrides were created, correct extruders were not known,
 // so -1 was used as "print as usual").
 // The resulting vector therefore keeps track of which extrusions are the ones that were overridden and which were not. If the extruder used is overridden,
 // its number is saved as is (zero-based index). Regular extrusions are saved as -number-1 (unfortunately there is no negative zero).
-const WipingExtrusions::ExtruderPerCopy* WipingExtrusions::get_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object, int correct_extruder_id, size_t num_of_copies)
+// The stored overrides are not modified, so that the layers may be grouped by extruders from multiple threads.
+bool WipingExtrusions::get_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object, int correct_extruder_id, size_t num_of_copies, ExtruderPerCopy &overrides) const
 {
-	ExtruderPerCopy *overrides = nullptr;
     auto entity_map_it = entity_map.find(std::make_tuple(entity, object));
-    if (entity_map_it != entity_map.end()) {
-        overrides = &entity_map_it->second;
-    	overrides->resize(num_of_copies, -1);
-	    // Each -1 now means "print as usual" - we will replace it with actual extruder id (shifted it so we don't lose that information):
-	    std::replace(overrides->begin(), overrides->end(), -1, -correct_extruder_id-1);
-	}
-    return overrides;
+    if (entity_map_it == entity_map.end())
+        return false;
+    overrides = entity_map_it->second;
+    overrides.resize(num_of_copies, -1);
+    // Each -1 now means "print as usual" - we will replace it with actual extruder id (shifted it so we don't lose that information):
+    std::replace(overrides.begin(), overrides.end(), -1, -correct_extruder_id-1);
+    return true;
 }
 
 // BBS
-int WipingExtrusions::get_support_extruder_overrides(const PrintObject* object)
+int WipingExtrusions::get_support_extruder_overrides(const PrintObject* object) const
 {
     auto iter = support_map.find(object);
     if (iter != support_map.end())
@@ -1371,7 +1371,7 @@ int WipingExtrusions::get_support_extruder_overrides(const PrintObject* object)
     return -1;
 }
 
-int WipingExtrusions::get_support_interface_extruder_overrides(const PrintObject* object)
+int WipingExtrusions::get_support_interface_extruder_overrides(const PrintObject* object) const
 {
     auto iter = support_intf_map.find(object);
     if (iter != support_intf_map.end())
@@ -30,10 +30,10 @@ public:
     // When allocating extruder overrides of an object's ExtrusionEntity, overrides for maximum 3 copies are allocated in place.
     typedef boost::container::small_vector<int32_t, 3> ExtruderPerCopy;
 
-    // This is called from GCode::process_layer - see implementation for further comments:
-    const ExtruderPerCopy* get_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object, int correct_extruder_id, size_t num_of_copies);
-    int get_support_extruder_overrides(const PrintObject* object);
-    int get_support_interface_extruder_overrides(const PrintObject* object);
+    // This is called from GCode::collect_layer_extrusions - see implementation for further comments:
+    bool get_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object, int correct_extruder_id, size_t num_of_copies, ExtruderPerCopy &overrides) const;
+    int get_support_extruder_overrides(const PrintObject* object) const;
+    int get_support_interface_extruder_overrides(const PrintObject* object) const;
 
     // This function goes through all infill entities, decides which ones will be used for wiping and
     // marks them by the extruder id. Returns volume that remains to be wiped on the wipe tower:
@@ -137,6 +137,8 @@ public:
         m_wiping_extrusions.set_layer_tools_ptr(this);
         return m_wiping_extrusions;
     }
+    // Read only access, which does not update the back pointer, thus it is safe to be called from multiple threads.
+    const WipingExtrusions& wiping_extrusions() const { return m_wiping_extrusions; }
 
 private:
     // This object holds list of extrusion that will be used for extruder wiping
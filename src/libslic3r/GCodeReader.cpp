@@ -4,9 +4,13 @@
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <chrono>
+#include <memory>
 #include "Utils.hpp"
 
 #include "LocalesUtils.hpp"
@@ -14,6 +18,19 @@
 #include <Shiny/Shiny.h>
 #include <fast_float/fast_float.h>
 
+#include <tbb/task_arena.h>
+// See GCode.cpp for the TBB 2017 / oneTBB pipeline interface switch.
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
 void GCodeReader::apply_config(const GCodeConfig &config)
@@ -26,7 +43,7 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
     m_config.apply(config, true);
 }
 
-const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
+const char* GCodeReader::tokenize_line(const char *ptr, const char *end, float *axes, uint32_t &mask, std::pair<const char*, const char*> &command)
 {
     PROFILE_FUNC();
 
@@ -71,8 +88,8 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 if (pend != c && is_end_of_word(*pend)) {
                     // The axis value has been parsed correctly.
                     if (axis != UNKNOWN_AXIS)
-	                    gline.m_axis[int(axis)] = float(v);
-                    gline.m_mask |= 1 << int(axis);
+	                    axes[int(axis)] = float(v);
+                    mask |= 1 << int(axis);
                     c = pend;
                 } else
                     // Skip the rest of the word.
@@ -82,12 +99,18 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 c = skip_word(c);
         }
     }
-    
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
 
     // Skip the rest of the line.
     for (; ! is_end_of_line(*c); ++ c);
+    return c;
+}
+
+const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
+{
+    const char *c = tokenize_line(ptr, end, gline.m_axis, gline.m_mask, command);
+    
+    if (gline.has(E) && m_config.use_relative_e_distances)
+        m_position[E] = 0;
 
     // Copy the raw string including the comment, without the trailing newlines.
     if (c > ptr) {
@@ -215,6 +238,171 @@ bool GCodeReader::parse_file(const std::string &file, callback_t callback, std::
     return ret;
 }
 
+namespace {
+
+// Line of G-code tokenized by GCodeReader::tokenize_line(), the offsets are relative to the start of its block.
+struct TokenizedLine
+{
+    // Line without the line number and the trailing newlines.
+    uint32_t    begin;
+    uint32_t    end;
+    // Command word.
+    uint32_t    cmd_begin;
+    uint32_t    cmd_end;
+    // Start of the next line.
+    uint32_t    next;
+    uint32_t    mask;
+    float       axes[NUM_AXES];
+};
+
+// Range of whole lines of the G-code file, tokenized by a worker thread.
+struct TokenizedBlock
+{
+    // Start of the block in the memory mapped file or in tail.
+    const char                 *data { nullptr };
+    size_t                      size { 0 };
+    // Offset of data in the file.
+    size_t                      file_pos { 0 };
+    // Copy of the last line of the file if it is not terminated by a newline,
+    // as the tokenizer reads up to the newline or a zero character.
+    std::string                 tail;
+    std::vector<TokenizedLine>  lines;
+};
+
+}
+
+bool GCodeReader::parse_file_parallel(const std::string &filename, callback_t callback, std::vector<size_t> &lines_ends)
+{
+    // Size of the blocks of lines tokenized by a single task. The blocks are released once consumed,
+    // thus the memory used by the tokenized lines is bounded by the number of blocks in flight.
+    static constexpr const size_t block_size = 1024 * 1024;
+
+    lines_ends.clear();
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before parse_file %1%") % filename.c_str();
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    boost::iostreams::mapped_file_source file;
+    size_t                               file_size = 0;
+    try {
+        file_size = boost::filesystem::file_size(filename);
+        if (file_size > size_t(std::numeric_limits<uint32_t>::max())) {
+            // The tokenized lines store 32 bit offsets.
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": " << filename << " is over 4GB, parsing it serially";
+            return this->parse_file(filename, callback, lines_ends);
+        }
+        // Memory mapping of an empty file fails.
+        if (file_size > 0)
+            file.open(filename);
+    } catch (const std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << ": failed to map " << filename << ", reason = " << err.what();
+        return false;
+    }
+    const char *file_begin = file_size > 0 ? file.data() : nullptr;
+    const char *file_end   = file_begin + file_size;
+
+    const char *block_begin = file_begin;
+    GCodeLine   gline;
+    m_parsing = true;
+    tbb::parallel_pipeline(2 * std::max<size_t>(1, tbb::this_task_arena::max_concurrency()),
+        // Cut the file into blocks of whole lines.
+        tbb::make_filter<void, std::shared_ptr<TokenizedBlock>>(slic3r_tbb_filtermode::serial_in_order,
+            [this, file_begin, file_end, &block_begin](tbb::flow_control &fc) -> std::shared_ptr<TokenizedBlock> {
+                if (block_begin == file_end || ! m_parsing) {
+                    fc.stop();
+                    return {};
+                }
+                auto block = std::make_shared<TokenizedBlock>();
+                block->data     = block_begin;
+                block->file_pos = block_begin - file_begin;
+                if (size_t(file_end - block_begin) > block_size) {
+                    // Cut after a LF, it always terminates a line, while a CR may be followed by a LF.
+                    const char *block_end = static_cast<const char*>(memchr(block_begin + block_size - 1, '\n', file_end - block_begin - block_size + 1));
+                    block_begin = block_end ? block_end + 1 : file_end;
+                } else
+                    block_begin = file_end;
+                if (block_begin == file_end && ! is_end_of_line(file_end[-1])) {
+                    // Last line of the file is not terminated by a newline.
+                    const char *tail_begin = file_end;
+                    for (; tail_begin != block->data && tail_begin[-1] != '\r' && tail_begin[-1] != '\n'; -- tail_begin) ;
+                    if (tail_begin == block->data) {
+                        block->tail.assign(tail_begin, file_end);
+                        block->data = block->tail.c_str();
+                        block->size = block->tail.size();
+                        return block;
+                    }
+                    // Process the tail as a block of its own.
+                    block_begin = tail_begin;
+                }
+                block->size = block_begin - block->data;
+                return block;
+            }) &
+        // Tokenize the lines of a block.
+        tbb::make_filter<std::shared_ptr<TokenizedBlock>, std::shared_ptr<TokenizedBlock>>(slic3r_tbb_filtermode::parallel,
+            [](std::shared_ptr<TokenizedBlock> block) -> std::shared_ptr<TokenizedBlock> {
+                CNumericLocalesSetter locales_setter;
+                const char *data = block->data;
+                const char *end  = data + block->size;
+                block->lines.reserve(block->size / 24);
+                for (const char *ptr = data; ptr != end;) {
+                    // Find end of line.
+                    const char *line_end = ptr;
+                    for (; line_end != end && *line_end != '\r' && *line_end != '\n'; ++ line_end) ;
+                    // Skip the line number.
+                    const char *begin = skip_whitespaces(ptr);
+                    if (std::toupper(*begin) == 'N')
+                        begin = skip_word(begin);
+                    begin = skip_whitespaces(begin);
+                    TokenizedLine &line = block->lines.emplace_back();
+                    std::pair<const char*, const char*> command;
+                    line.mask = 0;
+                    memset(line.axes, 0, sizeof(line.axes));
+                    line.begin     = uint32_t(begin - data);
+                    line.end       = uint32_t(tokenize_line(begin, line_end, line.axes, line.mask, command) - data);
+                    line.cmd_begin = uint32_t(command.first - data);
+                    line.cmd_end   = uint32_t(command.second - data);
+                    // Skip EOL.
+                    ptr = line_end;
+                    if (ptr != end && *ptr == '\r')
+                        ++ ptr;
+                    if (ptr != end && *ptr == '\n')
+                        ++ ptr;
+                    line.next = uint32_t(ptr - data);
+                }
+                return block;
+            }) &
+        // Simulate the lines in the file order.
+        tbb::make_filter<std::shared_ptr<TokenizedBlock>, void>(slic3r_tbb_filtermode::serial_in_order,
+            [this, &callback, &gline, &lines_ends](std::shared_ptr<TokenizedBlock> block) {
+                // The stage may run on any worker thread, the callback parses numbers with the locale dependent functions.
+                CNumericLocalesSetter locales_setter;
+                const char *data = block->data;
+                for (const TokenizedLine &line : block->lines) {
+                    if (! m_parsing)
+                        return;
+                    gline.reset();
+                    gline.m_mask = line.mask;
+                    memcpy(gline.m_axis, line.axes, sizeof(line.axes));
+                    if (line.end > line.begin)
+                        gline.m_raw.assign(data + line.begin, data + line.end);
+                    if (gline.has(E) && m_config.use_relative_e_distances)
+                        m_position[E] = 0;
+                    if (m_verbose)
+                        std::cout << gline.m_raw << std::endl;
+                    callback(*this, gline);
+                    std::pair<const char*, const char*> command(data + line.cmd_begin, data + line.cmd_end);
+                    update_coordinates(gline, command);
+                    if (line.next > 0 && data[line.next - 1] == '\n')
+                        lines_ends.emplace_back(block->file_pos + line.next);
+                }
+            }));
+
+    double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  finished parse_file %1%, %2% MB in %3% s, %4% MB/s")
+        % filename.c_str() % (double(file_size) / (1024. * 1024.)) % elapsed % (elapsed > 0. ? double(file_size) / (1024. * 1024. * elapsed) : 0.);
+
+    return true;
+}
+
 bool GCodeReader::parse_file_raw(const std::string &filename, raw_line_callback_t line_callback)
 {
     return this->parse_file_raw_internal(filename,
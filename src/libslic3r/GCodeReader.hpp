@@ -2,6 +2,7 @@
 #define slic3r_GCodeReader_hpp_
 
 #include "libslic3r.h"
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <functional>
@@ -90,18 +91,31 @@ public:
     typedef std::function<void(GCodeReader&, const char*, const char*)> raw_line_callback_t;
     
     GCodeReader() : m_verbose(false) { this->reset(); }
+    // m_parsing is atomic, thus the copy has to be spelled out.
+    GCodeReader(const GCodeReader &rhs) { *this = rhs; }
+    GCodeReader& operator=(const GCodeReader &rhs) {
+        m_config  = rhs.m_config;
+        memcpy(m_position, rhs.m_position, sizeof(m_position));
+        m_verbose = rhs.m_verbose;
+        m_parsing = rhs.m_parsing.load();
+        return *this;
+    }
     void reset() { memset(m_position, 0, sizeof(m_position)); }
     void apply_config(const GCodeConfig &config);
     void apply_config(const DynamicPrintConfig &config);
 
     template<typename Callback>
     void parse_buffer(const std::string &buffer, Callback callback)
+        { this->parse_buffer(buffer.c_str(), buffer.c_str() + buffer.size(), callback); }
+
+    // Parse a range of G-code lines. The range shall be followed by a zero character (as with std::string::c_str()),
+    // as the tokenizer peeks behind the end of the last line.
+    template<typename Callback>
+    void parse_buffer(const char *ptr, const char *end, Callback callback)
     {
-        const char *ptr = buffer.c_str();
-        const char *end = ptr + buffer.size();
         GCodeLine gline;
         m_parsing = true;
-        while (m_parsing && *ptr != 0) {
+        while (m_parsing && ptr < end && *ptr != 0) {
             gline.reset();
             ptr = this->parse_line(ptr, end, gline, callback);
         }
@@ -129,6 +143,10 @@ public:
     // Collect positions of line ends in the binary G-code to be used by the G-code viewer when memory mapping and displaying section of G-code
     // as an overlay in the 3D scene.
     bool parse_file(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends);
+    // Same as parse_file() with line ends, but the file is memory mapped and its lines are tokenized in parallel,
+    // block by block. The callback is called for the lines in the file order, one line at a time, with the "C" numeric locale,
+    // but possibly from a TBB worker thread. Files over 4GB are parsed by parse_file().
+    bool parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends);
     // Just read the G-code file line by line, calls callback (const char *begin, const char *end). Returns false if reading the file failed.
     bool parse_file_raw(const std::string &file, raw_line_callback_t callback);
 
@@ -157,6 +175,8 @@ private:
     template<typename ParseLineCallback, typename LineEndCallback>
     bool        parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
 
+    // Parse the command and the axes of a line, returns the end of the line. Does not modify the reader state.
+    static const char* tokenize_line(const char *ptr, const char *end, float *axes, uint32_t &mask, std::pair<const char*, const char*> &command);
     const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
     void        update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command);
 
@@ -178,8 +198,8 @@ private:
     GCodeConfig m_config;
     float       m_position[NUM_AXES];
     bool        m_verbose;
-    // To be set by the callback to stop parsing.
-    bool        m_parsing{ false };
+    // To be set by the callback to stop parsing. Read by the block producer of parse_file_parallel() on another thread.
+    std::atomic<bool> m_parsing{ false };
 };
 
 } /* namespace Slic3r */
@@ -19,12 +19,12 @@ inline double vsize2_with_unscale(const Point pt)
     return dot_with_unscale(pt, pt);
 }
 
-MinimumSpanningTree::MinimumSpanningTree(std::vector<Point> vertices) : adjacency_graph(prim(vertices))
+MinimumSpanningTree::MinimumSpanningTree(Points vertices) : adjacency_graph(prim(vertices))
 {
     //Just copy over the fields.
 }
 
-auto MinimumSpanningTree::prim(std::vector<Point> vertices) const -> AdjacencyGraph_t
+auto MinimumSpanningTree::prim(Points vertices) const -> AdjacencyGraph_t
 {
     AdjacencyGraph_t result;
     if (vertices.empty())
@@ -41,7 +41,7 @@ auto MinimumSpanningTree::prim(std::vector<Point> vertices) const -> AdjacencyGr
         return result;
     }
     result.reserve(vertices.size());
-    std::vector<Point> vertices_list(vertices.begin(), vertices.end());
+    Points vertices_list(vertices.begin(), vertices.end());
 
     std::unordered_map<const Point*, coordf_t> smallest_distance;    //The shortest distance to the current tree.
     std::unordered_map<const Point*, const Point*> smallest_distance_to; //Which point the shortest distance goes towards.
@@ -98,9 +98,9 @@ auto MinimumSpanningTree::prim(std::vector<Point> vertices) const -> AdjacencyGr
     return result;
 }
 
-std::vector<Point> MinimumSpanningTree::adjacent_nodes(Point node) const
+Points MinimumSpanningTree::adjacent_nodes(Point node) const
 {
-    std::vector<Point> result;
+    Points result;
     AdjacencyGraph_t::const_iterator adjacency_entry = adjacency_graph.find(node);
     if (adjacency_entry != adjacency_graph.end())
     {
@@ -111,9 +111,9 @@ std::vector<Point> MinimumSpanningTree::adjacent_nodes(Point node) const
     return result;
 }
 
-std::vector<Point> MinimumSpanningTree::leaves() const
+Points MinimumSpanningTree::leaves() const
 {
-    std::vector<Point> result;
+    Points result;
     for (std::pair<Point, std::vector<Edge>> node : adjacency_graph)
     {
         if (node.second.size() <= 1) //Leaves are nodes that have only one adjacent edge, or just the one node if the tree contains one node.
@@ -124,9 +124,9 @@ std::vector<Point> MinimumSpanningTree::leaves() const
     return result;
 }
 
-std::vector<Point> MinimumSpanningTree::vertices() const
+Points MinimumSpanningTree::vertices() const
 {
-    std::vector<Point> result;
+    Points result;
     using MapValue = std::pair<Point, std::vector<Edge>>;
     std::transform(adjacency_graph.begin(), adjacency_graph.end(), std::back_inserter(result),
                    [](const MapValue& node) { return node.first; });
@@ -39,25 +39,25 @@ public:
     /*!
      * \brief Constructs a minimum spanning tree that spans all given vertices.
      */
-    MinimumSpanningTree(std::vector<Point> vertices);
+    MinimumSpanningTree(Points vertices);
 
     /*!
      * \brief Gets the nodes that are adjacent to the specified node.
      * \return A list of nodes that are adjacent.
      */
-    std::vector<Point> adjacent_nodes(Point node) const;
+    Points adjacent_nodes(Point node) const;
 
     /*!
      * \brief Gets the leaves of the tree.
      * \return A list of nodes that are all leaves of the tree.
      */
-    std::vector<Point> leaves() const;
+    Points leaves() const;
 
     /*!
      * \brief Gets all vertices of the tree.
      * \return A list of vertices of the tree.
      */
-    std::vector<Point> vertices() const;
+    Points vertices() const;
 
 private:
     using AdjacencyGraph_t = std::unordered_map<Point, std::vector<Edge>, PointHash>;
@@ -70,7 +70,7 @@ private:
      * \param vertices The vertices to span.
      * \return An adjacency graph with for each point one or more edges.
      */
-    AdjacencyGraph_t prim(std::vector<Point> vertices) const;
+    AdjacencyGraph_t prim(Points vertices) const;
 };
 
 }
@@ -1546,10 +1546,9 @@ void PerimeterGenerator::process_classic()
         // collapse too narrow infill areas
         coord_t min_perimeter_infill_spacing = coord_t(solid_infill_spacing * (1. - INSET_OVERLAP_TOLERANCE));
 
-        ExPolygons infill_exp = offset2_ex(
-            not_filled_exp,
-            float(-inset - min_perimeter_infill_spacing / 2.),
-            float(min_perimeter_infill_spacing / 2.));
+        // The infill and the no-overlap infill share the inner offset of not_filled_exp.
+        Polygons not_filled_shrunk = offset(not_filled_exp, float(-inset - min_perimeter_infill_spacing / 2.));
+        ExPolygons infill_exp = offset_ex(not_filled_shrunk, float(min_perimeter_infill_spacing / 2.));
         // append infill areas to fill_surfaces
         //if any top_fills, grow them by ext_perimeter_spacing/2 to have the real un-anchored fill
         ExPolygons top_infill_exp = intersection_ex(fill_clip, offset_ex(top_fills, double(ext_perimeter_spacing / 2)));
@@ -1562,9 +1561,8 @@ void PerimeterGenerator::process_classic()
         {
             ExPolygons polyWithoutOverlap;
             if (min_perimeter_infill_spacing / 2 > infill_peri_overlap)
-                polyWithoutOverlap = offset2_ex(
-                    not_filled_exp,
-                    float(-inset - min_perimeter_infill_spacing / 2.),
+                polyWithoutOverlap = offset_ex(
+                    not_filled_shrunk,
                     float(min_perimeter_infill_spacing / 2 - infill_peri_overlap));
             else
                 polyWithoutOverlap = offset_ex(
@@ -1606,9 +1604,11 @@ void PerimeterGenerator::add_infill_contour_for_arachne( ExPolygons        infil
     for (ExPolygon &ex : infill_contour)
         ex.simplify_p(m_scaled_resolution, &inner_pp);
 
-    this->fill_surfaces->append(offset2_ex(union_ex(inner_pp), float(-min_perimeter_infill_spacing / 2.), float(insert + min_perimeter_infill_spacing / 2.)), stInternal);
+    // Both the infill and the no-overlap infill share the inner offset.
+    Polygons inner_shrunk = offset(union_ex(inner_pp), float(-min_perimeter_infill_spacing / 2.));
+    this->fill_surfaces->append(offset_ex(inner_shrunk, float(insert + min_perimeter_infill_spacing / 2.)), stInternal);
 
-    append(*this->fill_no_overlap, offset2_ex(union_ex(inner_pp), float(-min_perimeter_infill_spacing / 2.), float(+min_perimeter_infill_spacing / 2.)));
+    append(*this->fill_no_overlap, offset_ex(inner_shrunk, float(+min_perimeter_infill_spacing / 2.)));
 }
 
 // Thanks, Cura developers, for implementing an algorithm for generating perimeters with variable width (Arachne) that is based on the paper
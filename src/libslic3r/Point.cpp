@@ -5,8 +5,68 @@
 #include "BoundingBox.hpp"
 #include <algorithm>
 
+#ifdef SLIC3R_POINTS_ALLOCATOR
+#include <atomic>
+#include <deque>
+#include <mutex>
+#endif // SLIC3R_POINTS_ALLOCATOR
+
 namespace Slic3r {
 
+#ifdef SLIC3R_POINTS_ALLOCATOR
+// Counted by each thread into its own counters, so that the counting does not contend for a shared cache line.
+// The counters are atomic only to be read by points_allocations() from another thread.
+struct PointsAllocationCounters
+{
+    std::atomic<size_t> count { 0 };
+    std::atomic<size_t> bytes { 0 };
+};
+// Counters of all the threads which ever allocated Points. A deque does not move its elements when growing,
+// thus a thread keeps a pointer to its counters and locks the mutex only when registering them.
+struct PointsAllocationRegistry
+{
+    std::mutex                           mutex;
+    std::deque<PointsAllocationCounters> counters;
+};
+// Constructed on the first use, as static Points of other translation units may be allocated first,
+// and never destroyed, as static Points may be freed last.
+static PointsAllocationRegistry& points_allocation_registry()
+{
+    static PointsAllocationRegistry *registry = new PointsAllocationRegistry;
+    return *registry;
+}
+
+void count_points_allocation(size_t bytes)
+{
+    thread_local PointsAllocationCounters *counters = nullptr;
+    if (counters == nullptr) {
+        PointsAllocationRegistry   &registry = points_allocation_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        counters = &registry.counters.emplace_back();
+    }
+    counters->count.store(counters->count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    counters->bytes.store(counters->bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+}
+
+// May be called from any thread, also while the other threads allocate Points.
+PointsAllocations points_allocations()
+{
+    PointsAllocations           out;
+    PointsAllocationRegistry   &registry = points_allocation_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const PointsAllocationCounters &counters : registry.counters) {
+        out.count += counters.count.load(std::memory_order_relaxed);
+        out.bytes += counters.bytes.load(std::memory_order_relaxed);
+    }
+    return out;
+}
+#else // SLIC3R_POINTS_ALLOCATOR
+PointsAllocations points_allocations()
+{
+    return {};
+}
+#endif // SLIC3R_POINTS_ALLOCATOR
+
 std::vector<Vec3f> transform(const std::vector<Vec3f>& points, const Transform3f& t)
 {
     unsigned int vertices_count = (unsigned int)points.size();
@@ -179,7 +239,7 @@ Point Point::projection_onto(const Line &line) const
     return ((line.a - *this).cast<double>().squaredNorm() < (line.b - *this).cast<double>().squaredNorm()) ? line.a : line.b;
 }
 
-bool has_duplicate_points(std::vector<Point> &&pts)
+bool has_duplicate_points(Points &&pts)
 {
     std::sort(pts.begin(), pts.end());
     for (size_t i = 1; i < pts.size(); ++ i)
@@ -10,6 +10,10 @@
 #include <unordered_map>
 #include <Eigen/Geometry>
 
+#ifdef SLIC3R_POINTS_ALLOCATOR
+#include <oneapi/tbb/scalable_allocator.h>
+#endif // SLIC3R_POINTS_ALLOCATOR
+
 #include "LocalesUtils.hpp"
 
 namespace Slic3r {
@@ -48,7 +52,52 @@ using Vec3d   = Eigen::Matrix<double,   3, 1, Eigen::DontAlign>;
 using Vec4f   = Eigen::Matrix<float,    4, 1, Eigen::DontAlign>;
 using Vec4d   = Eigen::Matrix<double,   4, 1, Eigen::DontAlign>;
 
-using Points         = std::vector<Point>;
+#ifdef SLIC3R_POINTS_ALLOCATOR
+void count_points_allocation(size_t bytes);
+
+// Allocator of Points, enabled by the SLIC3R_POINTS_ALLOCATOR build option.
+// The thread caching scalable allocator serves the Polygons, Polylines and ExPolygons created and destroyed
+// by the layers processed in parallel without contending for the global heap. The allocations are counted per thread.
+template<typename T>
+class PointsAllocator : public tbb::scalable_allocator<T>
+{
+public:
+    template<typename U> struct rebind { using other = PointsAllocator<U>; };
+
+    PointsAllocator() noexcept = default;
+    template<typename U> PointsAllocator(const PointsAllocator<U> &) noexcept {}
+
+    T* allocate(size_t n, const void * /* hint */ = nullptr)
+    {
+        count_points_allocation(n * sizeof(T));
+        return tbb::scalable_allocator<T>::allocate(n);
+    }
+};
+
+template<typename T, typename U>
+inline bool operator==(const PointsAllocator<T> &, const PointsAllocator<U> &) noexcept { return true; }
+template<typename T, typename U>
+inline bool operator!=(const PointsAllocator<T> &, const PointsAllocator<U> &) noexcept { return false; }
+#else // SLIC3R_POINTS_ALLOCATOR
+template<typename T>
+using PointsAllocator = std::allocator<T>;
+#endif // SLIC3R_POINTS_ALLOCATOR
+
+struct PointsAllocations
+{
+    size_t count { 0 };
+    size_t bytes { 0 };
+
+    // Allocations made between the two snapshots.
+    PointsAllocations operator-(const PointsAllocations &rhs) const { return { count - rhs.count, bytes - rhs.bytes }; }
+};
+// Points allocated by all threads since the start of the application, always zero without SLIC3R_POINTS_ALLOCATOR.
+PointsAllocations points_allocations();
+
+using Points         = std::vector<Point, PointsAllocator<Point>>;
+// Vector of PointType, allocated as Points if PointType is Point.
+template<typename PointType>
+using PointsOf       = std::vector<PointType, std::conditional_t<std::is_same_v<PointType, Point>, PointsAllocator<PointType>, std::allocator<PointType>>>;
 using PointPtrs      = std::vector<Point*>;
 using PointConstPtrs = std::vector<const Point*>;
 using Points3        = std::vector<Vec3crd>;
@@ -310,16 +359,16 @@ BoundingBoxf get_extents(const std::vector<Vec2d> &pts);
 
 // Test for duplicate points in a vector of points.
 // The points are copied, sorted and checked for duplicates globally.
-bool        has_duplicate_points(std::vector<Point> &&pts);
-inline bool has_duplicate_points(const std::vector<Point> &pts)
+bool        has_duplicate_points(Points &&pts);
+inline bool has_duplicate_points(const Points &pts)
 {
-    std::vector<Point> cpy = pts;
+    Points cpy = pts;
     return has_duplicate_points(std::move(cpy));
 }
 
 // Test for duplicate points in a vector of points.
 // Only successive points are checked for equality.
-inline bool has_duplicate_successive_points(const std::vector<Point> &pts)
+inline bool has_duplicate_successive_points(const Points &pts)
 {
     for (size_t i = 1; i < pts.size(); ++ i)
         if (pts[i - 1] == pts[i])
@@ -329,7 +378,7 @@ inline bool has_duplicate_successive_points(const std::vector<Point> &pts)
 
 // Test for duplicate points in a vector of points.
 // Only successive points are checked for equality. Additionally, first and last points are compared for equality.
-inline bool has_duplicate_successive_points_closed(const std::vector<Point> &pts)
+inline bool has_duplicate_successive_points_closed(const Points &pts)
 {
     return has_duplicate_successive_points(pts) || (pts.size() >= 2 && pts.front() == pts.back());
 }
@@ -440,7 +440,7 @@ bool has_duplicate_points(const Polygons &polys)
     size_t cnt = 0;
     for (const Polygon &poly : polys)
         cnt += poly.points.size();
-    std::vector<Point> allpts;
+    Points allpts;
     allpts.reserve(cnt);
     for (const Polygon &poly : polys)
         allpts.insert(allpts.end(), poly.points.begin(), poly.points.end());
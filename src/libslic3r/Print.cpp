@@ -9,6 +9,7 @@
 #include "I18N.hpp"
 #include "ShortestPath.hpp"
 #include "Support/SupportMaterial.hpp"
+#include "Support/TreeModelVolumes.hpp"
 #include "Thread.hpp"
 #include "Time.hpp"
 #include "GCode.hpp"
@@ -16,13 +17,18 @@
 #include "Utils.hpp"
 #include "PrintConfig.hpp"
 #include "Model.hpp"
+#include "Format/SliceCache.hpp"
 #include <float.h>
 
 #include <algorithm>
 #include <limits>
+#include <string_view>
+#include <unordered_map>
 #include <unordered_set>
+#include <atomic>
 #include <boost/filesystem/path.hpp>
 #include <boost/format.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/fstream.hpp>
 
@@ -64,6 +70,8 @@ void Print::clear()
 	m_objects.clear();
     m_print_regions.clear();
     m_model.clear_objects();
+    // The tree support caches retained for a later support generation of the objects deleted.
+    TreeSupport3D::TreeModelVolumes::clear_retained_caches(this);
 }
 
 // Called by Print::apply().
@@ -1510,6 +1518,47 @@ void  PrintObject::copy_layers_overhang_from_shared_object()
     }
 }
 
+PrintObject::Counters PrintObject::counters() const
+{
+    Counters counters;
+    counters.layers         = m_layers.size();
+    counters.support_layers = m_support_layers.size();
+    counters.regions        = m_shared_regions ? this->num_printing_regions() : 0;
+    for (const Layer *layer : m_layers) {
+        counters.layer_regions += layer->regions().size();
+        for (const ExPolygon &expoly : layer->lslices)
+            counters.polygons += expoly.num_contours();
+    }
+    return counters;
+}
+
+const char* print_step_name(PrintStep step)
+{
+    switch (step) {
+    case psWipeTower:       return "wipe_tower";
+    case psSkirtBrim:       return "skirt_brim";
+    case psGCodeExport:     return "gcode_export";
+    case psConflictCheck:   return "conflict_check";
+    default:                return "unknown";
+    }
+}
+
+const char* print_object_step_name(PrintObjectStep step)
+{
+    switch (step) {
+    case posSlice:                  return "slice";
+    case posPerimeters:             return "perimeters";
+    case posPrepareInfill:          return "prepare_infill";
+    case posInfill:                 return "infill";
+    case posIroning:                return "ironing";
+    case posSupportMaterial:        return "support_material";
+    case posDetectOverhangsForLift: return "detect_overhangs_for_lift";
+    case posSimplifyWall:           return "simplify_wall";
+    case posSimplifyInfill:         return "simplify_infill";
+    case posSimplifySupportPath:    return "simplify_support_path";
+    default:                        return "unknown";
+    }
+}
 
 // BBS
 BoundingBox PrintObject::get_first_layer_bbox(float& a, float& layer_height, std::string& name)
@@ -1560,6 +1609,128 @@ std::map<ObjectID, unsigned int> getObjectExtruderMap(const Print& print) {
     return objectExtruderMap;
 }
 
+// Hash of what determines the layers of a PrintObject: the object transformation without the XY shift of its instances,
+// the meshes, transformations, configs and paintings of its volumes, the layer height modifiers and the resolved region configs.
+// The hashes of the meshes are cached, as the copies of an object usually share their mesh.
+static size_t print_object_content_hash(const PrintObject &print_object, std::unordered_map<const TriangleMesh*, size_t> &mesh_hashes)
+{
+    auto hash_matrix = [](size_t &seed, const Transform3d &trafo) {
+        for (int i = 0; i < 16; ++ i)
+            boost::hash_combine(seed, std::hash<double>{}(trafo.data()[i]));
+    };
+    auto hash_config = [](size_t &seed, const DynamicPrintConfig &config) {
+        for (auto it = config.cbegin(); it != config.cend(); ++ it) {
+            boost::hash_combine(seed, it->first);
+            boost::hash_combine(seed, it->second->hash());
+        }
+    };
+    auto hash_facets = [](size_t &seed, const FacetsAnnotation &facets) {
+        const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> &data = facets.get_data();
+        for (const std::pair<int, int> &triangle : data.first) {
+            boost::hash_combine(seed, triangle.first);
+            boost::hash_combine(seed, triangle.second);
+        }
+        boost::hash_combine(seed, std::hash<std::vector<bool>>{}(data.second));
+    };
+    auto hash_mesh = [&mesh_hashes](const TriangleMesh *mesh) {
+        auto it = mesh_hashes.find(mesh);
+        if (it == mesh_hashes.end()) {
+            const indexed_triangle_set &its = mesh->its;
+            size_t seed = std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(its.vertices.data()), its.vertices.size() * sizeof(stl_vertex)));
+            boost::hash_combine(seed, std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(its.indices.data()), its.indices.size() * sizeof(stl_triangle_vertex_indices))));
+            it = mesh_hashes.emplace(mesh, seed).first;
+        }
+        return it->second;
+    };
+
+    const ModelObject &model_object = *print_object.model_object();
+    size_t seed = 0;
+    hash_matrix(seed, print_object.trafo());
+    hash_config(seed, model_object.config.get());
+    for (const ModelVolume *model_volume : model_object.volumes) {
+        boost::hash_combine(seed, int(model_volume->type()));
+        boost::hash_combine(seed, hash_mesh(model_volume->mesh_ptr()));
+        hash_matrix(seed, model_volume->get_matrix());
+        hash_config(seed, model_volume->config.get());
+        hash_facets(seed, model_volume->supported_facets);
+        hash_facets(seed, model_volume->seam_facets);
+        hash_facets(seed, model_volume->mmu_segmentation_facets);
+    }
+    for (coordf_t z : model_object.layer_height_profile.get())
+        boost::hash_combine(seed, std::hash<double>{}(z));
+    for (const auto &range_and_config : model_object.layer_config_ranges) {
+        boost::hash_combine(seed, std::hash<double>{}(range_and_config.first.first));
+        boost::hash_combine(seed, std::hash<double>{}(range_and_config.first.second));
+        hash_config(seed, range_and_config.second.get());
+    }
+    for (size_t region_id = 0; region_id < print_object.num_printing_regions(); ++ region_id)
+        boost::hash_combine(seed, print_object.printing_region(region_id).config_hash());
+    return seed;
+}
+
+// Whether object2 may share the layers of object1, see print_object_content_hash().
+static bool is_print_object_the_same(const PrintObject* object1, const PrintObject* object2)
+{
+    if (object1->trafo().matrix() != object2->trafo().matrix())
+        return false;
+    const ModelObject* model_obj1 = object1->model_object();
+    const ModelObject* model_obj2 = object2->model_object();
+    if (model_obj1->volumes.size() != model_obj2->volumes.size())
+        return false;
+    bool has_extruder1 = model_obj1->config.has("extruder");
+    bool has_extruder2 = model_obj2->config.has("extruder");
+    if ((has_extruder1 != has_extruder2)
+        || (has_extruder1 && model_obj1->config.extruder() != model_obj2->config.extruder()))
+        return false;
+    for (int index = 0; index < model_obj1->volumes.size(); index++) {
+        const ModelVolume &model_volume1 = *model_obj1->volumes[index];
+        const ModelVolume &model_volume2 = *model_obj2->volumes[index];
+        if (model_volume1.type() != model_volume2.type())
+            return false;
+        if (model_volume1.mesh_ptr() != model_volume2.mesh_ptr()) {
+            const indexed_triangle_set &its1 = model_volume1.mesh().its;
+            const indexed_triangle_set &its2 = model_volume2.mesh().its;
+            if (its1.vertices != its2.vertices || its1.indices != its2.indices)
+                return false;
+        }
+        if (!(model_volume1.get_transformation() == model_volume2.get_transformation()))
+            return false;
+        has_extruder1 = model_volume1.config.has("extruder");
+        has_extruder2 = model_volume2.config.has("extruder");
+        if ((has_extruder1 != has_extruder2)
+            || (has_extruder1 && model_volume1.config.extruder() != model_volume2.config.extruder()))
+            return false;
+        if (!model_volume1.supported_facets.equals(model_volume2.supported_facets))
+            return false;
+        if (!model_volume1.seam_facets.equals(model_volume2.seam_facets))
+            return false;
+        if (!model_volume1.mmu_segmentation_facets.equals(model_volume2.mmu_segmentation_facets))
+            return false;
+        if (model_volume1.config.get() != model_volume2.config.get())
+            return false;
+    }
+    //if (!object1->config().equals(object2->config()))
+    //    return false;
+    if (model_obj1->config.get() != model_obj2->config.get())
+        return false;
+    if (model_obj1->layer_height_profile.get() != model_obj2->layer_height_profile.get())
+        return false;
+    if (model_obj1->layer_config_ranges.size() != model_obj2->layer_config_ranges.size())
+        return false;
+    for (auto it1 = model_obj1->layer_config_ranges.begin(), it2 = model_obj2->layer_config_ranges.begin(); it1 != model_obj1->layer_config_ranges.end(); ++ it1, ++ it2)
+        if (it1->first != it2->first || it1->second.get() != it2->second.get())
+            return false;
+    if (object1->num_printing_regions() != object2->num_printing_regions())
+        return false;
+    for (size_t region_id = 0; region_id < object1->num_printing_regions(); ++ region_id) {
+        const PrintRegion &region1 = object1->printing_region(region_id);
+        const PrintRegion &region2 = object2->printing_region(region_id);
+        if (region1.config_hash() != region2.config_hash() || !(region1.config() == region2.config()))
+            return false;
+    }
+    return true;
+}
+
 // Slicing process, running at a background thread.
 void Print::process(std::unordered_map<std::string, long long>* slice_time, bool use_cache)
 {
@@ -1583,86 +1754,52 @@ void Print::process(std::unordered_map<std::string, long long>* slice_time, bool
         obj->clear_shared_object();
 
     //add the print_object share check logic
-    auto is_print_object_the_same = [this](const PrintObject* object1, const PrintObject* object2) -> bool{
-        if (object1->trafo().matrix() != object2->trafo().matrix())
-            return false;
-        const ModelObject* model_obj1 = object1->model_object();
-        const ModelObject* model_obj2 = object2->model_object();
-        if (model_obj1->volumes.size() != model_obj2->volumes.size())
-            return false;
-        bool has_extruder1 = model_obj1->config.has("extruder");
-        bool has_extruder2 = model_obj2->config.has("extruder");
-        if ((has_extruder1 != has_extruder2)
-            || (has_extruder1 && model_obj1->config.extruder() != model_obj2->config.extruder()))
-            return false;
-        for (int index = 0; index < model_obj1->volumes.size(); index++) {
-            const ModelVolume &model_volume1 = *model_obj1->volumes[index];
-            const ModelVolume &model_volume2 = *model_obj2->volumes[index];
-            if (model_volume1.type() != model_volume2.type())
-                return false;
-            if (model_volume1.mesh_ptr() != model_volume2.mesh_ptr())
-                return false;
-            if (!(model_volume1.get_transformation() == model_volume2.get_transformation()))
-                return false;
-            has_extruder1 = model_volume1.config.has("extruder");
-            has_extruder2 = model_volume2.config.has("extruder");
-            if ((has_extruder1 != has_extruder2)
-                || (has_extruder1 && model_volume1.config.extruder() != model_volume2.config.extruder()))
-                return false;
-            if (!model_volume1.supported_facets.equals(model_volume2.supported_facets))
-                return false;
-            if (!model_volume1.seam_facets.equals(model_volume2.seam_facets))
-                return false;
-            if (!model_volume1.mmu_segmentation_facets.equals(model_volume2.mmu_segmentation_facets))
-                return false;
-            if (model_volume1.config.get() != model_volume2.config.get())
-                return false;
-        }
-        //if (!object1->config().equals(object2->config()))
-        //    return false;
-        if (model_obj1->config.get() != model_obj2->config.get())
-            return false;
-        return true;
+    //BBS: objects are bucketed by their content hash, so that a plate of many copies is grouped in linear time
+    //and copies loaded with their own meshes (for example from a 3MF) share the layers of the first copy as well.
+    std::unordered_map<const TriangleMesh*, size_t> mesh_hashes;
+    std::unordered_map<size_t, std::vector<PrintObject*>> slicing_objects_by_hash;
+    auto find_shared_object = [&slicing_objects_by_hash](const PrintObject *obj, size_t hash) -> PrintObject* {
+        auto it = slicing_objects_by_hash.find(hash);
+        if (it != slicing_objects_by_hash.end())
+            for (PrintObject *slicing_obj : it->second)
+                if (is_print_object_the_same(obj, slicing_obj))
+                    return slicing_obj;
+        return nullptr;
     };
     int object_count = m_objects.size();
+    std::vector<size_t> object_hashes(object_count);
+    for (int index = 0; index < object_count; index++)
+        object_hashes[index] = print_object_content_hash(*m_objects[index], mesh_hashes);
     std::set<PrintObject*> need_slicing_objects;
     std::set<PrintObject*> re_slicing_objects;
     if (!use_cache) {
         for (int index = 0; index < object_count; index++)
         {
             PrintObject *obj =  m_objects[index];
-            for (PrintObject *slicing_obj : need_slicing_objects)
-            {
-                if (is_print_object_the_same(obj, slicing_obj)) {
-                    obj->set_shared_object(slicing_obj);
-                    break;
-                }
-            }
-            if (!obj->get_shared_object())
+            if (PrintObject *slicing_obj = find_shared_object(obj, object_hashes[index]); slicing_obj)
+                obj->set_shared_object(slicing_obj);
+            else {
                 need_slicing_objects.insert(obj);
+                slicing_objects_by_hash[object_hashes[index]].emplace_back(obj);
+            }
         }
     }
     else {
         for (int index = 0; index < object_count; index++)
         {
             PrintObject *obj =  m_objects[index];
-            if (obj->layer_count() > 0)
+            if (obj->layer_count() > 0) {
                 need_slicing_objects.insert(obj);
+                slicing_objects_by_hash[object_hashes[index]].emplace_back(obj);
+            }
         }
         for (int index = 0; index < object_count; index++)
         {
             PrintObject *obj =  m_objects[index];
-            bool found_shared = false;
             if (need_slicing_objects.find(obj) == need_slicing_objects.end()) {
-                for (PrintObject *slicing_obj : need_slicing_objects)
-                {
-                    if (is_print_object_the_same(obj, slicing_obj)) {
-                        obj->set_shared_object(slicing_obj);
-                        found_shared = true;
-                        break;
-                    }
-                }
-                if (!found_shared) {
+                if (PrintObject *slicing_obj = find_shared_object(obj, object_hashes[index]); slicing_obj)
+                    obj->set_shared_object(slicing_obj);
+                else {
                     BOOST_LOG_TRIVIAL(warning) << boost::format("Also can not find the shared object, identify_id %1%, maybe shared object is skipped")%obj->model_object()->instances[0]->loaded_id;
                     //throw Slic3r::SlicingError("Can not find the cached data.");
                     //don't report errot, set use_cache to false, and reslice these objects
@@ -1684,8 +1821,9 @@ void Print::process(std::unordered_map<std::string, long long>* slice_time, bool
             start_time = (long long)Slic3r::Utils::get_current_milliseconds_time_utc();
         }
 
-
-        for (PrintObject* obj : m_objects) {
+        // Time when the last object finished its perimeters, to split the wall time between perimeters and infill.
+        std::atomic<long long> perimeters_end_time(start_time);
+        auto process_object = [&need_slicing_objects, &perimeters_end_time, slice_time](PrintObject *obj) {
             if (need_slicing_objects.count(obj) != 0) {
                 obj->make_perimeters();
             }
@@ -1695,45 +1833,63 @@ void Print::process(std::unordered_map<std::string, long long>* slice_time, bool
                 if (obj->set_started(posPerimeters))
                     obj->set_done(posPerimeters);
             }
-        }
 
-        if (slice_time) {
-            end_time = (long long)Slic3r::Utils::get_current_milliseconds_time_utc();
-            (*slice_time)[TIME_MAKE_PERIMETERS] = (*slice_time)[TIME_MAKE_PERIMETERS] + end_time - start_time;
-            start_time = (long long)Slic3r::Utils::get_current_milliseconds_time_utc();
-        }
+            if (slice_time) {
+                long long end_time = (long long)Slic3r::Utils::get_current_milliseconds_time_utc();
+                for (long long last = perimeters_end_time.load(); last < end_time && ! perimeters_end_time.compare_exchange_weak(last, end_time); ) ;
+            }
 
-        for (PrintObject *obj : m_objects) {
             if (need_slicing_objects.count(obj) != 0) {
                 obj->infill();
+                obj->ironing();
             }
             else {
                 if (obj->set_started(posPrepareInfill))
                     obj->set_done(posPrepareInfill);
                 if (obj->set_started(posInfill))
                     obj->set_done(posInfill);
+                if (obj->set_started(posIroning))
+                    obj->set_done(posIroning);
             }
+        };
+
+#ifdef SLIC3R_POINTS_ALLOCATOR
+        PointsAllocations points_alloc_start = points_allocations();
+#endif // SLIC3R_POINTS_ALLOCATOR
+        if (m_parallel_objects) {
+            // An object depends on its own perimeters only, thus the objects are chained through perimeters, infill and ironing
+            // independently of each other. The layer loops inside the steps are nested into the loop over the objects,
+            // so that the scheduler balances plates of many small objects as well as plates of a single large one.
+            // A cancellation or an error thrown by a step cancels the remaining work and is rethrown here.
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1),
+                [this, &process_object](const tbb::blocked_range<size_t>& range) {
+                    for (size_t i = range.begin(); i < range.end(); ++ i)
+                        process_object(m_objects[i]);
+                });
+        } else {
+            for (PrintObject *obj : m_objects)
+                process_object(obj);
         }
 
+#ifdef SLIC3R_POINTS_ALLOCATOR
+        // The object steps may run concurrently, thus their Points allocations are only reported here, once all of them finished.
+        PointsAllocations points_alloc = points_allocations() - points_alloc_start;
+        BOOST_LOG_TRIVIAL(info) << boost::format("Walls, infill and ironing allocated %1% Points (%2%)") % points_alloc.count % format_memsize_MB(points_alloc.bytes);
+#endif // SLIC3R_POINTS_ALLOCATOR
+
         if (slice_time) {
             end_time = (long long)Slic3r::Utils::get_current_milliseconds_time_utc();
-            (*slice_time)[TIME_INFILL] = (*slice_time)[TIME_INFILL] + end_time - start_time;
-        }
-
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->ironing();
-            }
-            else {
-                if (obj->set_started(posIroning))
-                    obj->set_done(posIroning);
-            }
+            (*slice_time)[TIME_MAKE_PERIMETERS] = (*slice_time)[TIME_MAKE_PERIMETERS] + perimeters_end_time.load() - start_time;
+            (*slice_time)[TIME_INFILL] = (*slice_time)[TIME_INFILL] + end_time - perimeters_end_time.load();
         }
 
         if (slice_time) {
             start_time = (long long)Slic3r::Utils::get_current_milliseconds_time_utc();
         }
 
+#ifdef SLIC3R_POINTS_ALLOCATOR
+        points_alloc_start = points_allocations();
+#endif // SLIC3R_POINTS_ALLOCATOR
         tbb::parallel_for(tbb::blocked_range<int>(0, int(m_objects.size())),
             [this, need_slicing_objects](const tbb::blocked_range<int>& range) {
                 for (int i = range.begin(); i < range.end(); i++) {
@@ -1749,6 +1905,11 @@ void Print::process(std::unordered_map<std::string, long long>* slice_time, bool
             }
         );
 
+#ifdef SLIC3R_POINTS_ALLOCATOR
+        points_alloc = points_allocations() - points_alloc_start;
+        BOOST_LOG_TRIVIAL(info) << boost::format("Support material allocated %1% Points (%2%)") % points_alloc.count % format_memsize_MB(points_alloc.bytes);
+#endif // SLIC3R_POINTS_ALLOCATOR
+
         if (slice_time) {
             end_time = (long long)Slic3r::Utils::get_current_milliseconds_time_utc();
             (*slice_time)[TIME_GENERATE_SUPPORT] = (*slice_time)[TIME_GENERATE_SUPPORT] + end_time - start_time;
@@ -1982,9 +2143,15 @@ std::string Print::export_gcode(const std::string& path_template, GCodeProcessor
     //BBS: compute plate offset for gcode-generator
     const Vec3d origin = this->get_plate_origin();
     gcode.set_gcode_offset(origin(0), origin(1));
+    gcode.set_parallel_layer_planning(m_parallel_layer_planning);
+    PrintStepStats stats;
+    stats.start();
     gcode.do_export(this, path.c_str(), result, thumbnail_cb);
+    stats.stop();
+    m_gcode_export_stats = stats;
     //BBS
-    result->conflict_result = m_conflict_result;
+    if (result != nullptr)
+        result->conflict_result = m_conflict_result;
     return path.c_str();
 }
 
@@ -2189,9 +2356,9 @@ Polygons Print::first_layer_islands() const
     return islands;
 }
 
-std::vector<Point> Print::first_layer_wipe_tower_corners(bool check_wipe_tower_existance) const
+Points Print::first_layer_wipe_tower_corners(bool check_wipe_tower_existance) const
 {
-    std::vector<Point> corners;
+    Points corners;
     if (check_wipe_tower_existance && (!has_wipe_tower() || m_wipe_tower_data.tool_changes.empty()))
         return corners;
     {
@@ -3331,7 +3498,55 @@ static void from_json(const json& j, groupedVolumeSlices& firstlayer_group)
     }
 }
 
-int Print::export_cached_data(const std::string& directory, bool with_space)
+// Volume IDs of the first layer groups are stored as indices of the volumes in the ModelObject.
+static std::vector<groupedVolumeSlices> first_layer_groups_to_volume_indices(const PrintObject* obj)
+{
+    std::vector<groupedVolumeSlices> groups = obj->firstLayerObjGroups();
+    for (groupedVolumeSlices& group : groups) {
+        //convert the id
+        for (ObjectID& obj_id : group.volume_ids)
+        {
+            const ModelVolume* currentModelVolumePtr = nullptr;
+            //BBS: support shared object logic
+            const PrintObject* shared_object = obj->get_shared_object();
+            if (!shared_object)
+                shared_object = obj;
+            const ModelVolumePtrs& volumes_ptr = shared_object->model_object()->volumes;
+            size_t volume_count = volumes_ptr.size();
+            for (size_t index = 0; index < volume_count; index ++) {
+                currentModelVolumePtr = volumes_ptr[index];
+                if (currentModelVolumePtr->id() == obj_id) {
+                    obj_id.id = index;
+                    break;
+                }
+            }
+        }
+    }
+    return groups;
+}
+
+// Convert the volume indices stored in the cache back to IDs of the volumes. Returns false on an invalid index.
+static bool first_layer_group_from_volume_indices(PrintObject* obj, groupedVolumeSlices& firstlayer_group, const std::string& file_name)
+{
+    for (ObjectID& obj_id : firstlayer_group.volume_ids)
+    {
+        ModelVolume* currentModelVolumePtr = nullptr;
+        ModelVolumePtrs& volumes_ptr = obj->model_object()->volumes;
+        size_t volume_count = volumes_ptr.size();
+        if (obj_id.id < volume_count) {
+            currentModelVolumePtr = volumes_ptr[obj_id.id];
+            obj_id = currentModelVolumePtr->id();
+        }
+        else {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": can not find volume_id %1% from object file %2% in firstlayer groups, volume_count %3%!")
+                %obj_id.id %file_name %volume_count;
+            return false;
+        }
+    }
+    return true;
+}
+
+int Print::export_cached_data(const std::string& directory, bool with_space, bool binary)
 {
     int ret = 0;
     boost::filesystem::path directory_path(directory);
@@ -3409,6 +3624,21 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         const PrintInstance &print_instance = obj->instances()[0];
         const ModelInstance *model_instance = print_instance.model_instance;
         size_t identify_id = (model_instance->loaded_id > 0)?model_instance->loaded_id: model_instance->id().id;
+
+        if (binary) {
+            std::string file_name = directory + "/obj_" + std::to_string(identify_id) + SliceCache::Extension;
+            BOOST_LOG_TRIVIAL(info) << boost::format("begin to save object %1%, identify_id %2% to %3%")%model_obj->name %identify_id %file_name;
+            try {
+                SliceCache::save(file_name, model_obj->name, identify_id, *obj, first_layer_groups_to_volume_indices(obj));
+                count ++;
+            }
+            catch(std::exception &err) {
+                BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": save to "<<file_name<<" got a generic exception, reason = " << err.what();
+                ret = CLI_EXPORT_CACHE_WRITE_FAILED;
+            }
+            continue;
+        }
+
         std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
 
         BOOST_LOG_TRIVIAL(info) << boost::format("begin to dump object %1%, identify_id %2% to %3%")%model_obj->name %identify_id %file_name;
@@ -3522,29 +3752,7 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
             } // for each layer*/
             root_json[JSON_SUPPORT_LAYERS] = std::move(support_layers_json);
 
-            const std::vector<groupedVolumeSlices> &first_layer_obj_groups =  obj->firstLayerObjGroups();
-            for (size_t s_group_index = 0; s_group_index < first_layer_obj_groups.size(); ++ s_group_index) {
-                groupedVolumeSlices group = first_layer_obj_groups[s_group_index];
-
-                //convert the id
-                for (ObjectID& obj_id : group.volume_ids)
-                {
-                    const ModelVolume* currentModelVolumePtr = nullptr;
-                    //BBS: support shared object logic
-                    const PrintObject* shared_object = obj->get_shared_object();
-                    if (!shared_object)
-                        shared_object = obj;
-                    const ModelVolumePtrs& volumes_ptr = shared_object->model_object()->volumes;
-                    size_t volume_count = volumes_ptr.size();
-                    for (size_t index = 0; index < volume_count; index ++) {
-                        currentModelVolumePtr = volumes_ptr[index];
-                        if (currentModelVolumePtr->id() == obj_id) {
-                            obj_id.id = index;
-                            break;
-                        }
-                    }
-                }
-
+            for (const groupedVolumeSlices &group : first_layer_groups_to_volume_indices(obj)) {
                 json first_layer_group_json;
 
                 first_layer_group_json = group;
@@ -3621,7 +3829,7 @@ int Print::load_cached_data(const std::string& directory)
     };
 
     int count = 0;
-    std::vector<std::pair<std::string, PrintObject*>> object_filenames;
+    std::vector<std::pair<std::string, PrintObject*>> object_filenames, object_binary_filenames;
     for (PrintObject *obj : m_objects) {
         const ModelObject* model_obj = obj->model_object();
         const PrintInstance &print_instance = obj->instances()[0];
@@ -3637,7 +3845,12 @@ int Print::load_cached_data(const std::string& directory)
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": object %1%'s loaded_id is 0, need to use the instance_id %2%")%model_obj->name %identify_id;
             //continue;
         }
-        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        std::string file_name = directory + "/obj_" + std::to_string(identify_id) + SliceCache::Extension;
+        if (fs::exists(file_name)) {
+            object_binary_filenames.push_back({file_name, obj});
+            continue;
+        }
+        file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
 
         if (!fs::exists(file_name)) {
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(": file %1% not exist, maybe a shared object, skip it")%file_name;
@@ -3777,21 +3990,8 @@ int Print::load_cached_data(const std::string& directory)
                 json& firstlayer_group_json = root_json[JSON_FIRSTLAYER_GROUPS][index];
                 groupedVolumeSlices firstlayer_group = firstlayer_group_json;
                 //convert the id
-                for (ObjectID& obj_id : firstlayer_group.volume_ids)
-                {
-                    ModelVolume* currentModelVolumePtr = nullptr;
-                    ModelVolumePtrs& volumes_ptr = obj->model_object()->volumes;
-                    size_t volume_count = volumes_ptr.size();
-                    if (obj_id.id < volume_count) {
-                        currentModelVolumePtr = volumes_ptr[obj_id.id];
-                        obj_id = currentModelVolumePtr->id();
-                    }
-                    else {
-                        BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": can not find volume_id %1% from object file %2% in firstlayer groups, volume_count %3%!")
-                            %obj_id.id %object_filenames[obj_index].first %volume_count;
-                        return CLI_IMPORT_CACHE_LOAD_FAILED;
-                    }
-                }
+                if (!first_layer_group_from_volume_indices(obj, firstlayer_group, object_filenames[obj_index].first))
+                    return CLI_IMPORT_CACHE_LOAD_FAILED;
                 firstlayer_objgroups.push_back(std::move(firstlayer_group));
             }
 
@@ -3810,6 +4010,93 @@ int Print::load_cached_data(const std::string& directory)
 
     object_jsons.clear();
     object_filenames.clear();
+
+    //BBS: binary caches are memory mapped, the layers are decoded in parallel directly from the mapping
+    for (const std::pair<std::string, PrintObject*>& object_filename : object_binary_filenames) {
+        const std::string& file_name = object_filename.first;
+        PrintObject *obj = object_filename.second;
+
+        try {
+            SliceCache::Reader reader(file_name);
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(":will load %1%, identify_id %2%, layer_count %3%, support_layer_count %4%, size %5%")
+                %reader.object_name() %reader.identify_id() %reader.layer_count() %reader.support_layer_count() %reader.size();
+
+            //create layer and layer regions
+            Layer* previous_layer = NULL;
+            for (size_t index = 0; index < reader.layer_count(); index++)
+            {
+                SliceCache::LayerInfo layer_info = reader.layer_info(index);
+                Layer* new_layer = obj->add_layer(layer_info.id, layer_info.height, layer_info.print_z, layer_info.slice_z);
+                if (!new_layer) {
+                    BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":create_layer failed, out of memory");
+                    return CLI_OUT_OF_MEMORY;
+                }
+                if (previous_layer) {
+                    previous_layer->upper_layer = new_layer;
+                    new_layer->lower_layer = previous_layer;
+                }
+                previous_layer = new_layer;
+
+                for (size_t region_index = 0; region_index < layer_info.region_config_hashes.size(); region_index++)
+                {
+                    const PrintRegion *print_region = find_region(obj, layer_info.region_config_hashes[region_index]);
+                    if (!print_region){
+                        BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":can not find print region of object %1%, layer %2%, print_z %3%, layer_region %4%")
+                            %reader.object_name() % index %new_layer->print_z %region_index;
+                        return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+                    }
+                    new_layer->add_region(print_region);
+                }
+            }
+
+            //create support_layers
+            Layer* previous_support_layer = NULL;
+            for (size_t index = 0; index < reader.support_layer_count(); index++)
+            {
+                SliceCache::LayerInfo layer_info = reader.support_layer_info(index);
+                SupportLayer* new_support_layer = obj->add_support_layer(layer_info.id, layer_info.interface_id, layer_info.height, layer_info.print_z);
+                if (!new_support_layer) {
+                    BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":add_support_layer failed, out of memory");
+                    return CLI_OUT_OF_MEMORY;
+                }
+                if (previous_support_layer) {
+                    previous_support_layer->upper_layer = new_support_layer;
+                    new_support_layer->lower_layer = previous_support_layer;
+                }
+                previous_support_layer = new_support_layer;
+            }
+
+            //decode the layers and the support layers in parallel
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, obj->layer_count() + obj->support_layer_count()),
+                [&reader, obj](const tbb::blocked_range<size_t>& layer_range) {
+                    for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
+                        if (layer_index < obj->layer_count())
+                            reader.load_layer(layer_index, *obj->get_layer(int(layer_index)));
+                        else
+                            reader.load_support_layer(layer_index - obj->layer_count(), *obj->get_support_layer(int(layer_index - obj->layer_count())));
+                    }
+                }
+            );
+
+            //load first group volumes
+            std::vector<groupedVolumeSlices>& firstlayer_objgroups = obj->firstLayerObjGroupsMod();
+            for (groupedVolumeSlices& firstlayer_group : reader.first_layer_groups()) {
+                if (!first_layer_group_from_volume_indices(obj, firstlayer_group, file_name))
+                    return CLI_IMPORT_CACHE_LOAD_FAILED;
+                firstlayer_objgroups.push_back(std::move(firstlayer_group));
+            }
+
+            count ++;
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": load object %1% from %2% successfully.")%count%file_name;
+        }
+        catch(std::exception &err) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": load from "<<file_name<<" got a generic exception, reason = " << err.what();
+            ret = CLI_IMPORT_CACHE_LOAD_FAILED;
+        }
+    }
+    object_binary_filenames.clear();
+
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": total printobject count %1%, loaded %2%, ret=%3%")%m_objects.size() %count %ret;
     return ret;
 }
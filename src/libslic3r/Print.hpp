@@ -22,6 +22,7 @@
 #include <Eigen/Geometry>
 
 #include <functional>
+#include <optional>
 #include <set>
 #include "Calib.hpp"
 
@@ -103,6 +104,10 @@ enum PrintObjectStep {
     posCount,
 };
 
+// BBS: names of the steps, as reported with the step statistics by the CLI
+const char* print_step_name(PrintStep step);
+const char* print_object_step_name(PrintObjectStep step);
+
 // A PrintRegion object represents a group of volumes to print
 // sharing the same config (including the same assigned extruder(s))
 class PrintRegion
@@ -434,13 +439,25 @@ public:
     //BBS
     BoundingBox get_first_layer_bbox(float& area, float& layer_height, std::string& name);
     void         get_certain_layers(float start, float end, std::vector<LayerPtrs> &out, std::vector<BoundingBox> &boundingbox_objects);
-    std::vector<Point> get_instances_shift_without_plate_offset();
+    Points get_instances_shift_without_plate_offset();
     PrintObject* get_shared_object() const { return m_shared_object; }
     void         set_shared_object(PrintObject *object);
     void         clear_shared_object();
     void         copy_layers_from_shared_object();
     void         copy_layers_overhang_from_shared_object();
 
+    // BBS: size of the sliced object, reported with the step statistics by the CLI
+    struct Counters {
+        size_t layers           { 0 };
+        size_t support_layers   { 0 };
+        size_t regions          { 0 };
+        // Sum of LayerRegions over all layers.
+        size_t layer_regions    { 0 };
+        // Contours and holes of the layer slices over all layers.
+        size_t polygons         { 0 };
+    };
+    Counters     counters() const;
+
     // BBS: Boundingbox of the first layer
     BoundingBox                 firstLayerObjectBrimBoundingBox;
 
@@ -468,8 +485,15 @@ private:
     bool                    invalidate_all_steps();
     // Invalidate steps based on a set of parameters changed.
     // It may be called for both the PrintObjectConfig and PrintRegionConfig.
+    // BBS: print_object_region_id is the region, which PrintRegionConfig changed, or -1 for the PrintObjectConfig.
+    // Changes of the region options, which only affect the fill generation, then invalidate the fills of that region only.
     bool                    invalidate_state_by_config_options(
-        const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys);
+        const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys,
+        int print_object_region_id = -1);
+    // BBS: Invalidates posInfill and its depending steps, but if the fills were complete, only the layers containing
+    // fill surfaces of the region will be refilled by the next infill() call. Fills of the other layers are kept.
+    bool                    invalidate_fills_of_region(int print_object_region_id);
+    bool                    layer_refilled(size_t layer_idx) const { return m_refilled_layers.empty() || m_refilled_layers[layer_idx]; }
     // If ! m_slicing_params.valid, recalculate.
     void                    update_slicing_parameters();
 
@@ -535,6 +559,13 @@ private:
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
     FillLightning::GeneratorPtr m_lightning_generator;
 
+    // BBS: print_object_region_id() of the regions to be refilled by the next infill() if ! m_refill_all_layers,
+    // see invalidate_fills_of_region().
+    std::vector<int>                        m_refill_regions;
+    bool                                    m_refill_all_layers { true };
+    // Layers refilled by the last infill(), only these are ironed and simplified again. Empty if all layers were refilled.
+    std::vector<unsigned char>              m_refilled_layers;
+
     std::vector < VolumeSlices >            firstLayerObjSliceByVolume;
     std::vector<groupedVolumeSlices>        firstLayerObjSliceByGroups;
 
@@ -724,11 +755,24 @@ public:
     ApplyStatus         apply(const Model &model, DynamicPrintConfig config) override;
 
     void                process(std::unordered_map<std::string, long long>* slice_time = nullptr, bool use_cache = false) override;
+    // BBS: Run the perimeter, infill and ironing steps of the objects concurrently, each object with its layers
+    // in parallel, instead of one object after the other. The result is the same, the switch is kept
+    // for comparing against the serial path.
+    void                set_parallel_objects(bool enable) { m_parallel_objects = enable; }
+    bool                parallel_objects() const { return m_parallel_objects; }
+    // BBS: Group the extrusions of the upcoming layers on worker threads while exporting G-code, see GCode::set_parallel_layer_planning().
+    void                set_parallel_layer_planning(bool enable) { m_parallel_layer_planning = enable; }
+    bool                parallel_layer_planning() const { return m_parallel_layer_planning; }
     // Exports G-code into a file name based on the path_template, returns the file path of the generated G-code file.
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
     std::string         export_gcode(const std::string& path_template, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
+    // BBS: Resources consumed by the last export_gcode(), empty if the G-code was not exported yet.
+    // psGCodeExport only marks a G-code file being ready, it is not timed by the export itself.
+    const std::optional<PrintStepStats>& gcode_export_stats() const { return m_gcode_export_stats; }
     //return 0 means successful
-    int                 export_cached_data(const std::string& dir_path, bool with_space=false);
+    //BBS: binary writes the memory mappable SliceCache container, otherwise the layers are dumped into JSON,
+    //with_space only applies to the JSON dump. load_cached_data() prefers the binary cache if both exist.
+    int                 export_cached_data(const std::string& dir_path, bool with_space=false, bool binary=true);
     int                 load_cached_data(const std::string& directory);
 
     // methods for handling state
@@ -835,7 +879,7 @@ public:
     static StringObjectException sequential_print_clearance_valid(const Print &print, Polygons *polygons = nullptr, std::vector<std::pair<Polygon, float>>* height_polygons = nullptr);
 
     // Return 4 wipe tower corners in the world coordinates (shifted and rotated), including the wipe tower brim.
-    std::vector<Point>  first_layer_wipe_tower_corners(bool check_wipe_tower_existance=true) const;
+    Points  first_layer_wipe_tower_corners(bool check_wipe_tower_existance=true) const;
     //OrcaSlicer
     CalibMode &         calib_mode() { return m_calib_params.mode; }
     const CalibMode&    calib_mode() const { return m_calib_params.mode; }
@@ -905,6 +949,9 @@ private:
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
     bool                                    m_support_used {false};
+    bool                                    m_parallel_objects {true};
+    bool                                    m_parallel_layer_planning {true};
+    std::optional<PrintStepStats>           m_gcode_export_stats;
 
     //BBS: plate's origin
     Vec3d   m_origin;
@@ -7,6 +7,8 @@
 #include <boost/log/trivial.hpp>
 
 #include "I18N.hpp"
+#include "Time.hpp"
+#include "Utils.hpp"
 
 //! macro used to mark string used at localization,
 //! return same string
@@ -22,6 +24,23 @@ void PrintTryCancel::operator()()
 
 size_t PrintStateBase::g_last_timestamp = 0;
 
+void PrintStepStats::start()
+{
+    m_start_wall_time    = std::chrono::steady_clock::now();
+    m_start_cpu_time_ms  = process_cpu_time_ms();
+    m_start_peak_rss     = peak_memory_usage();
+    wall_time_ms   = 0.;
+    cpu_time_ms    = 0;
+    peak_rss_delta = 0;
+}
+
+void PrintStepStats::stop()
+{
+    wall_time_ms   = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start_wall_time).count();
+    cpu_time_ms    = process_cpu_time_ms() - m_start_cpu_time_ms;
+    peak_rss_delta = (long long)peak_memory_usage() - (long long)m_start_peak_rss;
+}
+
 // Update "scale", "input_filename", "input_filename_base" placeholders from the current m_objects.
 void PrintBase::update_object_placeholders(DynamicConfig &config, const std::string &default_ext) const
 {
@@ -2,6 +2,8 @@
 #define slic3r_PrintBase_hpp_
 
 #include "libslic3r.h"
+#include <array>
+#include <chrono>
 #include <set>
 #include <vector>
 #include <string>
@@ -42,6 +44,28 @@ public:
    const char* what() const throw() { return "Background processing has been canceled"; }
 };
 
+// BBS: Resources consumed by a single Print / PrintObject step, measured between set_started() and set_done().
+// Only the wall time belongs to the step alone. The CPU time and the peak memory are sampled for the whole
+// process: they include the worker threads the step spawns, but also the work of the other objects processed
+// concurrently, whose steps overlap in time. Thus the values of the steps of different objects must not be
+// summed up, and the peak memory growth is only reported by the step during which the process peak was raised.
+struct PrintStepStats
+{
+    // Measured by a steady clock, with a sub-millisecond resolution.
+    double      wall_time_ms    { 0. };
+    long long   cpu_time_ms     { 0 };
+    // Growth of the peak resident memory of the process during the step, in bytes.
+    long long   peak_rss_delta  { 0 };
+
+    void        start();
+    void        stop();
+
+private:
+    std::chrono::steady_clock::time_point m_start_wall_time;
+    long long   m_start_cpu_time_ms     { 0 };
+    size_t      m_start_peak_rss        { 0 };
+};
+
 class PrintStateBase {
 public:
     enum State {
@@ -424,7 +448,7 @@ public:
     virtual void            set_task(const TaskParams &params) {}
     // Perform the calculation. This is the only method that is to be called at a worker thread.
     virtual void            process(std::unordered_map<std::string, long long>* slice_time = nullptr, bool use_cache = false) = 0;
-    virtual int             export_cached_data(const std::string& dir_path, bool with_space=false) { return 0;}
+    virtual int             export_cached_data(const std::string& dir_path, bool with_space=false, bool binary=true) { return 0;}
     virtual int            load_cached_data(const std::string& directory) { return 0;}
     // Clean up after process() finished, either with success, error or if canceled.
     // The adjustments on the Print / PrintObject data due to set_task() are to be reverted here.
@@ -582,11 +606,19 @@ public:
     bool            is_step_done(PrintStepEnum step) const { return m_state.is_done(step, this->state_mutex()); }
 	PrintStateBase::StateWithTimeStamp step_state_with_timestamp(PrintStepEnum step) const { return m_state.state_with_timestamp(step, this->state_mutex()); }
     PrintStateBase::StateWithWarnings  step_state_with_warnings(PrintStepEnum step) const { return m_state.state_with_warnings(step, this->state_mutex()); }
+    // Resources consumed by the last run of the step.
+    const PrintStepStats&              step_stats(PrintStepEnum step) const { return m_step_stats[step]; }
 
 protected:
-    bool            set_started(PrintStepEnum step) { return m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintStepEnum step) {
+        if (! m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); }))
+            return false;
+        m_step_stats[step].start();
+        return true;
+    }
 	PrintStateBase::TimeStamp set_done(PrintStepEnum step) {
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
+        m_step_stats[step].stop();
         if (status.second)
             this->status_update_warnings(static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
         return status.first;
@@ -617,6 +649,7 @@ protected:
 
 private:
     PrintState<PrintStepEnum, COUNT> m_state;
+    std::array<PrintStepStats, COUNT> m_step_stats;
 };
 
 template<typename PrintType, typename PrintObjectStepEnum, const size_t COUNT>
@@ -630,14 +663,21 @@ public:
     bool            is_step_done(PrintObjectStepEnum step) const { return m_state.is_done(step, PrintObjectBase::state_mutex(m_print)); }
     PrintStateBase::StateWithTimeStamp step_state_with_timestamp(PrintObjectStepEnum step) const { return m_state.state_with_timestamp(step, PrintObjectBase::state_mutex(m_print)); }
     PrintStateBase::StateWithWarnings  step_state_with_warnings(PrintObjectStepEnum step) const { return m_state.state_with_warnings(step, PrintObjectBase::state_mutex(m_print)); }
+    // Resources consumed by the last run of the step.
+    const PrintStepStats&              step_stats(PrintObjectStepEnum step) const { return m_step_stats[step]; }
 
 protected:
 	PrintObjectBaseWithState(PrintType *print, ModelObject *model_object) : PrintObjectBase(model_object), m_print(print) {}
 
-    bool            set_started(PrintObjectStepEnum step)
-        { return m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintObjectStepEnum step) {
+        if (! m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); }))
+            return false;
+        m_step_stats[step].start();
+        return true;
+    }
 	PrintStateBase::TimeStamp set_done(PrintObjectStepEnum step) {
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
+        m_step_stats[step].stop();
         if (status.second)
             this->status_update_warnings(m_print, static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
         return status.first;
@@ -677,6 +717,7 @@ protected:
 
 private:
     PrintState<PrintObjectStepEnum, COUNT>   m_state;
+    std::array<PrintStepStats, COUNT>        m_step_stats;
 };
 
 } // namespace Slic3r
@@ -374,13 +374,28 @@ void PrintObject::infill()
         const auto& adaptive_fill_octree = this->m_adaptive_fill_octrees.first;
         const auto& support_fill_octree = this->m_adaptive_fill_octrees.second;
 
+        // BBS: only some regions changed their fill options, refill just the layers containing these regions.
+        m_refilled_layers.clear();
+        if (! m_refill_all_layers) {
+            m_refilled_layers.assign(m_layers.size(), false);
+            for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx)
+                for (const LayerRegion *layerm : m_layers[layer_idx]->regions())
+                    if (std::binary_search(m_refill_regions.begin(), m_refill_regions.end(), layerm->region().print_object_region_id()) &&
+                        (! layerm->fill_surfaces.empty() || ! layerm->fills.empty())) {
+                        m_refilled_layers[layer_idx] = true;
+                        break;
+                    }
+            BOOST_LOG_TRIVIAL(debug) << "Refilling " << std::count(m_refilled_layers.begin(), m_refilled_layers.end(), true) << " of " << m_layers.size() << " layers";
+        }
+
         BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, m_layers.size()),
             [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get());
+                    if (this->layer_refilled(layer_idx))
+                        m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get());
                 }
             }
         );
@@ -390,6 +405,8 @@ void PrintObject::infill()
         ### $_->fill_surfaces->clear for map @{$_->regions}, @{$object->layers};
         */
         this->set_done(posInfill);
+        m_refill_all_layers = true;
+        m_refill_regions.clear();
     }
 }
 
@@ -403,7 +420,9 @@ void PrintObject::ironing()
             [this](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->make_ironing();
+                    // BBS: ironing is appended to the fills, thus only the refilled layers may be ironed again.
+                    if (this->layer_refilled(layer_idx))
+                        m_layers[layer_idx]->make_ironing();
                 }
             }
         );
@@ -528,7 +547,8 @@ void PrintObject::simplify_extrusion_path()
             [this](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->simplify_infill_extrusion_path();
+                    if (this->layer_refilled(layer_idx))
+                        m_layers[layer_idx]->simplify_infill_extrusion_path();
                 }
             }
         );
@@ -675,13 +695,16 @@ SupportLayerPtrs::iterator PrintObject::insert_support_layer(SupportLayerPtrs::i
 // Called by Print::apply().
 // This method only accepts PrintObjectConfig and PrintRegionConfig option keys.
 bool PrintObject::invalidate_state_by_config_options(
-    const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys)
+    const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys,
+    int print_object_region_id)
 {
     if (opt_keys.empty())
         return false;
 
     std::vector<PrintObjectStep> steps;
     bool invalidated = false;
+    // BBS: Only the fills of the region print_object_region_id need to be regenerated.
+    bool invalidate_region_fills = false;
     for (const t_config_option_key &opt_key : opt_keys) {
         if (   opt_key == "brim_width"
             || opt_key == "brim_object_gap"
@@ -834,10 +857,17 @@ bool PrintObject::invalidate_state_by_config_options(
                opt_key == "top_surface_pattern"
             || opt_key == "bottom_surface_pattern"
             || opt_key == "internal_solid_infill_pattern"
-            || opt_key == "external_fill_link_max_length"
             || opt_key == "sparse_infill_anchor"
             || opt_key == "sparse_infill_anchor_max"
-            || opt_key == "top_surface_line_width"
+            || opt_key == "top_surface_line_width") {
+            // BBS: These region options only affect the fills generated from the fill surfaces of the region itself,
+            // the fills of the layers not containing the region may be kept.
+            if (print_object_region_id >= 0)
+                invalidate_region_fills = true;
+            else
+                steps.emplace_back(posInfill);
+        } else if (
+               opt_key == "external_fill_link_max_length"
             || opt_key == "initial_layer_line_width") {
             steps.emplace_back(posInfill);
         } else if (opt_key == "sparse_infill_pattern") {
@@ -930,6 +960,31 @@ bool PrintObject::invalidate_state_by_config_options(
     sort_remove_duplicates(steps);
     for (PrintObjectStep step : steps)
         invalidated |= this->invalidate_step(step);
+    // After invalidating the steps above, so that the fills of all layers are regenerated if posInfill was invalidated completely.
+    if (invalidate_region_fills)
+        invalidated |= this->invalidate_fills_of_region(print_object_region_id);
+    return invalidated;
+}
+
+bool PrintObject::invalidate_fills_of_region(int print_object_region_id)
+{
+    // The fills of the other regions may only be kept if they were generated, ironed and simplified completely.
+    // Print::apply() holds the state mutex, thus the step states could not change while being tested.
+    bool complete = this->is_step_done_unguarded(posInfill) && this->is_step_done_unguarded(posIroning) && this->is_step_done_unguarded(posSimplifyInfill);
+    // Stops the background processing, thus m_refill_regions is not being accessed by infill() anymore.
+    bool invalidated = Inherited::invalidate_step(posInfill);
+    if (complete) {
+        m_refill_all_layers = false;
+        m_refill_regions.clear();
+    }
+    if (! m_refill_all_layers) {
+        auto it = std::lower_bound(m_refill_regions.begin(), m_refill_regions.end(), print_object_region_id);
+        if (it == m_refill_regions.end() || *it != print_object_region_id)
+            m_refill_regions.insert(it, print_object_region_id);
+    }
+    // Propagate to dependent steps the same way as invalidate_step(posInfill).
+    invalidated |= this->invalidate_steps({ posIroning, posSimplifyInfill });
+    invalidated |= m_print->invalidate_steps({ psSkirtBrim, psWipeTower, psGCodeExport });
     return invalidated;
 }
 
@@ -937,6 +992,13 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
 {
 	bool invalidated = Inherited::invalidate_step(step);
 
+    // BBS: the fills of all layers are to be regenerated, ironed and simplified again.
+    if (step == posSlice || step == posPerimeters || step == posPrepareInfill || step == posInfill || step == posIroning || step == posSimplifyInfill) {
+        m_refill_all_layers = true;
+        m_refill_regions.clear();
+        m_refilled_layers.clear();
+    }
+
     // propagate to dependent steps
     if (step == posPerimeters) {
 		invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill, posIroning, posSimplifyWall, posSimplifyInfill });
@@ -971,6 +1033,9 @@ bool PrintObject::invalidate_all_steps()
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	m_slicing_params.valid = false;
+    m_refill_all_layers = true;
+    m_refill_regions.clear();
+    m_refilled_layers.clear();
 	return result;
 }
 
@@ -2936,9 +3001,9 @@ void PrintObject::get_certain_layers(float start, float end, std::vector<LayerPt
     out.emplace_back(std::move(out_temp));
 };
 
-std::vector<Point> PrintObject::get_instances_shift_without_plate_offset()
+Points PrintObject::get_instances_shift_without_plate_offset()
 {
-    std::vector<Point> out;
+    Points out;
     out.reserve(m_instances.size());
     for (const auto& instance : m_instances)
         out.push_back(instance.shift_without_plate_offset());
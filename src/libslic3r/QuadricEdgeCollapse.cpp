@@ -3,6 +3,7 @@
 #include <optional>
 #include "MutablePriorityQueue.hpp"
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
 
 using namespace Slic3r;
 
@@ -115,8 +116,12 @@ namespace QuadricEdgeCollapse {
     // calculate error for vertex and quadrics, triangle quadrics and triangle vertex give zero, only pozitive number
     double vertex_error(const SymMat &q, const Vec3d &vertex);
     SymMat create_quadric(const Triangle &t, const Vec3d& n, const Vertices &vertices);
+    // vertex_quadrics: when set, used instead of the sum of surrounding triangle quadrics
     std::tuple<TriangleInfos, VertexInfos, EdgeInfos, Errors> 
-    init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn);
+    init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn,
+         const std::vector<SymMat> *vertex_quadrics = nullptr);
+    // sum of surrounding triangle quadrics for each vertex
+    std::vector<SymMat> create_vertex_quadrics(const indexed_triangle_set &its, ThrowOnCancel &throw_on_cancel);
     std::optional<uint32_t> find_triangle_index1(uint32_t vi, const VertexInfo& v_info,
         uint32_t ti, const EdgeInfos& e_infos, const Indices& indices);
     void reorder_edges(EdgeInfos &e_infos, const VertexInfo &v_info, uint32_t ti0, uint32_t ti1);
@@ -134,6 +139,15 @@ namespace QuadricEdgeCollapse {
                           uint32_t vi0, uint32_t vi1, uint32_t vi_top0,
                           const Triangle &t1, CopyEdgeInfos& infos, EdgeInfos &e_infos1);
     void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its);
+    // Collapse edges until triangle_count or maximal_error is reached, return error of the last collapsed edge.
+    // vertex_quadrics: IN quadrics of vertices to start with (when nullptr they are calculated from triangles)
+    //                  OUT quadrics of vertices which stay after compaction
+    // fixed_vertices: vertices which can't be moved (e.g. border between parts processed in parallel)
+    // kept_vertices: OUT input indices of vertices which stay after compaction
+    float reduce(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error,
+                 ThrowOnCancel &throw_on_cancel, StatusFn &status_fn,
+                 std::vector<SymMat> *vertex_quadrics = nullptr, const std::vector<bool> *fixed_vertices = nullptr,
+                 std::vector<uint32_t> *kept_vertices = nullptr);
 
 #ifdef EXPENSIVE_DEBUG_CHECKS
     void store_surround(const char *obj_filename, size_t triangle_index, int depth, const indexed_triangle_set &its,
@@ -153,6 +167,10 @@ namespace QuadricEdgeCollapse {
     const int status_set_offsets = 10;
     const int status_calc_errors = 30;
     const int status_create_refs = 10;
+    // parallel simplification
+    const size_t min_triangle_count_for_one_part = 50000;
+    const size_t max_part_count = 16;
+    const int status_parts_size = 80; // in percents, rest is for reduction of seams between parts
     } // namespace QuadricEdgeCollapse
 
 using namespace QuadricEdgeCollapse;
@@ -171,6 +189,19 @@ void Slic3r::its_quadric_edge_collapse(
     if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
     if (status_fn == nullptr) status_fn = [](int) {};
 
+    float last_collapsed_error = reduce(its, triangle_count, maximal_error, throw_on_cancel, status_fn);
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+float QuadricEdgeCollapse::reduce(indexed_triangle_set &its,
+                                  uint32_t              triangle_count,
+                                  float                 maximal_error,
+                                  ThrowOnCancel &       throw_on_cancel,
+                                  StatusFn &            status_fn,
+                                  std::vector<SymMat> * vertex_quadrics,
+                                  const std::vector<bool> *fixed_vertices,
+                                  std::vector<uint32_t> * kept_vertices)
+{
     StatusFn init_status_fn = [&](int percent) {
         float n_percent = percent * status_init_size / 100.f;
         status_fn(static_cast<int>(std::round(n_percent)));
@@ -180,7 +211,7 @@ void Slic3r::its_quadric_edge_collapse(
     VertexInfos   v_infos;
     EdgeInfos     e_infos;
     Errors        errors;
-    std::tie(t_infos, v_infos, e_infos, errors) = init(its, throw_on_cancel, init_status_fn);
+    std::tie(t_infos, v_infos, e_infos, errors) = init(its, throw_on_cancel, init_status_fn, vertex_quadrics);
     throw_on_cancel();
     status_fn(status_init_size);
 
@@ -256,6 +287,7 @@ void Slic3r::its_quadric_edge_collapse(
             reorder_edges(e_infos, v_info1, ti0, ti1);
         }
         if (!ti1_opt.has_value() || // edge has only one triangle
+            (fixed_vertices != nullptr && ((*fixed_vertices)[vi0] || (*fixed_vertices)[vi1])) ||
             degenerate(vi0, ti0, ti1, v_info1, e_infos, its.indices) ||
             degenerate(vi1, ti0, ti1, v_info0, e_infos, its.indices) ||
             create_no_volume(vi0, vi1, ti0, ti1, v_info0, v_info1, e_infos, its.indices) ||
@@ -341,9 +373,179 @@ void Slic3r::its_quadric_edge_collapse(
 #endif // EXPENSIVE_DEBUG_CHECKS
     }
 
+    // same order of vertices as after compaction
+    if (vertex_quadrics != nullptr) vertex_quadrics->clear();
+    if (kept_vertices != nullptr) kept_vertices->clear();
+    for (uint32_t vi = 0; vi < v_infos.size(); ++vi) {
+        const VertexInfo &v_info = v_infos[vi];
+        if (v_info.is_deleted()) continue;
+        if (vertex_quadrics != nullptr) vertex_quadrics->push_back(v_info.q);
+        if (kept_vertices != nullptr) kept_vertices->push_back(vi);
+    }
+
     // compact triangle
     compact(v_infos, t_infos, e_infos, its);
+    return last_collapsed_error;
+}
+
+void Slic3r::its_quadric_edge_collapse_parallel(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count,
+    float *                   max_error,
+    std::function<void(void)> throw_on_cancel,
+    std::function<void(int)>  status_fn)
+{
+    // The partition depends on the triangle count only, so that the result does not depend on the number of threads.
+    // Every border between parts is reduced at the end serially.
+    size_t part_count = std::min(max_part_count, its.indices.size() / min_triangle_count_for_one_part);
+    if (part_count < 2) {
+        its_quadric_edge_collapse(its, triangle_count, max_error, throw_on_cancel, status_fn);
+        return;
+    }
+
+    // check input
+    if (triangle_count >= its.indices.size()) return;
+    float maximal_error = (max_error == nullptr)? std::numeric_limits<float>::max() : *max_error;
+    if (maximal_error <= 0.f) return;
+    if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
+    if (status_fn == nullptr) status_fn = [](int) {};
+
+    // Quadrics are calculated from the whole mesh,
+    // so vertices on the border between parts see triangles of both parts.
+    std::vector<SymMat> vertex_quadrics = create_vertex_quadrics(its, throw_on_cancel);
+    throw_on_cancel();
+
+    // Split triangles into slabs with the same triangle count along the longest side of the bounding box.
+    const size_t triangle_count_all = its.indices.size();
+    int axis = 0;
+    bounding_box(its).size().maxCoeff(&axis);
+    std::vector<std::pair<float, uint32_t>> triangle_order(triangle_count_all);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, triangle_count_all),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            const Triangle &t = its.indices[i];
+            // centroid multiplied by 3
+            float c = its.vertices[t[0]][axis] + its.vertices[t[1]][axis] + its.vertices[t[2]][axis];
+            triangle_order[i] = {c, uint32_t(i)};
+        }
+    }); // END parallel for
+    tbb::parallel_sort(triangle_order.begin(), triangle_order.end());
+    auto part_begin = [&](size_t part) { return part * triangle_count_all / part_count; };
+
+    // Vertex shared by more parts is fixed, it is reduced only at the end with the whole mesh.
+    const int vertex_unused = -1;
+    const int vertex_fixed = -2;
+    std::vector<int> vertex_part(its.vertices.size(), vertex_unused);
+    for (size_t part = 0; part < part_count; ++part)
+        for (size_t i = part_begin(part); i < part_begin(part + 1); ++i)
+            for (int vi : its.indices[triangle_order[i].second]) {
+                int &vp = vertex_part[vi];
+                if (vp == vertex_unused) vp = int(part);
+                else if (vp != int(part)) vp = vertex_fixed;
+            }
+    throw_on_cancel();
+    status_fn(status_init_size);
+
+    struct Part
+    {
+        indexed_triangle_set its;
+        std::vector<uint32_t> vertex_ids; // index into input its.vertices
+        std::vector<SymMat> vertex_quadrics;
+        float last_collapsed_error = 0.f;
+    };
+    std::vector<Part> parts(part_count);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, part_count, 1),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t part_index = range.begin(); part_index < range.end(); ++part_index) {
+            Part &part = parts[part_index];
+            size_t begin = part_begin(part_index);
+            size_t end   = part_begin(part_index + 1);
+            for (size_t i = begin; i < end; ++i)
+                for (int vi : its.indices[triangle_order[i].second])
+                    part.vertex_ids.push_back(vi);
+            sort_remove_duplicates(part.vertex_ids);
+
+            part.its.vertices.reserve(part.vertex_ids.size());
+            part.vertex_quadrics.reserve(part.vertex_ids.size());
+            std::vector<bool> fixed_vertices;
+            fixed_vertices.reserve(part.vertex_ids.size());
+            for (uint32_t vi : part.vertex_ids) {
+                part.its.vertices.push_back(its.vertices[vi]);
+                part.vertex_quadrics.push_back(vertex_quadrics[vi]);
+                fixed_vertices.push_back(vertex_part[vi] == vertex_fixed);
+            }
+            part.its.indices.reserve(end - begin);
+            size_t seam_triangle_count = 0;
+            for (size_t i = begin; i < end; ++i) {
+                Triangle t = its.indices[triangle_order[i].second];
+                bool is_seam = false;
+                for (int &vi : t) {
+                    vi = int(std::lower_bound(part.vertex_ids.begin(), part.vertex_ids.end(), uint32_t(vi)) - part.vertex_ids.begin());
+                    is_seam |= fixed_vertices[vi];
+                }
+                if (is_seam) ++seam_triangle_count;
+                part.its.indices.push_back(t);
+            }
+
+            // Inner triangles of each part are reduced by the same ratio,
+            // triangles touching fixed vertices are left for the reduction of the whole mesh.
+            size_t   inner_triangle_count = part.its.indices.size() - seam_triangle_count;
+            uint32_t part_triangle_count  = uint32_t(seam_triangle_count +
+                (uint64_t(triangle_count) * inner_triangle_count + triangle_count_all - 1) / triangle_count_all);
+            if (part_triangle_count >= part.its.indices.size()) continue;
+            StatusFn part_status_fn = [](int) {}; // status is reported only from the calling thread
+            std::vector<uint32_t> kept_vertices;
+            part.last_collapsed_error = reduce(part.its, part_triangle_count, maximal_error, throw_on_cancel,
+                                               part_status_fn, &part.vertex_quadrics, &fixed_vertices, &kept_vertices);
+            for (uint32_t &vi : kept_vertices) vi = part.vertex_ids[vi];
+            part.vertex_ids = std::move(kept_vertices);
+        }
+    }); // END parallel for
+    throw_on_cancel();
+    status_fn(status_parts_size);
+
+    // merge parts, fixed vertices are shared
+    indexed_triangle_set merged;
+    std::vector<SymMat> merged_quadrics;
+    std::vector<int> fixed_vertex_ids(its.vertices.size(), -1);
+    for (size_t vi = 0; vi < its.vertices.size(); ++vi)
+        if (vertex_part[vi] == vertex_fixed) {
+            fixed_vertex_ids[vi] = int(merged.vertices.size());
+            merged.vertices.push_back(its.vertices[vi]);
+            merged_quadrics.push_back(vertex_quadrics[vi]);
+        }
+    float last_collapsed_error = 0.f;
+    for (Part &part : parts) {
+        std::vector<int> vertex_map(part.its.vertices.size());
+        for (size_t vi = 0; vi < part.its.vertices.size(); ++vi) {
+            uint32_t vi_orig = part.vertex_ids[vi];
+            if (vertex_part[vi_orig] == vertex_fixed) {
+                vertex_map[vi] = fixed_vertex_ids[vi_orig];
+            } else {
+                vertex_map[vi] = int(merged.vertices.size());
+                merged.vertices.push_back(part.its.vertices[vi]);
+                merged_quadrics.push_back(part.vertex_quadrics[vi]);
+            }
+        }
+        for (Triangle t : part.its.indices) {
+            for (int &vi : t) vi = vertex_map[vi];
+            merged.indices.push_back(t);
+        }
+        last_collapsed_error = std::max(last_collapsed_error, part.last_collapsed_error);
+        part = Part();
+    }
+
+    // reduce the rest, mainly around borders of parts
+    StatusFn seam_status_fn = [&](int percent) {
+        float n_percent = status_parts_size + percent * (100 - status_parts_size) / 100.f;
+        status_fn(static_cast<int>(std::round(n_percent)));
+    };
+    if (triangle_count < merged.indices.size())
+        last_collapsed_error = std::max(last_collapsed_error,
+            reduce(merged, triangle_count, maximal_error, throw_on_cancel, seam_status_fn, &merged_quadrics));
+    its = std::move(merged);
     if (max_error != nullptr) *max_error = last_collapsed_error;
+    status_fn(100);
 }
 
 Vec3d QuadricEdgeCollapse::create_normal(const Triangle &triangle,
@@ -438,13 +640,14 @@ SymMat QuadricEdgeCollapse::create_quadric(const Triangle &t,
 }
 
 std::tuple<TriangleInfos, VertexInfos, EdgeInfos, Errors> 
-QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn)
+QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn,
+                          const std::vector<SymMat> *vertex_quadrics)
 {
     int status_offset = 0;
     TriangleInfos t_infos(its.indices.size());
     VertexInfos   v_infos(its.vertices.size());
     {
-        std::vector<SymMat> triangle_quadrics(its.indices.size());
+        std::vector<SymMat> triangle_quadrics(vertex_quadrics == nullptr ? its.indices.size() : 0);
         // calculate normals
         tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()),
         [&](const tbb::blocked_range<size_t> &range) {
@@ -453,7 +656,8 @@ QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_
                 TriangleInfo &  t_info = t_infos[i];
                 Vec3d           normal = create_normal(t, its.vertices);
                 t_info.n = normal.cast<float>();
-                triangle_quadrics[i] = create_quadric(t, normal, its.vertices);
+                if (vertex_quadrics == nullptr)
+                    triangle_quadrics[i] = create_quadric(t, normal, its.vertices);
                 if (i % 1000000 == 0) {
                     throw_on_cancel();
                     status_fn(status_offset + (i * status_normal_size) / its.indices.size());
@@ -463,12 +667,16 @@ QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_
         status_offset += status_normal_size;
 
         // sum quadrics
+        if (vertex_quadrics != nullptr) {
+            assert(vertex_quadrics->size() == v_infos.size());
+            for (size_t vi = 0; vi < v_infos.size(); ++vi)
+                v_infos[vi].q = (*vertex_quadrics)[vi];
+        }
         for (size_t i = 0; i < its.indices.size(); i++) {
             const Triangle &t = its.indices[i];
-            const SymMat &  q = triangle_quadrics[i];
             for (size_t e = 0; e < 3; e++) {
                 VertexInfo &v_info = v_infos[t[e]];
-                v_info.q += q;
+                if (vertex_quadrics == nullptr) v_info.q += triangle_quadrics[i];
                 ++v_info.count; // triangle count
             }
             if (i % 1000000 == 0) {
@@ -535,6 +743,25 @@ QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_
     return {t_infos, v_infos, e_infos, errors};
 }
 
+std::vector<SymMat> QuadricEdgeCollapse::create_vertex_quadrics(const indexed_triangle_set &its, ThrowOnCancel &throw_on_cancel)
+{
+    std::vector<SymMat> triangle_quadrics(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            const Triangle &t = its.indices[i];
+            triangle_quadrics[i] = create_quadric(t, create_normal(t, its.vertices), its.vertices);
+            if (i % 1000000 == 0) throw_on_cancel();
+        }
+    }); // END parallel for
+
+    std::vector<SymMat> vertex_quadrics(its.vertices.size());
+    for (size_t i = 0; i < its.indices.size(); i++)
+        for (size_t e = 0; e < 3; e++)
+            vertex_quadrics[its.indices[i][e]] += triangle_quadrics[i];
+    return vertex_quadrics;
+}
+
 std::optional<uint32_t> QuadricEdgeCollapse::find_triangle_index1(uint32_t          vi,
                                                    const VertexInfo &v_info,
                                                    uint32_t          ti0,
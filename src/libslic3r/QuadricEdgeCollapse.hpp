@@ -25,4 +25,25 @@ void its_quadric_edge_collapse(
     std::function<void(void)> throw_on_cancel = nullptr,
     std::function<void(int)>  statusfn        = nullptr);
 
+/// <summary>
+/// Simplify mesh by Quadric metric on multiple threads.
+/// Triangles are split into slabs along the longest side of the bounding box,
+/// each slab is simplified separately with vertices shared between slabs fixed,
+/// the rest is simplified together with the whole mesh.
+/// Small meshes are simplified by its_quadric_edge_collapse.
+/// </summary>
+/// <param name="its">IN/OUT triangle mesh to be simplified.</param>
+/// <param name="triangle_count">Wanted triangle count.</param>
+/// <param name="max_error">Maximal Quadric for reduce.
+/// When nullptr then max float is used
+/// Output: Biggest last used ErrorValue to collapse edge</param>
+/// <param name="throw_on_cancel">Could stop process of calculation, called from worker threads.</param>
+/// <param name="statusfn">Give a feed back to user about progress. Values 1 - 100, called from the calling thread.</param>
+void its_quadric_edge_collapse_parallel(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count  = 0,
+    float *                   max_error       = nullptr,
+    std::function<void(void)> throw_on_cancel = nullptr,
+    std::function<void(int)>  statusfn        = nullptr);
+
 } // namespace Slic3r
@@ -43,7 +43,8 @@ Point ConcaveHull::centroid(const Points &pp)
 Points ConcaveHull::calculate_centroids() const
 {
     // We get the centroids of all the islands in the 2D slice
-    Points centroids = reserve_vector<Point>(m_polys.size());
+    Points centroids;
+    centroids.reserve(m_polys.size());
     std::transform(m_polys.begin(), m_polys.end(),
                    std::back_inserter(centroids),
                    [](const Polygon &poly) { return centroid(poly); });
@@ -19,6 +19,7 @@
 #include "../Utils.hpp"
 #include "../format.hpp"
 
+#include <deque>
 #include <string_view>
 
 #include <boost/log/trivial.hpp>
@@ -123,6 +124,9 @@ TreeModelVolumes::TreeModelVolumes(
         m_min_resolution = std::min(m_min_resolution, data_pair.first.resolution);
     }
 
+    // Share the collisions and avoidances with the other volumes calculated from the same inputs.
+    m_caches = acquire_caches(this->cache_key(), print_object.print());
+
 
 #if 0
     for (size_t mesh_idx = 0; mesh_idx < storage.meshes.size(); mesh_idx++) {
@@ -154,6 +158,197 @@ TreeModelVolumes::TreeModelVolumes(
 #endif
 }
 
+// Collisions and avoidances depend on the layer outlines, support blockers, the build volume, the tree support settings and the parameters derived from them.
+// Settings driving just the extrusion of the supports (patterns, interfaces, line spacing) do not change the caches.
+TreeModelVolumes::CacheKey TreeModelVolumes::cache_key() const
+{
+    CacheKey key;
+    key.parameters = {
+        double(m_max_move), double(m_max_move_slow), double(m_min_resolution), double(m_current_outline_idx),
+        double(m_current_min_xy_dist), double(m_current_min_xy_dist_delta), double(m_support_rests_on_model),
+        double(m_increase_until_radius), double(m_radius_0)
+    };
+    append(key.parameters, m_raft_layers);
+    for (const std::pair<TreeSupportMeshGroupSettings, std::vector<Polygons>> &outlines : m_layer_outlines) {
+        const TreeSupportMeshGroupSettings &settings = outlines.first;
+        key.parameters.insert(key.parameters.end(), {
+            double(settings.layer_height), double(settings.resolution), double(settings.support_line_width),
+            double(settings.support_bottom_enable), double(settings.support_bottom_height), double(settings.support_material_buildplate_only),
+            double(settings.support_xy_distance), double(settings.support_xy_distance_overhang),
+            double(settings.support_top_distance), double(settings.support_bottom_distance),
+            settings.support_tree_angle, settings.support_tree_angle_slow, settings.support_tree_branch_diameter_angle, settings.support_tree_top_rate,
+            double(settings.support_tree_branch_diameter), double(settings.support_tree_tip_diameter), double(settings.support_tree_bp_diameter),
+            double(settings.support_tree_max_diameter_increase_by_merges_when_support_to_model), double(settings.support_tree_min_height_to_model),
+            double(outlines.second.size())
+        });
+        append(key.outlines, outlines.second);
+    }
+    key.anti_overhang  = m_anti_overhang;
+    key.machine_border = m_machine_border;
+    key.bed_area       = m_bed_area;
+
+    auto hash_polygon = [](size_t &seed, const Polygon &polygon) {
+        boost::hash_combine(seed, std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(polygon.points.data()), polygon.points.size() * sizeof(Point))));
+    };
+    auto hash_polygons = [&hash_polygon](size_t &seed, const std::vector<Polygons> &layers) {
+        for (const Polygons &layer : layers) {
+            boost::hash_combine(seed, layer.size());
+            for (const Polygon &polygon : layer)
+                hash_polygon(seed, polygon);
+        }
+    };
+    for (double v : key.parameters)
+        boost::hash_combine(key.hash, std::hash<double>{}(v));
+    hash_polygons(key.hash, key.outlines);
+    hash_polygons(key.hash, key.anti_overhang);
+    boost::hash_combine(key.hash, key.machine_border.size());
+    for (const Polygon &polygon : key.machine_border)
+        hash_polygon(key.hash, polygon);
+    hash_polygon(key.hash, key.bed_area);
+    return key;
+}
+
+struct TreeModelVolumes::SharedCaches
+{
+    struct Retained {
+        const Print                        *print;
+        std::shared_ptr<Caches>             caches;
+    };
+
+    std::mutex                              mutex;
+    // Caches of the TreeModelVolumes alive.
+    std::vector<std::weak_ptr<Caches>>      alive;
+    // Caches retained for each print, most recently used caches first.
+    std::deque<Retained>                    retained;
+    // Per print.
+    size_t                                  max_retained { 2 };
+    // Of all the retained caches.
+    size_t                                  max_retained_memory { size_t(512) << 20 };
+
+    // Release the least recently used caches of the print exceeding max_retained.
+    // The released caches are moved to released to be destroyed outside of the lock.
+    void trim_count(const Print *print, std::vector<std::shared_ptr<Caches>> &released) {
+        size_t num_retained = 0;
+        for (auto it = this->retained.begin(); it != this->retained.end();)
+            if (it->print == print && ++ num_retained > this->max_retained) {
+                released.emplace_back(std::move(it->caches));
+                it = this->retained.erase(it);
+            } else
+                ++ it;
+    }
+    // Release the least recently used caches of all the prints exceeding max_retained_memory.
+    void trim_memory(std::vector<std::shared_ptr<Caches>> &released) {
+        size_t memory = 0;
+        for (auto it = this->retained.begin(); it != this->retained.end();)
+            if (memory += it->caches->memory_size(); memory > this->max_retained_memory) {
+                released.emplace_back(std::move(it->caches));
+                it = this->retained.erase(it);
+            } else
+                ++ it;
+    }
+};
+
+TreeModelVolumes::SharedCaches& TreeModelVolumes::shared_caches()
+{
+    static SharedCaches caches;
+    return caches;
+}
+
+std::shared_ptr<TreeModelVolumes::Caches> TreeModelVolumes::acquire_caches(CacheKey &&key, const Print *print)
+{
+    // Release the caches outside of the lock.
+    std::vector<std::shared_ptr<Caches>> released;
+    SharedCaches &shared = shared_caches();
+    std::lock_guard<std::mutex> guard(shared.mutex);
+    std::shared_ptr<Caches> out;
+    for (auto it = shared.alive.begin(); it != shared.alive.end();)
+        if (std::shared_ptr<Caches> caches = it->lock(); ! caches)
+            it = shared.alive.erase(it);
+        else {
+            if (! out && caches->key == key)
+                out = std::move(caches);
+            ++ it;
+        }
+    if (out) {
+        BOOST_LOG_TRIVIAL(debug) << "Tree support reuses the collision and avoidance caches of an object with the same outlines and settings";
+        // An entry retained for another print is kept.
+        if (auto it = std::find_if(shared.retained.begin(), shared.retained.end(), [&out, print](const SharedCaches::Retained &r) { return r.print == print && r.caches == out; });
+            it != shared.retained.end())
+            shared.retained.erase(it);
+    } else {
+        out = std::make_shared<Caches>();
+        out->key = std::move(key);
+        shared.alive.emplace_back(out);
+    }
+    if (shared.max_retained > 0) {
+        shared.retained.push_front({ print, out });
+        shared.trim_count(print, released);
+        shared.trim_memory(released);
+    }
+    return out;
+}
+
+void TreeModelVolumes::set_retained_caches(size_t num_caches)
+{
+    std::vector<std::shared_ptr<Caches>> released;
+    SharedCaches &shared = shared_caches();
+    std::lock_guard<std::mutex> guard(shared.mutex);
+    shared.max_retained = num_caches;
+    std::vector<const Print*> prints;
+    for (const SharedCaches::Retained &r : shared.retained)
+        if (std::find(prints.begin(), prints.end(), r.print) == prints.end())
+            prints.emplace_back(r.print);
+    for (const Print *print : prints)
+        shared.trim_count(print, released);
+}
+
+void TreeModelVolumes::set_retained_caches_memory_limit(size_t num_bytes)
+{
+    std::vector<std::shared_ptr<Caches>> released;
+    SharedCaches &shared = shared_caches();
+    std::lock_guard<std::mutex> guard(shared.mutex);
+    shared.max_retained_memory = num_bytes;
+    shared.trim_memory(released);
+}
+
+void TreeModelVolumes::clear_retained_caches(const Print *print)
+{
+    std::vector<std::shared_ptr<Caches>> released;
+    SharedCaches &shared = shared_caches();
+    std::lock_guard<std::mutex> guard(shared.mutex);
+    for (auto it = shared.retained.begin(); it != shared.retained.end();)
+        if (it->print == print) {
+            released.emplace_back(std::move(it->caches));
+            it = shared.retained.erase(it);
+        } else
+            ++ it;
+}
+
+size_t TreeModelVolumes::num_retained_caches(const Print *print)
+{
+    SharedCaches &shared = shared_caches();
+    std::lock_guard<std::mutex> guard(shared.mutex);
+    return std::count_if(shared.retained.begin(), shared.retained.end(), [print](const SharedCaches::Retained &r) { return r.print == print; });
+}
+
+bool TreeModelVolumes::has_cached_avoidances() const
+{
+    return ! m_caches->avoidance_cache.empty() || ! m_caches->avoidance_cache_slow.empty() || ! m_caches->avoidance_cache_holefree.empty() ||
+           ! m_caches->avoidance_cache_to_model.empty() || ! m_caches->avoidance_cache_to_model_slow.empty() || ! m_caches->avoidance_cache_holefree_to_model.empty();
+}
+
+void TreeModelVolumes::clear_all_but_object_collision()
+{
+    std::vector<std::shared_ptr<Caches>> released;
+    SharedCaches &shared = shared_caches();
+    std::lock_guard<std::mutex> guard(shared.mutex);
+    // New references to the caches are only created with the lock held.
+    // The avoidances of a retained cache are kept for the next support generation, as long as the retained caches fit into the memory limit.
+    shared.trim_memory(released);
+    if (m_caches.use_count() - std::count(released.begin(), released.end(), m_caches) == 1)
+        m_caches->clear_all_but_object_collision();
+}
+
 void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord_t max_layer, std::function<void()> throw_on_cancel)
 {
     auto t_start = std::chrono::high_resolution_clock::now();
@@ -275,24 +470,24 @@ void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord
             i = j;
         }
     };
-    paint_cache_into_SVGs(m_collision_cache,                    "collision_cache");
-    paint_cache_into_SVGs(m_collision_cache_holefree,           "collision_cache_holefree");
-    paint_cache_into_SVGs(m_avoidance_cache,                    "avoidance_cache");
-    paint_cache_into_SVGs(m_avoidance_cache_slow,               "avoidance_cache_slow");
-    paint_cache_into_SVGs(m_avoidance_cache_to_model,           "avoidance_cache_to_model");
-    paint_cache_into_SVGs(m_avoidance_cache_to_model_slow,      "avoidance_cache_to_model_slow");
-    paint_cache_into_SVGs(m_placeable_areas_cache,              "placable_areas_cache");
-    paint_cache_into_SVGs(m_avoidance_cache_holefree,           "avoidance_cache_holefree");
-    paint_cache_into_SVGs(m_avoidance_cache_holefree_to_model,  "avoidance_cache_holefree_to_model");
-    paint_cache_into_SVGs(m_wall_restrictions_cache,            "wall_restrictions_cache");
-    paint_cache_into_SVGs(m_wall_restrictions_cache_min,        "wall_restrictions_cache_min");
+    paint_cache_into_SVGs(m_caches->collision_cache,                    "collision_cache");
+    paint_cache_into_SVGs(m_caches->collision_cache_holefree,           "collision_cache_holefree");
+    paint_cache_into_SVGs(m_caches->avoidance_cache,                    "avoidance_cache");
+    paint_cache_into_SVGs(m_caches->avoidance_cache_slow,               "avoidance_cache_slow");
+    paint_cache_into_SVGs(m_caches->avoidance_cache_to_model,           "avoidance_cache_to_model");
+    paint_cache_into_SVGs(m_caches->avoidance_cache_to_model_slow,      "avoidance_cache_to_model_slow");
+    paint_cache_into_SVGs(m_caches->placeable_areas_cache,              "placable_areas_cache");
+    paint_cache_into_SVGs(m_caches->avoidance_cache_holefree,           "avoidance_cache_holefree");
+    paint_cache_into_SVGs(m_caches->avoidance_cache_holefree_to_model,  "avoidance_cache_holefree_to_model");
+    paint_cache_into_SVGs(m_caches->wall_restrictions_cache,            "wall_restrictions_cache");
+    paint_cache_into_SVGs(m_caches->wall_restrictions_cache_min,        "wall_restrictions_cache_min");
 #endif
 }
 
 const Polygons& TreeModelVolumes::getCollision(const coord_t orig_radius, LayerIndex layer_idx, bool min_xy_dist) const
 {
     const coord_t radius = this->ceilRadius(orig_radius, min_xy_dist);
-    if (std::optional<std::reference_wrapper<const Polygons>> result = m_collision_cache.getArea({ radius, layer_idx }); result)
+    if (std::optional<std::reference_wrapper<const Polygons>> result = m_caches->collision_cache.getArea({ radius, layer_idx }); result)
         return (*result).get();
     if (m_precalculated) {
         BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate collision at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
@@ -307,7 +502,7 @@ const Polygons& TreeModelVolumes::getCollision(const coord_t orig_radius, LayerI
 // Used for pushing tree supports away from object during the final Organic optimization step.
 std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> TreeModelVolumes::get_collision_lower_bound_area(LayerIndex layer_id, coord_t max_radius) const
 {
-    return m_collision_cache.get_lower_bound_area({ max_radius, layer_id });
+    return m_caches->collision_cache.get_lower_bound_area({ max_radius, layer_id });
 }
 
 // Private. Only called internally by calculateAvoidance() and calculateAvoidanceToModel(), radius is already snapped to grid.
@@ -315,7 +510,7 @@ const Polygons& TreeModelVolumes::getCollisionHolefree(coord_t radius, LayerInde
 {
     assert(radius == this->ceilRadius(radius));
     assert(radius < m_increase_until_radius + m_current_min_xy_dist_delta);
-    if (std::optional<std::reference_wrapper<const Polygons>> result = m_collision_cache_holefree.getArea({ radius, layer_idx }); result)
+    if (std::optional<std::reference_wrapper<const Polygons>> result = m_caches->collision_cache_holefree.getArea({ radius, layer_idx }); result)
         return (*result).get();
     if (m_precalculated) {
         BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate collision holefree at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
@@ -358,7 +553,7 @@ const Polygons& TreeModelVolumes::getPlaceableAreas(const coord_t orig_radius, L
 {
 
     const coord_t radius = ceilRadius(orig_radius);
-    if (std::optional<std::reference_wrapper<const Polygons>> result = m_placeable_areas_cache.getArea({ radius, layer_idx }); result)
+    if (std::optional<std::reference_wrapper<const Polygons>> result = m_caches->placeable_areas_cache.getArea({ radius, layer_idx }); result)
         return (*result).get();
     if (m_precalculated) {
         BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate Placeable Areas at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
@@ -383,7 +578,7 @@ const Polygons& TreeModelVolumes::getWallRestriction(const coord_t orig_radius,
 
     const coord_t radius = ceilRadius(orig_radius);
     if (std::optional<std::reference_wrapper<const Polygons>> result = 
-        (min_xy_dist ? m_wall_restrictions_cache_min : m_wall_restrictions_cache).getArea({ radius, layer_idx });
+        (min_xy_dist ? m_caches->wall_restrictions_cache_min : m_caches->wall_restrictions_cache).getArea({ radius, layer_idx });
         result)
         return (*result).get();
     if (m_precalculated) {
@@ -422,7 +617,7 @@ void TreeModelVolumes::calculateCollision(const coord_t radius, const LayerIndex
         [this](size_t i, size_t j) { return m_layer_outlines[i].second.size() < m_layer_outlines[j].second.size(); });
 
     LayerPolygonCache           data;
-    data.allocate(m_collision_cache.getMaxCalculatedLayer(radius) + 1, max_layer_idx + 1);
+    data.allocate(m_caches->collision_cache.getMaxCalculatedLayer(radius) + 1, max_layer_idx + 1);
 
     const bool                  calculate_placable = m_support_rests_on_model && radius == 0;
     LayerPolygonCache           data_placeable;
@@ -571,9 +766,9 @@ void TreeModelVolumes::calculateCollision(const coord_t radius, const LayerIndex
 #endif
     if (throw_on_cancel)
         throw_on_cancel();
-    m_collision_cache.insert(std::move(data), radius);
+    m_caches->collision_cache.insert(std::move(data), radius);
     if (calculate_placable)
-        m_placeable_areas_cache.insert(std::move(data_placeable), radius);
+        m_caches->placeable_areas_cache.insert(std::move(data_placeable), radius);
 }
 
 void TreeModelVolumes::calculateCollisionHolefree(const std::vector<RadiusLayerPair> &keys, std::function<void()> throw_on_cancel)
@@ -588,7 +783,8 @@ void TreeModelVolumes::calculateCollisionHolefree(const std::vector<RadiusLayerP
         data.reserve(range.size() * keys.size());
         for (LayerIndex layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
             for (RadiusLayerPair key : keys)
-                if (layer_idx <= key.second) {
+                // Skip the areas already calculated by the volumes sharing the cache.
+                if (layer_idx <= key.second && ! m_caches->collision_cache_holefree.getArea({ key.first, layer_idx })) {
                     // Logically increase the collision by m_increase_until_radius
                     coord_t radius = key.first;
                     assert(radius == this->ceilRadius(radius));
@@ -604,7 +800,7 @@ void TreeModelVolumes::calculateCollisionHolefree(const std::vector<RadiusLayerP
                         throw_on_cancel();
                 }
         }
-        m_collision_cache_holefree.insert(std::move(data));
+        m_caches->collision_cache_holefree.insert(std::move(data));
     });
 }
 
@@ -721,7 +917,7 @@ void TreeModelVolumes::calculatePlaceables(const std::vector<RadiusLayerPair> &k
 
 void TreeModelVolumes::calculatePlaceables(const coord_t radius, const LayerIndex max_required_layer, std::function<void()> throw_on_cancel)
 {
-    LayerIndex start_layer = 1 + m_placeable_areas_cache.getMaxCalculatedLayer(radius);
+    LayerIndex start_layer = 1 + m_caches->placeable_areas_cache.getMaxCalculatedLayer(radius);
     if (start_layer > max_required_layer) {
         BOOST_LOG_TRIVIAL(debug) << "Requested calculation for value already calculated ?";
         return;
@@ -755,7 +951,7 @@ void TreeModelVolumes::calculatePlaceables(const coord_t radius, const LayerInde
         }
     }
 #endif
-    m_placeable_areas_cache.insert(std::move(data), start_layer, radius);
+    m_caches->placeable_areas_cache.insert(std::move(data), start_layer, radius);
 }
 
 void TreeModelVolumes::calculateWallRestrictions(const std::vector<RadiusLayerPair> &keys, std::function<void()> throw_on_cancel)
@@ -799,7 +995,7 @@ void TreeModelVolumes::calculateWallRestrictions(const std::vector<RadiusLayerPa
         for (size_t key_idx = range.begin(); key_idx < range.end(); ++ key_idx) {
             const coord_t    radius             = keys[key_idx].first;
             const LayerIndex max_required_layer = keys[key_idx].second;
-            const coord_t    min_layer_bottom   = std::max(1, m_wall_restrictions_cache.getMaxCalculatedLayer(radius));
+            const coord_t    min_layer_bottom   = std::max(1, m_caches->wall_restrictions_cache.getMaxCalculatedLayer(radius));
             const size_t     buffer_size        = max_required_layer + 1 - min_layer_bottom;
             std::vector<Polygons> data(buffer_size, Polygons{});
             std::vector<Polygons> data_min;
@@ -821,9 +1017,9 @@ void TreeModelVolumes::calculateWallRestrictions(const std::vector<RadiusLayerPa
                         throw_on_cancel();
                 }
             });
-            m_wall_restrictions_cache.insert(std::move(data), min_layer_bottom, radius);
+            m_caches->wall_restrictions_cache.insert(std::move(data), min_layer_bottom, radius);
             if (! data_min.empty())
-                m_wall_restrictions_cache_min.insert(std::move(data_min), min_layer_bottom, radius);
+                m_caches->wall_restrictions_cache_min.insert(std::move(data_min), min_layer_bottom, radius);
         }
     });
 }
@@ -866,6 +1062,27 @@ void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layer
     }
 }
 
+size_t TreeModelVolumes::RadiusLayerPolygonCache::memory_size() const
+{
+    std::shared_lock<std::shared_mutex> guard(m_mutex);
+    size_t out = m_data.capacity() * sizeof(LayerData);
+    for (const LayerData &layer : m_data)
+        for (const std::pair<const coord_t, Polygons> &radius_polygons : layer) {
+            out += sizeof(radius_polygons) + radius_polygons.second.capacity() * sizeof(Polygon);
+            for (const Polygon &polygon : radius_polygons.second)
+                out += polygon.points.capacity() * sizeof(Point);
+        }
+    return out;
+}
+
+size_t TreeModelVolumes::Caches::memory_size() const
+{
+    return collision_cache.memory_size() + collision_cache_holefree.memory_size() + 
+           avoidance_cache.memory_size() + avoidance_cache_slow.memory_size() + avoidance_cache_to_model.memory_size() + avoidance_cache_to_model_slow.memory_size() +
+           placeable_areas_cache.memory_size() + avoidance_cache_holefree.memory_size() + avoidance_cache_holefree_to_model.memory_size() +
+           wall_restrictions_cache.memory_size() + wall_restrictions_cache_min.memory_size();
+}
+
 // For debugging purposes, sorted by layer index, then by radius.
 std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::sorted() const
 {
@@ -9,7 +9,9 @@
 #ifndef slic3r_TreeModelVolumes_hpp
 #define slic3r_TreeModelVolumes_hpp
 
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
@@ -24,6 +26,7 @@ namespace Slic3r
 {
 
 class BuildVolume;
+class Print;
 class PrintObject;
 
 namespace TreeSupport3D
@@ -51,23 +54,33 @@ public:
     TreeModelVolumes(const TreeModelVolumes&) = delete;
     TreeModelVolumes& operator=(const TreeModelVolumes&) = delete;
 
+    // Detaches from the caches, which may be shared with other TreeModelVolumes or retained for a later support generation.
     void clear() { 
-        this->clear_all_but_object_collision();
-        m_collision_cache.clear();
-    }
-    void clear_all_but_object_collision() { 
-        //m_collision_cache.clear_all_but_radius0();
-        m_collision_cache_holefree.clear();
-        m_avoidance_cache.clear();
-        m_avoidance_cache_slow.clear();
-        m_avoidance_cache_to_model.clear();
-        m_avoidance_cache_to_model_slow.clear();
-        m_placeable_areas_cache.clear();
-        m_avoidance_cache_holefree.clear();
-        m_avoidance_cache_holefree_to_model.clear();
-        m_wall_restrictions_cache.clear();
-        m_wall_restrictions_cache_min.clear();
+        m_caches = std::make_shared<Caches>();
     }
+    // Releases all but the object collision areas to reduce memory footprint, unless the caches are shared with other TreeModelVolumes alive.
+    // The avoidances of a cache retained for a later support generation are kept while the retained caches fit into
+    // the memory limit, see set_retained_caches_memory_limit().
+    void clear_all_but_object_collision();
+
+    /*!
+     * \brief Number of the most recently used caches of each Print kept alive after their TreeModelVolumes are destroyed.
+     *
+     * Collisions and avoidances are shared by all TreeModelVolumes with the same layer outlines, support blockers, build volume and tree support settings.
+     * A retained cache is reused when the support of an object is regenerated after changing options the avoidances do not depend on.
+     * Zero disables the retention, the caches are then shared by the TreeModelVolumes alive at the same time only.
+     */
+    static void set_retained_caches(size_t num_caches);
+    // Limit of the memory held by the retained caches of all the prints. The least recently used caches are released first once it is exceeded.
+    static void set_retained_caches_memory_limit(size_t num_bytes);
+    // Release the caches retained for the print, for example when the print is cleared. The number of the caches to retain is kept.
+    static void clear_retained_caches(const Print *print);
+    // Number of the caches retained for the print now.
+    static size_t num_retained_caches(const Print *print);
+    // Whether the collisions and avoidances are shared with the other volumes.
+    bool shares_caches_with(const TreeModelVolumes &rhs) const { return m_caches == rhs.m_caches; }
+    // Whether any avoidance areas are cached, that is they were not released by clear_all_but_object_collision().
+    bool has_cached_avoidances() const;
 
     enum class AvoidanceType : int8_t
     {
@@ -211,24 +224,24 @@ private:
         RadiusLayerPolygonCache& operator=(const RadiusLayerPolygonCache&) = delete;
 
         void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            std::unique_lock<std::shared_mutex> guard(m_mutex);
             for (auto &d : in)
                 this->get_allocate_layer_data(d.first.second).emplace(d.first.first, std::move(d.second));
         }
         // by layer
         void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            std::unique_lock<std::shared_mutex> guard(m_mutex);
             for (auto &d : in)
                 this->get_allocate_layer_data(d.first).emplace(radius, std::move(d.second));
         }
         void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            std::unique_lock<std::shared_mutex> guard(m_mutex);
             allocate_layers(first_layer_idx + in.size());
             for (auto &d : in)
                 m_data[first_layer_idx ++].emplace(radius, std::move(d));
         }
         void insert(LayerPolygonCache &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            std::unique_lock<std::shared_mutex> guard(m_mutex);
             LayerIndex i = in.begin();
             allocate_layers(i + LayerIndex(in.size()));
             for (auto &d : in.polygons_mutable())
@@ -240,7 +253,7 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            std::shared_lock<std::shared_mutex> guard(m_mutex);
             if (key.second >= m_data.size())
                 return std::optional<std::reference_wrapper<const Polygons>>{};
             const auto &layer = m_data[key.second];
@@ -250,7 +263,7 @@ private:
         }
         // Get a collision area at a given layer for a radius that is a lower or equial to the key radius.
         std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            std::shared_lock<std::shared_mutex> guard(m_mutex);
             if (key.second >= m_data.size())
                 return {};
             const auto &layer = m_data[key.second];
@@ -272,7 +285,7 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         LayerIndex getMaxCalculatedLayer(coord_t radius) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            std::shared_lock<std::shared_mutex> guard(m_mutex);
             auto layer_idx = LayerIndex(m_data.size()) - 1;
             for (; layer_idx > 0; -- layer_idx)
                 if (const auto &layer = m_data[layer_idx]; layer.find(radius) != layer.end())
@@ -284,7 +297,10 @@ private:
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
 
-        void clear() { m_data.clear(); }
+        void clear() { std::unique_lock<std::shared_mutex> guard(m_mutex); m_data.clear(); }
+        bool empty() const { std::shared_lock<std::shared_mutex> guard(m_mutex); return m_data.empty(); }
+        // Estimate of the memory allocated by the cached areas.
+        size_t memory_size() const;
         void clear_all_but_radius0() { 
             for (LayerData &l : m_data) {
                 auto begin = l.begin();
@@ -302,9 +318,81 @@ private:
         void                allocate_layers(size_t num_layers);
 
         Layers              m_data;
-        mutable std::mutex  m_mutex;
+        // Readers share the lock, only the insertion of newly calculated areas is exclusive.
+        mutable std::shared_mutex m_mutex;
     };
 
+    // Inputs the caches are calculated from, compared before the caches are shared. The hash is compared first.
+    struct CacheKey {
+        size_t                  hash { 0 };
+        std::vector<double>     parameters;
+        std::vector<Polygons>   outlines;
+        std::vector<Polygons>   anti_overhang;
+        // The build volume is translated to the object coordinates, thus it differs for equal objects placed differently.
+        Polygons                machine_border;
+        Polygon                 bed_area;
+
+        bool operator==(const CacheKey &rhs) const {
+            return this->hash == rhs.hash && this->parameters == rhs.parameters && this->outlines == rhs.outlines && this->anti_overhang == rhs.anti_overhang &&
+                   this->machine_border == rhs.machine_border && this->bed_area == rhs.bed_area;
+        }
+    };
+
+    /*!
+     * \brief Caches for the collision, avoidance and areas on the model where support can be placed safely
+     * at given radius and layer indices.
+     */
+    struct Caches {
+        CacheKey                    key;
+
+        RadiusLayerPolygonCache     collision_cache;
+        RadiusLayerPolygonCache     collision_cache_holefree;
+        RadiusLayerPolygonCache     avoidance_cache;
+        RadiusLayerPolygonCache     avoidance_cache_slow;
+        RadiusLayerPolygonCache     avoidance_cache_to_model;
+        RadiusLayerPolygonCache     avoidance_cache_to_model_slow;
+        RadiusLayerPolygonCache     placeable_areas_cache;
+
+        /*!
+         * \brief Caches to avoid holes smaller than the radius until which the radius is always increased, as they are free of holes. 
+         * Also called safe avoidances, as they are safe regarding not running into holes.
+         */
+        RadiusLayerPolygonCache     avoidance_cache_holefree;
+        RadiusLayerPolygonCache     avoidance_cache_holefree_to_model;
+
+        /*!
+         * \brief Caches to represent walls not allowed to be passed over.
+         */
+        RadiusLayerPolygonCache     wall_restrictions_cache;
+
+        // A different cache for min_xy_dist as the maximal safe distance an influence area can be increased(guaranteed overlap of two walls in consecutive layer) 
+        // is much smaller when min_xy_dist is used. This causes the area of the wall restriction to be thinner and as such just using the min_xy_dist wall 
+        // restriction would be slower.    
+        RadiusLayerPolygonCache     wall_restrictions_cache_min;
+
+        void clear_all_but_object_collision() {
+            //collision_cache.clear_all_but_radius0();
+            collision_cache_holefree.clear();
+            avoidance_cache.clear();
+            avoidance_cache_slow.clear();
+            avoidance_cache_to_model.clear();
+            avoidance_cache_to_model_slow.clear();
+            placeable_areas_cache.clear();
+            avoidance_cache_holefree.clear();
+            avoidance_cache_holefree_to_model.clear();
+            wall_restrictions_cache.clear();
+            wall_restrictions_cache_min.clear();
+        }
+        size_t memory_size() const;
+    };
+
+    // Registry of the caches shared between TreeModelVolumes, see set_retained_caches().
+    struct SharedCaches;
+    static SharedCaches& shared_caches();
+    // Find the caches calculated from the same inputs or register new ones, retained for the print.
+    static std::shared_ptr<Caches> acquire_caches(CacheKey &&key, const Print *print);
+    CacheKey cache_key() const;
+
 
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer. Holes are removed.
@@ -492,58 +580,31 @@ private:
     // Z heights of the raft layers (additional layers below the object, last raft layer aligned with the bottom of the first object layer).
     std::vector<double>         m_raft_layers;
 
-    /*!
-     * \brief Caches for the collision, avoidance and areas on the model where support can be placed safely
-     * at given radius and layer indices.
-     */
-    RadiusLayerPolygonCache     m_collision_cache;
-    RadiusLayerPolygonCache     m_collision_cache_holefree;
-    RadiusLayerPolygonCache     m_avoidance_cache;
-    RadiusLayerPolygonCache     m_avoidance_cache_slow;
-    RadiusLayerPolygonCache     m_avoidance_cache_to_model;
-    RadiusLayerPolygonCache     m_avoidance_cache_to_model_slow;
-    RadiusLayerPolygonCache     m_placeable_areas_cache;
-
-    /*!
-     * \brief Caches to avoid holes smaller than the radius until which the radius is always increased, as they are free of holes. 
-     * Also called safe avoidances, as they are safe regarding not running into holes.
-     */
-    RadiusLayerPolygonCache     m_avoidance_cache_holefree;
-    RadiusLayerPolygonCache     m_avoidance_cache_holefree_to_model;
+    std::shared_ptr<Caches>     m_caches { std::make_shared<Caches>() };
 
     RadiusLayerPolygonCache& avoidance_cache(const AvoidanceType type, const bool to_model) {
         if (to_model) {
             switch (type) {
-            case AvoidanceType::Fast:       return m_avoidance_cache_to_model;
-            case AvoidanceType::Slow:       return m_avoidance_cache_to_model_slow;
+            case AvoidanceType::Fast:       return m_caches->avoidance_cache_to_model;
+            case AvoidanceType::Slow:       return m_caches->avoidance_cache_to_model_slow;
             case AvoidanceType::Count:      assert(false);
-            case AvoidanceType::FastSafe:   return m_avoidance_cache_holefree_to_model;
+            case AvoidanceType::FastSafe:   return m_caches->avoidance_cache_holefree_to_model;
             }
         } else {
             switch (type) {
-            case AvoidanceType::Fast:       return m_avoidance_cache;
-            case AvoidanceType::Slow:       return m_avoidance_cache_slow;
+            case AvoidanceType::Fast:       return m_caches->avoidance_cache;
+            case AvoidanceType::Slow:       return m_caches->avoidance_cache_slow;
             case AvoidanceType::Count:      assert(false);
-            case AvoidanceType::FastSafe:   return m_avoidance_cache_holefree;
+            case AvoidanceType::FastSafe:   return m_caches->avoidance_cache_holefree;
             }
         }
         assert(false);
-        return m_avoidance_cache;
+        return m_caches->avoidance_cache;
     }
     const RadiusLayerPolygonCache& avoidance_cache(const AvoidanceType type, const bool to_model) const {
         return const_cast<TreeModelVolumes*>(this)->avoidance_cache(type, to_model);
     }
 
-    /*!
-     * \brief Caches to represent walls not allowed to be passed over.
-     */
-    RadiusLayerPolygonCache     m_wall_restrictions_cache;
-
-    // A different cache for min_xy_dist as the maximal safe distance an influence area can be increased(guaranteed overlap of two walls in consecutive layer) 
-    // is much smaller when min_xy_dist is used. This causes the area of the wall restriction to be thinner and as such just using the min_xy_dist wall 
-    // restriction would be slower.    
-    RadiusLayerPolygonCache     m_wall_restrictions_cache_min;
-
 #ifdef SLIC3R_TREESUPPORTS_PROGRESS
     std::unique_ptr<std::mutex> m_critical_progress { std::make_unique<std::mutex>() };
 #endif // SLIC3R_TREESUPPORTS_PROGRESS
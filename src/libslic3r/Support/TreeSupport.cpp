@@ -149,13 +149,13 @@ Lines spanning_tree_to_lines(const std::vector<MinimumSpanningTree>& spanning_tr
 {
     Lines polylines;
     for (const MinimumSpanningTree& mst : spanning_trees) {
-        std::vector<Point> points = mst.vertices();
+        Points points = mst.vertices();
         std::unordered_set<Point, PointHash> to_ignore;
         for (Point pt1 : points) {
             if (to_ignore.find(pt1) != to_ignore.end())
                 continue;
 
-            const std::vector<Point>& neighbours = mst.adjacent_nodes(pt1);
+            const Points& neighbours = mst.adjacent_nodes(pt1);
             if (neighbours.empty())
                 continue;
 
@@ -395,7 +395,7 @@ static bool move_inside_expolys(const ExPolygons& polygons, Point& from, double
 {
     Point from0 = from;
     Point ret = from;
-    std::vector<Point> valid_pts;
+    Points valid_pts;
     double bestDist2 = std::numeric_limits<double>::max();
     unsigned int bestPoly = NO_INDEX;
     bool is_already_on_correct_side_of_boundary = false; // whether [from] is already on the right side of the boundary
@@ -2631,7 +2631,7 @@ void TreeSupport::drop_nodes()
         std::vector<MinimumSpanningTree> spanning_trees;
         for (const std::unordered_map<Point, SupportNode*, PointHash>& group : nodes_per_part)
         {
-            std::vector<Point> points_to_buildplate;
+            Points points_to_buildplate;
             for (const std::pair<const Point, SupportNode*>& entry : group)
             {
                 points_to_buildplate.emplace_back(entry.first); //Just the position of the node.
@@ -2645,6 +2645,8 @@ void TreeSupport::drop_nodes()
         coordf_t max_y = std::numeric_limits<coordf_t>::min();
         draw_layer_mst(debug_out_path("mtree_%.2f.svg", print_z), spanning_trees, m_object->get_layer(obj_layer_nr)->lslices_extrudable);
 #endif
+        // Nodes created for the next layer by each thread, appended to contact_nodes[layer_nr_next] once all the groups are dropped.
+        tbb::enumerable_thread_specific<std::vector<SupportNode*>> nodes_next_layer;
         for (size_t group_index = 0; group_index < nodes_per_part.size(); group_index++)
         {
             auto& nodes_this_part = nodes_per_part[group_index];
@@ -2658,7 +2660,7 @@ void TreeSupport::drop_nodes()
                 {
                     return; //Delete this node (don't create a new node for it on the next layer).
                 }
-                const std::vector<Point>& neighbours = mst.adjacent_nodes(node.position);
+                const Points& neighbours = mst.adjacent_nodes(node.position);
                 if (node.type == ePolygon) {
                     // Remove all circle neighbours that are completely inside the polygon and merge them into this node.
                     for (const Point &neighbour : neighbours) {
@@ -2705,8 +2707,8 @@ void TreeSupport::drop_nodes()
                     SupportNode* next_node = m_ts_data->create_node(next_position, node_parent->distance_to_top + 1, obj_layer_nr_next, node_parent->support_roof_layers_below - 1, to_buildplate, node_parent,
                         print_z_next, height_next);
                     get_max_move_dist(next_node);
+                    nodes_next_layer.local().push_back(next_node);
                     m_ts_data->m_mutex.lock();
-                    contact_nodes[layer_nr_next].push_back(next_node);
                     neighbour->valid = false;
                     p_node->valid = false;
                     m_ts_data->m_mutex.unlock();
@@ -2757,10 +2759,7 @@ void TreeSupport::drop_nodes()
                                                                           to_buildplate, p_node, print_z_next, height_next);
                         next_node->max_move_dist = 0;
                         next_node->overhang = std::move(overhang);
-                        m_ts_data->m_mutex.lock();
-                        contact_nodes[layer_nr_next].emplace_back(next_node);
-                        m_ts_data->m_mutex.unlock();
-
+                        nodes_next_layer.local().push_back(next_node);
                     }
                     return;
                 }
@@ -2768,7 +2767,6 @@ void TreeSupport::drop_nodes()
                 //If the branch falls completely inside a collision area (the entire branch would be removed by the X/Y offset), delete it.
                 if (group_index > 0 && is_inside_ex(get_collision(0, obj_layer_nr), node.position))
                 {
-                    std::scoped_lock lock(m_ts_data->m_mutex);
                     const coordf_t branch_radius_node = get_radius(p_node);
                     Point to_outside = projection_onto(get_collision(0, obj_layer_nr), node.position);
                     double dist2_to_outside = vsize2_with_unscale(node.position - to_outside);
@@ -2776,6 +2774,7 @@ void TreeSupport::drop_nodes()
                     {
                         if (support_on_buildplate_only)
                         {
+                            std::scoped_lock lock(m_ts_data->m_mutex);
                             unsupported_branch_leaves.push_front({ layer_nr, p_node });
                         }
                         else {
@@ -2792,9 +2791,9 @@ void TreeSupport::drop_nodes()
                 }
                 Point next_layer_vertex = node.position;
                 Point move_to_neighbor_center;
-                std::vector<Point>       moves;
+                Points       moves;
                 std::vector<float>       weights;
-                const std::vector<Point>& neighbours = mst.adjacent_nodes(node.position);
+                const Points& neighbours = mst.adjacent_nodes(node.position);
                 // 1. do not merge neighbors under 5mm
                 // 2. Only merge node with single neighbor in distance between [max_move_distance, 10mm/layer_height]
                 float dist2_to_first_neighbor = neighbours.empty() ? 0 : vsize2_with_unscale(neighbours[0] - node.position);
@@ -2909,12 +2908,11 @@ void TreeSupport::drop_nodes()
                 double dist_to_outer   = unscale_(direction_to_outer.cast<double>().norm());
                 next_node->radius      = std::max(node.radius, std::min(next_node->radius, dist_to_outer));
                 get_max_move_dist(next_node);
-                m_ts_data->m_mutex.lock();
-                contact_nodes[layer_nr_next].push_back(next_node);
-                m_ts_data->m_mutex.unlock();
+                nodes_next_layer.local().push_back(next_node);
             }
             );
         }
+        nodes_next_layer.combine_each([&contact_nodes_next = contact_nodes[layer_nr_next]](const std::vector<SupportNode*> &nodes) { append(contact_nodes_next, nodes); });
 
 #ifdef SUPPORT_TREE_DEBUG_TO_SVG
         if (contact_nodes[layer_nr].empty() == false) {
@@ -2994,7 +2992,7 @@ void TreeSupport::smooth_nodes()
         if (curr_layer_nodes.empty()) continue;
         for (SupportNode *node : curr_layer_nodes) {
             if (!node->is_processed) {
-                std::vector<Point> pts;
+                Points pts;
                 std::vector<double> radii;
                 std::vector<SupportNode *>   branch;
                 SupportNode *              p_node = node;
@@ -3016,7 +3014,7 @@ void TreeSupport::smooth_nodes()
                 } while (p_node && !p_node->is_processed);
                 if (pts.size() < 3) continue;
 
-                std::vector<Point> pts1 = pts;
+                Points pts1 = pts;
                 std::vector<double> radii1 = radii;
                 // TODO here we assume layer height gap is constant. If not true, need to consider height jump
                 const int iterations = 100;
@@ -3324,7 +3322,7 @@ void TreeSupport::generate_contact_points()
         bounding_box_size(0) * cos_angle + bounding_box_size(1) * sin_angle,
         bounding_box_size(0) * sin_angle + bounding_box_size(1) * cos_angle) / 2;
 
-    std::vector<Point> grid_points;
+    Points grid_points;
     coordf_t sample_step = std::max(point_spread, max_bridge_length / 2);
     for (auto x = -rotated_dims(0); x < rotated_dims(0); x += sample_step) {
         for (auto y = -rotated_dims(1); y < rotated_dims(1); y += sample_step) {
@@ -3615,12 +3613,8 @@ Polygons TreeSupportData::get_contours_with_holes(size_t layer_nr) const
 
 SupportNode* TreeSupportData::create_node(const Point position, const int distance_to_top, const int obj_layer_nr, const int support_roof_layers_below, const bool to_buildplate, SupportNode* parent, coordf_t print_z_, coordf_t height_, coordf_t dist_mm_to_top_, coordf_t radius_)
 {
-    // this function may be called from multiple threads, need to lock
-    m_mutex.lock();
-    std::unique_ptr<SupportNode> node = std::make_unique<SupportNode>(position, distance_to_top, obj_layer_nr, support_roof_layers_below, to_buildplate, parent, print_z_, height_, dist_mm_to_top_, radius_);
-    SupportNode* raw_ptr = node.get();
-    contact_nodes.emplace_back(std::move(node));
-    m_mutex.unlock();
+    // this function may be called from multiple threads, each of them allocates from its own pool
+    SupportNode* raw_ptr = &m_node_pools.local().emplace_back(position, distance_to_top, obj_layer_nr, support_roof_layers_below, to_buildplate, parent, print_z_, height_, dist_mm_to_top_, radius_);
     if (parent)
         raw_ptr->movement = position - parent->position;
     return raw_ptr;
@@ -3628,8 +3622,7 @@ SupportNode* TreeSupportData::create_node(const Point position, const int distan
 
 void TreeSupportData::clear_nodes()
 {
-    tbb::spin_mutex::scoped_lock guard(m_mutex);
-    contact_nodes.clear();
+    m_node_pools.clear();
 }
 
 coordf_t TreeSupportData::ceil_radius(coordf_t radius) const
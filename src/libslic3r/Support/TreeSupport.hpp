@@ -4,6 +4,8 @@
 #include <forward_list>
 #include <unordered_set>
 #include "tbb/concurrent_unordered_map.h"
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/scalable_allocator.h"
 #include "../ExPolygon.hpp"
 #include "../Point.hpp"
 #include "../Slicing.hpp"
@@ -244,12 +246,13 @@ public:
     Polygons get_contours(size_t layer_nr) const;
     Polygons get_contours_with_holes(size_t layer_nr) const;
 
+    // Allocates the node from the pool of the calling thread, thus it may be called concurrently without locking.
     SupportNode* create_node(const Point position, const int distance_to_top, const int obj_layer_nr, const int support_roof_layers_below, const bool to_buildplate, SupportNode* parent,
         coordf_t     print_z_, coordf_t height_, coordf_t dist_mm_to_top_ = 0, coordf_t radius_ = 0);
+    // Releases the nodes of all the threads at once.
     void clear_nodes();
     std::vector<LayerHeightData> layer_heights;
 
-    std::vector<std::unique_ptr<SupportNode>> contact_nodes;
     // ExPolygon                  m_machine_border;
 
 private:
@@ -298,6 +301,10 @@ private:
 
     tbb::spin_mutex  m_mutex;
 
+    // Nodes are linked to their parents and children on the other layers up to the end of the support generation,
+    // therefore they are never released one by one. A deque keeps the node addresses stable while the pool grows.
+    tbb::enumerable_thread_specific<Slic3r::deque<SupportNode, tbb::scalable_allocator<SupportNode>>> m_node_pools;
+
 public:
     bool is_slim = false;
     /*!
@@ -12,6 +12,7 @@
 #include <deque>
 #include <queue>
 #include <mutex>
+#include <tuple>
 #include <utility>
 
 #include <boost/log/trivial.hpp>
@@ -472,41 +473,24 @@ static FacetSliceType slice_facet_for_cut_mesh(
     return FacetSliceType::NoSlice;
 }
 
-template<typename TransformVertex>
-void slice_facet_at_zs(
-    // Scaled or unscaled vertices. transform_vertex_fn may scale zs.
-    const std::vector<Vec3f>                         &mesh_vertices,
-    const TransformVertex                            &transform_vertex_fn,
-    const stl_triangle_vertex_indices                &indices,
-    const Vec3i                                      &edge_ids,
-    // Scaled or unscaled zs. If vertices have their zs scaled or transform_vertex_fn scales them, then zs have to be scaled as well.
-    const std::vector<float>                         &zs,
-    std::vector<IntersectionLines>                   &lines,
-    std::array<std::mutex, 64>                       &lines_mutex)
+// Range of indices of the slicing planes crossing a face: first plane with slice_z >= min_z,
+// first plane with slice_z > max_z. The range is empty for a horizontal triangle: Any valid horizontal triangle must have
+// a vertical triangle connected, otherwise the part has zero volume.
+static inline std::pair<int, int> facet_slice_range(const std::vector<float> &vertex_z, const stl_triangle_vertex_indices &face, const std::vector<float> &zs)
 {
-    stl_vertex vertices[3] { transform_vertex_fn(mesh_vertices[indices(0)]), transform_vertex_fn(mesh_vertices[indices(1)]), transform_vertex_fn(mesh_vertices[indices(2)]) };
-
-    // find facet extents
-    const float min_z = fminf(vertices[0].z(), fminf(vertices[1].z(), vertices[2].z()));
-    const float max_z = fmaxf(vertices[0].z(), fmaxf(vertices[1].z(), vertices[2].z()));
-
-    // find layer extents
-    auto min_layer = std::lower_bound(zs.begin(), zs.end(), min_z); // first layer whose slice_z is >= min_z
-    auto max_layer = std::upper_bound(min_layer, zs.end(), max_z); // first layer whose slice_z is > max_z
-    int  idx_vertex_lowest = (vertices[1].z() == min_z) ? 1 : ((vertices[2].z() == min_z) ? 2 : 0);
-
-    for (auto it = min_layer; it != max_layer; ++ it) {
-        IntersectionLine il;
-        // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
-        if (min_z != max_z && slice_facet(*it, vertices, indices, edge_ids, idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
-            assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
-            size_t slice_id = it - zs.begin();
-            boost::lock_guard<std::mutex> l(lines_mutex[slice_id % lines_mutex.size()]);
-            lines[slice_id].emplace_back(il);
-        }
-    }
+    const float z0    = vertex_z[face(0)];
+    const float z1    = vertex_z[face(1)];
+    const float z2    = vertex_z[face(2)];
+    const float min_z = std::min(z0, std::min(z1, z2));
+    const float max_z = std::max(z0, std::max(z1, z2));
+    if (min_z == max_z)
+        return { 0, 0 };
+    auto min_layer = std::lower_bound(zs.begin(), zs.end(), min_z);
+    return { int(min_layer - zs.begin()), int(std::upper_bound(min_layer, zs.end(), max_z) - zs.begin()) };
 }
 
+// The faces are bucketed by the slicing planes they cross, then each thread slices a contiguous range of planes,
+// therefore the intersection lines are collected without locking and in the order of the faces.
 template<typename TransformVertex, typename ThrowOnCancel>
 static inline std::vector<IntersectionLines> slice_make_lines(
     const std::vector<stl_vertex>                   &vertices,
@@ -517,14 +501,87 @@ static inline std::vector<IntersectionLines> slice_make_lines(
     const ThrowOnCancel                              throw_on_cancel_fn)
 {
     std::vector<IntersectionLines>  lines(zs.size(), IntersectionLines());
-    std::array<std::mutex, 64>      lines_mutex;
-    tbb::parallel_for(
-        tbb::blocked_range<int>(0, int(indices.size())),
-        [&vertices, &transform_vertex_fn, &indices, &face_edge_ids, &zs, &lines, &lines_mutex, throw_on_cancel_fn](const tbb::blocked_range<int> &range) {
-            for (int face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
-                if ((face_idx & 0x0ffff) == 0)
+    if (zs.empty() || indices.empty())
+        return lines;
+
+    // Counting sort of the faces by the slicing planes they cross. Faces are processed in fixed size chunks,
+    // each chunk counts into its own row of chunk_counts, which is then converted into the row's output offsets.
+    static constexpr const size_t faces_per_chunk = 0x10000;
+    const size_t num_layers = zs.size();
+    const size_t num_chunks = (indices.size() + faces_per_chunk - 1) / faces_per_chunk;
+    std::vector<size_t> chunk_counts(num_chunks * num_layers, 0);
+    std::vector<int>    face_first_layer(indices.size());
+    std::vector<int>    face_last_layer(indices.size());
+    {
+        std::vector<float> vertex_z(vertices.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, vertices.size()),
+            [&vertices, &transform_vertex_fn, &vertex_z](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i)
+                    vertex_z[i] = transform_vertex_fn(vertices[i]).z();
+            });
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+            [&vertex_z, &indices, &zs, &face_first_layer, &face_last_layer, &chunk_counts, num_layers, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+                for (size_t chunk_id = range.begin(); chunk_id < range.end(); ++ chunk_id) {
                     throw_on_cancel_fn();
-                slice_facet_at_zs(vertices, transform_vertex_fn, indices[face_idx], face_edge_ids[face_idx], zs, lines, lines_mutex);
+                    const size_t face_begin = chunk_id * faces_per_chunk;
+                    const size_t face_end   = std::min(indices.size(), face_begin + faces_per_chunk);
+                    size_t *counts = chunk_counts.data() + chunk_id * num_layers;
+                    for (size_t face_idx = face_begin; face_idx < face_end; ++ face_idx) {
+                        std::tie(face_first_layer[face_idx], face_last_layer[face_idx]) = facet_slice_range(vertex_z, indices[face_idx], zs);
+                        for (int layer_id = face_first_layer[face_idx]; layer_id < face_last_layer[face_idx]; ++ layer_id)
+                            ++ counts[layer_id];
+                    }
+                }
+            });
+    }
+
+    std::vector<size_t> layer_offsets(num_layers + 1, 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers),
+        [&chunk_counts, &layer_offsets, num_chunks, num_layers](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                size_t offset = 0;
+                for (size_t chunk_id = 0; chunk_id < num_chunks; ++ chunk_id)
+                    offset += std::exchange(chunk_counts[chunk_id * num_layers + layer_id], offset);
+                layer_offsets[layer_id + 1] = offset;
+            }
+        });
+    for (size_t layer_id = 0; layer_id < num_layers; ++ layer_id)
+        layer_offsets[layer_id + 1] += layer_offsets[layer_id];
+
+    std::vector<int> layer_faces(layer_offsets.back());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+        [&indices, &face_first_layer, &face_last_layer, &chunk_counts, &layer_offsets, &layer_faces, num_layers, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+            for (size_t chunk_id = range.begin(); chunk_id < range.end(); ++ chunk_id) {
+                throw_on_cancel_fn();
+                size_t *offsets = chunk_counts.data() + chunk_id * num_layers;
+                for (size_t face_idx = chunk_id * faces_per_chunk; face_idx < std::min(indices.size(), (chunk_id + 1) * faces_per_chunk); ++ face_idx)
+                    for (int layer_id = face_first_layer[face_idx]; layer_id < face_last_layer[face_idx]; ++ layer_id)
+                        layer_faces[layer_offsets[layer_id] + offsets[layer_id] ++] = int(face_idx);
+            }
+        });
+    chunk_counts     = std::vector<size_t>();
+    face_first_layer = std::vector<int>();
+    face_last_layer  = std::vector<int>();
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, num_layers),
+        [&vertices, &transform_vertex_fn, &indices, &face_edge_ids, &zs, &lines, &layer_offsets, &layer_faces, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                throw_on_cancel_fn();
+                IntersectionLines &layer_lines = lines[layer_id];
+                layer_lines.reserve(layer_offsets[layer_id + 1] - layer_offsets[layer_id]);
+                for (size_t i = layer_offsets[layer_id]; i < layer_offsets[layer_id + 1]; ++ i) {
+                    const int                          face_idx = layer_faces[i];
+                    const stl_triangle_vertex_indices &face     = indices[face_idx];
+                    stl_vertex facet_vertices[3] { transform_vertex_fn(vertices[face(0)]), transform_vertex_fn(vertices[face(1)]), transform_vertex_fn(vertices[face(2)]) };
+                    const float min_z = fminf(facet_vertices[0].z(), fminf(facet_vertices[1].z(), facet_vertices[2].z()));
+                    int  idx_vertex_lowest = (facet_vertices[1].z() == min_z) ? 1 : ((facet_vertices[2].z() == min_z) ? 2 : 0);
+                    IntersectionLine il;
+                    if (slice_facet(zs[layer_id], facet_vertices, face, face_edge_ids[face_idx], idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
+                        assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+                        layer_lines.emplace_back(il);
+                    }
+                }
             }
         }
     );
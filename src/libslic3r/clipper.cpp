@@ -9,5 +9,7 @@
 #define CLIPPERLIB_NAMESPACE_PREFIX	Slic3r
 // Override Slic3r::ClipperLib::IntPoint to Slic3r::Point
 #define CLIPPERLIB_INTPOINT_TYPE    Slic3r::Point
+// Override Slic3r::ClipperLib::Path to Slic3r::Points
+#define CLIPPERLIB_PATH_TYPE        Slic3r::Points
 
 #include <clipper/clipper.cpp>
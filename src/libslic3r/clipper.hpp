@@ -16,11 +16,13 @@
 
 #define CLIPPERLIB_NAMESPACE_PREFIX		Slic3r
 #define CLIPPERLIB_INTPOINT_TYPE    	Slic3r::Point
+#define CLIPPERLIB_PATH_TYPE        	Slic3r::Points
 
 #include <clipper/clipper.hpp>
 
 #undef clipper_hpp
 #undef CLIPPERLIB_NAMESPACE_PREFIX
 #undef CLIPPERLIB_INTPOINT_TYPE
+#undef CLIPPERLIB_PATH_TYPE
 
 #endif // slic3r_clipper_hpp
@@ -126,8 +126,8 @@ enum Axis {
 	NUM_AXES_WITH_UNKNOWN,
 };
 
-template <typename T>
-inline void append(std::vector<T>& dest, const std::vector<T>& src)
+template <typename T, typename... Args> // Arbitrary allocator can be used
+inline void append(std::vector<T, Args...>& dest, const std::vector<T, Args...>& src)
 {
     if (dest.empty())
         dest = src;
@@ -135,8 +135,8 @@ inline void append(std::vector<T>& dest, const std::vector<T>& src)
         dest.insert(dest.end(), src.begin(), src.end());
 }
 
-template <typename T>
-inline void append(std::vector<T>& dest, std::vector<T>&& src)
+template <typename T, typename... Args> // Arbitrary allocator can be used
+inline void append(std::vector<T, Args...>& dest, std::vector<T, Args...>&& src)
 {
     if (dest.empty())
         dest = std::move(src);
@@ -158,8 +158,8 @@ void clear_and_shrink(std::vector<T, Args...>& vec)
 }
 
 // Append the source in reverse.
-template <typename T>
-inline void append_reversed(std::vector<T>& dest, const std::vector<T>& src)
+template <typename T, typename... Args> // Arbitrary allocator can be used
+inline void append_reversed(std::vector<T, Args...>& dest, const std::vector<T, Args...>& src)
 {
     if (dest.empty())
         dest = src;
@@ -168,8 +168,8 @@ inline void append_reversed(std::vector<T>& dest, const std::vector<T>& src)
 }
 
 // Append the source in reverse.
-template <typename T>
-inline void append_reversed(std::vector<T>& dest, std::vector<T>&& src)
+template <typename T, typename... Args> // Arbitrary allocator can be used
+inline void append_reversed(std::vector<T, Args...>& dest, std::vector<T, Args...>&& src)
 {
     if (dest.empty())
         dest = std::move(src);
@@ -200,8 +200,8 @@ inline void remove_nulls(std::vector<T*> &vec)
     	vec.end());
 }
 
-template <typename T>
-inline void sort_remove_duplicates(std::vector<T> &vec)
+template <typename T, typename... Args> // Arbitrary allocator can be used
+inline void sort_remove_duplicates(std::vector<T, Args...> &vec)
 {
 	std::sort(vec.begin(), vec.end());
 	vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
@@ -11,6 +11,7 @@
 #include "Platform.hpp"
 #include "Time.hpp"
 #include "libslic3r.h"
+#include "Point.hpp"
 
 #ifdef __APPLE__
 #include "MacUtils.hpp"
@@ -1367,10 +1368,51 @@ std::string log_memory_info(bool ignore_loglevel)
         else
             out += "N/A";
 #endif
+#ifdef SLIC3R_POINTS_ALLOCATOR
+        // Points allocated since the start, as the steps of the objects may run concurrently.
+        // The allocations of a step are logged by Print::process() from its serial parts.
+        PointsAllocations points_alloc = points_allocations();
+        out += "; Points allocations: " + std::to_string(points_alloc.count) + " (" + format_memsize_MB(points_alloc.bytes) + ")";
+#endif // SLIC3R_POINTS_ALLOCATOR
     }
     return out;
 }
 
+size_t peak_memory_usage()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return (size_t)pmc.PeakWorkingSetSize;
+#elif defined(__linux__) or defined(__APPLE__)
+    rusage memory_info;
+    if (getrusage(RUSAGE_SELF, &memory_info) == 0) {
+        size_t peak_mem_usage = (size_t)memory_info.ru_maxrss;
+    #ifdef __linux__
+        peak_mem_usage *= 1024;// getrusage returns the value in kB on linux
+    #endif
+        return peak_mem_usage;
+    }
+#endif
+    return 0;
+}
+
+long long process_cpu_time_ms()
+{
+#ifdef WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+        auto to_100ns = [](const FILETIME &t) { return ((long long)t.dwHighDateTime << 32) | (long long)t.dwLowDateTime; };
+        return (to_100ns(kernel_time) + to_100ns(user_time)) / 10000;
+    }
+#elif defined(__linux__) or defined(__APPLE__)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return (long long)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+#endif
+    return 0;
+}
+
 // Returns the size of physical memory (RAM) in bytes.
 // http://nadeausoftware.com/articles/2012/09/c_c_tip_how_get_physical_memory_size_system
 size_t total_physical_memory()
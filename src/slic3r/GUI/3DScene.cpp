@@ -673,7 +673,7 @@ bool GLVolume::simplify_mesh(const indexed_triangle_set &_its, std::shared_ptr<G
             int          init_face_count = its->indices.size();
             TriangleMesh origin_mesh(*its);
             try { // Start the actual calculation.
-                its_quadric_edge_collapse(*its, triangle_count, &max_error, throw_on_cancel, statusfn);
+                its_quadric_edge_collapse_parallel(*its, triangle_count, &max_error, throw_on_cancel, statusfn);
             } catch (std::exception&) {
                 state->status = State::idle;
             }
@@ -767,7 +767,9 @@ void BackgroundSlicingProcess::finalize_gcode()
 {
     m_print->set_status(95, _utf8(L("Running post-processing scripts")));
 
-    run_post_process_scripts(m_temp_output_path, false, "File", m_temp_output_path, m_fff_print->full_print_config());
+    if (run_post_process_scripts(m_temp_output_path, false, "File", m_temp_output_path, m_fff_print->full_print_config()))
+        // The scripts changed the G-code in place, MD5 computed during the export is no more valid.
+        m_gcode_result->gcode_md5.clear();
 
     m_print->set_status(100, _utf8(L("Successfully executed post-processing script")));
 }
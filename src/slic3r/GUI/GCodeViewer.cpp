@@ -1180,33 +1180,34 @@ void GCodeViewer::refresh(const GCodeProcessorResult& gcode_result, const std::v
 
     // update ranges for coloring / legend
     m_extrusions.reset_ranges();
+    const GCodeProcessorResult::MoveVertices &moves = gcode_result.moves;
     for (size_t i = 0; i < m_moves_count; ++i) {
         // skip first vertex
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+        const EMoveType type = moves.type(i);
 
-        switch (curr.type)
+        switch (type)
         {
         case EMoveType::Extrude:
         {
-            m_extrusions.ranges.height.update_from(round_to_bin(curr.height));
-            m_extrusions.ranges.width.update_from(round_to_bin(curr.width));
-            m_extrusions.ranges.fan_speed.update_from(curr.fan_speed);
-            m_extrusions.ranges.temperature.update_from(curr.temperature);
-            if (curr.extrusion_role != erCustom || is_visible(erCustom))
-                m_extrusions.ranges.volumetric_rate.update_from(round_to_bin(curr.volumetric_rate()));
-
-            if (curr.layer_duration > 0.f) {
-                m_extrusions.ranges.layer_duration.update_from(curr.layer_duration);
+            m_extrusions.ranges.height.update_from(round_to_bin(moves.height(i)));
+            m_extrusions.ranges.width.update_from(round_to_bin(moves.width(i)));
+            m_extrusions.ranges.fan_speed.update_from(moves.fan_speed(i));
+            m_extrusions.ranges.temperature.update_from(moves.temperature(i));
+            if (moves.extrusion_role(i) != erCustom || is_visible(erCustom))
+                m_extrusions.ranges.volumetric_rate.update_from(round_to_bin(moves.volumetric_rate(i)));
+
+            if (moves.layer_duration(i) > 0.f) {
+                m_extrusions.ranges.layer_duration.update_from(moves.layer_duration(i));
             }
             [[fallthrough]];
         }
         case EMoveType::Travel:
         {
-            if (m_buffers[buffer_id(curr.type)].visible)
-                m_extrusions.ranges.feedrate.update_from(curr.feedrate);
+            if (m_buffers[buffer_id(type)].visible)
+                m_extrusions.ranges.feedrate.update_from(moves.feedrate(i));
 
             break;
         }
@@ -1823,14 +1824,15 @@ void GCodeViewer::update_layers_slider_mode()
 
 void GCodeViewer::update_marker_curr_move() {
     if ((int)m_last_result_id != -1) {
-        auto it = std::find_if(m_gcode_result->moves.begin(), m_gcode_result->moves.end(), [this](auto move) {
-                if (m_sequential_view.current.last < m_sequential_view.gcode_ids.size() && m_sequential_view.current.last >= 0) {
-                    return move.gcode_id == static_cast<uint64_t>(m_sequential_view.gcode_ids[m_sequential_view.current.last]);
+        if (m_sequential_view.current.last < m_sequential_view.gcode_ids.size() && m_sequential_view.current.last >= 0) {
+            const GCodeProcessorResult::MoveVertices &moves    = m_gcode_result->moves;
+            const uint64_t                            gcode_id = m_sequential_view.gcode_ids[m_sequential_view.current.last];
+            for (size_t i = 0; i < moves.size(); ++ i)
+                if (moves.gcode_id(i) == gcode_id) {
+                    m_sequential_view.marker.update_curr_move(moves[i]);
+                    break;
                 }
-                return false;
-            });
-        if (it != m_gcode_result->moves.end())
-            m_sequential_view.marker.update_curr_move(*it);
+        }
     }
 }
 
@@ -2387,7 +2389,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessorResult::MoveVertex);
+    m_statistics.results_size = gcode_result.moves.memory_usage();
     m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
@@ -2411,37 +2413,39 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
     // extract approximate paths bounding box from result
     //BBS: add only gcode mode
-    for (const GCodeProcessorResult::MoveVertex& move : gcode_result.moves) {
+    const GCodeProcessorResult::MoveVertices &moves = gcode_result.moves;
+    for (size_t move_id = 0; move_id < moves.size(); ++ move_id) {
         //if (wxGetApp().is_gcode_viewer()) {
         //if (m_only_gcode_in_preview) {
             // for the gcode viewer we need to take in account all moves to correctly size the printbed
-        //    m_paths_bounding_box.merge(move.position.cast<double>());
+        //    m_paths_bounding_box.merge(moves.position(move_id).cast<double>());
         //}
         //else {
-            if (move.type == EMoveType::Extrude && move.extrusion_role != erCustom && move.width != 0.0f && move.height != 0.0f) {
-                m_paths_bounding_box.merge(move.position.cast<double>());
+            if (moves.type(move_id) == EMoveType::Extrude && moves.extrusion_role(move_id) != erCustom && moves.width(move_id) != 0.0f && moves.height(move_id) != 0.0f) {
+                const Vec3f &position = moves.position(move_id);
+                m_paths_bounding_box.merge(position.cast<double>());
                 //BBS: use convex_hull for toolpath outside check
-                pts.emplace_back(Point(scale_(move.position.x()), scale_(move.position.y())));
+                pts.emplace_back(Point(scale_(position.x()), scale_(position.y())));
             }
         //}
     }
 
     // BBS: also merge the point on arc to bounding box
-    for (const GCodeProcessorResult::MoveVertex& move : gcode_result.moves) {
+    for (size_t move_id = 0; move_id < moves.size(); ++ move_id) {
         // continue if not arc path
-        if (!move.is_arc_move_with_interpolation_points())
+        if (!moves.is_arc_move_with_interpolation_points(move_id))
             continue;
 
         //if (wxGetApp().is_gcode_viewer())
         //if (m_only_gcode_in_preview)
-        //    for (int i = 0; i < move.interpolation_points.size(); i++)
-        //        m_paths_bounding_box.merge(move.interpolation_points[i].cast<double>());
+        //    for (const Vec3f &point : moves.interpolation_points(move_id))
+        //        m_paths_bounding_box.merge(point.cast<double>());
         //else {
-            if (move.type == EMoveType::Extrude && move.width != 0.0f && move.height != 0.0f)
-                for (int i = 0; i < move.interpolation_points.size(); i++) {
-                    m_paths_bounding_box.merge(move.interpolation_points[i].cast<double>());
+            if (moves.type(move_id) == EMoveType::Extrude && moves.width(move_id) != 0.0f && moves.height(move_id) != 0.0f)
+                for (const Vec3f &point : moves.interpolation_points(move_id)) {
+                    m_paths_bounding_box.merge(point.cast<double>());
                     //BBS: use convex_hull for toolpath outside check
-                    pts.emplace_back(Point(scale_(move.interpolation_points[i].x()), scale_(move.interpolation_points[i].y())));
+                    pts.emplace_back(Point(scale_(point.x()), scale_(point.y())));
                 }
         //}
     }
@@ -2481,9 +2485,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
     m_sequential_view.gcode_ids.clear();
     for (size_t i = 0; i < gcode_result.moves.size(); ++i) {
-        const GCodeProcessorResult::MoveVertex& move = gcode_result.moves[i];
-        if (move.type != EMoveType::Seam)
-            m_sequential_view.gcode_ids.push_back(move.gcode_id);
+        if (moves.type(i) != EMoveType::Seam)
+            m_sequential_view.gcode_ids.push_back(moves.gcode_id(i));
     }
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(",m_contained_in_bed %1%\n")%m_contained_in_bed;
 
@@ -2498,8 +2501,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     std::vector<size_t> biased_seams_ids;
 
     // toolpaths data -> extract vertices from result
+    // The moves are assembled into two buffers swapped at each step, the previous move is not assembled again.
+    GCodeProcessorResult::MoveVertex prev, curr;
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+        std::swap(prev, curr);
+        gcode_result.moves.get(i, curr);
         if (curr.type == EMoveType::Seam) {
             ++seams_count;
             biased_seams_ids.push_back(i - biased_seams_ids.size() - 1);
@@ -2511,8 +2517,6 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
-
         // update progress dialog
         ++progress_count;
         if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
@@ -2627,14 +2631,10 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 VertexBuffer& vbuffer = v_multibuffer[prev_sub_path.first.b_id];
                 // offset into the vertex buffer of the next segment 1st vertex
                 size_t temp_offset = prev_sub_path.last.s_id - curr_s_id;
-                for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--) {
-                    size_t move_id = m_ssid_to_moveid_map[i];
-                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points.size() : 0);
-                }
-                if (is_internal_point) {
-                    size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                    temp_offset += (gcode_result.moves[move_id].interpolation_points.size() - interpolation_point_id);
-                }
+                for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--)
+                    temp_offset += gcode_result.moves.interpolation_points(m_ssid_to_moveid_map[i]).size();
+                if (is_internal_point)
+                    temp_offset += gcode_result.moves.interpolation_points(m_ssid_to_moveid_map[curr_s_id]).size() - interpolation_point_id;
                 const size_t next_1st_offset = temp_offset * 6 * vertex_size_floats;
                 // offset into the vertex buffer of the right vertex of the previous segment
                 const size_t prev_right_offset = prev_sub_path.last.i_id - next_1st_offset - 3 * vertex_size_floats;
@@ -2669,14 +2669,10 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 VertexBuffer& vbuffer = v_multibuffer[prev_sub_path.first.b_id];
                 // offset into the vertex buffer of the next segment 1st vertex
                 size_t temp_offset = prev_sub_path.last.s_id - curr_s_id;
-                for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--) {
-                    size_t move_id = m_ssid_to_moveid_map[i];
-                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points.size() : 0);
-                }
-                if (is_internal_point) {
-                    size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                    temp_offset += (gcode_result.moves[move_id].interpolation_points.size() - interpolation_point_id);
-                }
+                for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--)
+                    temp_offset += gcode_result.moves.interpolation_points(m_ssid_to_moveid_map[i]).size();
+                if (is_internal_point)
+                    temp_offset += gcode_result.moves.interpolation_points(m_ssid_to_moveid_map[curr_s_id]).size() - interpolation_point_id;
                 const size_t next_1st_offset = temp_offset * 6 * vertex_size_floats;
                 // offset into the vertex buffer of the left vertex of the previous segment
                 const size_t prev_left_offset = prev_sub_path.last.i_id - next_1st_offset - 1 * vertex_size_floats;
@@ -2706,6 +2702,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         };
 
         size_t vertex_size_floats = t_buffer.vertices.vertex_size_floats();
+        // Buffer reused by all the moves, its arc points keep their allocation.
+        GCodeProcessorResult::MoveVertex curr_move;
         for (const Path& path : t_buffer.paths) {
             //BBS: the two segments of the path sharing the current vertex may belong
             //to two different vertex buffers
@@ -2717,14 +2715,15 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             for (size_t j = 1; j < path_vertices_count; ++j) {
                 size_t curr_s_id = path.sub_paths.front().first.s_id + j;
                 size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                int interpolation_points_num = gcode_result.moves[move_id].is_arc_move_with_interpolation_points()?
-                                                    gcode_result.moves[move_id].interpolation_points.size() : 0;
+                gcode_result.moves.get(move_id, curr_move);
+                int interpolation_points_num = curr_move.is_arc_move_with_interpolation_points()?
+                                                    curr_move.interpolation_points.size() : 0;
                 int loop_num = interpolation_points_num;
                 //BBS: select the subpaths which contains the previous/next segments
                 if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
                     ++prev_sub_path_id;
                 if (j == path_vertices_count - 1) {
-                    if (!gcode_result.moves[move_id].is_arc_move_with_interpolation_points())
+                    if (!curr_move.is_arc_move_with_interpolation_points())
                         break;   // BBS: the last move has no internal point.
                     loop_num--;  //BBS: don't need to handle the endpoint of the last arc move of path
                     next_sub_path_id = prev_sub_path_id;
@@ -2735,20 +2734,24 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 const Path::Sub_Path& prev_sub_path = path.sub_paths[prev_sub_path_id];
                 const Path::Sub_Path& next_sub_path = path.sub_paths[next_sub_path_id];
 
+                const Vec3f prev_move_position = gcode_result.moves.position(move_id - 1);
+                // First point of the next move, towards which the corner at the end of the current move is smoothed.
+                Vec3f next_move_first_point = Vec3f::Zero();
+                if (move_id + 1 < gcode_result.moves.size())
+                    next_move_first_point = gcode_result.moves.is_arc_move_with_interpolation_points(move_id + 1) ?
+                                                gcode_result.moves.interpolation_points(move_id + 1)[0] : gcode_result.moves.position(move_id + 1);
+
                 // BBS: smooth triangle toolpaths corners including arc move which has internal interpolation point
                 for (int k = 0; k <= loop_num; k++) {
                     const Vec3f& prev = k==0?
-                                        gcode_result.moves[move_id - 1].position :
-                                        gcode_result.moves[move_id].interpolation_points[k-1];
+                                        prev_move_position :
+                                        curr_move.interpolation_points[k-1];
                     const Vec3f& curr = k==interpolation_points_num?
-                                        gcode_result.moves[move_id].position :
-                                        gcode_result.moves[move_id].interpolation_points[k];
+                                        curr_move.position :
+                                        curr_move.interpolation_points[k];
                     const Vec3f& next = k < interpolation_points_num - 1?
-                                        gcode_result.moves[move_id].interpolation_points[k+1]:
-                                        (k == interpolation_points_num - 1? gcode_result.moves[move_id].position :
-                                        (gcode_result.moves[move_id + 1].is_arc_move_with_interpolation_points()?
-                                        gcode_result.moves[move_id + 1].interpolation_points[0] :
-                                        gcode_result.moves[move_id + 1].position));
+                                        curr_move.interpolation_points[k+1]:
+                                        (k == interpolation_points_num - 1? curr_move.position : next_move_first_point);
 
                     const Vec3f prev_dir = (curr - prev).normalized();
                     const Vec3f prev_right = Vec3f(prev_dir.y(), -prev_dir.x(), 0.0f).normalized();
@@ -2899,8 +2902,15 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
     seams_count = 0;
 
+    // The moves are assembled into prev, curr and next_move rotated at each step, each move is assembled once.
+    GCodeProcessorResult::MoveVertex next_move;
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+        std::swap(prev, curr);
+        // next_move was assembled by the previous step, except at the first two steps.
+        if (i > 1)
+            std::swap(curr, next_move);
+        else
+            gcode_result.moves.get(i, curr);
         if (curr.type == EMoveType::Seam)
             ++seams_count;
 
@@ -2910,10 +2920,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
         const GCodeProcessorResult::MoveVertex* next = nullptr;
-        if (i < m_moves_count - 1)
-            next = &gcode_result.moves[i + 1];
+        if (i < m_moves_count - 1) {
+            gcode_result.moves.get(i + 1, next_move);
+            next = &next_move;
+        }
 
         ++progress_count;
         if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
@@ -3070,27 +3081,27 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     size_t last_travel_s_id = 0;
     seams_count = 0;
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& move = gcode_result.moves[i];
-        if (move.type == EMoveType::Seam)
+        const EMoveType type = moves.type(i);
+        if (type == EMoveType::Seam)
             ++seams_count;
 
         size_t move_id = i - seams_count;
 
-        if (move.type == EMoveType::Extrude) {
+        if (type == EMoveType::Extrude) {
             // layers zs
             const double* const last_z = m_layers.empty() ? nullptr : &m_layers.get_zs().back();
-            const double z = static_cast<double>(move.position.z());
+            const double z = static_cast<double>(moves.position(i).z());
             if (last_z == nullptr || z < *last_z - EPSILON || *last_z + EPSILON < z)
                 m_layers.append(z, { last_travel_s_id, move_id });
             else
                 m_layers.get_endpoints().back().last = move_id;
             // extruder ids
-            m_extruder_ids.emplace_back(move.extruder_id);
+            m_extruder_ids.emplace_back(moves.extruder_id(i));
             // roles
             if (i > 0)
-                m_roles.emplace_back(move.extrusion_role);
+                m_roles.emplace_back(moves.extrusion_role(i));
         }
-        else if (move.type == EMoveType::Travel) {
+        else if (type == EMoveType::Travel) {
             if (move_id - last_travel_s_id > 1 && !m_layers.empty())
                 m_layers.get_endpoints().back().last = move_id;
 
@@ -3492,10 +3503,7 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
                             if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Line) {
                                 for (size_t i = sub_path.first.s_id + 1; i < m_sequential_view.current.last + 1; i++) {
                                     size_t move_id = m_ssid_to_moveid_map[i];
-                                    const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
-                                    if (curr.is_arc_move()) {
-                                        offset += curr.interpolation_points.size();
-                                    }
+                                    offset += m_gcode_result->moves.interpolation_points(move_id).size();
                                 }
                                 offset = 2 * offset - 1;
                             }
@@ -3504,10 +3512,7 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
                                 // BBS: modify to support moves which has internal point
                                 for (size_t i = sub_path.first.s_id + 1; i < m_sequential_view.current.last + 1; i++) {
                                     size_t move_id = m_ssid_to_moveid_map[i];
-                                    const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
-                                    if (curr.is_arc_move()) {
-                                        offset += curr.interpolation_points.size();
-                                    }
+                                    offset += m_gcode_result->moves.interpolation_points(move_id).size();
                                 }
                                 offset = indices_count * (offset - 1) + (indices_count - 2);
                                 if (sub_path_id == 0)
@@ -3606,10 +3611,7 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
             unsigned int segments_count = max_s_id - min_s_id;
             for (size_t i = min_s_id + 1; i < max_s_id + 1; i++) {
                 size_t move_id = m_ssid_to_moveid_map[i];
-                const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
-                if (curr.is_arc_move()) {
-                    segments_count += curr.interpolation_points.size();
-                }
+                segments_count += m_gcode_result->moves.interpolation_points(move_id).size();
             }
             size_in_indices = buffer.indices_per_segment() * segments_count;
             break;
@@ -4906,6 +4906,8 @@ void Plater::priv::delete_all_objects_from_model()
     partplate_list.clear();
 
     model.clear_objects();
+    // BBS: the no fit polygons of the deleted objects will not be queried again
+    arrangement::clear_default_nfp_cache();
     update();
     // Delete object from Sidebar list. Do it after update, so that the GLScene selection is updated with the modified model.
     sidebar->obj_list()->delete_all_objects_from_list();
@@ -4946,6 +4948,7 @@ void Plater::priv::reset(bool apply_presets_change)
     // Stop and reset the Print content.
     this->background_process.reset();
     model.clear_objects();
+    arrangement::clear_default_nfp_cache();
     assemble_view->get_canvas3d()->reset_explosion_ratio();
     update();
 
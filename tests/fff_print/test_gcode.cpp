@@ -3,6 +3,12 @@
 #include <memory>
 
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/AsyncFileWriter.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/GCodeReader.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
 
 using namespace Slic3r;
 
@@ -20,3 +26,203 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+SCENARIO("GCodeProcessorResult move storage", "[GCode]") {
+    GIVEN("A linear move and an arc move") {
+        GCodeProcessorResult::MoveVertices moves;
+        std::vector<Vec3f> points { Vec3f(1.f, 0.f, 0.2f), Vec3f(0.f, 1.f, 0.2f) };
+
+        GCodeProcessorResult::MoveVertex linear;
+        linear.gcode_id       = 10;
+        linear.type           = EMoveType::Extrude;
+        linear.extrusion_role = erExternalPerimeter;
+        linear.extruder_id    = 2;
+        linear.position       = Vec3f(1.f, 2.f, 0.2f);
+        linear.width          = 0.42f;
+        linear.height         = 0.2f;
+        linear.layer_duration = 3.f;
+        linear.move_path_type = EMovePathType::Linear_move;
+        moves.push_back(linear);
+
+        GCodeProcessorResult::MoveVertex arc = linear;
+        arc.gcode_id             = 11;
+        arc.move_path_type       = EMovePathType::Arc_move_ccw;
+        arc.arc_center_position  = Vec3f(0.f, 0.f, 0.2f);
+        arc.interpolation_points = points;
+        moves.push_back(arc);
+        points.clear();
+
+        THEN("the moves read back the stored values") {
+            REQUIRE(moves.size() == 2);
+            GCodeProcessorResult::MoveVertex move = moves[0];
+            REQUIRE(move.gcode_id == 10);
+            REQUIRE(move.type == EMoveType::Extrude);
+            REQUIRE(move.extrusion_role == erExternalPerimeter);
+            REQUIRE(move.extruder_id == 2);
+            REQUIRE(move.position == Vec3f(1.f, 2.f, 0.2f));
+            REQUIRE(move.width == 0.42f);
+            REQUIRE(! move.is_arc_move());
+            REQUIRE(move.interpolation_points.empty());
+        }
+        THEN("the arc move owns a copy of its interpolation points") {
+            GCodeProcessorResult::MoveVertex move = moves.back();
+            REQUIRE(move.is_arc_move_with_interpolation_points());
+            REQUIRE(move.interpolation_points.size() == 2);
+            REQUIRE(move.interpolation_points[1] == Vec3f(0.f, 1.f, 0.2f));
+        }
+        WHEN("the arc move is copied and the original erased, as done by the Z corrector") {
+            moves.push_back(moves[1]);
+            moves.height(2) = 0.3f;
+            moves.erase(1);
+            THEN("the copy keeps the interpolation points") {
+                REQUIRE(moves.size() == 2);
+                GCodeProcessorResult::MoveVertex move = moves[1];
+                REQUIRE(move.gcode_id == 11);
+                REQUIRE(move.height == 0.3f);
+                REQUIRE(move.interpolation_points.size() == 2);
+                REQUIRE(move.interpolation_points[0] == Vec3f(1.f, 0.f, 0.2f));
+            }
+        }
+        THEN("the iterators visit all the moves in order") {
+            std::vector<unsigned int> ids;
+            for (const GCodeProcessorResult::MoveVertex &move : moves)
+                ids.emplace_back(move.gcode_id);
+            REQUIRE(ids == std::vector<unsigned int>{ 10, 11 });
+        }
+    }
+}
+
+SCENARIO("GCodeReader parallel file parsing", "[GCode]") {
+    GIVEN("A G-code file with mixed line endings, line numbers and an unterminated last line") {
+        std::string gcode;
+        const char *eols[] = { "\n", "\r\n", "\r", "\n\n" };
+        for (int i = 0; i < 200000; ++ i) {
+            switch (i % 4) {
+            case 0: gcode += "G1 X" + std::to_string(i % 1000) + ".5 Y3.25 E0.125"; break;
+            case 1: gcode += "N" + std::to_string(i) + " G92 E0 ; comment"; break;
+            case 2: gcode += "  ;TYPE:Outer wall"; break;
+            case 3: gcode += "G2 X1 Y2 I3 J4 F1200"; break;
+            }
+            gcode += eols[(i / 4) % 4];
+        }
+        gcode += "G1 Z0.4";
+        boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("gcode_reader_%%%%%%.gcode");
+        {
+            boost::nowide::ofstream out(path.string(), std::ios::binary);
+            out << gcode;
+        }
+        WHEN("the file is parsed serially and in parallel") {
+            struct ParsedLine {
+                std::string raw;
+                float       x;
+                bool        has_e;
+                float       reader_x;
+                bool operator==(const ParsedLine &rhs) const { return raw == rhs.raw && x == rhs.x && has_e == rhs.has_e && reader_x == rhs.reader_x; }
+            };
+            std::vector<ParsedLine> serial, parallel;
+            std::vector<size_t>     serial_lines_ends, parallel_lines_ends;
+            GCodeReader serial_reader, parallel_reader;
+            serial_reader.parse_file(path.string(), [&serial](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+                serial.push_back({ line.raw(), line.x(), line.has_e(), reader.x() });
+            }, serial_lines_ends);
+            parallel_reader.parse_file_parallel(path.string(), [&parallel](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+                parallel.push_back({ line.raw(), line.x(), line.has_e(), reader.x() });
+            }, parallel_lines_ends);
+            boost::filesystem::remove(path);
+            THEN("the same lines, values and line ends are reported") {
+                REQUIRE(parallel.size() == serial.size());
+                REQUIRE(parallel == serial);
+                REQUIRE(parallel_lines_ends == serial_lines_ends);
+                REQUIRE(parallel_reader.z() == 0.4f);
+            }
+        }
+    }
+}
+
+static std::string read_file(const boost::filesystem::path &path)
+{
+    boost::nowide::ifstream in(path.string(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+SCENARIO("AsyncFileWriter", "[GCode]") {
+    GIVEN("Small strings, strings handed over without copying and data over the buffer size") {
+        // Distinct content of each piece to detect reordering.
+        std::vector<std::string> pieces;
+        for (size_t i = 0; i < 200; ++ i) {
+            size_t size = i % 10 == 0 ? AsyncFileWriter::HandoverSize + i : i % 10 == 5 ? AsyncFileWriter::BufferSize / 3 : 17 + i;
+            std::string piece(size, char('a' + i % 26));
+            piece += std::to_string(i) + "\n";
+            pieces.emplace_back(std::move(piece));
+        }
+        std::string expected;
+        for (const std::string &piece : pieces)
+            expected += piece;
+        boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("async_writer_%%%%%%.gcode");
+
+        WHEN("the pieces are written, some of them moved") {
+            std::string md5;
+            {
+                AsyncFileWriter writer(path.string(), true);
+                REQUIRE(writer.is_open());
+                for (size_t i = 0; i < pieces.size(); ++ i) {
+                    if (i % 2 == 0)
+                        writer.write(std::string(pieces[i]));
+                    else
+                        writer.write(pieces[i]);
+                    if (i == pieces.size() / 2) {
+                        // The data written before flush() is stored.
+                        writer.flush();
+                        size_t size = 0;
+                        for (size_t j = 0; j <= i; ++ j)
+                            size += pieces[j].size();
+                        REQUIRE(read_file(path) == expected.substr(0, size));
+                    }
+                }
+                writer.close();
+                REQUIRE(! writer.is_error());
+                REQUIRE(! writer.is_open());
+                md5 = writer.md5();
+            }
+            THEN("the file contains the pieces in the order written") {
+                REQUIRE(read_file(path) == expected);
+            }
+            THEN("the MD5 does not depend on how the data was split") {
+                boost::filesystem::path path2 = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("async_writer_%%%%%%.gcode");
+                AsyncFileWriter writer(path2.string(), true);
+                writer.write(expected.data(), expected.size());
+                writer.close();
+                boost::filesystem::remove(path2);
+                REQUIRE(md5.size() == 32);
+                REQUIRE(writer.md5() == md5);
+            }
+            boost::filesystem::remove(path);
+        }
+    }
+    GIVEN("A file, which cannot be opened") {
+        AsyncFileWriter writer((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("no_such_dir_%%%%%%") / "out.gcode").string());
+        THEN("the writer is not open and writing is ignored") {
+            REQUIRE(! writer.is_open());
+            writer.write(std::string(AsyncFileWriter::BufferSize, 'x'));
+            writer.flush();
+            writer.close();
+        }
+    }
+#ifdef __linux__
+    GIVEN("A device, which fails all the writes") {
+        AsyncFileWriter writer("/dev/full", true);
+        REQUIRE(writer.is_open());
+        WHEN("more than a buffer is written") {
+            writer.write(std::string(AsyncFileWriter::BufferSize + 1, 'x'));
+            writer.write(std::string(100, 'y'));
+            writer.flush();
+            THEN("the failure of the writer thread is reported") {
+                REQUIRE(writer.is_error());
+                writer.close();
+                REQUIRE(writer.is_error());
+                REQUIRE(writer.md5().empty());
+            }
+        }
+    }
+#endif // __linux__
+}
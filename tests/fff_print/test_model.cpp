@@ -3,6 +3,7 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Model.hpp"
 #include "libslic3r/ModelArrange.hpp"
+#include "libslic3r/ClipperUtils.hpp"
 
 #include <boost/nowide/cstdio.hpp>
 #include <boost/filesystem.hpp>
@@ -59,3 +60,41 @@ SCENARIO("Model construction", "[Model]") {
         }
     }
 }
+
+SCENARIO("Arrange until the bed is full", "[Model][Arrange]") {
+    GIVEN("20 squares of 30mm and a 100mm square bed") {
+        BoundingBox bed(Point::Zero(), Point(scaled(100.), scaled(100.)));
+        arrangement::ArrangePolygons items(20);
+        for (arrangement::ArrangePolygon &ap : items) {
+            ap.poly.contour = Polygon({ { 0, 0 }, { scaled(30.), 0 }, { scaled(30.), scaled(30.) }, { 0, scaled(30.) } });
+            ap.inflation = scaled(1.);
+        }
+        WHEN("the squares are placed in their order until the first one which does not fit") {
+            size_t count = arrangement::arrange_until_full(items, {}, bed, arrangement::ArrangeParams{});
+            THEN("at most 9 squares fit, the placed ones first") {
+                REQUIRE(count > 0);
+                REQUIRE(count <= 9);
+                for (size_t i = 0; i < items.size(); ++ i)
+                    REQUIRE(items[i].bed_idx == (i < count ? 0 : arrangement::UNARRANGED));
+            }
+            THEN("the placed squares are inside the bed and do not overlap") {
+                ExPolygons placed;
+                double area = 0.;
+                for (size_t i = 0; i < count; ++ i) {
+                    ExPolygon p = items[i].poly;
+                    p.rotate(items[i].rotation);
+                    p.translate(items[i].translation.x(), items[i].translation.y());
+                    BoundingBox bb = get_extents(p);
+                    REQUIRE(bed.contains(bb.min));
+                    REQUIRE(bed.contains(bb.max));
+                    placed.emplace_back(std::move(p));
+                    area += placed.back().area();
+                }
+                double union_area = 0.;
+                for (const ExPolygon &p : union_ex(placed))
+                    union_area += p.area();
+                REQUIRE(union_area == Approx(area));
+            }
+        }
+    }
+}
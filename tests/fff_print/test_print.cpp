@@ -3,9 +3,16 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Utils.hpp"
+#include "libslic3r/Format/SliceCache.hpp"
 
 #include "test_data.hpp"
 
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
 using namespace Slic3r;
 using namespace Slic3r::Test;
 
@@ -30,6 +37,297 @@ SCENARIO("PrintObject: Perimeter generation", "[PrintObject]") {
     }
 }
 
+SCENARIO("PrintObject: step statistics and counters", "[PrintObject]") {
+    GIVEN("20mm cube and default config") {
+        WHEN("the print is processed and its G-code exported")  {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, { { "fill_density", 0 } });
+            REQUIRE(! print.gcode_export_stats());
+            std::string gcode = Slic3r::Test::gcode(print);
+            const PrintObject &object = *print.objects().front();
+            THEN("the object steps are done and timed") {
+                for (PrintObjectStep step : { posSlice, posPerimeters, posPrepareInfill, posInfill })
+                    REQUIRE(object.is_step_done(step));
+                // Slicing 100 layers takes measurable time with the sub-millisecond steady clock.
+                REQUIRE(object.step_stats(posSlice).wall_time_ms > 0.);
+                REQUIRE(object.step_stats(posSlice).cpu_time_ms <= process_cpu_time_ms());
+            }
+            THEN("the G-code export is timed") {
+                REQUIRE(! gcode.empty());
+                REQUIRE(print.gcode_export_stats());
+                REQUIRE(print.gcode_export_stats()->wall_time_ms > 0.);
+            }
+            THEN("every step has a name") {
+                for (int step = 0; step < int(posCount); ++ step)
+                    REQUIRE(std::string(print_object_step_name(PrintObjectStep(step))) != "unknown");
+                for (int step = 0; step < int(psCount); ++ step)
+                    REQUIRE(std::string(print_step_name(PrintStep(step))) != "unknown");
+            }
+            THEN("the counters match the sliced layers") {
+                PrintObject::Counters counters = object.counters();
+                REQUIRE(counters.layers == object.layers().size());
+                REQUIRE(counters.layer_regions == object.layers().size());
+                REQUIRE(counters.polygons == object.layers().size());
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: refill of a single region", "[PrintObject]") {
+    GIVEN("20mm cube with a layer range modifier at its top") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        // The layer range shall differ from the rest of the object, so that it gets a region of its own.
+        // Otherwise changing its pattern splits the region, which reslices the object.
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, { { "layer_height", 0.2 }, { "initial_layer_print_height", 0.2 }, { "top_surface_pattern", "monotonic" } });
+        DynamicPrintConfig config = print.full_print_config();
+        ModelConfig &range_config = model.objects.front()->layer_config_ranges[{ 15., 20. }];
+        // Layer ranges always carry their layer height, see layer_height_profile_from_ranges().
+        range_config.set_key_value("layer_height", new ConfigOptionFloat(0.2));
+        range_config.set_key_value("top_surface_pattern", new ConfigOptionEnum<InfillPattern>(ipRectilinear));
+        print.apply(model, config);
+        print.process();
+        auto fills_of_layers = [&print]() {
+            std::vector<std::vector<const ExtrusionEntity*>> out;
+            for (const Layer *layer : print.objects().front()->layers()) {
+                std::vector<const ExtrusionEntity*> fills;
+                for (const LayerRegion *layerm : layer->regions())
+                    fills.insert(fills.end(), layerm->fills.entities.begin(), layerm->fills.entities.end());
+                out.emplace_back(std::move(fills));
+            }
+            return out;
+        };
+        // Share of the length of the top surface fill of the top layer running along the sides of the cube.
+        // Concentric loops over the square top follow its sides, rectilinear lines run at the infill angle.
+        auto top_fill_axis_parallel_ratio = [&print]() {
+            double axis_parallel = 0., total = 0.;
+            for (const LayerRegion *layerm : print.objects().front()->layers().back()->regions())
+                for (const ExtrusionEntity *fill : layerm->fills.entities)
+                    if (fill->role() == erTopSolidInfill)
+                        for (const Polyline &polyline : fill->as_polylines())
+                            for (const Line &line : polyline.lines()) {
+                                double length = line.length();
+                                total += length;
+                                if (std::abs(line.a.x() - line.b.x()) < SCALED_EPSILON || std::abs(line.a.y() - line.b.y()) < SCALED_EPSILON)
+                                    axis_parallel += length;
+                            }
+            return total > 0. ? axis_parallel / total : 0.;
+        };
+        std::vector<std::vector<const ExtrusionEntity*>> fills_before = fills_of_layers();
+        REQUIRE(top_fill_axis_parallel_ratio() < 0.5);
+        WHEN("top surface pattern of the layer range is changed") {
+            range_config.set_key_value("top_surface_pattern", new ConfigOptionEnum<InfillPattern>(ipConcentric));
+            print.apply(model, config);
+            const PrintObject &object = *print.objects().front();
+            THEN("only the fills are invalidated") {
+                REQUIRE(object.is_step_done(posPrepareInfill));
+                REQUIRE(! object.is_step_done(posInfill));
+            }
+            print.process();
+            THEN("fills of the layers below the layer range are kept") {
+                std::vector<std::vector<const ExtrusionEntity*>> fills_after = fills_of_layers();
+                REQUIRE(fills_after.size() == fills_before.size());
+                for (size_t layer_idx = 0; layer_idx < fills_after.size(); ++ layer_idx)
+                    if (object.get_layer(int(layer_idx))->print_z < 15.)
+                        REQUIRE(fills_after[layer_idx] == fills_before[layer_idx]);
+                REQUIRE(! fills_after.back().empty());
+            }
+            THEN("the top layer is filled with the concentric pattern") {
+                REQUIRE(top_fill_axis_parallel_ratio() > 0.9);
+            }
+        }
+    }
+}
+
+SCENARIO("Print: Identical objects share their layers", "[Print]") {
+    GIVEN("Two 20mm cubes loaded with their own meshes") {
+        WHEN("the print is processed") {
+            Slic3r::Print print;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20, TestMesh::cube_20x20x20}, print, { { "fill_density", 0 } });
+            REQUIRE(print.objects().size() == 2);
+            const PrintObject &object1 = *print.objects()[0];
+            const PrintObject &object2 = *print.objects()[1];
+            THEN("the second object reuses the layers of the first one") {
+                REQUIRE(object1.model_object()->volumes.front()->mesh_ptr() != object2.model_object()->volumes.front()->mesh_ptr());
+                REQUIRE(object1.get_shared_object() == nullptr);
+                REQUIRE(object2.get_shared_object() == &object1);
+                REQUIRE(object2.layers().size() == object1.layers().size());
+                REQUIRE(object2.layers().front() == object1.layers().front());
+            }
+            THEN("the shared layers match the layers of the cube sliced on its own") {
+                Slic3r::Print reference_print;
+                Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, reference_print, { { "fill_density", 0 } });
+                const PrintObject &reference = *reference_print.objects().front();
+                REQUIRE(object2.layers().size() == reference.layers().size());
+                for (size_t layer_idx = 0; layer_idx < reference.layers().size(); ++ layer_idx) {
+                    const Layer &layer           = *object2.layers()[layer_idx];
+                    const Layer &reference_layer = *reference.layers()[layer_idx];
+                    REQUIRE(layer.print_z == Approx(reference_layer.print_z));
+                    REQUIRE(layer.height == Approx(reference_layer.height));
+                    double area = 0., reference_area = 0.;
+                    for (const ExPolygon &expoly : layer.lslices)
+                        area += expoly.area();
+                    for (const ExPolygon &expoly : reference_layer.lslices)
+                        reference_area += expoly.area();
+                    REQUIRE(area == Approx(reference_area));
+                }
+            }
+        }
+    }
+    GIVEN("A 20mm cube and a 20mm cube with a hole") {
+        WHEN("the print is processed") {
+            Slic3r::Print print;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20, TestMesh::cube_with_hole}, print, { { "fill_density", 0 } });
+            THEN("both objects are sliced") {
+                for (const PrintObject *object : print.objects())
+                    REQUIRE(object->get_shared_object() == nullptr);
+            }
+        }
+    }
+}
+
+static void require_equal_extrusions(const ExtrusionEntityCollection &lhs, const ExtrusionEntityCollection &rhs)
+{
+    REQUIRE(lhs.items_count() == rhs.items_count());
+    ExtrusionEntityCollection lhs_flat = lhs.flatten();
+    ExtrusionEntityCollection rhs_flat = rhs.flatten();
+    REQUIRE(lhs_flat.entities.size() == rhs_flat.entities.size());
+    for (size_t i = 0; i < lhs_flat.entities.size(); ++ i) {
+        REQUIRE(lhs_flat.entities[i]->role() == rhs_flat.entities[i]->role());
+        REQUIRE(lhs_flat.entities[i]->as_polyline().points == rhs_flat.entities[i]->as_polyline().points);
+    }
+}
+
+static void require_equal_layers(const Layer &lhs, const Layer &rhs)
+{
+    REQUIRE(lhs.id() == rhs.id());
+    REQUIRE(lhs.print_z == rhs.print_z);
+    REQUIRE(lhs.height == rhs.height);
+    REQUIRE(lhs.slice_z == rhs.slice_z);
+    REQUIRE(lhs.lslices == rhs.lslices);
+    REQUIRE(lhs.lslices_bboxes.size() == rhs.lslices_bboxes.size());
+    REQUIRE(lhs.loverhangs == rhs.loverhangs);
+    REQUIRE(lhs.region_count() == rhs.region_count());
+    for (size_t region_id = 0; region_id < lhs.region_count(); ++ region_id) {
+        const LayerRegion &lhs_region = *lhs.regions()[region_id];
+        const LayerRegion &rhs_region = *rhs.regions()[region_id];
+        REQUIRE(lhs_region.region().config_hash() == rhs_region.region().config_hash());
+        REQUIRE(lhs_region.slices.surfaces.size() == rhs_region.slices.surfaces.size());
+        for (size_t i = 0; i < lhs_region.slices.surfaces.size(); ++ i) {
+            REQUIRE(lhs_region.slices.surfaces[i].surface_type == rhs_region.slices.surfaces[i].surface_type);
+            REQUIRE(lhs_region.slices.surfaces[i].expolygon == rhs_region.slices.surfaces[i].expolygon);
+        }
+        REQUIRE(lhs_region.fill_expolygons == rhs_region.fill_expolygons);
+        require_equal_extrusions(lhs_region.perimeters, rhs_region.perimeters);
+        require_equal_extrusions(lhs_region.fills, rhs_region.fills);
+    }
+}
+
+SCENARIO("Print: binary slice cache", "[Print]") {
+    GIVEN("A sliced overhang with support material") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::overhang}, print, model, { { "enable_support", true } });
+        print.process();
+        const PrintObject &object = *print.objects().front();
+        REQUIRE(object.support_layer_count() > 0);
+
+        const boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("slice_cache_%%%%%%");
+        REQUIRE(print.export_cached_data(dir.string()) == 0);
+        std::vector<boost::filesystem::path> files;
+        for (const boost::filesystem::directory_entry &entry : boost::filesystem::directory_iterator(dir))
+            files.emplace_back(entry.path());
+        REQUIRE(files.size() == 1);
+        REQUIRE(files.front().extension() == SliceCache::Extension);
+        const std::string file = files.front().string();
+
+        WHEN("the cache is loaded into a new print of the same model") {
+            Slic3r::Print loaded;
+            loaded.apply(model, print.full_print_config());
+            REQUIRE(loaded.load_cached_data(dir.string()) == 0);
+            const PrintObject &loaded_object = *loaded.objects().front();
+            THEN("the layers match the sliced layers") {
+                REQUIRE(loaded_object.layer_count() == object.layer_count());
+                for (size_t i = 0; i < object.layer_count(); ++ i)
+                    require_equal_layers(*loaded_object.get_layer(int(i)), *object.get_layer(int(i)));
+            }
+            THEN("the support layers match the generated support layers") {
+                REQUIRE(loaded_object.support_layer_count() == object.support_layer_count());
+                for (size_t i = 0; i < object.support_layer_count(); ++ i) {
+                    const SupportLayer &lhs = *loaded_object.support_layers()[i];
+                    const SupportLayer &rhs = *object.support_layers()[i];
+                    require_equal_layers(lhs, rhs);
+                    REQUIRE(lhs.interface_id() == rhs.interface_id());
+                    REQUIRE(lhs.support_islands == rhs.support_islands);
+                    require_equal_extrusions(lhs.support_fills, rhs.support_fills);
+                }
+            }
+        }
+
+        auto read_file = [](const std::string &path) {
+            boost::nowide::ifstream ifs(path, std::ios::binary);
+            return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        };
+        auto write_file = [](const std::string &path, const std::string &data) {
+            boost::nowide::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+            ofs.write(data.data(), std::streamsize(data.size()));
+        };
+        const std::string data = read_file(file);
+        REQUIRE(SliceCache::Reader(file).layer_count() == object.layer_count());
+
+        WHEN("the version of the cache does not match") {
+            std::string modified = data;
+            // The version follows the 8 bytes of the magic.
+            uint32_t version = SliceCache::Version + 1;
+            std::memcpy(&modified[8], &version, sizeof(version));
+            write_file(file, modified);
+            THEN("the cache is rejected") {
+                REQUIRE_THROWS_AS(SliceCache::Reader(file), Slic3r::FileIOError);
+                Slic3r::Print loaded;
+                loaded.apply(model, print.full_print_config());
+                REQUIRE(loaded.load_cached_data(dir.string()) == CLI_IMPORT_CACHE_LOAD_FAILED);
+            }
+        }
+        WHEN("the file is not a slice cache") {
+            std::string modified = data;
+            modified[0] = 'X';
+            write_file(file, modified);
+            THEN("the cache is rejected") {
+                REQUIRE_THROWS_AS(SliceCache::Reader(file), Slic3r::FileIOError);
+            }
+        }
+        WHEN("the cache is truncated") {
+            write_file(file, data.substr(0, data.size() / 2));
+            THEN("the cache is rejected") {
+                REQUIRE_THROWS_AS(SliceCache::Reader(file), Slic3r::FileIOError);
+                Slic3r::Print loaded;
+                loaded.apply(model, print.full_print_config());
+                REQUIRE(loaded.load_cached_data(dir.string()) == CLI_IMPORT_CACHE_LOAD_FAILED);
+            }
+        }
+        WHEN("a layer record is corrupted") {
+            std::string modified = data;
+            // The first layer record follows the header and the object name. Its region count is stored behind
+            // the layer id, interface id, height, print_z and slice_z, make it larger than the rest of the file.
+            const size_t count_offset = 88 + object.model_object()->name.size() + 2 * sizeof(int32_t) + 3 * sizeof(double);
+            uint64_t count = uint64_t(-1);
+            std::memcpy(&modified[count_offset], &count, sizeof(count));
+            write_file(file, modified);
+            THEN("decoding of the layer fails") {
+                SliceCache::Reader corrupted(file);
+                REQUIRE_THROWS_AS(corrupted.layer_info(0), Slic3r::FileIOError);
+                Slic3r::Print loaded;
+                loaded.apply(model, print.full_print_config());
+                REQUIRE(loaded.load_cached_data(dir.string()) == CLI_IMPORT_CACHE_LOAD_FAILED);
+            }
+        }
+
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(dir, ec);
+    }
+}
+
 SCENARIO("Print: Skirt generation", "[Print]") {
     GIVEN("20mm cube and default config") {
         WHEN("Skirts is set to 2 loops")  {
@@ -1,11 +1,14 @@
 #include <catch2/catch.hpp>
 
 #include "libslic3r/libslic3r.h"
+#include "libslic3r/GCode.hpp"
 #include "libslic3r/GCodeReader.hpp"
 
 #include "test_data.hpp"
 
 #include <algorithm>
+#include <sstream>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/regex.hpp>
 
 using namespace Slic3r;
@@ -269,3 +272,69 @@ SCENARIO( "PrintGCode basic functionality", "[PrintGCode]") {
         }
     }
 }
+
+// The labels of the objects are derived from their ObjectIDs, which differ between two prints of the same model.
+static std::string strip_object_labels(const std::string &gcode)
+{
+    std::string out;
+    std::istringstream in(gcode);
+    for (std::string line; std::getline(in, line);)
+        if (line.find("label id:") == std::string::npos && ! boost::starts_with(line, "; printing object "))
+            out += line + "\n";
+    return out;
+}
+
+SCENARIO("PrintGCode parallel layer planning", "[PrintGCode]") {
+    GIVEN("Two objects with support material") {
+        auto gcode_with = [](bool parallel, const char *print_sequence, bool reduce_crossing_wall = false) {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            ::Test::init_print({ TestMesh::overhang, TestMesh::cube_20x20x20 }, print, model, {
+                { "print_sequence",                 print_sequence },
+                { "enable_support",                 true },
+                { "layer_height",                   0.2 },
+                { "initial_layer_print_height",     0.2 },
+                { "gcode_comments",                 true },
+                { "reduce_crossing_wall",           reduce_crossing_wall }
+                });
+            print.set_parallel_layer_planning(parallel);
+            return strip_object_labels(::Test::gcode(print));
+        };
+        WHEN("printed by layer") {
+            THEN("G-code with extrusions grouped in parallel is identical to the serial one") {
+                REQUIRE(gcode_with(true, "by layer") == gcode_with(false, "by layer"));
+            }
+        }
+        WHEN("printed by object") {
+            THEN("G-code with extrusions grouped in parallel is identical to the serial one") {
+                REQUIRE(gcode_with(true, "by object") == gcode_with(false, "by object"));
+            }
+        }
+        WHEN("printed by layer avoiding crossing walls") {
+            THEN("G-code with travel boundaries prepared in parallel is identical to the serial one") {
+                REQUIRE(gcode_with(true, "by layer", true) == gcode_with(false, "by layer", true));
+            }
+        }
+    }
+}
+
+SCENARIO("PrintGCode parallel processing of the objects", "[PrintGCode]") {
+    GIVEN("Two objects") {
+        auto gcode_with = [](bool parallel) {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            ::Test::init_print({ TestMesh::overhang, TestMesh::cube_20x20x20 }, print, model, {
+                { "layer_height",                   0.2 },
+                { "initial_layer_print_height",     0.2 },
+                { "gcode_comments",                 true }
+                });
+            print.set_parallel_objects(parallel);
+            return strip_object_labels(::Test::gcode(print));
+        };
+        WHEN("the perimeters, infill and ironing of the objects are processed concurrently") {
+            THEN("G-code is identical to the one of the objects processed one after the other") {
+                REQUIRE(gcode_with(true) == gcode_with(false));
+            }
+        }
+    }
+}
@@ -1,7 +1,9 @@
 #include <catch2/catch.hpp>
 
+#include "libslic3r/BuildVolume.hpp"
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Support/TreeModelVolumes.hpp"
 
 #include "test_data.hpp" // get access to init_print, etc
 
@@ -29,7 +31,7 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
 	{
         ConstSupportLayerPtrsAdaptor support_layers = print.objects().front()->support_layers();
 
-		first_support_layer_height_ok = support_layers.front()->print_z == print.config().first_layer_height.value;
+		first_support_layer_height_ok = support_layers.front()->print_z == print.config().initial_layer_print_height.value;
 
 		layer_height_minimum_ok = true;
 		layer_height_maximum_ok = true;
@@ -119,6 +121,80 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+SCENARIO("SupportMaterial: tree support collision and avoidance caches", "[SupportMaterial]")
+{
+    using TreeSupport3D::TreeModelVolumes;
+    GIVEN("A sliced 20mm cube") {
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({ TestMesh::cube_20x20x20 }, print, Slic3r::DynamicPrintConfig::full_print_config());
+        const PrintObject &print_object = *print.objects().front();
+        const BuildVolume  build_volume{ { { 0., 0. }, { 200., 0. }, { 200., 200. }, { 0., 200. } }, 200. };
+        const coord_t      max_move      = scaled<coord_t>(1.);
+        const coord_t      max_move_slow = scaled<coord_t>(0.5);
+        const coord_t      radius        = scaled<coord_t>(1.);
+        TreeModelVolumes::set_retained_caches(2);
+        TreeModelVolumes::set_retained_caches_memory_limit(size_t(512) << 20);
+        TreeModelVolumes::clear_retained_caches(&print);
+        WHEN("two volumes are created from the same object") {
+            TreeModelVolumes volumes{ print_object, build_volume, max_move, max_move_slow, 0 };
+            volumes.getAvoidance(radius, 5, TreeModelVolumes::AvoidanceType::Fast, false, false);
+            std::optional<TreeModelVolumes> other;
+            other.emplace(print_object, build_volume, max_move, max_move_slow, 0);
+            THEN("the second volume reuses the avoidances of the first one") {
+                REQUIRE(other->shares_caches_with(volumes));
+                REQUIRE(other->has_cached_avoidances());
+            }
+            THEN("the avoidances are kept while the other volume uses them") {
+                volumes.clear_all_but_object_collision();
+                REQUIRE(other->has_cached_avoidances());
+            }
+            THEN("the avoidances of a retained cache are kept once the other volume is destroyed") {
+                other.reset();
+                REQUIRE(TreeModelVolumes::num_retained_caches(&print) == 1);
+                volumes.clear_all_but_object_collision();
+                REQUIRE(volumes.has_cached_avoidances());
+            }
+            THEN("the avoidances are released once the retained caches exceed the memory limit") {
+                other.reset();
+                TreeModelVolumes::set_retained_caches_memory_limit(0);
+                REQUIRE(TreeModelVolumes::num_retained_caches(&print) == 0);
+                volumes.clear_all_but_object_collision();
+                REQUIRE(! volumes.has_cached_avoidances());
+                TreeModelVolumes::set_retained_caches_memory_limit(size_t(512) << 20);
+            }
+        }
+        WHEN("the build volume is moved relative to the object") {
+            TreeModelVolumes volumes{ print_object, build_volume, max_move, max_move_slow, 0 };
+            const BuildVolume moved{ { { 10., 0. }, { 210., 0. }, { 210., 200. }, { 10., 200. } }, 200. };
+            TreeModelVolumes other{ print_object, moved, max_move, max_move_slow, 0 };
+            THEN("the caches are not shared") {
+                REQUIRE(! other.shares_caches_with(volumes));
+            }
+        }
+        WHEN("a volume is destroyed") {
+            std::optional<TreeModelVolumes> volumes;
+            volumes.emplace(print_object, build_volume, max_move, max_move_slow, 0);
+            volumes->getAvoidance(radius, 5, TreeModelVolumes::AvoidanceType::Fast, false, false);
+            volumes->clear_all_but_object_collision();
+            volumes.reset();
+            THEN("its caches are retained and reused with the avoidances by the next volume of the same object") {
+                REQUIRE(TreeModelVolumes::num_retained_caches(&print) == 1);
+                TreeModelVolumes next{ print_object, build_volume, max_move, max_move_slow, 0 };
+                REQUIRE(next.has_cached_avoidances());
+            }
+            THEN("clearing another print keeps the retained caches") {
+                Slic3r::Print other_print;
+                other_print.clear();
+                REQUIRE(TreeModelVolumes::num_retained_caches(&print) == 1);
+            }
+            THEN("the retained caches are released when the print is cleared") {
+                print.clear();
+                REQUIRE(TreeModelVolumes::num_retained_caches(&print) == 0);
+            }
+        }
+    }
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
@@ -177,6 +177,29 @@ SCENARIO( "TriangleMesh: slice behavior.") {
     }
 }
 
+SCENARIO( "TriangleMesh: slicing many layers.") {
+    GIVEN( "A sphere of radius 10mm") {
+        indexed_triangle_set sphere = its_make_sphere(10., 2. * PI / 180.);
+        WHEN("It is sliced with 0.05mm layers") {
+            std::vector<float> zs;
+            for (float z = -9.975f; z < 10.f; z += 0.05f)
+                zs.emplace_back(z);
+            std::vector<Polygons> slices = slice_mesh(sphere, zs, MeshSlicingParams{});
+            THEN( "Every layer is a single circle of the sphere's cross section.") {
+                REQUIRE(slices.size() == zs.size());
+                for (size_t i = 0; i < zs.size(); ++ i) {
+                    REQUIRE(slices[i].size() == 1);
+                    double r2 = 100. - double(zs[i]) * double(zs[i]);
+                    REQUIRE(std::abs(slices[i].front().area() * SCALING_FACTOR * SCALING_FACTOR - PI * r2) < 0.02 * PI * 100.);
+                }
+            }
+            THEN( "Slicing again produces the same contours.") {
+                REQUIRE(slice_mesh(sphere, zs, MeshSlicingParams{}) == slices);
+            }
+        }
+    }
+}
+
 SCENARIO( "make_xxx functions produce meshes.") {
     GIVEN("make_cube() function") {
         WHEN("make_cube() is called with arguments 20,20,20") {
@@ -328,6 +351,25 @@ TEST_CASE("Regression test for issue #4486 - files take forever to slice") {
 }
 #endif // TEST_PERFORMANCE
 
+#ifdef TEST_PERFORMANCE
+TEST_CASE("Benchmark slice_mesh throughput by triangle and layer count") {
+    for (double fa : { 2. * PI / 90., 2. * PI / 360., 2. * PI / 1440. }) {
+        indexed_triangle_set sphere = its_make_sphere(50., fa);
+        for (float layer_height : { 0.2f, 0.05f, 0.01f }) {
+            std::vector<float> zs;
+            for (float z = -50.f + 0.5f * layer_height; z < 50.f; z += layer_height)
+                zs.emplace_back(z);
+            auto start = std::chrono::steady_clock::now();
+            std::vector<Polygons> slices = slice_mesh(sphere, zs, MeshSlicingParams{});
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "slice_mesh: " << sphere.indices.size() << " triangles, " << zs.size() << " layers: " << ms << " ms, "
+                      << (ms > 0 ? double(sphere.indices.size()) / ms : 0.) << " triangles/ms" << std::endl;
+            REQUIRE(slices.size() == zs.size());
+        }
+    }
+}
+#endif // TEST_PERFORMANCE
+
 #ifdef BUILD_PROFILE
 TEST_CASE("Profile test for issue #4486 - files take forever to slice") {
     TriangleMesh mesh;
@@ -1225,3 +1225,79 @@ TEST_CASE("Test for biggest bounding box area", "[Nesting], [NestKernels]")
     REQUIRE(pile.size() == N);
     REQUIRE(bb.area() == double(N) * N * W * W);
 }
+
+TEST_CASE("NfpCache compares the contours exactly", "[Nesting]")
+{
+    using Cache = placers::NfpCache<PolygonImpl>;
+    Cache cache;
+
+    Item square = RectangleItem(10, 10);
+    Item rect   = RectangleItem(10, 20);
+    auto square_contour = Cache::contour(square.transformedShape(), square.leftmostBottomVertex());
+    auto rect_contour   = Cache::contour(rect.transformedShape(), rect.leftmostBottomVertex());
+
+    PolygonImpl nfp = RectangleItem(20, 20).transformedShape();
+    Cache::Key key = Cache::key(square_contour, square_contour);
+    cache.put(key, square.leftmostBottomVertex(), nfp);
+
+    // The same shapes at another place hit the cache, the NFP is moved along.
+    Item moved = square;
+    moved.translate({100, 50});
+    PolygonImpl found;
+    REQUIRE(cache.get(Cache::key(Cache::contour(moved.transformedShape(), moved.leftmostBottomVertex()), square_contour),
+                      moved.leftmostBottomVertex(), found));
+    REQUIRE(sl::boundingBox(found).minCorner() == sl::boundingBox(nfp).minCorner() + moved.leftmostBottomVertex() - square.leftmostBottomVertex());
+
+    // A different shape with a colliding hash misses the cache.
+    Cache::Key collision = Cache::key(rect_contour, square_contour);
+    collision.hash = key.hash;
+    REQUIRE(! cache.get(collision, rect.leftmostBottomVertex(), found));
+
+    placers::NfpCacheStats stats = cache.stats();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.entries == 1);
+}
+
+TEST_CASE("NfpCache shared by placers gives the same result", "[Nesting]")
+{
+    std::vector<Item> shapes(prusaParts().begin(), prusaParts().begin() + 4);
+    std::vector<Item> input;
+    for (size_t i = 0; i < 5; ++i)
+        input.insert(input.end(), shapes.begin(), shapes.end());
+    auto bin = Box(250000000, 210000000);
+
+    auto place = [&input, &bin](std::shared_ptr<placers::NfpCache<PolygonImpl>> cache) {
+        std::vector<Item> items = input;
+        {
+            NfpPlacer placer(bin);
+            NfpPlacer::Config pconfig;
+            pconfig.nfp_cache = cache;
+            placer.configure(pconfig);
+            for (Item &item : items) {
+                auto result = placer.pack(item);
+                placer.accept(result);
+            }
+        }
+        return items;
+    };
+
+    std::vector<Item> reference = place(nullptr);
+    auto cache = std::make_shared<placers::NfpCache<PolygonImpl>>();
+    std::vector<Item> first = place(cache);
+    placers::NfpCacheStats stats_first = cache->stats();
+    std::vector<Item> second = place(cache);
+    placers::NfpCacheStats stats_second = cache->stats();
+
+    for (size_t i = 0; i < input.size(); ++i) {
+        REQUIRE(first[i].translation() == reference[i].translation());
+        REQUIRE(double(first[i].rotation()) == double(reference[i].rotation()));
+        REQUIRE(second[i].translation() == reference[i].translation());
+        REQUIRE(double(second[i].rotation()) == double(reference[i].rotation()));
+    }
+    // Repeated shapes are served by the cache already by the first placer,
+    // the second placer calculates no new polygon.
+    REQUIRE(stats_first.hits > 0);
+    REQUIRE(stats_second.misses == stats_first.misses);
+    REQUIRE(stats_second.hits > stats_first.hits);
+}
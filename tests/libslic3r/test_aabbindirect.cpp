@@ -1,6 +1,9 @@
 #include <catch2/catch.hpp>
 #include <test_utils.hpp>
 
+#include <chrono>
+#include <iostream>
+
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
 
@@ -58,3 +61,87 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Approx(0.5));
     REQUIRE(closest_point.z() == Approx(1.));
 }
+
+TEST_CASE("Quantized tree answers the queries as the full tree", "[AABBIndirect]")
+{
+    TriangleMesh tmesh = make_sphere(1., 2. * PI / 64.);
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+    AABBTreeIndirect::QuantizedTree3f qtree(tree);
+    REQUIRE(qtree.nodes().size() == tree.nodes().size());
+    REQUIRE(qtree.nodes().size() * sizeof(qtree.nodes().front()) * 2 <= tree.nodes().size() * sizeof(tree.nodes().front()));
+
+    // Quantized bounding boxes contain the original ones.
+    for (size_t i = 0; i < tree.nodes().size(); ++ i)
+        if (tree.node(i).is_valid()) {
+            REQUIRE(qtree.node(i).idx == tree.node(i).idx);
+            REQUIRE(qtree.node(i).bbox.contains(tree.node(i).bbox));
+        } else
+            REQUIRE(! qtree.node(i).is_valid());
+
+    for (int i = 0; i < 50; ++ i) {
+        double angle = 2. * PI * i / 50.;
+        Vec3d  origin(0.1 * i / 50., 0.2, 0.3 - 0.05 * i);
+        Vec3d  dir = Vec3d(0.4 * cos(angle), 0.4 * sin(angle), 1.).normalized();
+
+        igl::Hit hit, qhit;
+        bool intersected  = AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origin, dir, hit);
+        bool qintersected = AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, qtree, origin, dir, qhit);
+        REQUIRE(intersected == qintersected);
+        if (intersected)
+            REQUIRE(qhit.t == Approx(hit.t));
+
+        std::vector<igl::Hit> hits, qhits;
+        AABBTreeIndirect::intersect_ray_all_hits(tmesh.its.vertices, tmesh.its.indices, tree, origin, dir, hits);
+        AABBTreeIndirect::intersect_ray_all_hits(tmesh.its.vertices, tmesh.its.indices, qtree, origin, dir, qhits);
+        REQUIRE(hits.size() == qhits.size());
+
+        size_t hit_idx, qhit_idx;
+        Vec3d  closest_point, qclosest_point;
+        double squared_distance  = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices, tree, origin, hit_idx, closest_point);
+        double qsquared_distance = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices, qtree, origin, qhit_idx, qclosest_point);
+        REQUIRE(qsquared_distance == Approx(squared_distance));
+
+        std::vector<size_t> in_radius  = AABBTreeIndirect::all_triangles_in_radius(tmesh.its.vertices, tmesh.its.indices, tree, origin, 0.1);
+        std::vector<size_t> qin_radius = AABBTreeIndirect::all_triangles_in_radius(tmesh.its.vertices, tmesh.its.indices, qtree, origin, 0.1);
+        std::sort(in_radius.begin(), in_radius.end());
+        std::sort(qin_radius.begin(), qin_radius.end());
+        REQUIRE(in_radius == qin_radius);
+    }
+}
+
+#ifdef TEST_PERFORMANCE
+// Memory and query time of the full and of the quantized tree.
+TEST_CASE("Quantized tree memory and query speed", "[AABBIndirect]")
+{
+    TriangleMesh tmesh = make_sphere(1., 2. * PI / 1024.);
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+    AABBTreeIndirect::QuantizedTree3f qtree(tree);
+
+    std::vector<Vec3d> origins, dirs;
+    for (int i = 0; i < 20000; ++ i) {
+        double angle = 0.01 * i;
+        origins.emplace_back(0.5 * cos(0.37 * i), 0.5 * sin(0.37 * i), 0.2 * sin(0.11 * i));
+        dirs.emplace_back(Vec3d(cos(angle), sin(angle), cos(0.7 * angle)).normalized());
+    }
+    auto measure = [&tmesh, &origins, &dirs](const auto &tree) {
+        auto   start = std::chrono::steady_clock::now();
+        size_t num_hits = 0;
+        for (size_t i = 0; i < origins.size(); ++ i) {
+            igl::Hit hit;
+            num_hits += AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origins[i], dirs[i], hit);
+            size_t hit_idx;
+            Vec3d  closest_point;
+            AABBTreeIndirect::squared_distance_to_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices, tree, origins[i], hit_idx, closest_point);
+        }
+        REQUIRE(num_hits == origins.size());
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    double time  = measure(tree);
+    double qtime = measure(qtree);
+
+    std::cout << "triangles: " << tmesh.its.indices.size() << std::endl;
+    std::cout << "tree;memory [MB];query time [s]" << std::endl;
+    std::cout << "full;" << double(tree.nodes().size() * sizeof(tree.nodes().front())) / (1024. * 1024.) << ";" << time << std::endl;
+    std::cout << "quantized;" << double(qtree.nodes().size() * sizeof(qtree.nodes().front())) / (1024. * 1024.) << ";" << qtime << std::endl;
+}
+#endif // TEST_PERFORMANCE
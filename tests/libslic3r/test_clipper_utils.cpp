@@ -299,3 +299,37 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+TEST_CASE("Clipper2 backend matches the legacy Clipper", "[ClipperUtils]") {
+    // CCW square 20x20mm with a CW square hole 10x10mm and a CCW square 10x10mm overlapping its right edge.
+    Polygon   square { { 0, 0 }, { scaled(20.), 0 }, { scaled(20.), scaled(20.) }, { 0, scaled(20.) } };
+    Polygon   hole   { { scaled(5.), scaled(5.) }, { scaled(5.), scaled(15.) }, { scaled(15.), scaled(15.) }, { scaled(15.), scaled(5.) } };
+    Polygon   other  { { scaled(15.), scaled(5.) }, { scaled(25.), scaled(5.) }, { scaled(25.), scaled(15.) }, { scaled(15.), scaled(15.) } };
+    ExPolygons subject { ExPolygon(square, hole) };
+    ExPolygons clip    { ExPolygon(other) };
+
+    auto run = [&subject, &clip](bool clipper2) {
+        ClipperUtils::set_clipper2_backend(clipper2);
+        return std::vector<ExPolygons> {
+            offset_ex(subject, scaled<float>(1.)),
+            offset_ex(subject, - scaled<float>(1.)),
+            offset2_ex(subject, - scaled<float>(2.), scaled<float>(1.)),
+            union_ex(subject, clip),
+            diff_ex(subject, clip),
+            intersection_ex(subject, clip),
+            opening_ex(subject, scaled<float>(1.)),
+            closing_ex(subject, scaled<float>(1.))
+        };
+    };
+
+    const bool clipper2_default = ClipperUtils::clipper2_backend();
+    std::vector<ExPolygons> legacy   = run(false);
+    std::vector<ExPolygons> clipper2 = run(true);
+    ClipperUtils::set_clipper2_backend(clipper2_default);
+
+    for (size_t i = 0; i < legacy.size(); ++ i) {
+        REQUIRE(clipper2[i].size() == legacy[i].size());
+        REQUIRE(count_polys(clipper2[i]) == count_polys(legacy[i]));
+        REQUIRE(area(clipper2[i]) == Approx(area(legacy[i])).epsilon(0.001));
+    }
+}
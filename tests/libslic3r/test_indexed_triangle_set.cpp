@@ -2,6 +2,8 @@
 #include <fstream>
 #include <catch2/catch.hpp>
 
+#include <tbb/task_arena.h>
+
 #include "libslic3r/TriangleMesh.hpp"
 
 using namespace Slic3r;
@@ -282,6 +284,35 @@ TEST_CASE("Simplify mesh by Quadric edge collapse to 5%", "[its]")
     CHECK(is_similar(its, mesh.its, cfg));
 }
 
+TEST_CASE("Simplify mesh by Quadric edge collapse in parallel to 5%", "[its]")
+{
+    // big enough to be split into parts
+    indexed_triangle_set sphere = its_make_sphere(10., 2 * PI / 400.);
+    double original_volume = its_volume(sphere);
+    uint32_t wanted_count = sphere.indices.size() * 0.05;
+    indexed_triangle_set its = sphere; // copy
+    float max_error = std::numeric_limits<float>::max();
+    its_quadric_edge_collapse_parallel(its, wanted_count, &max_error);
+    CHECK(its.indices.size() <= wanted_count);
+    CHECK(its_num_open_edges(its) == 0);
+    double volume = its_volume(its);
+    CHECK(fabs(original_volume - volume) < 10.);
+
+    CompareConfig cfg;
+    cfg.max_average_distance = 0.02f;
+    cfg.max_distance         = 0.1f;
+
+    CHECK(is_similar(sphere, its, cfg));
+    CHECK(is_similar(its, sphere, cfg));
+
+    // The parts do not depend on the number of threads.
+    indexed_triangle_set its_single_thread = sphere;
+    max_error = std::numeric_limits<float>::max();
+    tbb::task_arena(1).execute([&]() { its_quadric_edge_collapse_parallel(its_single_thread, wanted_count, &max_error); });
+    CHECK(its_single_thread.indices == its.indices);
+    CHECK(its_single_thread.vertices == its.vertices);
+}
+
 bool exist_triangle_with_twice_vertices(const std::vector<stl_triangle_vertex_indices>& indices)
 {
     for (const auto &face : indices)
@@ -0,0 +1,99 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "libslic3r/Format/objparser.hpp"
+
+using namespace ObjParser;
+
+SCENARIO("Memory mapped OBJ parser reads the same data as the sequential parser", "[obj]") {
+	// objparse() splits the file into blocks of 4MB, which are parsed in parallel.
+	static constexpr const size_t block_size = 4 * 1024 * 1024;
+	GIVEN("an OBJ file larger than the block size") {
+		std::mt19937 rng(11);
+		std::uniform_real_distribution<double> dist(-100., 100.);
+		std::string data = "# region: test\n";
+		std::vector<double> coordinates;
+		char buf[256];
+		size_t num_vertices = 0;
+		for (size_t i = 0; i < 150000; ++ i) {
+			// Groups, objects, smoothing groups and materials changing inside the blocks, faces before the first usemtl of a block,
+			// absolute and relative indices referencing the vertices of the preceding blocks, different line endings.
+			const char *eol = i % 3 == 0 ? "\r\n" : "\n";
+			if (i % 10000 == 0) {
+				sprintf(buf, "o object%d%sg group%d%s", int(i / 10000), eol, int(i / 10000), eol);
+				data += buf;
+			}
+			if (i % 7000 == 0) {
+				sprintf(buf, "usemtl material%d%ss %d%s", int(i / 7000), eol, int(i / 7000) % 2, eol);
+				data += buf;
+			}
+			for (int j = 0; j < 3; ++ j) {
+				double x = dist(rng), y = dist(rng), z = dist(rng);
+				sprintf(buf, "v %.6f %.6f %.6f%s", x, y, z, eol);
+				data += buf;
+				coordinates.insert(coordinates.end(), { x, y, z });
+			}
+			sprintf(buf, "vn %.4f %.4f %.4f%svt %.4f %.4f%s", dist(rng), dist(rng), dist(rng), eol, dist(rng), dist(rng), eol);
+			data += buf;
+			num_vertices += 3;
+			if (i % 2 == 0)
+				sprintf(buf, "f -3/-1/-1 -2/-1/-1 -1/-1/-1%s", eol);
+			else if (i % 5 == 1 && num_vertices > 100)
+				sprintf(buf, "f %d %d//%d %d%s", int(num_vertices - 99), int(num_vertices - 98), int(i), int(num_vertices), eol);
+			else
+				sprintf(buf, "\tf %d/%d %d/%d %d/%d %s", int(num_vertices - 2), int(i + 1), int(num_vertices - 1), int(i + 1), int(num_vertices), int(i + 1), eol);
+			data += buf;
+		}
+		// Lines cross the block boundaries.
+		REQUIRE(data.size() > 2 * block_size);
+		REQUIRE(data[block_size - 1] != '\n');
+		REQUIRE(data[block_size] != '\n');
+		boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("objparser_%%%%%%.obj");
+		{
+			FILE *f = fopen(path.string().c_str(), "wb");
+			fwrite(data.data(), 1, data.size(), f);
+			fclose(f);
+		}
+		WHEN("the file is parsed by blocks and as a stream") {
+			ObjData parsed, reference;
+			bool ok = objparse(path.string().c_str(), parsed);
+			bool reference_ok;
+			{
+				boost::nowide::ifstream stream(path.string(), std::ios::binary);
+				reference_ok = objparse(stream, reference);
+			}
+			boost::filesystem::remove(path);
+			THEN("the data are the same") {
+				REQUIRE(ok);
+				REQUIRE(reference_ok);
+				REQUIRE(parsed.vertices.size() == 150000 * 4);
+				REQUIRE(objequal(parsed, reference));
+				REQUIRE(parsed.smoothingGroups == reference.smoothingGroups);
+				REQUIRE(parsed.usemtls.size() == reference.usemtls.size());
+				for (size_t i = 0; i < parsed.usemtls.size(); ++ i) {
+					REQUIRE(parsed.usemtls[i].vertexIdxEnd == reference.usemtls[i].vertexIdxEnd);
+					REQUIRE(parsed.usemtls[i].face_start == reference.usemtls[i].face_start);
+					REQUIRE(parsed.usemtls[i].face_end == reference.usemtls[i].face_end);
+				}
+			}
+			THEN("the coordinates are rounded as by strtod()") {
+				REQUIRE(parsed.coordinates.size() == coordinates.size() / 3 * OBJ_VERTEX_LENGTH);
+				size_t num_different = 0;
+				for (size_t i = 0; i < coordinates.size() / 3; ++ i)
+					for (size_t j = 0; j < 3; ++ j) {
+						sprintf(buf, "%.6f", coordinates[i * 3 + j]);
+						if (parsed.coordinates[i * OBJ_VERTEX_LENGTH + j] != float(strtod(buf, nullptr)))
+							++ num_different;
+					}
+				REQUIRE(num_different == 0);
+			}
+		}
+	}
+}
@@ -1,5 +1,10 @@
 #include <catch2/catch.hpp>
 
+#include <atomic>
+#include <thread>
+
+#include <tbb/parallel_for.h>
+
 #include "libslic3r/Point.hpp"
 #include "libslic3r/Polygon.hpp"
 
@@ -148,3 +153,44 @@ SCENARIO("Remove collinear points from Polygon", "[Polygon]") {
         }
     }
 }
+
+SCENARIO("Points allocations counted while other threads allocate", "[Points]") {
+    GIVEN("Points allocated by parallel tasks") {
+        constexpr size_t num_allocations = 1000;
+        constexpr size_t num_points      = 16;
+        WHEN("the allocations are read while the tasks run") {
+            PointsAllocations start = points_allocations();
+            std::atomic<bool> finished { false };
+            bool              monotonic = true;
+            std::thread reader([&finished, &monotonic, start]() {
+                PointsAllocations last = start;
+                while (! finished) {
+                    PointsAllocations current = points_allocations();
+                    monotonic &= current.count >= last.count && current.bytes >= last.bytes;
+                    last = current;
+                }
+            });
+            tbb::parallel_for(size_t(0), num_allocations, [](size_t) {
+                Points pts;
+                pts.reserve(num_points);
+            });
+            finished = true;
+            reader.join();
+            PointsAllocations allocated = points_allocations() - start;
+            THEN("the counters never go back") {
+                REQUIRE(monotonic);
+            }
+#ifdef SLIC3R_POINTS_ALLOCATOR
+            THEN("all the allocations of the tasks are counted") {
+                REQUIRE(allocated.count >= num_allocations);
+                REQUIRE(allocated.bytes >= num_allocations * num_points * sizeof(Point));
+            }
+#else // SLIC3R_POINTS_ALLOCATOR
+            THEN("nothing is counted without the Points allocator") {
+                REQUIRE(allocated.count == 0);
+                REQUIRE(allocated.bytes == 0);
+            }
+#endif // SLIC3R_POINTS_ALLOCATOR
+        }
+    }
+}
@@ -1,6 +1,14 @@
 #include <catch2/catch.hpp>
 
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+
 #include "libslic3r/Model.hpp"
+#include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/Format/STL.hpp"
 
 using namespace Slic3r;
@@ -55,3 +63,257 @@ SCENARIO("Reading an STL file", "[stl]") {
 		}
 	}
 }
+
+static stl_file stl_from_its(const indexed_triangle_set &its)
+{
+	stl_file stl;
+	stl.stats.type = inmemory;
+	stl.stats.number_of_facets    = uint32_t(its.indices.size());
+	stl.stats.original_num_facets = int(its.indices.size());
+	stl_allocate(&stl);
+	bool first = true;
+	for (size_t i = 0; i < its.indices.size(); ++ i) {
+		stl_facet &facet = stl.facet_start[i];
+		for (int j = 0; j < 3; ++ j)
+			facet.vertex[j] = its.vertices[its.indices[i](j)];
+		facet.normal = (facet.vertex[1] - facet.vertex[0]).cross(facet.vertex[2] - facet.vertex[0]).normalized();
+		stl_facet_stats(&stl, facet, first);
+	}
+	stl_get_size(&stl);
+	return stl;
+}
+
+SCENARIO("Welding the shared vertices of an STL", "[stl]") {
+	GIVEN("two cubes touching at a single corner") {
+		indexed_triangle_set its = its_make_cube(10., 10., 10.);
+		indexed_triangle_set other = its;
+		for (stl_vertex &v : other.vertices)
+			v += stl_vertex(10.f, 10.f, 10.f);
+		its_merge(its, other);
+		stl_file stl = stl_from_its(its);
+		WHEN("the facets are connected") {
+			stl_check_facets_exact(&stl);
+			THEN("all edges are connected") {
+				REQUIRE(stl.stats.connected_facets_3_edge == 24);
+				REQUIRE(stl.stats.connected_edges == 72);
+			}
+			THEN("the neighbors are symmetric") {
+				for (int i = 0; i < 24; ++ i)
+					for (int j = 0; j < 3; ++ j) {
+						int other_facet = stl.neighbors_start[i].neighbor[j];
+						REQUIRE(stl.neighbors_start[other_facet].neighbor[(stl.neighbors_start[i].which_vertex_not[j] + 1) % 3] == i);
+					}
+			}
+		}
+		WHEN("the mesh is repaired and its shared vertices are generated") {
+			TriangleMesh mesh;
+			mesh.from_stl(stl, true);
+			THEN("the touching corners are not welded") {
+				REQUIRE(mesh.its.indices.size() == 24);
+				REQUIRE(mesh.its.vertices.size() == 16);
+				REQUIRE(its_num_open_edges(mesh.its) == 0);
+				REQUIRE(mesh.volume() == Approx(2000.));
+			}
+		}
+	}
+}
+
+// The former FILE* based STL reader, fscanf() for ASCII, fread() for binary files, kept as the reference for stl_open().
+static bool stl_open_reference(stl_file *stl, const char *file)
+{
+	const int header_size = LABEL_SIZE + NUM_FACET_SIZE;
+	stl->clear();
+	stl->stats.reset_header(LABEL_SIZE);
+	FILE *fp = boost::nowide::fopen(file, "rb");
+	if (fp == nullptr)
+		return false;
+	fseek(fp, 0, SEEK_END);
+	long file_size = ftell(fp);
+	fseek(fp, header_size, SEEK_SET);
+	unsigned char chtest[128];
+	if (! fread(chtest, sizeof(chtest), 1, fp)) {
+		fclose(fp);
+		return false;
+	}
+	stl->stats.type = ascii;
+	for (size_t s = 0; s < sizeof(chtest); ++ s)
+		if (chtest[s] > 127) {
+			stl->stats.type = binary;
+			break;
+		}
+	rewind(fp);
+	uint32_t num_facets = 0;
+	if (stl->stats.type == binary) {
+		num_facets = (file_size - header_size) / SIZEOF_STL_FACET;
+		fread(stl->stats.header.data(), LABEL_SIZE, 1, fp);
+		fseek(fp, header_size, SEEK_SET);
+	} else {
+		fp = boost::nowide::freopen(file, "r", fp);
+		char linebuf[100];
+		int num_lines = 1;
+		while (fgets(linebuf, 100, fp) != nullptr)
+			if (strlen(linebuf) > 4 && strncmp(linebuf, "solid", 5) != 0 && strncmp(linebuf, "endsolid", 8) != 0)
+				++ num_lines;
+		rewind(fp);
+		int i = 0;
+		for (; i < LABEL_SIZE && (stl->stats.header[i] = getc(fp)) != '\n'; ++ i) ;
+		stl->stats.header[i] = '\0';
+		num_facets = num_lines / ASCII_LINES_PER_FACET;
+		rewind(fp);
+	}
+	stl->stats.number_of_facets = stl->stats.original_num_facets = num_facets;
+	stl_allocate(stl);
+	bool first = true;
+	char normal_buf[3][32];
+	for (uint32_t i = 0; i < num_facets; ++ i) {
+		stl_facet facet;
+		memset(&facet, 0, sizeof(facet));
+		if (stl->stats.type == binary) {
+			if (fread(&facet, 1, SIZEOF_STL_FACET, fp) != SIZEOF_STL_FACET) {
+				fclose(fp);
+				return false;
+			}
+		} else {
+			fscanf(fp, " endsolid%*[^\n]\n");
+			fscanf(fp, " solid%*[^\n]\n");
+			int res_normal  = fscanf(fp, " facet normal %31s %31s %31s", normal_buf[0], normal_buf[1], normal_buf[2]);
+			fscanf(fp, " outer loop");
+			int res_vertex1 = fscanf(fp, " vertex %f %f %f", &facet.vertex[0](0), &facet.vertex[0](1), &facet.vertex[0](2));
+			int res_vertex2 = fscanf(fp, " vertex %f %f %f", &facet.vertex[1](0), &facet.vertex[1](1), &facet.vertex[1](2));
+			int res_vertex3 = fscanf(fp, " vertex %f %f %f ", &facet.vertex[2](0), &facet.vertex[2](1), &facet.vertex[2](2));
+			char buf[2048];
+			fgets(buf, 2047, fp);
+			bool endloop_ok = strncmp(buf, "endloop", 7) == 0;
+			fscanf(fp, " ");
+			fgets(buf, 2047, fp);
+			bool endfacet_ok = strncmp(buf, "endfacet", 8) == 0;
+			if (res_normal != 3 || res_vertex1 != 3 || res_vertex2 != 3 || res_vertex3 != 3 || ! endloop_ok || ! endfacet_ok) {
+				fclose(fp);
+				return false;
+			}
+			if (sscanf(normal_buf[0], "%f", &facet.normal(0)) != 1 ||
+			    sscanf(normal_buf[1], "%f", &facet.normal(1)) != 1 ||
+			    sscanf(normal_buf[2], "%f", &facet.normal(2)) != 1)
+				facet.normal = stl_normal::Zero();
+		}
+		stl->facet_start[i] = facet;
+		stl_facet_stats(stl, facet, first);
+	}
+	fclose(fp);
+	stl->stats.size = stl->stats.max - stl->stats.min;
+	return true;
+}
+
+static void require_same_stl(const stl_file &stl, const stl_file &reference)
+{
+	REQUIRE(stl.stats.type == reference.stats.type);
+	REQUIRE(stl.stats.number_of_facets == reference.stats.number_of_facets);
+	REQUIRE(stl.stats.original_num_facets == reference.stats.original_num_facets);
+	REQUIRE(strcmp(stl.stats.header.data(), reference.stats.header.data()) == 0);
+	REQUIRE(stl.stats.min == reference.stats.min);
+	REQUIRE(stl.stats.max == reference.stats.max);
+	REQUIRE(stl.stats.shortest_edge == reference.stats.shortest_edge);
+	size_t num_different = 0;
+	for (size_t i = 0; i < reference.facet_start.size(); ++ i) {
+		// Bitwise comparison, the mangled normals are NaNs.
+		if (memcmp(&stl.facet_start[i], &reference.facet_start[i], 48) != 0)
+			++ num_different;
+	}
+	REQUIRE(num_different == 0);
+}
+
+// Random facets, the ASCII STL writer below prints them with 9 significant digits to round trip the floats exactly.
+static std::vector<stl_facet> random_facets(size_t num_facets)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> dist(-100.f, 100.f);
+	std::vector<stl_facet> facets(num_facets);
+	for (stl_facet &facet : facets) {
+		for (int i = 0; i < 3; ++ i)
+			facet.vertex[i] = stl_vertex(dist(rng), dist(rng), dist(rng));
+		facet.normal = (facet.vertex[1] - facet.vertex[0]).cross(facet.vertex[2] - facet.vertex[0]).normalized();
+		facet.extra[0] = facet.extra[1] = 0;
+	}
+	return facets;
+}
+
+SCENARIO("Memory mapped STL reader reads the same facets as the former reader", "[stl]") {
+	// stl_open() splits the file into chunks of 4MB.
+	static constexpr const size_t block_size = 1 << 22;
+	boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("stl_reader_%%%%%%.stl");
+	GIVEN("an ASCII STL file larger than the block size") {
+		const std::vector<stl_facet> facets = random_facets(40000);
+		std::string data = "solid first part\n";
+		char buf[256];
+		for (size_t i = 0; i < facets.size(); ++ i) {
+			const stl_facet &f = facets[i];
+			// Different line endings, indentation, text after the end tags, solid / endsolid pairs and mangled normals in the middle.
+			const char *eol = i % 3 == 0 ? "\r\n" : "\n";
+			if (i % 5000 == 2500)
+				data += "endsolid first part\nsolid second part\n";
+			if (i % 997 == 0)
+				sprintf(buf, "facet normal nan inf -nan%s", eol);
+			else
+				sprintf(buf, "  facet normal %.9g %.9g %.9g%s", f.normal.x(), f.normal.y(), f.normal.z(), eol);
+			data += buf;
+			sprintf(buf, "\touter loop%s", eol);
+			data += buf;
+			for (int j = 0; j < 3; ++ j) {
+				sprintf(buf, "\t\tvertex %.9g %.9g %.9g%s", f.vertex[j].x(), f.vertex[j].y(), f.vertex[j].z(), eol);
+				data += buf;
+			}
+			sprintf(buf, i % 7 == 0 ? "\tendloop garbage%s  endfacet\t more garbage%s" : "\tendloop%s  endfacet%s", eol, eol);
+			data += buf;
+		}
+		data += "endsolid second part\n";
+		// A line crosses the block boundary.
+		REQUIRE(data.size() > 2 * block_size);
+		REQUIRE(data[block_size - 1] != '\n');
+		REQUIRE(data[block_size] != '\n');
+		{
+			FILE *f = boost::nowide::fopen(path.string().c_str(), "wb");
+			fwrite(data.data(), 1, data.size(), f);
+			fclose(f);
+		}
+		WHEN("the file is read by both readers") {
+			stl_file stl, reference;
+			bool ok           = stl_open(&stl, path.string().c_str());
+			bool reference_ok = stl_open_reference(&reference, path.string().c_str());
+			boost::filesystem::remove(path);
+			THEN("the facets and statistics are the same") {
+				REQUIRE(ok);
+				REQUIRE(reference_ok);
+				REQUIRE(stl.stats.number_of_facets == facets.size());
+				require_same_stl(stl, reference);
+			}
+		}
+	}
+	GIVEN("a binary STL file larger than the block size") {
+		const std::vector<stl_facet> facets = random_facets(100000);
+		{
+			FILE *f = boost::nowide::fopen(path.string().c_str(), "wb");
+			char header[LABEL_SIZE];
+			memset(header, ' ', LABEL_SIZE);
+			memcpy(header, "binary reference", 16);
+			fwrite(header, 1, LABEL_SIZE, f);
+			uint32_t num_facets = uint32_t(facets.size());
+			fwrite(&num_facets, 1, 4, f);
+			for (const stl_facet &facet : facets)
+				fwrite(&facet, 1, SIZEOF_STL_FACET, f);
+			fclose(f);
+		}
+		REQUIRE(boost::filesystem::file_size(path) > block_size);
+		WHEN("the file is read by both readers") {
+			stl_file stl, reference;
+			bool ok           = stl_open(&stl, path.string().c_str());
+			bool reference_ok = stl_open_reference(&reference, path.string().c_str());
+			boost::filesystem::remove(path);
+			THEN("the facets and statistics are the same") {
+				REQUIRE(ok);
+				REQUIRE(reference_ok);
+				REQUIRE(stl.stats.number_of_facets == facets.size());
+				require_same_stl(stl, reference);
+			}
+		}
+	}
+}